@@ -251,6 +251,7 @@
 #include "include/qc.h"             // Quality Control Min and Max Sensor Values on Surface of the Earth
 #include "include/mkrboard.h"       // MKR Related Board Functions and Definations
 #include "include/support.h"        // Support Functions
+#include "include/i2c.h"            // I2C Bus Health and Recovery
 #include "include/output.h"         // Serial and OLED Output Functions
 #include "include/cf.h"             // Configuration File Variables
 #include "include/eeprom.h"         // EEPROM Functions
@@ -259,10 +260,15 @@
 #include "include/time.h"           // Time Management Functions
 #include "include/network.h"        // MKR modem network related functions
 #include "include/wrda.h"           // Wind Rain Distance Air Functions
+#include "include/adc.h"            // Analog Option Pin Sampling Service
+#include "include/burst.h"          // High Rate Wind Burst Functions
+#include "include/cal.h"            // Calibration Streaming Functions
+#include "include/lux.h"            // Lux Sensor Service
 #include "include/mux.h"            // Mux Functions for mux connected sensors
 #include "include/dsmux.h"          // Dallas One Wire Mux Functions
 #include "include/sensors_i2c_44_47.h" // Handle i2c Sensors in this address range
 #include "include/sensors.h"        // I2C Based Sensor Functions
+#include "include/hotplug.h"        // Background Sensor Discovery
 #include "include/statmon.h"        // Station Monitor Functions
 #include "include/obs.h"            // Observation Functions
 #include "include/info.h"           // Info Functions
@@ -335,19 +341,29 @@ unsigned long time_to_next_obs() {
  */
 void HeartBeat() {
   digitalWrite(HEARTBEAT_PIN, HIGH);
-  delay(250);
+  WB_Delay(250);
   digitalWrite(HEARTBEAT_PIN, LOW);
 }
 
 /*
  * ======================================================================================================================
- * BackGroundWork() - Take Sensor Reading, Check LoRa for Messages, Delay 1 Second for use as timming delay            
- *                    Anything that needs sampling or to run every second add below.
+ * BackGroundTasks() - The once a second sampling and service work of BackGroundWork(), without its waits.
+ *                     CAL_Stream() runs this once a second so sampling carries on while it streams.
  * ======================================================================================================================
  */
-void BackGroundWork() {
-  unsigned long OneSecondFromNow = millis() + 1000;
-  
+void BackGroundTasks() {
+  if (!cf_nowind) {
+    Wind_AngleRequest(); // On the wire while the tasks below run, Wind_TakeReading() collects it
+  }
+
+  if (TurnLedOff) {   // Turned on when a rain gauge tip was counted in the last second
+    digitalWrite(LED_PIN, LOW);  
+    TurnLedOff = false;
+  }
+
+  Rain_Drain(); // Count rain gauge tips queued by the interrupt handlers
+  ADC_Service(); // Start this second's analog option pin conversions
+
   ConnectionState = conMan->check();  
   NetworkTimeManagement();
 
@@ -359,9 +375,32 @@ void BackGroundWork() {
     Wind_TakeReading();
   }
 
-  if (PM25AQI_exists) {
+  WB_Service(); // Start, write and end high rate wind bursts
+
+  LUX_Service(); // Keep the latest lux, VEML7700 auto range one step per read
+
+  I2C_Service(); // Recover the bus and sensors after repeated I2C failures
+
+  HP_Service(); // Probe one sensor, bring found ones online and missing ones offline
+
+  if (AQS_Enabled) {
+    AQS_Service(); // Duty cycle the air quality sensor, sampled just before each observation
+  }
+  else if (PM25AQI_exists) {
     pm25aqi_TakeReading();
   }
+}
+
+/*
+ * ======================================================================================================================
+ * BackGroundWork() - Take Sensor Reading, Check LoRa for Messages, Delay 1 Second for use as timming delay            
+ *                    Anything that needs sampling or to run every second add to BackGroundTasks().
+ * ======================================================================================================================
+ */
+void BackGroundWork() {
+  unsigned long OneSecondFromNow = millis() + 1000;
+  
+  BackGroundTasks();
   
   HeartBeat(); // Provides a 250ms delay
   
@@ -371,12 +410,7 @@ void BackGroundWork() {
 
   unsigned long TimeRemaining = (OneSecondFromNow - millis());
   if ((TimeRemaining > 0) && (TimeRemaining < 1000)) {
-    delay (TimeRemaining);
-  }
-  
-  if (TurnLedOff) {   // Turned on by rain gauge interrupt handler
-    digitalWrite(LED_PIN, LOW);  
-    TurnLedOff = false;
+    WB_Delay (TimeRemaining);  // Takes burst samples while it waits
   }
 }
 
@@ -388,6 +422,7 @@ void BackGroundWork() {
 void setup() 
 {
   pinMode (LED_PIN, OUTPUT);
+  I2C_Begin();  // Before the OLED, the first I2C user
   Output_Initialize();
   delay(2000); // prevents usb driver crash on startup, do not omit this
 
@@ -402,6 +437,7 @@ void setup()
   Output (msgbuf);
 
   ECCX08_initialize();
+  I2C_ClockReset(); // The ECCX08 library leaves Wire at 1 MHz
   sprintf (Buffer32Bytes, "CryptoID:%s", CryptoID);
   Output(Buffer32Bytes);
 
@@ -447,6 +483,9 @@ void setup()
 
   EEPROM_initialize();
 
+  // Find the Need to Send spool, moves a N2SOBS.TXT into it using the EEPROM file position
+  SD_N2S_Initialize();
+
   obs_interval_initialize();
 
   INFO_Initialize();
@@ -462,7 +501,7 @@ void setup()
     pinMode(RAINGAUGE1_IRQ_PIN, INPUT);
     raingauge1_interrupt_count = 0;
     raingauge1_interrupt_stime = millis();
-    raingauge1_interrupt_ltime = 0;  // used to debounce the tip
+    Rain_Clear(&raingauge1, cf_rg1_debounce);
     attachInterrupt(RAINGAUGE1_IRQ_PIN, raingauge1_interrupt_handler, FALLING);
     Output (F("RG1:ENABLED"));
   }
@@ -475,7 +514,7 @@ void setup()
     pinMode(RAINGAUGE2_IRQ_PIN, INPUT);
     raingauge2_interrupt_count = 0;
     raingauge2_interrupt_stime = millis();
-    raingauge2_interrupt_ltime = 0;  // used to debounce the tip
+    Rain_Clear(&raingauge2, cf_rg2_debounce);
     attachInterrupt(RAINGAUGE2_IRQ_PIN, raingauge2_interrupt_handler, FALLING);
     Output (F("RG2:ENABLED"));
   }
@@ -483,6 +522,17 @@ void setup()
     Output (F("RG2:NOT ENABLED"));
   }
 
+  // Distance Gauge Running Median
+  if ((cf_op1 == OP1_STATE_DIST_5M) || (cf_op1 == OP1_STATE_DIST_10M)) {
+    DS_Clear();
+  }
+
+  // Analog Option Pins - OP1 raw or distance, OP2 raw or Voltaic
+  ADC_Begin();
+
+  // Air Quality Station, OP2 powers the PM25AQI when op2 is not in use
+  OPT_AQS_Initialize();
+
   // I2C Sensors
 
   if (cf_nowind) {
@@ -490,11 +540,13 @@ void setup()
   }
   else {
     Output (F("WIND:ENABLED"));
+    Wind_Clear();
     as5600_initialize();
     // Optipolar Hall Effect Sensor SS451A - Wind Speed
     pinMode(ANEMOMETER_IRQ_PIN, INPUT);
     anemometer_interrupt_count = 0;
     anemometer_interrupt_stime = millis();
+    Wind_PeriodClear(&ws_pulse);
     attachInterrupt(ANEMOMETER_IRQ_PIN, anemometer_interrupt_handler, FALLING);
   }
   
@@ -528,6 +580,9 @@ void setup()
   hi_initialize();
   wbgt_initialize();
   mslp_initialize();
+  I2C_ClockReset(); // The sensor library begin() calls leave Wire at 100 kHz
+
+  HP_Initialize(); // Sensors found now, the rest are probed for in the background
 
   Output(F("CM:CHECK"));
   // When not connected to a cellular network, conMan.check(); may hang or block for a long time because it internally 
@@ -569,6 +624,11 @@ void setup()
 void loop() 
 {
   BackGroundWork();
+
+  // Serial console commands, "CAL" starts calibration streaming
+  if (SerialConsoleEnabled) {
+    CAL_Command();
+  }
   
   // If Serial Console Pin LOW then Display Station Information
   // if (0 && DSM_countdown && digitalRead(SCE_PIN) == LOW) { //<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<< REMOVE 0 for production!!!!!!!!!
@@ -610,6 +670,7 @@ void loop()
     // Check to see if we should reset after so many loops with out a network connection
     if (NoNetworkLoopCycleCount >= cf_no_network_reset_count) {
       Output(F("NW TimeOut:Reboot"));
+      SD_LogClose();
       delay (5000);
       conMan->disconnect();  // Disconnect calls NB.shutdown() which calls send("AT+CPWROFF")       
       digitalWrite(REBOOT_PIN, HIGH);
@@ -622,6 +683,7 @@ void loop()
     // Check to see if we should reset the modem after so many publish fails
     if (OBS_PubFailCnt >= PUB_FAILS_BEFORE_ACTION) {
       Output(F("Publish Fail - Resetting Modem!"));
+      SD_LogSync();
       modem.hardReset();
 
       Output(F("Publish Fail - Waiting 12s"));
@@ -639,6 +701,7 @@ void loop()
     if (--DailyRebootCountDownTimer<=0) {
       // Lets not rip the rug out from the modem. Do a graceful shutdown.
       Output (F("Daily Reboot"));
+      SD_LogClose();
       delay (5000);  
       conMan->disconnect();  // Disconnect calls NB.shutdown() which calls send("AT+CPWROFF")        
       digitalWrite(REBOOT_PIN, HIGH);
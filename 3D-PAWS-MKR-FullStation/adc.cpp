@@ -0,0 +1,224 @@
+/*
+ * ======================================================================================================================
+ * adc.cpp - Analog Option Pin Sampling Service
+ * ======================================================================================================================
+ */
+#include <Arduino.h>
+#include <wiring_private.h>  // pinPeripheral()
+
+#include "include/cf.h"
+#include "include/output.h"
+#include "include/main.h"
+#include "include/wrda.h"
+#include "include/adc.h"
+
+/*
+ * ======================================================================================================================
+ * Variables and Data Structures
+ * =======================================================================================================================
+ */
+ADC_CHANNEL_STR adc_channel[ADC_CHANNELS];
+volatile int adc_active = -1;        // Channel being converted, -1 when the round is done
+volatile bool adc_discard = false;   // Next result is the settling conversion after a pin change
+
+/*
+ * ======================================================================================================================
+ * Fuction Definations
+ * =======================================================================================================================
+ */
+
+/*
+ * ======================================================================================================================
+ * ADC_Sync() - Wait for ADC register writes to reach the ADC clock domain
+ * ======================================================================================================================
+ */
+void ADC_Sync() {
+  while (ADC->STATUS.bit.SYNCBUSY);
+}
+
+/*
+ * ======================================================================================================================
+ * ADC_Start() - Switch the ADC input to channel c and start the settling conversion
+ * ======================================================================================================================
+ */
+void ADC_Start(int c) {
+  adc_active = c;
+  adc_discard = true;
+  ADC->INPUTCTRL.bit.MUXPOS = adc_channel[c].mux;
+  ADC_Sync();
+  ADC->SWTRIG.bit.START = 1;
+}
+
+/*
+ * ======================================================================================================================
+ * ADC_Next() - Index of the next channel in use after channel c, -1 if none
+ * ======================================================================================================================
+ */
+int ADC_Next(int c) {
+  for (c++; c<ADC_CHANNELS; c++) {
+    if (adc_channel[c].pin != -1) {
+      return (c);
+    }
+  }
+  return (-1);
+}
+
+/*
+ * ======================================================================================================================
+ * ADC_Handler() - Result ready interrupt, store the result and move on to the next pin
+ * ======================================================================================================================
+ */
+void ADC_Handler() {
+  uint16_t r = ADC->RESULT.reg;  // Reading the result clears the interrupt
+  ADC_CHANNEL_STR *ch;
+  int c = adc_active;
+
+  if (c == -1) {
+    return;
+  }
+
+  if (adc_discard) {
+    adc_discard = false;
+    ADC->SWTRIG.bit.START = 1;
+    return;
+  }
+
+  ch = &adc_channel[c];
+  ch->latest = r;
+  ch->result[ch->idx] = r;
+  ch->idx = (ch->idx + 1) % ADC_AVG_RESULTS;
+  if (ch->count < ADC_AVG_RESULTS) {
+    ch->count++;
+  }
+
+  c = ADC_Next(c);
+  if (c == -1) {
+    adc_active = -1;
+  }
+  else {
+    ADC_Start(c);
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * ADC_AddPin() - Add an analog pin to the service
+ * ======================================================================================================================
+ */
+void ADC_AddPin(int c, int pin) {
+  pinPeripheral(pin, PIO_ANALOG);
+  adc_channel[c].pin = pin;
+  adc_channel[c].mux = g_APinDescription[pin].ulADCChannelNumber;
+  sprintf (msgbuf, "ADC:A%d", pin - A0);
+  Output (msgbuf);
+}
+
+/*
+ * ======================================================================================================================
+ * ADC_Begin() - Set up the ADC for 16x averaged 12 bit results and pick the option pins that need sampling
+ *               Waits for the first round so readings are available right away.
+ * ======================================================================================================================
+ */
+void ADC_Begin() {
+  unsigned long start;
+
+  Output (F("ADC:INIT"));
+  memset(adc_channel, 0, sizeof(adc_channel));
+  adc_channel[0].pin = -1;
+  adc_channel[1].pin = -1;
+
+  if ((cf_op1 == OP1_STATE_RAW) || (cf_op1 == OP1_STATE_DIST_5M) || (cf_op1 == OP1_STATE_DIST_10M)) {
+    ADC_AddPin(0, OP1_PIN);
+  }
+  if ((cf_op2 == OP2_STATE_RAW) || (cf_op2 == OP2_STATE_VOLTAIC)) {
+    ADC_AddPin(1, OP2_PIN);
+  }
+  if (ADC_Next(-1) == -1) {
+    Output (F("ADC:NO PINS"));
+    return;
+  }
+
+  ADC->CTRLA.bit.ENABLE = 0;
+  ADC_Sync();
+  ADC->CTRLB.bit.RESSEL = ADC_CTRLB_RESSEL_16BIT_Val;  // Required for averaging
+  ADC_Sync();
+  ADC->AVGCTRL.reg = ADC_AVGCTRL_SAMPLENUM_16 | ADC_AVGCTRL_ADJRES(4);  // Sum of 16 divided by 16, 12 bit
+  ADC_Sync();
+  ADC->INTFLAG.reg = ADC_INTFLAG_RESRDY;
+  ADC->INTENSET.reg = ADC_INTENSET_RESRDY;
+  NVIC_EnableIRQ(ADC_IRQn);
+  ADC->CTRLA.bit.ENABLE = 1;
+  ADC_Sync();
+
+  ADC_Service();
+  start = millis();
+  while ((adc_active != -1) && ((millis() - start) < ADC_PRIME_MS));
+}
+
+/*
+ * ======================================================================================================================
+ * ADC_Service() - Called every second, start a round of conversions if the last one has finished
+ * ======================================================================================================================
+ */
+void ADC_Service() {
+  int c = ADC_Next(-1);
+
+  if ((c != -1) && (adc_active == -1)) {
+    ADC_Start(c);
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * ADC_Channel() - Channel sampling pin, NULL if the pin is not in the service
+ * ======================================================================================================================
+ */
+ADC_CHANNEL_STR *ADC_Channel(int pin) {
+  for (int c=0; c<ADC_CHANNELS; c++) {
+    if (adc_channel[c].pin == pin) {
+      return (&adc_channel[c]);
+    }
+  }
+  return (NULL);
+}
+
+/*
+ * ======================================================================================================================
+ * ADC_PinAvg() - Average of the last ADC_AVG_RESULTS 1s results for pin, 0-4095, -1 if none
+ * ======================================================================================================================
+ */
+float ADC_PinAvg(int pin) {
+  ADC_CHANNEL_STR *ch = ADC_Channel(pin);
+  unsigned long total = 0;
+  int n;
+
+  if (ch == NULL) {
+    return (-1);
+  }
+
+  noInterrupts();
+  n = ch->count;
+  for (int i=0; i<n; i++) {
+    total += ch->result[i];
+  }
+  interrupts();
+
+  if (n == 0) {
+    return (-1);
+  }
+  return ((float) total / n);
+}
+
+/*
+ * ======================================================================================================================
+ * ADC_PinLatest() - Last 1s result for pin, 0-4095, -1 if none
+ * ======================================================================================================================
+ */
+int ADC_PinLatest(int pin) {
+  ADC_CHANNEL_STR *ch = ADC_Channel(pin);
+
+  if ((ch == NULL) || (ch->count == 0)) {
+    return (-1);
+  }
+  return (ch->latest);
+}
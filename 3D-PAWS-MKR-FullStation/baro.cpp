@@ -0,0 +1,136 @@
+/*
+ * ======================================================================================================================
+ * baro.cpp - Barometer Functions
+ * ======================================================================================================================
+ */
+#include <Arduino.h>
+#include <Adafruit_BME280.h>
+#include <Adafruit_BMP280.h>
+#include <Adafruit_BMP3XX.h>
+#include <Adafruit_BMP5xx.h>
+#include <Adafruit_LPS35HW.h>
+
+#include "include/baro.h"
+
+/*
+ * ======================================================================================================================
+ * Fuction Definations
+ * =======================================================================================================================
+ */
+
+/*
+ * ======================================================================================================================
+ * BARO_Continuous() - Put the barometer in normal mode with oversampling and the IIR filter
+ * ======================================================================================================================
+ */
+bool BARO_Continuous(BARO_STR *b) {
+  switch (b->type) {
+    case BARO_BMP280 : {
+      // 43ms conversion plus 500ms standby, 1.8 Hz
+      Adafruit_BMP280 *bmp = (Adafruit_BMP280 *) b->dev;
+      bmp->setSampling(Adafruit_BMP280::MODE_NORMAL,
+                       Adafruit_BMP280::SAMPLING_X2,     // Temperature
+                       Adafruit_BMP280::SAMPLING_X16,    // Pressure
+                       Adafruit_BMP280::FILTER_X16,
+                       Adafruit_BMP280::STANDBY_MS_500);
+      return (true);
+    }
+
+    case BARO_BME280 : {
+      // 45ms conversion plus 500ms standby, 1.8 Hz
+      Adafruit_BME280 *bme = (Adafruit_BME280 *) b->dev;
+      bme->setSampling(Adafruit_BME280::MODE_NORMAL,
+                       Adafruit_BME280::SAMPLING_X2,     // Temperature
+                       Adafruit_BME280::SAMPLING_X16,    // Pressure
+                       Adafruit_BME280::SAMPLING_X1,     // Humidity, the IIR filter is not applied to it
+                       Adafruit_BME280::FILTER_X16,
+                       Adafruit_BME280::STANDBY_MS_500);
+      return (true);
+    }
+
+    case BARO_BMP3XX : {
+      // 37ms conversion, ODR 1.5 Hz
+      Adafruit_BMP3XX *bm3 = (Adafruit_BMP3XX *) b->dev;
+      bm3->setTemperatureOversampling(BMP3_OVERSAMPLING_2X);
+      bm3->setPressureOversampling(BMP3_OVERSAMPLING_16X);
+      bm3->setIIRFilterCoeff(BMP3_IIR_FILTER_COEFF_15);
+      bm3->setOutputDataRate(BMP3_ODR_1_5_HZ);
+      return (bm3->startNormalMode());
+    }
+
+    case BARO_BMP5XX : {
+      Adafruit_BMP5xx *bmp5 = (Adafruit_BMP5xx *) b->dev;
+      return (bmp5->setTemperatureOversampling(BMP5XX_OVERSAMPLING_2X) &&
+              bmp5->setPressureOversampling(BMP5XX_OVERSAMPLING_16X) &&
+              bmp5->setIIRFilterCoeff(BMP5XX_IIR_FILTER_COEFF_15) &&
+              bmp5->setOutputDataRate(BMP5XX_ODR_02_HZ) &&
+              bmp5->setPowerMode(BMP5XX_POWERMODE_NORMAL));
+    }
+
+    case BARO_LPS35HW : {
+      // Low pass filter bandwidth ODR/9
+      Adafruit_LPS35HW *lps = (Adafruit_LPS35HW *) b->dev;
+      lps->setDataRate(LPS35HW_RATE_1_HZ);
+      lps->enableLowPass(false);
+      return (true);
+    }
+
+    default :
+      return (false);
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * BARO_Read() - Read the latest result, p hPa, t C, h %. NAN if not measured or on error
+ * ======================================================================================================================
+ */
+bool BARO_Read(BARO_STR *b, float &p, float &t, float &h) {
+  bool ok = false;
+
+  p = t = h = NAN;
+
+  switch (b->type) {
+    case BARO_BMP280 :
+      if ((ok = ((Adafruit_BMP280 *) b->dev)->readAll(&t, &p))) {
+        p = p/100.0F;
+      }
+      break;
+
+    case BARO_BME280 :
+      if ((ok = ((Adafruit_BME280 *) b->dev)->readAll(&t, &p, &h))) {
+        p = p/100.0F;
+      }
+      break;
+
+    case BARO_BMP3XX : {
+      Adafruit_BMP3XX *bm3 = (Adafruit_BMP3XX *) b->dev;
+      if ((ok = bm3->performReading())) {
+        p = bm3->pressure/100.0F;
+        t = bm3->temperature;
+      }
+      break;
+    }
+
+    case BARO_BMP5XX : {
+      Adafruit_BMP5xx *bmp5 = (Adafruit_BMP5xx *) b->dev;
+      if ((ok = bmp5->performReading())) {
+        p = bmp5->pressure;                  // Library returns hPa
+        t = bmp5->temperature;
+      }
+      break;
+    }
+
+    case BARO_LPS35HW :
+      ok = ((Adafruit_LPS35HW *) b->dev)->readAll(&t, &p);
+      break;
+
+    default :
+      break;
+  }
+
+  if (!ok) {
+    p = t = h = NAN;
+  }
+  return (ok);
+}
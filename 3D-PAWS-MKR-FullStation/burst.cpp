@@ -0,0 +1,292 @@
+/*
+ * ======================================================================================================================
+ * burst.cpp - High Rate Wind Burst
+ * ======================================================================================================================
+ */
+#include <Arduino.h>
+#include <SdFat.h>
+#include <RTCZero.h>
+
+#include "include/ssbits.h"
+#include "include/cf.h"
+#include "include/output.h"
+#include "include/sdcard.h"
+#include "include/time.h"
+#include "include/main.h"
+#include "include/wrda.h"
+#include "include/burst.h"
+
+/*
+ * ======================================================================================================================
+ * Variables and Data Structures
+ * =======================================================================================================================
+ */
+WB_STR wb;
+WB_RESULT_STR wb_result;
+File WB_fp;                          // Kept out of WB_STR, that is cleared with memset()
+char WB_dir[] = "/WB";
+
+/*
+ * ======================================================================================================================
+ * Fuction Definations
+ * =======================================================================================================================
+ */
+
+/*
+ * ======================================================================================================================
+ * WB_Stats() - Add a sample to the online statistics
+ *   Welford mean and variance, Q15 vector sums as in Wind_TakeReading() and a running 3s sum that only
+ *   counts windows of consecutive slots.
+ * ======================================================================================================================
+ */
+void WB_Stats(float speed, int angle, bool consecutive) {
+  double d;
+  int32_t cms = (int32_t) (speed * 100.0f + 0.5f);
+  int window = WB_GUST_SECONDS * cf_wb_rate;
+
+  wb.n++;
+  d = speed - wb.mean;
+  wb.mean += d / wb.n;
+  wb.m2 += d * (speed - wb.mean);
+
+  if (angle == -1) {
+    wb.angle_bad++;
+  }
+  else {
+    wb.ns_sum += (int32_t) Wind_Cos_Q15(angle) * cms;
+    wb.ew_sum += (int32_t) Wind_Sin_Q15(angle) * cms;
+  }
+
+  if (!consecutive) {
+    wb.gust_fill = 0;
+    wb.gust_sum = 0;
+  }
+  if (wb.gust_fill >= window) {
+    wb.gust_sum -= wb.gust_ring[wb.gust_idx];
+  }
+  else {
+    wb.gust_fill++;
+  }
+  wb.gust_ring[wb.gust_idx] = speed;
+  wb.gust_sum += speed;
+  wb.gust_idx = (wb.gust_idx + 1) % window;
+  if ((wb.gust_fill >= window) && ((wb.gust_sum / window) > wb.gust)) {
+    wb.gust = wb.gust_sum / window;
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * WB_Poll() - Take a burst sample when its slot is due. Slots missed while the main loop was busy are skipped.
+ * ======================================================================================================================
+ */
+void WB_Poll() {
+  uint32_t now, late, pulses, last_us;
+  WB_SAMPLE_STR *s;
+  float speed;
+  int angle;
+  bool consecutive;
+
+  if (!wb.active || (wb.slot >= wb.slots)) {
+    return;
+  }
+  now = micros();
+  if ((int32_t)(now - wb.next_us) < 0) {
+    return;
+  }
+
+  late = (now - wb.next_us) / wb.period_us;
+  consecutive = (late == 0);
+  wb.slot += late;
+  wb.next_us += (late + 1) * wb.period_us;
+
+  if (wb.slot < wb.slots) {
+    noInterrupts();
+    pulses = anemometer_pulses;
+    last_us = anemometer_interrupt_last_us;
+    interrupts();
+    speed = Wind_PeriodSpeed(&wb.pulse, pulses - wb.pulses, last_us, last_us, now);
+    wb.pulses = pulses;
+    angle = Wind_ReadAngle();
+
+    WB_Stats(speed, angle, consecutive);
+
+    if ((uint16_t)(wb.head - wb.tail) < WB_RING) {
+      s = &wb.ring[wb.head & WB_RING_MASK];
+      s->slot = wb.slot;
+      s->speed = (uint16_t) (speed * 100.0f + 0.5f);
+      s->angle = (angle == -1) ? WB_NODATA : angle;
+      wb.head++;
+    }
+    else {
+      wb.lost++;
+    }
+    wb.slot++;
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * WB_Delay() - Wait ms, taking burst samples as their slots come due. Used in place of delay() for the waits in 
+ *              the main loop, where no I2C transaction is in progress.
+ * ======================================================================================================================
+ */
+void WB_Delay(unsigned long ms) {
+  unsigned long start = millis();
+
+  if (!wb.active) {
+    delay(ms);
+    return;
+  }
+  while ((millis() - start) < ms) {
+    WB_Poll();
+    delay(1);
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * WB_Write() - Write buffered samples to the burst file
+ * ======================================================================================================================
+ */
+void WB_Write() {
+  uint16_t head = wb.head;  // Sampler can run while the SD card is busy, take what is there now
+  uint16_t n;
+
+  while (wb.tail != head) {
+    // Contiguous run up to the end of the ring or head
+    n = head - wb.tail;
+    if (n > (WB_RING - (wb.tail & WB_RING_MASK))) {
+      n = WB_RING - (wb.tail & WB_RING_MASK);
+    }
+    if (WB_fp) {
+      if (WB_fp.write((uint8_t *) &wb.ring[wb.tail & WB_RING_MASK], n * sizeof(WB_SAMPLE_STR)) !=
+          (n * sizeof(WB_SAMPLE_STR))) {
+        SystemStatusBits |= SSB_SD;  // Turn On Bit
+      }
+    }
+    wb.tail += n;
+  }
+  if (WB_fp) {
+    WB_fp.flush();
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * WB_Start() - Open the burst file and start sampling
+ * ======================================================================================================================
+ */
+void WB_Start(uint32_t epoch) {
+  WB_HEADER_STR h;
+  char dir[16];
+  char fn[40];
+  uint32_t last_us;
+  time_t ts = epoch;
+  tm *dt = gmtime(&ts);
+
+  memset(&wb, 0, sizeof(WB_STR));
+  wb.start_window = epoch / (cf_wb_interval * 60);
+  wb.period_us = 1000000 / cf_wb_rate;
+  wb.slots = WB_MINUTES * 60 * cf_wb_rate;
+
+  // Seed the pulse history with the last pulse before the burst, so the first sample measures a period from it
+  noInterrupts();
+  wb.pulses = anemometer_pulses;
+  last_us = anemometer_interrupt_last_us;
+  interrupts();
+  Wind_PeriodClear(&wb.pulse);
+  if (wb.pulses) {
+    wb.pulse.pulse_us = last_us;
+    wb.pulse.valid = true;
+  }
+
+  sprintf (dir, "%s/%04d", WB_dir, dt->tm_year+1900);
+  if (!SD.exists(dir)) {
+    SD.mkdir(dir);  // Makes WB_dir too
+  }
+  sprintf (fn, "%s/%02d%02d%02d%02d.WB", dir, dt->tm_mon+1, dt->tm_mday, dt->tm_hour, dt->tm_min);
+  WB_fp = SD.open(fn, FILE_WRITE);
+  if (!WB_fp) {
+    SystemStatusBits |= SSB_SD;  // Turn On Bit
+    sprintf (msgbuf, "WB:OPEN ERR %s", fn);
+    Output (msgbuf);
+    // Still take the burst, the statistics are reported
+  }
+  else {
+    memcpy(h.magic, "WB01", 4);
+    h.start = epoch;
+    h.rate = cf_wb_rate;
+    h.slots = wb.slots;
+    h.radius = ws_radius;
+    h.calibration = ws_calibration;
+    WB_fp.write((uint8_t *) &h, sizeof(h));
+    sprintf (msgbuf, "WB:START %s", fn);
+    Output (msgbuf);
+  }
+
+  wb.next_us = micros() + wb.period_us;  // A slot is sampled at its end, over the pulses in it
+  wb.active = true;
+}
+
+/*
+ * ======================================================================================================================
+ * WB_End() - Write the last samples, close the file and set the results for the next observation
+ * ======================================================================================================================
+ */
+void WB_End() {
+  wb.active = false;
+  WB_Write();
+  if (WB_fp) {
+    WB_fp.close();
+  }
+
+  wb_result.samples = wb.n;
+  wb_result.ws = wb.mean;
+  wb_result.sd = (wb.n > 1) ? sqrt(wb.m2 / (wb.n - 1)) : 0;
+  wb_result.gust = wb.gust;
+  wb_result.wd = (wb.angle_bad) ? -1 : Wind_VectorToDegrees(wb.ns_sum, wb.ew_sum);
+  if (wb.mean >= WB_MIN_MEAN) {
+    wb_result.ti = wb_result.sd / wb.mean;
+    wb_result.gf = wb.gust / wb.mean;
+  }
+  else {
+    wb_result.ti = WB_ERR;
+    wb_result.gf = WB_ERR;
+  }
+  wb_result.pending = (wb.n > 0);
+
+  sprintf (msgbuf, "WB:END N%u L%u WS%.1f TI%.2f GF%.2f", wb.n, wb.lost, wb_result.ws, wb_result.ti, wb_result.gf);
+  Output (msgbuf);
+}
+
+/*
+ * ======================================================================================================================
+ * WB_Service() - Called every second from BackGroundWork(), start and end bursts and write buffered samples
+ * ======================================================================================================================
+ */
+void WB_Service() {
+  uint32_t epoch;
+
+  if (!cf_wb_rate || cf_nowind || !AS5600_exists) {
+    return;
+  }
+
+  if (wb.active) {
+    if (wb.slot >= wb.slots) {
+      WB_End();
+    }
+    else if ((uint16_t)(wb.head - wb.tail) >= WB_WRITE_AT) {
+      WB_Write();
+    }
+    return;
+  }
+
+  if (STC_valid && SD_exists) {
+    epoch = stc.getEpoch();
+    // Bursts start in the first minute of each wb_interval window
+    if (((epoch % (cf_wb_interval * 60)) < 60) && ((epoch / (cf_wb_interval * 60)) != wb.start_window)) {
+      WB_Start(epoch);
+    }
+  }
+}
@@ -0,0 +1,188 @@
+/*
+ * ======================================================================================================================
+ * cal.cpp - Calibration Streaming over USB Serial
+ * ======================================================================================================================
+ */
+#include <Arduino.h>
+
+#include "include/output.h"
+#include "include/support.h"
+#include "include/sensors.h"
+#include "include/main.h"
+#include "include/wrda.h"
+#include "include/adc.h"
+#include "include/burst.h"
+#include "include/cal.h"
+
+/*
+ * ======================================================================================================================
+ * Variables and Data Structures
+ * =======================================================================================================================
+ */
+char cal_cmd[CAL_CMD_SIZE];
+int cal_cmd_len = 0;
+
+/*
+ * ======================================================================================================================
+ * Fuction Definations
+ * =======================================================================================================================
+ */
+
+/*
+ * ======================================================================================================================
+ * CAL_Put16() / CAL_Put32() / CAL_PutFloat() - Little endian into the payload, returns the next position
+ * ======================================================================================================================
+ */
+uint8_t *CAL_Put16(uint8_t *p, uint16_t v) {
+  *p++ = v;
+  *p++ = v >> 8;
+  return (p);
+}
+
+uint8_t *CAL_Put32(uint8_t *p, uint32_t v) {
+  *p++ = v;
+  *p++ = v >> 8;
+  *p++ = v >> 16;
+  *p++ = v >> 24;
+  return (p);
+}
+
+uint8_t *CAL_PutFloat(uint8_t *p, float f) {
+  uint32_t v;
+  memcpy(&v, &f, sizeof(v));
+  return (CAL_Put32(p, v));
+}
+
+/*
+ * ======================================================================================================================
+ * CAL_Send() - Frame and write one record
+ * ======================================================================================================================
+ */
+void CAL_Send(uint8_t type, uint8_t *payload, uint8_t len) {
+  uint8_t head[4] = {CAL_SYNC1, CAL_SYNC2, type, len};
+  uint8_t tail[2];
+  uint16_t crc;
+
+  crc = crc16_ccitt(0xFFFF, head+2, 2);
+  crc = crc16_ccitt(crc, payload, len);
+  CAL_Put16(tail, crc);
+
+  Serial.write(head, sizeof(head));
+  Serial.write(payload, len);
+  Serial.write(tail, sizeof(tail));
+}
+
+/*
+ * ======================================================================================================================
+ * CAL_Stream() - Send raw records at rate Hz until "Q" is received or CAL_MAX_MINUTES
+ *   Keeps the watchdog heartbeat going without the 250ms delay in HeartBeat(). The rain rings are drained
+ *   every record and BackGroundTasks() runs once a second, so tips, wind and the other 1s sampling carry on.
+ *   Records that fall due while it runs are sent right after, seq and micros show the gap.
+ * ======================================================================================================================
+ */
+void CAL_Stream(int rate) {
+  uint8_t payload[CAL_PAYLOAD_SIZE], *p;
+  uint16_t seq = 0;
+  uint32_t period_us = 1000000 / rate;
+  uint32_t next_us, pulses, last_us;
+  unsigned long start_ms = millis(), hb_ms = millis(), bmx_ms = 0, bg_ms = millis();
+  float bp = 0, bt = 0, bh = 0;
+  bool console = SerialConsoleEnabled;
+  int angle, op1, op2;
+
+  sprintf (msgbuf, "CAL:START %dHz, Q to stop", rate);
+  Output (msgbuf);
+  delay(100);
+  SerialConsoleEnabled = false;  // No text in the binary stream
+
+  next_us = micros();
+  while ((millis() - start_ms) < (CAL_MAX_MINUTES * 60000UL)) {
+    if (Serial.available() && (toupper(Serial.read()) == 'Q')) {
+      break;
+    }
+
+    // Heartbeat, 250ms high once a second
+    if ((millis() - hb_ms) >= 1000) {
+      hb_ms = millis();
+      digitalWrite(HEARTBEAT_PIN, HIGH);
+    }
+    else if ((millis() - hb_ms) >= 250) {
+      digitalWrite(HEARTBEAT_PIN, LOW);
+    }
+
+    if ((millis() - bg_ms) >= 1000) {
+      bg_ms = millis();
+      BackGroundTasks();
+    }
+    WB_Poll();  // A wind burst started by BackGroundTasks() keeps its slots
+
+    if ((int32_t)(micros() - next_us) < 0) {
+      continue;
+    }
+    next_us += period_us;
+
+    if (BMX_1_exists && ((millis() - bmx_ms) >= 1000)) {
+      bmx_ms = millis();
+      bmx1_read(bp, bt, bh);
+    }
+
+    Rain_Drain();
+    ADC_Service();
+    angle = Wind_ReadAngle();
+    op1 = ADC_PinLatest(OP1_PIN);
+    op2 = ADC_PinLatest(OP2_PIN);
+
+    noInterrupts();
+    pulses = anemometer_pulses;
+    last_us = anemometer_interrupt_last_us;
+    interrupts();
+
+    p = payload;
+    p = CAL_Put16(p, seq++);
+    p = CAL_Put32(p, millis());
+    p = CAL_Put32(p, micros());
+    p = CAL_Put32(p, pulses);
+    p = CAL_Put32(p, last_us);
+    p = CAL_Put16(p, (angle == -1) ? 0xFFFF : angle);
+    p = CAL_Put16(p, (op1 == -1) ? 0xFFFF : op1);
+    p = CAL_Put16(p, (op2 == -1) ? 0xFFFF : op2);
+    p = CAL_Put32(p, raingauge1.head + raingauge1.overflow);
+    p = CAL_Put32(p, raingauge2.head + raingauge2.overflow);
+    p = CAL_PutFloat(p, bp);
+    p = CAL_PutFloat(p, bt);
+    p = CAL_PutFloat(p, bh);
+    CAL_Send(CAL_TYPE_RAW, payload, p - payload);
+  }
+
+  digitalWrite(HEARTBEAT_PIN, LOW);
+  SerialConsoleEnabled = console;
+  Serial.println();
+  sprintf (msgbuf, "CAL:STOP %u", seq);
+  Output (msgbuf);
+}
+
+/*
+ * ======================================================================================================================
+ * CAL_Command() - Collect a console line without waiting, start streaming on "CAL" or "CAL <hz>"
+ * ======================================================================================================================
+ */
+void CAL_Command() {
+  int c, rate;
+
+  while (Serial.available()) {
+    c = Serial.read();
+    if ((c == '\r') || (c == '\n')) {
+      cal_cmd[cal_cmd_len] = 0;
+      cal_cmd_len = 0;
+      if ((strncasecmp(cal_cmd, "CAL", 3) == 0) && ((cal_cmd[3] == 0) || (cal_cmd[3] == ' '))) {
+        rate = (cal_cmd[3] == ' ') ? atoi(&cal_cmd[4]) : CAL_RATE_DEFAULT;
+        rate = constrain(rate, CAL_RATE_MIN, CAL_RATE_MAX);
+        CAL_Stream(rate);
+        return;
+      }
+    }
+    else if (cal_cmd_len < (CAL_CMD_SIZE-1)) {
+      cal_cmd[cal_cmd_len++] = c;
+    }
+  }
+}
@@ -12,6 +12,7 @@
 #include "include/output.h"
 #include "include/sdcard.h"
 #include "include/wrda.h"
+#include "include/burst.h"
 #include "include/main.h"
 #include "include/cf.h"
 
@@ -45,15 +46,26 @@ int cf_lora_txpwr=5;
 int cf_lora_freq=915;
 // Instruments
 int cf_nowind=0;
+int cf_wind_products=0;
+int cf_ws_period=0;
+int cf_wd_oversample=0;
+int cf_wb_rate=0;
+int cf_wb_interval=60;
 int cf_rg1_enable=0;
+int cf_rg1_debounce=RG_DEBOUNCE_MS;
+int cf_rg2_debounce=RG_DEBOUNCE_MS;
+int cf_rg_products=0;
 int cf_op1=OP1_STATE_NULL;
 int cf_op2=OP2_STATE_NULL;
 int cf_ds_baseline=0;
+int cf_ds_outlier=0;
 int cf_elevation=0;
 // System Timing
 int cf_obs_period=0;
 int cf_daily_reboot=22;
 int cf_no_network_reset_count=60;
+int cf_n2s_pct=10;
+int cf_log_sync=5;
 char *cf_rtro=NULL;
 int cf_rtro_hour=0;
 int cf_rtro_minute=0;
@@ -365,10 +377,56 @@ void SD_ReadConfigFile() {
   cf_nowind      = SD_findInt(F("nowind"));
   sprintf(msgbuf, "CF:%s=[%d]", F("nowind"), cf_nowind); Output (msgbuf);
 
+  // Wind Products 2 and 10 minute
+  cf_wind_products = SD_findInt(F("wind_products"));
+  sprintf(msgbuf, "CF:%s=[%d]", F("wind_products"), cf_wind_products); Output (msgbuf);
+
+  // Wind Speed from anemometer pulse period at low speed
+  cf_ws_period = SD_findInt(F("ws_period"));
+  sprintf(msgbuf, "CF:%s=[%d]", F("ws_period"), cf_ws_period); Output (msgbuf);
+
+  // Wind Direction reads averaged per sample
+  cf_wd_oversample = SD_findInt(F("wd_oversample"));
+  if (cf_wd_oversample < 0) {
+    cf_wd_oversample = 0;
+  }
+  else if (cf_wd_oversample > WD_OVERSAMPLE_MAX) {
+    cf_wd_oversample = WD_OVERSAMPLE_MAX;
+  }
+  sprintf(msgbuf, "CF:%s=[%d]", F("wd_oversample"), cf_wd_oversample); Output (msgbuf);
+
+  // Wind Burst
+  cf_wb_rate = SD_findInt(F("wb_rate"));
+  if (cf_wb_rate < 0) {
+    cf_wb_rate = 0;
+  }
+  else if (cf_wb_rate && (cf_wb_rate < WB_RATE_MIN)) {
+    cf_wb_rate = WB_RATE_MIN;
+  }
+  else if (cf_wb_rate > WB_RATE_MAX) {
+    cf_wb_rate = WB_RATE_MAX;
+  }
+  sprintf(msgbuf, "CF:%s=[%d]", F("wb_rate"), cf_wb_rate); Output (msgbuf);
+
+  cf_wb_interval = SD_findInt(F("wb_interval"));
+  if (cf_wb_interval == 0) {
+    cf_wb_interval = 60;
+  }
+  else if (cf_wb_interval < WB_MINUTES) {
+    cf_wb_interval = WB_MINUTES;
+  }
+  sprintf(msgbuf, "CF:%s=[%d]", F("wb_interval"), cf_wb_interval); Output (msgbuf);
+
   // Rain Gauge 1 D1
   cf_rg1_enable   = SD_findInt(F("rg1_enable"));
   sprintf(msgbuf, "CF:%s=[%d]", F("rg1_enable"), cf_rg1_enable); Output (msgbuf);
 
+  cf_rg1_debounce = SD_findInt(F("rg1_debounce"));
+  if (cf_rg1_debounce <= 0) {
+    cf_rg1_debounce = RG_DEBOUNCE_MS;
+  }
+  sprintf(msgbuf, "CF:%s=[%d]", F("rg1_debounce"), cf_rg1_debounce); Output (msgbuf);
+
   // Option Pin 1 A1
   cf_op1   = SD_findInt(F("op1"));
   sprintf(msgbuf, "%s=[%d]", F("CF:op1"), cf_op1); Output (msgbuf);
@@ -395,6 +453,16 @@ void SD_ReadConfigFile() {
     pinMode(OP2_PIN, INPUT);
   }
 
+  cf_rg2_debounce = SD_findInt(F("rg2_debounce"));
+  if (cf_rg2_debounce <= 0) {
+    cf_rg2_debounce = RG_DEBOUNCE_MS;
+  }
+  sprintf(msgbuf, "CF:%s=[%d]", F("rg2_debounce"), cf_rg2_debounce); Output (msgbuf);
+
+  // Rain Products
+  cf_rg_products = SD_findInt(F("rg_products"));
+  sprintf(msgbuf, "CF:%s=[%d]", F("rg_products"), cf_rg_products); Output (msgbuf);
+
   // Option Pin 2 A2
   cf_op2    = SD_findInt(F("op2"));
   sprintf(msgbuf, "%s=[%d]", F("CF:op2"), cf_op2); Output (msgbuf);
@@ -411,6 +479,12 @@ void SD_ReadConfigFile() {
   cf_ds_baseline = SD_findInt(F("ds_baseline"));
   sprintf(msgbuf, "CF:%s=[%d]", F("ds_baseline"), cf_ds_baseline); Output (msgbuf);
 
+  cf_ds_outlier = SD_findInt(F("ds_outlier"));
+  if (cf_ds_outlier < 0) {
+    cf_ds_outlier = 0;
+  }
+  sprintf(msgbuf, "CF:%s=[%d]", F("ds_outlier"), cf_ds_outlier); Output (msgbuf);
+
   // System Timing
   cf_obs_period   = SD_findInt(F("obs_period"));
   if (cf_obs_period == 0) {
@@ -431,4 +505,16 @@ void SD_ReadConfigFile() {
     cf_no_network_reset_count = 60;
   }
   sprintf(msgbuf, "CF:%s=[%d]", F("no_network_reset_count"), cf_no_network_reset_count); Output (msgbuf);
+
+  cf_n2s_pct = SD_findInt(F("n2s_pct"));
+  if ((cf_n2s_pct < 1) || (cf_n2s_pct > 90)) {
+    cf_n2s_pct = 10;
+  }
+  sprintf(msgbuf, "CF:%s=[%d]", F("n2s_pct"), cf_n2s_pct); Output (msgbuf);
+
+  cf_log_sync = SD_findInt(F("log_sync"));
+  if ((cf_log_sync < 1) || (cf_log_sync > 60)) {
+    cf_log_sync = 5;
+  }
+  sprintf(msgbuf, "CF:%s=[%d]", F("log_sync"), cf_log_sync); Output (msgbuf);
 }
\ No newline at end of file
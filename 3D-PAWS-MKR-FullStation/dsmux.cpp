@@ -18,6 +18,7 @@
 
  bool DSMUX_exists = false;
  bool dsmux_sensor_exists[DS248X_CHANNELS];
+ bool dsmux_sensor_parasite[DS248X_CHANNELS];
 
  /*
  * ======================================================================================================================
@@ -27,38 +28,131 @@
 
 /* 
  *=======================================================================================================================
- * dsmux_readTemperature() - 
+ * dsmux_crc8() - Dallas 1-Wire CRC-8, polynomial 0x31 reflected
  *=======================================================================================================================
  */
-float dsmux_readTemperature(uint8_t channel) {
-  // Select the channel on the DS2482-800
+uint8_t dsmux_crc8(const uint8_t *data, int len) {
+  uint8_t crc = 0;
+
+  while (len--) {
+    uint8_t b = *data++;
+    for (int i = 0; i < 8; i++) {
+      crc = ((crc ^ b) & 0x01) ? ((crc >> 1) ^ 0x8C) : (crc >> 1);
+      b >>= 1;
+    }
+  }
+  return (crc);
+}
+
+/* 
+ *=======================================================================================================================
+ * dsmux_command() - Select the channel, reset and address the probe with SKIP ROM
+ *=======================================================================================================================
+ */
+bool dsmux_command(uint8_t channel) {
   if (!ds248x.selectChannel(channel)) {
-    // Handle error if channel selection fails
     Output("DSMUX:Select CH Err");
-    return NAN; // Return 'Not a Number' to indicate an error
+    return (false);
   }
+  return (ds248x.OneWireReset() && ds248x.OneWireWriteByte(DS18B20_CMD_SKIP_ROM));
+}
 
-  // Start temperature conversion
-  ds248x.OneWireReset();
-  ds248x.OneWireWriteByte(DS18B20_CMD_SKIP_ROM); // Skip ROM command
-  ds248x.OneWireWriteByte(DS18B20_CMD_CONVERT_T); // Convert T command
-  delay(750); // Wait for conversion (750ms for maximum precision)
+/* 
+ *=======================================================================================================================
+ * dsmux_parasite_powered() - READ POWER SUPPLY, a parasite powered probe pulls the bus low
+ *=======================================================================================================================
+ */
+bool dsmux_parasite_powered(uint8_t channel) {
+  uint8_t bit = 1;
 
-  // Read scratchpad
-  ds248x.OneWireReset();
-  ds248x.OneWireWriteByte(DS18B20_CMD_SKIP_ROM); // Skip ROM command
-  ds248x.OneWireWriteByte(DS18B20_CMD_READ_SCRATCHPAD); // Read Scratchpad command
+  if (!dsmux_command(channel) || !ds248x.OneWireWriteByte(DS18B20_CMD_READ_POWER) || !ds248x.OneWireReadBit(&bit)) {
+    return (false);
+  }
+  return (bit == 0);
+}
 
+/* 
+ *=======================================================================================================================
+ * dsmux_startConversion() - CONVERT T, the strong pullup powers a parasite probe until the next 1-Wire command
+ *=======================================================================================================================
+ */
+bool dsmux_startConversion(uint8_t channel) {
+  if (!dsmux_command(channel)) {
+    return (false);
+  }
+  if (dsmux_sensor_parasite[channel] && !ds248x.strongPullup(true)) {
+    return (false);
+  }
+  return (ds248x.OneWireWriteByte(DS18B20_CMD_CONVERT_T));
+}
+
+/* 
+ *=======================================================================================================================
+ * dsmux_readScratchpad() - Read the finished conversion, NAN on error or bad CRC
+ *=======================================================================================================================
+ */
+float dsmux_readScratchpad(uint8_t channel) {
   uint8_t data[9];
+  bool zero = true;
+
+  if (!dsmux_command(channel) || !ds248x.OneWireWriteByte(DS18B20_CMD_READ_SCRATCHPAD)) {
+    return (NAN);
+  }
   for (int i = 0; i < 9; i++) {
-    ds248x.OneWireReadByte(&data[i]);
+    if (!ds248x.OneWireReadByte(&data[i])) {
+      return (NAN);
+    }
+    zero = zero && (data[i] == 0);
+  }
+
+  // All zeros passes the CRC, a shorted bus reads that way
+  if (zero || (dsmux_crc8(data, 8) != data[8])) {
+    return (NAN);
   }
 
   // Calculate temperature
   int16_t raw = (data[1] << 8) | data[0];
-  float celsius = (float)raw / 16.0;
+  return ((float)raw / 16.0);
+}
 
-  return (celsius);
+/* 
+ *=======================================================================================================================
+ * dsmux_readTemperatures() - Convert and read all probes, t[] is NAN for channels without a good reading
+ *   Externally powered probes all convert together. Each parasite powered probe is converted on its own with
+ *   the strong pullup while the others convert.
+ *=======================================================================================================================
+ */
+void dsmux_readTemperatures(float *t) {
+  bool started[DS248X_CHANNELS];
+  unsigned long ready_ms = millis();
+  long wait_ms;
+
+  for (int channel=0; channel<DS248X_CHANNELS; channel++) {
+    t[channel] = NAN;
+    started[channel] = false;
+    if (dsmux_sensor_exists[channel] && !dsmux_sensor_parasite[channel]) {
+      started[channel] = dsmux_startConversion(channel);
+      ready_ms = millis() + DS18B20_CONVERSION_MS;
+    }
+  }
+
+  for (int channel=0; channel<DS248X_CHANNELS; channel++) {
+    if (dsmux_sensor_exists[channel] && dsmux_sensor_parasite[channel] && dsmux_startConversion(channel)) {
+      delay(DS18B20_CONVERSION_MS);
+      t[channel] = dsmux_readScratchpad(channel);
+    }
+  }
+
+  wait_ms = (long)(ready_ms - millis());
+  if (wait_ms > 0) {
+    delay(wait_ms);
+  }
+
+  for (int channel=0; channel<DS248X_CHANNELS; channel++) {
+    if (started[channel]) {
+      t[channel] = dsmux_readScratchpad(channel);
+    }
+  }
 }
 
 /* 
@@ -97,6 +191,28 @@ bool dsmux_get_sensor_address(int channel, uint8_t *addr) {
   return (true);
 }
 
+/* 
+ *=======================================================================================================================
+ * dsmux_channel_exist() - Check for a probe on the channel, it answers a 1-Wire reset with a presence pulse
+ *=======================================================================================================================
+ */
+bool dsmux_channel_exist(uint8_t channel) {
+  return (ds248x.selectChannel(channel) && ds248x.OneWireReset());
+}
+
+/* 
+ *=======================================================================================================================
+ * dsmux_channel_begin() - Start using the probe on the channel, it may not be the one that was there before
+ *=======================================================================================================================
+ */
+void dsmux_channel_begin(uint8_t channel) {
+  dsmux_sensor_exists[channel] = true;
+  dsmux_sensor_parasite[channel] = dsmux_parasite_powered(channel);
+
+  sprintf (Buffer32Bytes, "  dst-%d OK%s", channel, (dsmux_sensor_parasite[channel]) ? " P" : "");
+  Output(Buffer32Bytes);
+}
+
 /* 
  *=======================================================================================================================
  * dsmux_obs_do() - do obs for dallas temperature sensors
@@ -104,9 +220,12 @@ bool dsmux_get_sensor_address(int channel, uint8_t *addr) {
  */
 void dsmux_obs_do(int &sidx) {
   if (DSMUX_exists) {
+    float temps[DS248X_CHANNELS];
+
+    dsmux_readTemperatures(temps);
     for (int channel=0; channel<DS248X_CHANNELS; channel++) {
       if (dsmux_sensor_exists[channel]) {
-        float t = dsmux_readTemperature(channel);
+        float t = temps[channel];
         t = (isnan(t) || (t < QC_MIN_T)  || (t > QC_MAX_T))  ? QC_ERR_T  : t;
 
         sprintf (Buffer32Bytes, "dst%d", channel);
@@ -128,21 +247,27 @@ void dsmux_initialize() {
   Output("DSMUX:INIT");
 
   if (ds248x.begin(&Wire, DSMUX_ADDRESS)) {
-    uint8_t addr[8];
+    uint8_t addr[DS248X_CHANNELS][8];
+    float temps[DS248X_CHANNELS];
 
     Output ("DSMUX Channel Scan");
     DSMUX_exists = true;
     int count=0;
 
     for (int channel=0; channel<DS248X_CHANNELS; channel++) {
-      dsmux_sensor_exists[channel] = dsmux_get_sensor_address(channel, addr);
+      dsmux_sensor_exists[channel] = dsmux_get_sensor_address(channel, addr[channel]);
+      dsmux_sensor_parasite[channel] = dsmux_sensor_exists[channel] && dsmux_parasite_powered(channel);
+    }
 
+    dsmux_readTemperatures(temps);
+    for (int channel=0; channel<DS248X_CHANNELS; channel++) {
       if (dsmux_sensor_exists[channel]) {
-        float t = dsmux_readTemperature(channel);
+        uint8_t *a = addr[channel];
 
-        sprintf (Buffer32Bytes, "  dst-%d=%.2f %02X:%02X:%02X:%02X:%02X:%02X:%02X:%02X",
-          channel, t, addr[0],addr[1],addr[2],addr[3], addr[4],addr[5],addr[6],addr[7]);
-        Output(Buffer32Bytes);  
+        sprintf (msgbuf, "  dst-%d=%.2f %02X:%02X:%02X:%02X:%02X:%02X:%02X:%02X%s",
+          channel, temps[channel], a[0],a[1],a[2],a[3], a[4],a[5],a[6],a[7],
+          (dsmux_sensor_parasite[channel]) ? " P" : "");
+        Output(msgbuf);  // Longer than Buffer32Bytes
         count++;
       }
     }
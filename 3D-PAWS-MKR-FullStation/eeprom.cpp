@@ -14,6 +14,9 @@
 #include "include/sdcard.h"
 #include "include/wrda.h"
 #include "include/time.h"
+#include "include/support.h"
+#include "include/i2c.h"
+#include "include/i2cq.h"
 #include "include/eeprom.h"
 
 /*
@@ -30,12 +33,126 @@ bool eeprom_exists = false;
 
 Adafruit_EEPROM_I2C eeprom_i2c;
 
+EEPROM_NVM eeprom_saved;            // What the chip holds, valid after a read or write
+bool eeprom_saved_valid = false;
+
+// Queued page write, sent from its own copy so eeprom can change while it is on the wire
+I2CQ_XFER_STR eeprom_xfer;
+uint8_t eeprom_wbuf[2 + EEPROM_PAGE_SIZE];
+int eeprom_wfirst;                  // Offset in the structure of the page being written
+bool eeprom_wqueued = false;        // Not yet waited for
+volatile bool eeprom_werr = false;  // Write failed, reported from the foreground
+
 /*
  * ======================================================================================================================
  * Fuction Definations
  * =======================================================================================================================
  */
 
+/* 
+ *=======================================================================================================================
+ * EEPROM_WriteDone() - Queued page write done, from the interrupt. The chip now holds the page
+ *=======================================================================================================================
+ */
+void EEPROM_WriteDone(I2CQ_XFER_STR *x) {
+  if (x->status == I2C_OK) {
+    memcpy (((uint8_t *) &eeprom_saved) + eeprom_wfirst, &eeprom_wbuf[2], x->tx_len - 2);
+  }
+  else {
+    eeprom_saved_valid = false;
+    eeprom_werr = true;
+  }
+}
+
+/* 
+ *=======================================================================================================================
+ * EEPROM_Ready() - Wait for a queued page write and the EEPROM write cycle after it, FRAM answers at once
+ *=======================================================================================================================
+ */
+void EEPROM_Ready() {
+  if (eeprom_wqueued) {
+    eeprom_wqueued = false;
+    if (I2CQ_Wait(&eeprom_xfer) == I2C_OK) {
+      for (int t = 0; (t < EEPROM_WRITE_MS) && !I2C_Device_Exist(EEPROM_I2C_ADDR); t++) {
+        delay(1);
+      }
+    }
+  }
+  if (eeprom_werr) {
+    eeprom_werr = false;
+    Output(F("EEPROM WR ERR"));
+  }
+}
+
+/* 
+ *=======================================================================================================================
+ * EEPROM_Read() - Read the structure in one transaction, the library reads a byte per transaction
+ *=======================================================================================================================
+ */
+bool EEPROM_Read() {
+  uint8_t mem[2] = {(uint8_t)(eeprom_address >> 8), (uint8_t)eeprom_address};
+
+  EEPROM_Ready();
+  if (I2CQ_Transfer(EEPROM_I2C_ADDR, mem, 2, NULL, 0, eeprom_ptr, sizeof(eeprom)) != I2C_OK) {
+    eeprom_saved_valid = false;
+    return (false);
+  }
+  memcpy (&eeprom_saved, &eeprom, sizeof(eeprom));
+  eeprom_saved_valid = true;
+  return (true);
+}
+
+/* 
+ *=======================================================================================================================
+ * EEPROM_Save() - Write only the bytes that changed, a page per transaction
+ *   The library writes a byte per transaction and waits out the EEPROM write cycle after each, about 5 ms a byte
+ *   on a 24LC32. Most saves change the timestamp, a rain total or n2sfp and the checksum, all in one page.
+ *   The last page is queued and the save returns while it is written, the next read or save waits for it.
+ *=======================================================================================================================
+ */
+void EEPROM_Save() {
+  uint8_t *saved = (uint8_t *) &eeprom_saved;
+  int first = 0;
+  int last = sizeof(eeprom) - 1;
+  int n;
+
+  EEPROM_Ready();
+  if (eeprom_saved_valid) {
+    while ((first <= last) && (eeprom_ptr[first] == saved[first])) {
+      first++;
+    }
+    while ((last >= first) && (eeprom_ptr[last] == saved[last])) {
+      last--;
+    }
+  }
+  eeprom_saved_valid = true;  // Cleared by a failed page write
+
+  while (first <= last) {
+    uint16_t mem = eeprom_address + first;
+
+    // A page write wraps at the end of the page, stop there
+    n = min(last - first + 1, EEPROM_PAGE_SIZE - (mem % EEPROM_PAGE_SIZE));
+    if (eeprom_wqueued) {
+      EEPROM_Ready();
+      if (!eeprom_saved_valid) {
+        return;
+      }
+    }
+    eeprom_wbuf[0] = mem >> 8;
+    eeprom_wbuf[1] = mem;
+    memcpy (&eeprom_wbuf[2], &eeprom_ptr[first], n);
+    eeprom_wfirst = first;
+    memset (&eeprom_xfer, 0, sizeof(eeprom_xfer));
+    eeprom_xfer.addr = EEPROM_I2C_ADDR;
+    eeprom_xfer.tx = eeprom_wbuf;
+    eeprom_xfer.tx_len = n + 2;
+    eeprom_xfer.done = EEPROM_WriteDone;
+    I2CQ_Submit(&eeprom_xfer);
+    eeprom_wqueued = true;
+    first += n;
+  }
+}
+
 /* 
  *=======================================================================================================================
  * EEPROM_ChecksumCompute()
@@ -74,8 +191,7 @@ bool EEPROM_Valid() {
     if ((eeprom.rgt1 < 0.0) ||
         (eeprom.rgp1 < 0.0) ||
         (eeprom.rgt2 < 0.0) ||
-        (eeprom.rgp2 < 0.0) ||
-        (eeprom.n2sfp > (SD_n2s_max_filesz + 1000) )) {
+        (eeprom.rgp2 < 0.0)) {
       return (false);    
     }
     else {
@@ -102,7 +218,7 @@ void EEPROM_ClearRainTotals(uint32_t current_time) {
     eeprom.rgts = current_time;
     eeprom.n2sfp = 0;
     EEPROM_ChecksumUpdate();
-    eeprom_i2c.write(eeprom_address, eeprom_ptr, sizeof(eeprom));
+    EEPROM_Save();
   }
   else {
     Output(F("EEPROM CRT ERROR"));
@@ -147,7 +263,7 @@ void EEPROM_Validate() {
   
   uint32_t current_time = stc.getEpoch();
 
-  eeprom_i2c.read(eeprom_address, eeprom_ptr, sizeof(eeprom));
+  EEPROM_Read();
 
   if (!EEPROM_Valid()) {
     EEPROM_ClearRainTotals(current_time);
@@ -170,7 +286,7 @@ void EEPROM_Validate() {
       Output("T>RO, RT>RO - OK");
       eeprom.rgts = current_time;
       EEPROM_ChecksumUpdate();
-      eeprom_i2c.write(eeprom_address, eeprom_ptr, sizeof(eeprom));          
+      EEPROM_Save();          
     }
     else if ((current_time > seconds_at_rollover) && (eeprom.rgts <= seconds_at_rollover) && (eeprom.rgts > seconds_yesterday_at_rollover)){
       // if current time is after 6am and RT time is before 6am and after yesterday at 6am -  move today's totals to yesterday
@@ -182,7 +298,7 @@ void EEPROM_Validate() {
         eeprom.rgt2 = 0.0;
         eeprom.rgts = current_time;
         EEPROM_ChecksumUpdate();
-        eeprom_i2c.write(eeprom_address, eeprom_ptr, sizeof(eeprom));
+        EEPROM_Save();
       }
       else {
         // if current time is after 6am and RT time is before 6am and before yesterday at 6am - EEPROM has no valid data - clear EEPROM
@@ -196,7 +312,7 @@ void EEPROM_Validate() {
         Output("T<RO, RT<RO & RT>YRO - OK");
         eeprom.rgts = current_time;
         EEPROM_ChecksumUpdate();
-        eeprom_i2c.write(eeprom_address, eeprom_ptr, sizeof(eeprom));          
+        EEPROM_Save();          
       }
       else if (eeprom.rgts > (seconds_yesterday_at_rollover - 84600)) { 
         // if current time is before 6am and RT time after 6am 2 days ago - move current total to yesterday
@@ -207,7 +323,7 @@ void EEPROM_Validate() {
         eeprom.rgt2 = 0.0;
         eeprom.rgts = current_time;
         EEPROM_ChecksumUpdate();
-        eeprom_i2c.write(eeprom_address, eeprom_ptr, sizeof(eeprom));
+        EEPROM_Save();
       }
       else {
         // if current time is before 6am and RT time before 6am 2 days ago - EEPROM has no valid data - clear EEPROM
@@ -268,7 +384,7 @@ void EEPROM_UpdateRainTotals(float rgt1, float rgt2) {
     if (update) {
       eeprom.rgts = current_time;
       EEPROM_ChecksumUpdate();
-      eeprom_i2c.write(eeprom_address, eeprom_ptr, sizeof(eeprom));
+      EEPROM_Save();
       Output(F("EEPROM RT UPDATED"));
     }
   }
@@ -280,6 +396,7 @@ void EEPROM_UpdateRainTotals(float rgt1, float rgt2) {
  *=======================================================================================================================
  */
 void EEPROM_SaveUnreportedRain() {
+  Rain_Drain();
   if (raingauge1_interrupt_count || raingauge2_interrupt_count) {
     unsigned long rgds;     // rain gauge delta seconds, seconds since last rain gauge observation logged
 
@@ -304,7 +421,7 @@ void EEPROM_Update() {
   if (eeprom_valid) {
     eeprom.rgts = stc.getEpoch();
     EEPROM_ChecksumUpdate();
-    eeprom_i2c.write(eeprom_address, eeprom_ptr, sizeof(eeprom));
+    EEPROM_Save();
     Output(F("EEPROM UPDATED"));
   }
 }
@@ -315,7 +432,7 @@ void EEPROM_Update() {
  *=======================================================================================================================
  */
 void EEPROM_Dump() {
-  eeprom_i2c.read(eeprom_address, eeprom_ptr, sizeof(eeprom));
+  EEPROM_Read();
 
   unsigned long checksum = EEPROM_ChecksumCompute();
 
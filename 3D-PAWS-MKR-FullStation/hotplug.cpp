@@ -0,0 +1,369 @@
+/*
+ * ======================================================================================================================
+ * hotplug.cpp - Background Sensor Discovery
+ * ======================================================================================================================
+ */
+#include <Arduino.h>
+
+#include "include/cf.h"
+#include "include/output.h"
+#include "include/support.h"
+#include "include/i2c.h"
+#include "include/wrda.h"
+#include "include/mux.h"
+#include "include/dsmux.h"
+#include "include/sensors_i2c_44_47.h"
+#include "include/sensors.h"
+#include "include/main.h"
+#include "include/hotplug.h"
+
+/*
+ * ======================================================================================================================
+ * Variables and Data Structures
+ * =======================================================================================================================
+ */
+HP_STR hp[HP_SIZE];
+int hp_count = 0;
+int hp_next = 0;                    // Candidate to probe on the next call
+char hp_changes[HP_CHANGES_SIZE];   // "+VEML,-MCP2" since the last INFO
+
+/*
+ * ======================================================================================================================
+ * Fuction Definations
+ * =======================================================================================================================
+ */
+
+/*
+ * ======================================================================================================================
+ * HP_Add() - Add a candidate, begun if it was found at boot
+ * ======================================================================================================================
+ */
+void HP_Add(HP_TYPE type, uint8_t n) {
+  HP_STR *h;
+
+  if (hp_count == HP_SIZE) {
+    return;
+  }
+  h = &hp[hp_count++];
+  h->type = type;
+  h->n = n;
+  h->misses = 0;
+  h->hold = 0;
+  h->begun = false;
+}
+
+/*
+ * ======================================================================================================================
+ * HP_Address() - I2C address of a main bus candidate
+ * ======================================================================================================================
+ */
+uint8_t HP_Address(HP_STR *h) {
+  const uint8_t mcp[] = {MCP_ADDRESS_1, MCP_ADDRESS_2, MCP_ADDRESS_3, MCP_ADDRESS_4};
+
+  switch (h->type) {
+    case HP_BMX :       return ((h->n == 1) ? BMX_ADDRESS_1 : BMX_ADDRESS_2);
+    case HP_MCP :       return (mcp[h->n-1]);
+    case HP_HTU :       return (HTU21DF_I2CADDR);
+    case HP_HIH8 :      return (HIH8000_ADDRESS);
+    case HP_VEML :      return (VEML7700_ADDRESS);
+    case HP_PM25 :      return (PM25AQI_ADDRESS);
+    case HP_LPS :       return ((h->n == 1) ? LPS_ADDRESS_1 : LPS_ADDRESS_2);
+    case HP_AS5600 :    return (AS5600_ADR);
+    case HP_TLW :       return (TLW_ADDRESS);
+    case HP_TSM :       return (TSM_ADDRESS);
+    case HP_I2C_44_47 : return (h->n);
+    default :           return (0);
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * HP_Flag() - The exists flag of the sensor, NULL for those that keep their state elsewhere
+ * ======================================================================================================================
+ */
+bool *HP_Flag(HP_STR *h) {
+  bool *mcp[] = {&MCP_1_exists, &MCP_2_exists, &MCP_3_exists, &MCP_4_exists};
+
+  switch (h->type) {
+    case HP_BMX :       return ((h->n == 1) ? &BMX_1_exists : &BMX_2_exists);
+    case HP_MCP :       return (mcp[h->n-1]);
+    case HP_HTU :       return (&HTU21DF_exists);
+    case HP_HIH8 :      return (&HIH8_exists);
+    case HP_VEML :      return (&VEML7700_exists);
+    case HP_PM25 :      return (&PM25AQI_exists);
+    case HP_LPS :       return ((h->n == 1) ? &LPS_1_exists : &LPS_2_exists);
+    case HP_AS5600 :    return (&AS5600_exists);
+    case HP_TLW :       return (&TLW_exists);
+    case HP_TSM :       return (&TSM_exists);
+    case HP_DST :       return (&dsmux_sensor_exists[h->n]);
+    default :           return (NULL);
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * HP_Exists() - True if the sensor is online
+ * ======================================================================================================================
+ */
+bool HP_Exists(HP_STR *h) {
+  bool *flag = HP_Flag(h);
+
+  if (flag) {
+    return (*flag);
+  }
+  if (h->type == HP_I2C_44_47) {
+    return (i2c_44_47_sensors[h->n-0x44].type != SENSOR_UNKNOWN);
+  }
+  // HP_MUX_TSM
+  return ((mux[h->n].sensor[0].type == m_tsm) && (mux[h->n].sensor[0].state == ONLINE));
+}
+
+/*
+ * ======================================================================================================================
+ * HP_Name() - Sensor name as in the INFO sensors list
+ * ======================================================================================================================
+ */
+void HP_Name(HP_STR *h, char *name) {
+  switch (h->type) {
+    case HP_BMX :       sprintf (name, "BMX%d", h->n); break;
+    case HP_MCP :       sprintf (name, "MCP%d", h->n); break;
+    case HP_HTU :       strcpy (name, "HTU"); break;
+    case HP_HIH8 :      strcpy (name, "HIH8"); break;
+    case HP_VEML :      strcpy (name, "VEML"); break;
+    case HP_PM25 :      strcpy (name, "PM25AQ"); break;
+    case HP_LPS :       sprintf (name, "LPS%d", h->n); break;
+    case HP_AS5600 :    strcpy (name, "AS5600"); break;
+    case HP_TLW :       strcpy (name, "TLW"); break;
+    case HP_TSM :       strcpy (name, "TSM"); break;
+    case HP_I2C_44_47 : {
+      const char *type = sensor_i2c_44_47_name(h->n-0x44);
+      sprintf (name, "%s(%02x)", (type) ? type : "I2C", h->n);
+      break;
+    }
+    case HP_MUX_TSM :   sprintf (name, "TSM%d(%d.0)", mux[h->n].sensor[0].id, h->n); break;
+    case HP_DST :       sprintf (name, "DST%d", h->n); break;
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * HP_Probe() - True if the sensor answers
+ * ======================================================================================================================
+ */
+bool HP_Probe(HP_STR *h) {
+  switch (h->type) {
+    case HP_MUX_TSM :   return (mux_tsm_exist(h->n));
+    case HP_DST :       return (dsmux_channel_exist(h->n));
+    default :           return (I2C_Device_Exist(HP_Address(h)));
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * HP_Online() - Start the sensor, true if it is online
+ * ======================================================================================================================
+ */
+bool HP_Online(HP_STR *h) {
+  switch (h->type) {
+    case HP_BMX :       bmx_begin(h->n); break;
+    case HP_MCP :       mcp9808_begin(h->n); break;
+    case HP_HTU :       htu21d_initialize(); break;
+    case HP_HIH8 :      hih8_initialize(); break;
+    case HP_AS5600 :    as5600_initialize(); break;
+    case HP_TLW :       tlw_initialize(); break;
+    case HP_TSM :       tsm_initialize(); break;
+    case HP_I2C_44_47 : sensor_i2c_44_47_begin(h->n); break;
+    case HP_DST :       dsmux_channel_begin(h->n); break;
+
+    case HP_MUX_TSM :
+      mux_channel_set(h->n);
+      mux_tsm_begin(h->n);
+      mux_deselect_all();
+      break;
+
+    // begin() allocates, once started these only need their configuration back
+    case HP_VEML :
+    case HP_PM25 :
+    case HP_LPS :
+      if (!h->begun) {
+        if (h->type == HP_VEML) {
+          lux_initialize();
+        }
+        else if (h->type == HP_PM25) {
+          pm25aqi_initialize();
+        }
+        else {
+          lps_begin(h->n);
+        }
+      }
+      else {
+        *HP_Flag(h) = true;
+        sensor_reinitialize(HP_Address(h));
+        if (h->type == HP_PM25) {
+          pm25aqi_clear();
+          pm25aqi_1m_clear();
+        }
+      }
+      break;
+  }
+  I2C_ClockReset(); // The library begin() calls leave Wire at 100 kHz
+
+  if (HP_Exists(h)) {
+    h->begun = true;
+    return (true);
+  }
+  return (false);
+}
+
+/*
+ * ======================================================================================================================
+ * HP_Offline() - Stop using the sensor
+ * ======================================================================================================================
+ */
+void HP_Offline(HP_STR *h) {
+  bool *flag = HP_Flag(h);
+
+  if (flag) {
+    *flag = false;
+  }
+  else if (h->type == HP_I2C_44_47) {
+    sensor_i2c_44_47_offline(h->n);
+  }
+  else {
+    mux[h->n].sensor[0].state = OFFLINE;
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * HP_Change() - Log a sensor going online (+) or offline (-), list it for INFO and send INFO now
+ * ======================================================================================================================
+ */
+void HP_Change(HP_STR *h, char sign) {
+  char name[16];
+  int len = strlen(hp_changes);
+
+  HP_Name(h, name);
+  sprintf (Buffer32Bytes, "HP:%c%s", sign, name);
+  Output (Buffer32Bytes);
+
+  if ((len + (int)strlen(name) + 3) < HP_CHANGES_SIZE) {
+    sprintf (hp_changes+len, "%s%c%s", (len) ? "," : "", sign, name);
+  }
+
+  // Derived observations follow their inputs
+  wbt_initialize();
+  hi_initialize();
+  wbgt_initialize();
+  mslp_initialize();
+
+  nextinfo = millis();
+}
+
+/*
+ * ======================================================================================================================
+ * HP_Initialize() - Build the candidate list, call after the sensors are initialized in setup()
+ * ======================================================================================================================
+ */
+void HP_Initialize() {
+  hp_count = 0;
+  hp_next = 0;
+  hp_changes[0] = 0;
+
+  HP_Add(HP_BMX, 1);
+  HP_Add(HP_BMX, 2);
+  for (int n = 1; n <= 4; n++) {
+    HP_Add(HP_MCP, n);
+  }
+  HP_Add(HP_HTU, 0);
+  HP_Add(HP_HIH8, 0);
+  HP_Add(HP_VEML, 0);
+  HP_Add(HP_PM25, 0);
+  HP_Add(HP_LPS, 1);
+  HP_Add(HP_LPS, 2);
+  if (!cf_nowind) {
+    HP_Add(HP_AS5600, 0);
+  }
+  HP_Add(HP_TLW, 0);
+  for (uint8_t addr = 0x44; addr <= 0x47; addr++) {
+    HP_Add(HP_I2C_44_47, addr);
+  }
+  if (MUX_exists) {
+    for (int c = 0; c < MUX_CHANNELS; c++) {
+      HP_Add(HP_MUX_TSM, c);
+    }
+  }
+  else {
+    HP_Add(HP_TSM, 0);
+  }
+  if (DSMUX_exists) {
+    for (int c = 0; c < DS248X_CHANNELS; c++) {
+      HP_Add(HP_DST, c);
+    }
+  }
+
+  for (int i = 0; i < hp_count; i++) {
+    hp[i].begun = HP_Exists(&hp[i]);
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * HP_Service() - Called every second from BackGroundWork(), probe the next candidate
+ * ======================================================================================================================
+ */
+void HP_Service() {
+  HP_STR *h;
+  bool found;
+
+  if (hp_count == 0) {
+    return;
+  }
+  h = &hp[hp_next];
+  hp_next = (hp_next + 1) % hp_count;
+
+  if (h->hold) {
+    h->hold--;
+    return;
+  }
+
+  // The duty cycled air quality sensor is only on the bus while powered
+  if ((h->type == HP_PM25) && AQS_Enabled && (aqs_state == AQS_OFF)) {
+    return;
+  }
+
+  found = HP_Probe(h);
+
+  if (HP_Exists(h)) {
+    if (found) {
+      h->misses = 0;
+    }
+    else if (++h->misses == HP_MISS_LIMIT) {
+      h->misses = 0;
+      HP_Offline(h);
+      HP_Change(h, '-');
+    }
+  }
+  else if (found) {
+    if (HP_Online(h)) {
+      HP_Change(h, '+');
+    }
+    else {
+      h->hold = HP_HOLD_PASSES;
+    }
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * HP_Info() - Add the sensor changes since the last INFO, then clear them
+ * ======================================================================================================================
+ */
+void HP_Info(char *msg, int size) {
+  int len = strlen(msg);
+
+  if (hp_changes[0]) {
+    snprintf (msg+len, size-len, ",\"hp\":\"%s\"", hp_changes);
+    hp_changes[0] = 0;
+  }
+}
@@ -0,0 +1,402 @@
+/*
+ * ======================================================================================================================
+ * i2c.cpp - I2C Bus Clock, Health Counters and Recovery
+ * ======================================================================================================================
+ */
+#include <Arduino.h>
+#include <Wire.h>
+#include <Adafruit_I2CDevice.h>
+
+#include "include/output.h"
+#include "include/sensors.h"
+#include "include/main.h"
+#include "include/i2c.h"
+#include "include/i2cq.h"
+
+/*
+ * ======================================================================================================================
+ * Variables and Data Structures
+ * =======================================================================================================================
+ */
+I2C_STATS_STR i2c_stats[I2C_STATS_SIZE];
+int i2c_stats_count = 0;
+unsigned int i2c_recoveries = 0;    // Times SDA was found held low and the bus freed
+bool i2c_pending = false;           // An address reached I2C_FAIL_LIMIT
+uint32_t i2c_clock = I2C_CLOCK_STANDARD;  // Wire clock now, 0 when unknown
+uint32_t i2c_clock_limit = 0;       // Highest clock allowed, 0 no limit
+
+// Devices that run at fast mode, everything else runs at standard mode
+const uint8_t i2c_fast[] = {
+  0x10,                             // VEML7700
+  0x18, 0x19, 0x1A, 0x1B,           // MCP9808
+  0x1F,                             // DS2482-800
+  0x27,                             // HIH8000
+  0x36,                             // AS5600
+  0x3C, 0x3D,                       // SSD1306 OLED
+  0x40,                             // HTU21D-F, AS5600L
+  0x44, 0x45, 0x46, 0x47,           // SHT3x, SHT4x, HDC302x, BMP58x
+  0x50,                             // FRAM
+  0x5C, 0x5D,                       // LPS35HW
+  0x68,                             // DS3231 RTC
+  0x70,                             // PCA9548 mux
+  0x76, 0x77                        // BMP280, BME280, BMP3xx
+};
+
+/*
+ * ======================================================================================================================
+ * Fuction Definations
+ * =======================================================================================================================
+ */
+
+/*
+ * ======================================================================================================================
+ * I2C_Find() - Counters for the address, NULL if it has not been used
+ * ======================================================================================================================
+ */
+I2C_STATS_STR *I2C_Find(uint8_t addr) {
+  for (int i = 0; i < i2c_stats_count; i++) {
+    if (i2c_stats[i].addr == addr) {
+      return (&i2c_stats[i]);
+    }
+  }
+  return (NULL);
+}
+
+/*
+ * ======================================================================================================================
+ * I2C_DefaultClock() - Clock from the fast mode device list
+ * ======================================================================================================================
+ */
+uint32_t I2C_DefaultClock(uint8_t addr) {
+  for (unsigned int i = 0; i < sizeof(i2c_fast); i++) {
+    if (i2c_fast[i] == addr) {
+      return (I2C_CLOCK_FAST);
+    }
+  }
+  return (I2C_CLOCK_STANDARD);
+}
+
+/*
+ * ======================================================================================================================
+ * I2C_Stats() - Counters for the address, added on first use, NULL when the table is full
+ * ======================================================================================================================
+ */
+I2C_STATS_STR *I2C_Stats(uint8_t addr) {
+  I2C_STATS_STR *s = I2C_Find(addr);
+
+  if ((s != NULL) || (i2c_stats_count == I2C_STATS_SIZE)) {
+    return (s);
+  }
+  s = &i2c_stats[i2c_stats_count++];
+  memset(s, 0, sizeof(I2C_STATS_STR));
+  s->addr = addr;
+  s->clock = I2C_DefaultClock(addr);
+  return (s);
+}
+
+/*
+ * ======================================================================================================================
+ * I2C_ClockFor() - Clock for the address, its own or the default, held to the limit
+ * ======================================================================================================================
+ */
+uint32_t I2C_ClockFor(uint8_t addr) {
+  I2C_STATS_STR *s = I2C_Find(addr);       // Probes of absent devices are not added to the table
+  uint32_t hz = (s != NULL) ? s->clock : I2C_DefaultClock(addr);
+
+  if (i2c_clock_limit && (hz > i2c_clock_limit)) {
+    hz = i2c_clock_limit;
+  }
+  return (hz);
+}
+
+/*
+ * ======================================================================================================================
+ * I2C_ClockSet() - Change the Wire clock if it is not hz, true if it was changed. Also used by the queue
+ * ======================================================================================================================
+ */
+bool I2C_ClockSet(uint32_t hz) {
+  if (hz == i2c_clock) {
+    return (false);
+  }
+  Wire.setClock(hz);
+  i2c_clock = hz;
+  return (true);
+}
+
+/*
+ * ======================================================================================================================
+ * I2C_Clock() - Wait for queued transactions and set the Wire clock for the address, also the Adafruit_BusIO
+ *               start hook. Not called between a write without a stop and its read, both are to the same address
+ *               so the clock holds.
+ * ======================================================================================================================
+ */
+void I2C_Clock(uint8_t addr) {
+  I2CQ_Idle();
+  I2C_ClockSet(I2C_ClockFor(addr));
+}
+
+/*
+ * ======================================================================================================================
+ * I2C_ClockLimit() - Highest clock for all devices, 0 for no limit. Set while a mux channel is selected
+ * ======================================================================================================================
+ */
+void I2C_ClockLimit(uint32_t hz) {
+  i2c_clock_limit = hz;
+}
+
+/*
+ * ======================================================================================================================
+ * I2C_ClockReset() - Wire clock was changed outside of I2C_Clock(), set it on the next transaction
+ * ======================================================================================================================
+ */
+void I2C_ClockReset() {
+  i2c_clock = 0;
+}
+
+/*
+ * ======================================================================================================================
+ * I2C_Count() - Count a finished transaction, also the Adafruit_BusIO hook
+ * ======================================================================================================================
+ */
+void I2C_Count(uint8_t addr, uint8_t status, uint32_t start_us) {
+  unsigned long us = micros() - start_us;
+  I2C_STATS_STR *s = I2C_Stats(addr);
+
+  if (s == NULL) {
+    return;
+  }
+
+  s->tx++;
+  s->us_total += us;
+  if (us > s->us_max) {
+    s->us_max = us;
+  }
+
+  if (status == I2C_OK) {
+    s->fails = 0;
+    return;
+  }
+
+  if ((status == I2C_NACK_ADDR) || (status == I2C_NACK_DATA)) {
+    s->nack++;
+  }
+  else {
+    s->err++;
+  }
+
+  // Sensors NACK their address while converting, that is not a signal problem
+  if ((status != I2C_NACK_ADDR) && (i2c_clock > I2C_CLOCK_STANDARD) && (s->clock > I2C_CLOCK_STANDARD)) {
+    if (++s->fast_errs == I2C_DEMOTE_LIMIT) {
+      s->clock = I2C_CLOCK_STANDARD;
+      s->demoted = true;
+    }
+  }
+
+  if (++s->fails == I2C_FAIL_LIMIT) {
+    s->pending = true;
+    i2c_pending = true;
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * I2C_Write() - Write len bytes, no bytes is an address only write. Returns the endTransmission() code
+ * ======================================================================================================================
+ */
+uint8_t I2C_Write(uint8_t addr, const uint8_t *buf, int len, bool stop) {
+  uint32_t start_us;
+  uint8_t status;
+
+  I2C_Clock(addr);
+  start_us = micros();
+  Wire.beginTransmission(addr);
+  if (len) {
+    Wire.write(buf, len);
+  }
+  status = Wire.endTransmission(stop);
+  I2C_Count(addr, status, start_us);
+  return (status);
+}
+
+/*
+ * ======================================================================================================================
+ * I2C_Read() - Read up to len bytes, returns the number read
+ * ======================================================================================================================
+ */
+int I2C_Read(uint8_t addr, uint8_t *buf, int len) {
+  uint32_t start_us;
+  int n;
+
+  I2C_Clock(addr);
+  start_us = micros();
+  n = Wire.requestFrom(addr, (uint8_t)len);
+
+  I2C_Count(addr, (n == len) ? I2C_OK : ((n == 0) ? I2C_NACK_ADDR : I2C_ERROR), start_us);
+  for (int i = 0; i < n; i++) {
+    buf[i] = Wire.read();
+  }
+  return (n);
+}
+
+/*
+ * ======================================================================================================================
+ * I2C_SDAPin() - Level on the SDA pin with Wire running. On the SAMD the pin belongs to the SERCOM, it is read from
+ *                the PORT with its input buffer on
+ * ======================================================================================================================
+ */
+int I2C_SDAPin() {
+#if defined(ARDUINO_ARCH_SAMD)
+  const PinDescription *pin = &g_APinDescription[PIN_WIRE_SDA];
+
+  PORT->Group[pin->ulPort].PINCFG[pin->ulPin].bit.INEN = 1;
+  return ((PORT->Group[pin->ulPort].IN.reg & (1ul << pin->ulPin)) ? HIGH : LOW);
+#else
+  return (digitalRead(PIN_WIRE_SDA));
+#endif
+}
+
+/*
+ * ======================================================================================================================
+ * I2C_SDALow() - True if a device is holding SDA low, low over half a clock with the queue idle. Wire keeps running
+ * ======================================================================================================================
+ */
+bool I2C_SDALow() {
+  I2CQ_Idle();
+  if (I2C_SDAPin() == HIGH) {
+    return (false);
+  }
+  delayMicroseconds(I2C_HALF_CLOCK_US);
+  return (I2C_SDAPin() == LOW);
+}
+
+/*
+ * ======================================================================================================================
+ * I2C_Recover() - If a device holds SDA low, stop Wire, clock SCL until it lets go, send a STOP and start Wire
+ *   again. True if the bus is free. The lines are driven open drain, low as an output and released as an input
+ *   with pull up.
+ * ======================================================================================================================
+ */
+bool I2C_Recover() {
+  bool free;
+
+  if (!I2C_SDALow()) {
+    return (true);
+  }
+
+  Wire.end();
+  pinMode(PIN_WIRE_SCL, INPUT_PULLUP);
+  pinMode(PIN_WIRE_SDA, INPUT_PULLUP);
+  delayMicroseconds(I2C_HALF_CLOCK_US);
+
+  // A device part way through sending a byte lets go of SDA within 9 clocks
+  for (int i = 0; (i < 9) && (digitalRead(PIN_WIRE_SDA) == LOW); i++) {
+    pinMode(PIN_WIRE_SCL, OUTPUT);
+    digitalWrite(PIN_WIRE_SCL, LOW);
+    delayMicroseconds(I2C_HALF_CLOCK_US);
+    pinMode(PIN_WIRE_SCL, INPUT_PULLUP);
+    delayMicroseconds(I2C_HALF_CLOCK_US);
+  }
+
+  // STOP, SDA rising while SCL is high
+  pinMode(PIN_WIRE_SCL, OUTPUT);
+  digitalWrite(PIN_WIRE_SCL, LOW);
+  pinMode(PIN_WIRE_SDA, OUTPUT);
+  digitalWrite(PIN_WIRE_SDA, LOW);
+  delayMicroseconds(I2C_HALF_CLOCK_US);
+  pinMode(PIN_WIRE_SCL, INPUT_PULLUP);
+  delayMicroseconds(I2C_HALF_CLOCK_US);
+  pinMode(PIN_WIRE_SDA, INPUT_PULLUP);
+  delayMicroseconds(I2C_HALF_CLOCK_US);
+
+  free = (digitalRead(PIN_WIRE_SDA) == HIGH);
+  i2c_recoveries++;
+
+  Wire.begin();
+  i2c_clock = I2C_CLOCK_STANDARD;
+  return (free);
+}
+
+/*
+ * ======================================================================================================================
+ * I2C_Begin() - Start Wire, free the bus if needed, start the queue and count Adafruit_BusIO transactions. Called
+ *               once from setup()
+ * ======================================================================================================================
+ */
+void I2C_Begin() {
+  Wire.begin();
+  i2c_clock = I2C_CLOCK_STANDARD;
+  I2C_Recover();
+  I2CQ_Begin();
+  Adafruit_I2CDevice_start_hook = I2C_Clock;
+  Adafruit_I2CDevice_hook = I2C_Count;
+}
+
+/*
+ * ======================================================================================================================
+ * I2C_Service() - Called every second from BackGroundWork(), report demoted addresses. When addresses keep failing
+ *                 and SDA is held low, free the bus and reinitialize them. With SDA high the bus is fine, a device
+ *                 that is absent or busy only adds to its own counters.
+ * ======================================================================================================================
+ */
+void I2C_Service() {
+  for (int i = 0; i < i2c_stats_count; i++) {
+    if (i2c_stats[i].demoted) {
+      i2c_stats[i].demoted = false;
+      sprintf (Buffer32Bytes, "I2C:%02X 100KHZ", i2c_stats[i].addr);
+      Output (Buffer32Bytes);
+    }
+  }
+
+  if (!i2c_pending) {
+    return;
+  }
+  i2c_pending = false;
+
+  if (!I2C_SDALow()) {
+    for (int i = 0; i < i2c_stats_count; i++) {
+      if (i2c_stats[i].pending) {
+        i2c_stats[i].pending = false;
+        i2c_stats[i].fails = 0;           // Check again after another I2C_FAIL_LIMIT
+      }
+    }
+    return;
+  }
+
+  if (!I2C_Recover()) {
+    Output ("I2C:SDA STUCK");
+  }
+
+  for (int i = 0; i < i2c_stats_count; i++) {
+    if (i2c_stats[i].pending) {
+      i2c_stats[i].pending = false;
+      i2c_stats[i].fails = 0;
+      sprintf (Buffer32Bytes, "I2C:%02X REINIT", i2c_stats[i].addr);
+      Output (Buffer32Bytes);
+      sensor_reinitialize(i2c_stats[i].addr);
+    }
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * I2C_Info() - Add the counters to the INFO message, stop adding addresses when out of room
+ * ======================================================================================================================
+ */
+void I2C_Info(char *msg, int size) {
+  const char *comma = "";
+  int len;
+
+  len = strlen(msg);
+  len += snprintf (msg+len, size-len, ",\"i2c\":\"");
+  for (int i = 0; i < i2c_stats_count; i++) {
+    I2C_STATS_STR *s = &i2c_stats[i];
+    if ((size-len) < 80) {              // Room for the longest entry and the closing i2cr
+      break;
+    }
+    len += snprintf (msg+len, size-len, "%s%02X%s(%lu/%lu/%lu/%lu/%lu)", comma, s->addr,
+      (s->clock < I2C_DefaultClock(s->addr)) ? "s" : "", s->tx, s->nack, s->err,
+      (s->tx) ? (unsigned long)(s->us_total / s->tx) : 0UL, s->us_max);
+    comma = ",";
+  }
+  snprintf (msg+len, size-len, "\",\"i2cr\":%u", i2c_recoveries);
+}
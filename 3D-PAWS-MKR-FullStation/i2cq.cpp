@@ -0,0 +1,608 @@
+/*
+ * ======================================================================================================================
+ * i2cq.cpp - Queued I2C Master, SERCOM with DMA
+ * ======================================================================================================================
+ */
+#include <Arduino.h>
+#include <Wire.h>
+
+#include "include/i2c.h"
+#include "include/i2cq.h"
+
+/*
+ * ======================================================================================================================
+ * Variables and Data Structures
+ * =======================================================================================================================
+ */
+I2CQ_XFER_STR *i2cq[I2CQ_SIZE];     // Ring, the head is on the wire
+volatile int i2cq_head = 0;
+volatile int i2cq_count = 0;
+
+/*
+ * ======================================================================================================================
+ * Fuction Definations
+ * =======================================================================================================================
+ */
+
+void I2CQ_Start(I2CQ_XFER_STR *x);
+
+/*
+ * ======================================================================================================================
+ * I2CQ_Complete() - The head transaction is done, count it, tell the caller and start the next
+ * ======================================================================================================================
+ */
+void I2CQ_Complete(uint8_t status) {
+  I2CQ_XFER_STR *x = i2cq[i2cq_head];
+
+  i2cq_head = (i2cq_head + 1) % I2CQ_SIZE;
+  i2cq_count--;
+
+  I2C_Count(x->addr, status, x->start_us);
+  x->status = status;
+  if (x->done) {
+    x->done(x);
+  }
+
+  if (i2cq_count) {
+    I2CQ_Start(i2cq[i2cq_head]);
+  }
+}
+
+#if defined(ARDUINO_ARCH_SAMD) && I2CQ_DMA
+/*
+ * ======================================================================================================================
+ *  SAMD - The DMA feeds and empties the SERCOM DATA register a byte per trigger, the SERCOM interrupt ends each
+ *  phase. Wire owns the SERCOM's vector, it is taken over in a copy of the vector table in RAM and Wire's handler
+ *  is called from ours while the queue is idle. Nothing else in the station uses the DMAC, it is set up here.
+ *    Write   - DMA, length counter. The DMA interrupt turns on MB, set once the STOP after the last byte is out.
+ *              A NACK stops the counter with a STOP and sets ERROR.
+ *    Pointer - The write ahead of a read, a byte per MB from the interrupt, then ADDR with the read address for
+ *              the repeated START.
+ *    Read    - DMA, length counter. MB is a NACK of the address. The DMA interrupt turns on SB, set once the
+ *              STOP after the last byte is out.
+ * ======================================================================================================================
+ */
+#define I2CQ_IDLE          0
+#define I2CQ_WRITE         1
+#define I2CQ_POINTER       2
+#define I2CQ_READ          3
+#define I2CQ_END           4        // Last byte moved, waiting for the STOP
+#define I2CQ_BUS_IDLE      1        // STATUS.BUSSTATE
+#define I2CQ_BUS_OWNER     2
+#define I2CQ_VECTORS       (16 + PERIPH_COUNT_IRQn)
+
+__attribute__((aligned(16))) DmacDescriptor i2cq_desc[2];   // First descriptor of each channel, DMAC->BASEADDR
+__attribute__((aligned(16))) DmacDescriptor i2cq_wb[2];     // Channel write back, DMAC->WRBADDR
+__attribute__((aligned(16))) DmacDescriptor i2cq_desc_tx;   // tx when it follows pre
+__attribute__((aligned(256))) void (*i2cq_vectors[I2CQ_VECTORS])();  // SCB->VTOR
+void (*i2cq_wire_handler)();        // Wire's SERCOM handler
+Sercom *i2cq_sercom = NULL;         // PERIPH_WIRE, set by I2CQ_Begin()
+uint8_t i2cq_sercom_n;              // Its number, SERCOMn
+volatile uint8_t i2cq_phase = I2CQ_IDLE;
+uint8_t i2cq_sent;                  // Pointer bytes sent
+bool i2cq_baud_set = false;         // BAUD changed since Wire last set it
+
+/*
+ * ======================================================================================================================
+ * I2CQ_Sync() - Wait for a SERCOM command, address or CTRLB write to reach its clock domain, a few clocks
+ * ======================================================================================================================
+ */
+void I2CQ_Sync() {
+  while (i2cq_sercom->I2CM.SYNCBUSY.bit.SYSOP);
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_BaudFor() - SERCOM BAUD value for a clock, as Wire.setClock() works it out
+ * ======================================================================================================================
+ */
+uint8_t I2CQ_BaudFor(uint32_t hz) {
+  return (SystemCoreClock / (2 * hz) - 5 - (((SystemCoreClock / 1000000) * WIRE_RISE_TIME_NANOSECONDS) / (2 * 1000)));
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_Baud() - Write the BAUD register, it can only be changed with the SERCOM disabled. A handful of clock
+ *               domain syncs, no bus time, so it is done from the interrupt.
+ * ======================================================================================================================
+ */
+void I2CQ_Baud(uint8_t baud) {
+  if (i2cq_sercom->I2CM.BAUD.bit.BAUD == baud) {
+    return;
+  }
+  i2cq_sercom->I2CM.CTRLA.bit.ENABLE = 0;
+  while (i2cq_sercom->I2CM.SYNCBUSY.bit.ENABLE);
+  i2cq_sercom->I2CM.BAUD.bit.BAUD = baud;
+  i2cq_sercom->I2CM.CTRLA.bit.ENABLE = 1;
+  while (i2cq_sercom->I2CM.SYNCBUSY.bit.ENABLE);
+  i2cq_sercom->I2CM.STATUS.bit.BUSSTATE = I2CQ_BUS_IDLE;   // As Wire does after enabling
+  I2CQ_Sync();
+  i2cq_baud_set = true;
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_Channel() - Reset a DMA channel and set its SERCOM trigger, a byte per trigger
+ * ======================================================================================================================
+ */
+void I2CQ_Channel(uint8_t ch, uint8_t trigger) {
+  DMAC->CHID.reg = DMAC_CHID_ID(ch);
+  DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+  DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+  while (DMAC->CHCTRLA.reg & DMAC_CHCTRLA_SWRST);
+  DMAC->CHCTRLB.reg = DMAC_CHCTRLB_LVL(0) | DMAC_CHCTRLB_TRIGSRC(trigger) | DMAC_CHCTRLB_TRIGACT_BEAT;
+  DMAC->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL | DMAC_CHINTENSET_TERR;
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_ChannelStop() - Disable a DMA channel and clear its flags, the write back then holds what was left
+ * ======================================================================================================================
+ */
+void I2CQ_ChannelStop(uint8_t ch) {
+  DMAC->CHID.reg = DMAC_CHID_ID(ch);
+  DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+  while (DMAC->CHCTRLA.reg & DMAC_CHCTRLA_ENABLE);
+  DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL | DMAC_CHINTFLAG_TERR | DMAC_CHINTFLAG_SUSP;
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_Desc() - Fill a descriptor for n bytes between buf and DATA. With increment the buffer address is its end
+ * ======================================================================================================================
+ */
+void I2CQ_Desc(DmacDescriptor *d, const uint8_t *buf, uint16_t n, bool read, DmacDescriptor *next) {
+  d->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE |
+    (read ? DMAC_BTCTRL_DSTINC : DMAC_BTCTRL_SRCINC) | (next ? DMAC_BTCTRL_BLOCKACT_NOACT : DMAC_BTCTRL_BLOCKACT_INT);
+  d->BTCNT.reg = n;
+  if (read) {
+    d->SRCADDR.reg = (uint32_t) &i2cq_sercom->I2CM.DATA.reg;
+    d->DSTADDR.reg = (uint32_t) (buf + n);
+  }
+  else {
+    d->SRCADDR.reg = (uint32_t) (buf + n);
+    d->DSTADDR.reg = (uint32_t) &i2cq_sercom->I2CM.DATA.reg;
+  }
+  d->DESCADDR.reg = (uint32_t) next;
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_Interrupts() - SERCOM interrupts for the phase, flags left from the last one cleared
+ * ======================================================================================================================
+ */
+void I2CQ_Interrupts(uint8_t on) {
+  i2cq_sercom->I2CM.INTENCLR.reg = SERCOM_I2CM_INTENCLR_MB | SERCOM_I2CM_INTENCLR_SB | SERCOM_I2CM_INTENCLR_ERROR;
+  i2cq_sercom->I2CM.INTFLAG.reg = SERCOM_I2CM_INTFLAG_ERROR;
+  i2cq_sercom->I2CM.INTENSET.reg = on;
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_Write() - Start a write on its own, pre then tx. Writing ADDR sends the START and the address
+ * ======================================================================================================================
+ */
+void I2CQ_Write(I2CQ_XFER_STR *x) {
+  DmacDescriptor *d = &i2cq_desc[I2CQ_CH_TX];
+
+  if (x->pre_len && x->tx_len) {
+    I2CQ_Desc(d, x->pre, x->pre_len, false, &i2cq_desc_tx);
+    I2CQ_Desc(&i2cq_desc_tx, x->tx, x->tx_len, false, NULL);
+  }
+  else if (x->pre_len) {
+    I2CQ_Desc(d, x->pre, x->pre_len, false, NULL);
+  }
+  else {
+    I2CQ_Desc(d, x->tx, x->tx_len, false, NULL);
+  }
+  i2cq_phase = I2CQ_WRITE;
+  I2CQ_Interrupts(SERCOM_I2CM_INTENSET_ERROR);
+  DMAC->CHID.reg = DMAC_CHID_ID(I2CQ_CH_TX);
+  DMAC->CHCTRLA.reg |= DMAC_CHCTRLA_ENABLE;
+
+  i2cq_sercom->I2CM.ADDR.reg = SERCOM_I2CM_ADDR_ADDR(x->addr << 1) | SERCOM_I2CM_ADDR_LENEN |
+    SERCOM_I2CM_ADDR_LEN(x->pre_len + x->tx_len);
+  I2CQ_Sync();
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_Pointer() - Start the write ahead of a read, the interrupt sends its bytes
+ * ======================================================================================================================
+ */
+void I2CQ_Pointer(I2CQ_XFER_STR *x) {
+  i2cq_phase = I2CQ_POINTER;
+  i2cq_sent = 0;
+  I2CQ_Interrupts(SERCOM_I2CM_INTENSET_MB | SERCOM_I2CM_INTENSET_ERROR);
+  i2cq_sercom->I2CM.ADDR.reg = SERCOM_I2CM_ADDR_ADDR(x->addr << 1);
+  I2CQ_Sync();
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_Read() - Start the read, a repeated START when it follows the pointer
+ * ======================================================================================================================
+ */
+void I2CQ_Read(I2CQ_XFER_STR *x) {
+  I2CQ_Desc(&i2cq_desc[I2CQ_CH_RX], x->rx, x->rx_len, true, NULL);
+  i2cq_phase = I2CQ_READ;
+  I2CQ_Interrupts(SERCOM_I2CM_INTENSET_MB | SERCOM_I2CM_INTENSET_ERROR);
+  DMAC->CHID.reg = DMAC_CHID_ID(I2CQ_CH_RX);
+  DMAC->CHCTRLA.reg |= DMAC_CHCTRLA_ENABLE;
+
+  i2cq_sercom->I2CM.CTRLB.bit.ACKACT = 0;
+  I2CQ_Sync();
+  i2cq_sercom->I2CM.ADDR.reg = SERCOM_I2CM_ADDR_ADDR((x->addr << 1) | 1) | SERCOM_I2CM_ADDR_LENEN |
+    SERCOM_I2CM_ADDR_LEN(x->rx_len);
+  I2CQ_Sync();
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_Start() - Put the transaction on the wire, from the caller with interrupts off or from an interrupt
+ * ======================================================================================================================
+ */
+void I2CQ_Start(I2CQ_XFER_STR *x) {
+  I2CQ_Baud(x->baud);
+  x->start_us = micros();
+  if (x->rx_len && (x->pre_len + x->tx_len)) {
+    I2CQ_Pointer(x);
+  }
+  else if (x->rx_len) {
+    I2CQ_Read(x);
+  }
+  else {
+    I2CQ_Write(x);
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_Finish() - End the head transaction, STOP if the length counter has not sent one
+ * ======================================================================================================================
+ */
+void I2CQ_Finish(uint8_t status) {
+  I2CQ_ChannelStop(I2CQ_CH_TX);
+  I2CQ_ChannelStop(I2CQ_CH_RX);
+  I2CQ_Interrupts(0);
+  if (i2cq_sercom->I2CM.STATUS.bit.BUSSTATE == I2CQ_BUS_OWNER) {
+    i2cq_sercom->I2CM.CTRLB.bit.ACKACT = 1;
+    i2cq_sercom->I2CM.CTRLB.bit.CMD = 3;       // STOP
+    I2CQ_Sync();
+  }
+  i2cq_sercom->I2CM.INTFLAG.reg = SERCOM_I2CM_INTFLAG_MB | SERCOM_I2CM_INTFLAG_SB | SERCOM_I2CM_INTFLAG_ERROR;
+  i2cq_phase = I2CQ_IDLE;
+  I2CQ_Complete(status);
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_Nack() - Status for a NACK of a write. The address if the DMA had not moved more than the first byte, the
+ *               SERCOM may ask for it before it has the address acknowledge
+ * ======================================================================================================================
+ */
+uint8_t I2CQ_Nack() {
+  if (i2cq_phase == I2CQ_POINTER) {
+    return ((i2cq_sent) ? I2C_NACK_DATA : I2C_NACK_ADDR);
+  }
+  if (i2cq_phase == I2CQ_READ) {
+    return (I2C_NACK_ADDR);
+  }
+  return (((i2cq_wb[I2CQ_CH_TX].DESCADDR.reg != i2cq_desc[I2CQ_CH_TX].DESCADDR.reg) ||
+    ((i2cq_desc[I2CQ_CH_TX].BTCNT.reg - i2cq_wb[I2CQ_CH_TX].BTCNT.reg) > 1)) ? I2C_NACK_DATA : I2C_NACK_ADDR);
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_SERCOM_Handler() - The SERCOM's vector. A phase has ended, a pointer byte is acknowledged or a NACK or bus
+ *                         error. Wire's handler while the queue is idle
+ * ======================================================================================================================
+ */
+void I2CQ_SERCOM_Handler() {
+  I2CQ_XFER_STR *x;
+  uint8_t flags;
+  uint16_t status;
+
+  if (i2cq_phase == I2CQ_IDLE) {
+    i2cq_wire_handler();
+    return;
+  }
+  x = i2cq[i2cq_head];
+  flags = i2cq_sercom->I2CM.INTFLAG.reg & i2cq_sercom->I2CM.INTENSET.reg;
+  status = i2cq_sercom->I2CM.STATUS.reg;
+
+  if (status & (SERCOM_I2CM_STATUS_BUSERR | SERCOM_I2CM_STATUS_ARBLOST)) {
+    I2CQ_Finish(I2C_ERROR);
+  }
+  else if ((flags & SERCOM_I2CM_INTFLAG_ERROR) || ((flags & SERCOM_I2CM_INTFLAG_MB) &&
+           (status & SERCOM_I2CM_STATUS_RXNACK) && (i2cq_phase != I2CQ_END))) {
+    I2CQ_ChannelStop(I2CQ_CH_TX);
+    I2CQ_Finish(I2CQ_Nack());
+  }
+  else if (i2cq_phase == I2CQ_POINTER) {
+    if (!(flags & SERCOM_I2CM_INTFLAG_MB)) {
+      return;
+    }
+    if (i2cq_sent < x->pre_len + x->tx_len) {
+      i2cq_sercom->I2CM.DATA.reg = (i2cq_sent < x->pre_len) ? x->pre[i2cq_sent] : x->tx[i2cq_sent - x->pre_len];
+      i2cq_sent++;
+    }
+    else {
+      I2CQ_Read(x);
+    }
+  }
+  else if ((i2cq_phase == I2CQ_END) && (flags & (SERCOM_I2CM_INTFLAG_MB | SERCOM_I2CM_INTFLAG_SB))) {
+    I2CQ_Finish(I2C_OK);
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * DMAC_Handler() - A phase has moved its last byte, wait for its STOP. Or the DMA hit a bus error
+ * ======================================================================================================================
+ */
+void DMAC_Handler() {
+  uint8_t tx, rx;
+
+  DMAC->CHID.reg = DMAC_CHID_ID(I2CQ_CH_TX);
+  tx = DMAC->CHINTFLAG.reg;
+  DMAC->CHINTFLAG.reg = tx;
+  DMAC->CHID.reg = DMAC_CHID_ID(I2CQ_CH_RX);
+  rx = DMAC->CHINTFLAG.reg;
+  DMAC->CHINTFLAG.reg = rx;
+
+  if (i2cq_phase == I2CQ_IDLE) {
+    return;
+  }
+  if ((tx | rx) & DMAC_CHINTFLAG_TERR) {
+    I2CQ_Finish(I2C_ERROR);
+  }
+  else if ((i2cq_phase == I2CQ_WRITE) && (tx & DMAC_CHINTFLAG_TCMPL)) {
+    i2cq_phase = I2CQ_END;
+    i2cq_sercom->I2CM.INTENSET.reg = SERCOM_I2CM_INTENSET_MB;
+  }
+  else if ((i2cq_phase == I2CQ_READ) && (rx & DMAC_CHINTFLAG_TCMPL)) {
+    i2cq_phase = I2CQ_END;
+    i2cq_sercom->I2CM.INTENCLR.reg = SERCOM_I2CM_INTENCLR_MB;
+    i2cq_sercom->I2CM.INTENSET.reg = SERCOM_I2CM_INTENSET_SB;
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_Poll() - Finish the head transaction on a timeout. A read whose STOP is out with no SB is finished here
+ * ======================================================================================================================
+ */
+void I2CQ_Poll() {
+  noInterrupts();
+  if (i2cq_count && (i2cq_phase != I2CQ_IDLE)) {
+    I2CQ_XFER_STR *x = i2cq[i2cq_head];
+
+    if ((i2cq_phase == I2CQ_END) && (i2cq_sercom->I2CM.STATUS.bit.BUSSTATE == I2CQ_BUS_IDLE)) {
+      I2CQ_Finish(I2C_OK);
+    }
+    else if ((micros() - x->start_us) > I2CQ_TIMEOUT_US) {
+      I2CQ_Finish(I2C_ERROR);
+    }
+  }
+  interrupts();
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_Begin() - Find Wire's SERCOM, take over its vector, clock the DMAC and set up the two channels
+ * ======================================================================================================================
+ */
+void I2CQ_Begin() {
+  SERCOM *periph[] = {&sercom0, &sercom1, &sercom2, &sercom3, &sercom4, &sercom5};
+  Sercom *regs[] = {SERCOM0, SERCOM1, SERCOM2, SERCOM3, SERCOM4, SERCOM5};
+  int irq;
+
+  for (uint8_t n = 0; n < 6; n++) {
+    if (periph[n] == &PERIPH_WIRE) {
+      i2cq_sercom = regs[n];
+      i2cq_sercom_n = n;
+    }
+  }
+  if (i2cq_sercom == NULL) {
+    return;
+  }
+  irq = SERCOM0_IRQn + i2cq_sercom_n;
+
+  // Our handler in a RAM copy of the vector table, Wire's is called from it
+  memcpy(i2cq_vectors, (void *) SCB->VTOR, sizeof(i2cq_vectors));
+  i2cq_wire_handler = i2cq_vectors[16 + irq];
+  i2cq_vectors[16 + irq] = I2CQ_SERCOM_Handler;
+  noInterrupts();
+  SCB->VTOR = (uint32_t) i2cq_vectors;
+  __DSB();
+  interrupts();
+
+  PM->AHBMASK.reg |= PM_AHBMASK_DMAC;
+  PM->APBBMASK.reg |= PM_APBBMASK_DMAC;
+
+  DMAC->CTRL.reg &= ~DMAC_CTRL_DMAENABLE;
+  DMAC->CTRL.reg = DMAC_CTRL_SWRST;
+  while (DMAC->CTRL.reg & DMAC_CTRL_SWRST);
+  DMAC->BASEADDR.reg = (uint32_t) i2cq_desc;
+  DMAC->WRBADDR.reg = (uint32_t) i2cq_wb;
+  DMAC->CTRL.reg = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN(0xF);
+
+  I2CQ_Channel(I2CQ_CH_TX, SERCOM0_DMAC_ID_TX + 2 * i2cq_sercom_n);
+  I2CQ_Channel(I2CQ_CH_RX, SERCOM0_DMAC_ID_RX + 2 * i2cq_sercom_n);
+  NVIC_ClearPendingIRQ(DMAC_IRQn);
+  NVIC_SetPriority(DMAC_IRQn, 2);
+  NVIC_EnableIRQ(DMAC_IRQn);
+  NVIC_EnableIRQ((IRQn_Type) irq);
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_Prepare() - Work out the BAUD value now, the interrupt only writes it
+ * ======================================================================================================================
+ */
+void I2CQ_Prepare(I2CQ_XFER_STR *x) {
+  x->baud = I2CQ_BaudFor(x->clock);
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_QueueMode() - Queue is about to run, smart mode on for the DMA, reading DATA acknowledges the byte
+ * ======================================================================================================================
+ */
+void I2CQ_QueueMode() {
+  i2cq_sercom->I2CM.CTRLB.bit.SMEN = 1;
+  I2CQ_Sync();
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_WireMode() - Queue is empty, give the SERCOM back to Wire. Smart mode off, Wire sends its own acknowledge
+ *                   commands, and the clock set again on Wire's next transaction if the queue changed it.
+ * ======================================================================================================================
+ */
+void I2CQ_WireMode() {
+  if ((i2cq_sercom != NULL) && i2cq_sercom->I2CM.CTRLB.bit.SMEN) {
+    i2cq_sercom->I2CM.CTRLB.bit.SMEN = 0;
+    I2CQ_Sync();
+  }
+  if (i2cq_baud_set) {
+    i2cq_baud_set = false;
+    I2C_ClockReset();
+  }
+}
+
+#else
+/*
+ * ======================================================================================================================
+ *  No DMA - The head transaction runs on Wire when I2CQ_Poll() gets to it
+ * ======================================================================================================================
+ */
+void I2CQ_Start(I2CQ_XFER_STR *x) {
+  (void) x;
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_Poll() - Run the head transaction, a repeated START between its write and read
+ * ======================================================================================================================
+ */
+void I2CQ_Poll() {
+  I2CQ_XFER_STR *x;
+  uint8_t status = I2C_OK;
+  int n;
+
+  if (!i2cq_count) {
+    return;
+  }
+  x = i2cq[i2cq_head];
+  I2C_ClockSet(x->clock);
+  x->start_us = micros();
+
+  if (x->pre_len + x->tx_len) {
+    Wire.beginTransmission(x->addr);
+    if (x->pre_len) {
+      Wire.write(x->pre, x->pre_len);
+    }
+    if (x->tx_len) {
+      Wire.write(x->tx, x->tx_len);
+    }
+    status = Wire.endTransmission(x->rx_len == 0);
+  }
+  if ((status == I2C_OK) && x->rx_len) {
+    n = Wire.requestFrom(x->addr, (size_t) x->rx_len);
+    status = (n == x->rx_len) ? I2C_OK : ((n == 0) ? I2C_NACK_ADDR : I2C_ERROR);
+    for (int i = 0; i < n; i++) {
+      x->rx[i] = Wire.read();
+    }
+  }
+  I2CQ_Complete(status);
+}
+
+void I2CQ_Begin() {}
+void I2CQ_Prepare(I2CQ_XFER_STR *x) { (void) x; }
+void I2CQ_QueueMode() {}
+void I2CQ_WireMode() {}
+#endif
+
+/*
+ * ======================================================================================================================
+ * I2CQ_Submit() - Queue a transaction, false if a phase is too long or there is nothing to send or read.
+ *                 Waits for room when the queue is full.
+ * ======================================================================================================================
+ */
+bool I2CQ_Submit(I2CQ_XFER_STR *x) {
+  int tx = x->pre_len + x->tx_len;
+
+  if ((tx + x->rx_len == 0) || (tx > I2CQ_MAX_LEN) || (x->rx_len > I2CQ_MAX_LEN) ||
+      (x->rx_len && (tx > I2CQ_PRE_MAX))) {
+    return (false);
+  }
+  x->status = I2CQ_PENDING;
+  x->clock = I2C_ClockFor(x->addr);
+  I2CQ_Prepare(x);
+
+  while (i2cq_count == I2CQ_SIZE) {
+    I2CQ_Poll();
+  }
+
+  noInterrupts();
+  i2cq[(i2cq_head + i2cq_count) % I2CQ_SIZE] = x;
+  if (i2cq_count++ == 0) {
+    I2CQ_QueueMode();
+    I2CQ_Start(x);
+  }
+  interrupts();
+  return (true);
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_Wait() - Wait for a submitted transaction, returns its status
+ * ======================================================================================================================
+ */
+uint8_t I2CQ_Wait(I2CQ_XFER_STR *x) {
+  while (x->status == I2CQ_PENDING) {
+    I2CQ_Poll();
+  }
+  return (x->status);
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_Idle() - Wait for the queue to empty and give the SERCOM back to Wire. Called before any Wire transaction
+ * ======================================================================================================================
+ */
+void I2CQ_Idle() {
+  while (i2cq_count) {
+    I2CQ_Poll();
+  }
+  I2CQ_WireMode();
+}
+
+/*
+ * ======================================================================================================================
+ * I2CQ_Transfer() - Blocking transaction through the queue, returns its status. For the OLED, EEPROM and AS5600.
+ *                   An address only write has no DMA phase, it goes on Wire.
+ * ======================================================================================================================
+ */
+uint8_t I2CQ_Transfer(uint8_t addr, const uint8_t *pre, size_t pre_len, const uint8_t *tx, size_t tx_len,
+    uint8_t *rx, size_t rx_len) {
+  I2CQ_XFER_STR x;
+
+  if (pre_len + tx_len + rx_len == 0) {
+    return (I2C_Write(addr, NULL, 0));
+  }
+  memset (&x, 0, sizeof(x));
+  x.addr = addr;
+  x.pre = pre;
+  x.pre_len = pre_len;
+  x.tx = tx;
+  x.tx_len = tx_len;
+  x.rx = rx;
+  x.rx_len = rx_len;
+  if (!I2CQ_Submit(&x)) {
+    return (I2C_ERROR);
+  }
+  return (I2CQ_Wait(&x));
+}
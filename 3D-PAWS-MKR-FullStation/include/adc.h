@@ -0,0 +1,34 @@
+/*
+ * ======================================================================================================================
+ *  adc.h - Analog Option Pin Sampling Service Definations
+ *
+ *  The SAMD21 ADC is left running in 16x hardware averaging mode with the result ready interrupt enabled.
+ *  ADC_Service() is called every second from BackGroundWork() and starts one round of conversions over the
+ *  pins in use. ADC_Handler() stores each result and starts the next pin, so no time is spent waiting.
+ *    The first conversion after changing pins is discarded to let the sample and hold settle.
+ *    Each pin keeps its last ADC_AVG_RESULTS results, one per second, for ADC_PinAvg().
+ *  Once ADC_Begin() has run all analog reads of these pins must go through this service, analogRead()
+ *  reconfigures and disables the ADC.
+ * ======================================================================================================================
+ */
+#define ADC_CHANNELS        2        // OP1 and OP2
+#define ADC_AVG_RESULTS     5        // 1s results averaged by ADC_PinAvg()
+#define ADC_PRIME_MS        50       // Longest ADC_Begin() waits for the first round of results
+
+typedef struct {
+  int pin;                             // Arduino pin, -1 if not in use
+  uint8_t mux;                         // ADC input for the pin
+  volatile uint16_t latest;            // Last result, 12 bit
+  volatile uint16_t result[ADC_AVG_RESULTS];
+  volatile uint8_t idx;                // Next result slot
+  volatile uint8_t count;              // Results stored, up to ADC_AVG_RESULTS
+} ADC_CHANNEL_STR;
+
+// Extern variables
+extern ADC_CHANNEL_STR adc_channel[ADC_CHANNELS];
+
+// Function prototypes
+void ADC_Begin();
+void ADC_Service();
+float ADC_PinAvg(int pin);
+int ADC_PinLatest(int pin);
@@ -0,0 +1,35 @@
+/*
+ * ======================================================================================================================
+ *  baro.h - Barometer Definations
+ *
+ *  The barometers are put in normal (continuous) mode at initialization with pressure oversampling and the
+ *  on chip IIR filter, so they convert on their own at about 1-2 Hz. Reading one for an observation is a
+ *  register burst of the latest filtered result, no conversion is started or waited for.
+ *    The IIR filter takes about 10 seconds to settle after initialization, about 20 samples.
+ *    BARO_Read() returns pressure in hPa, temperature in C and humidity in %, NAN when the barometer
+ *    does not measure it or the read fails.
+ * ======================================================================================================================
+ */
+typedef enum {
+  BARO_NONE,
+  BARO_BMP280,
+  BARO_BME280,
+  BARO_BMP3XX,                         // BMP388 and BMP390
+  BARO_BMP5XX,                         // BMP580 and BMP581
+  BARO_LPS35HW
+} BARO_TYPE;
+
+typedef struct {
+  BARO_TYPE type;
+  void *dev;                           // Library object of the type, Adafruit_BMP280 etc.
+} BARO_STR;
+
+// Extern variables
+extern BARO_STR bmx1_baro;
+extern BARO_STR bmx2_baro;
+extern BARO_STR lps1_baro;
+extern BARO_STR lps2_baro;
+
+// Function prototypes
+bool BARO_Continuous(BARO_STR *b);
+bool BARO_Read(BARO_STR *b, float &p, float &t, float &h);
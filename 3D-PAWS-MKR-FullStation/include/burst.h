@@ -0,0 +1,90 @@
+/*
+ * ======================================================================================================================
+ *  burst.h - High Rate Wind Burst Definations
+ *
+ *  Every wb_interval minutes a WB_MINUTES burst of wind samples is taken at wb_rate Hz, on top of the
+ *  normal 1s wind sampling.
+ *    Sampling runs from WB_Delay(), which takes the place of delay() for the waits in the main loop, so it 
+ *    happens during the time the main loop already spends waiting and never inside another I2C transaction.
+ *    A sample slot that is missed while the main loop is busy is skipped, the slot index keeps the time base.
+ *    Samples go to a RAM ring and are written from BackGroundWork() to /WB/YYYY/MMDDHHMM.WB.
+ *    Mean, standard deviation, 3s gust and vector direction are kept online and reported with the next
+ *    observation after the burst, with turbulence intensity (sd/mean) and gust factor (gust/mean).
+ *
+ *  File format, little endian
+ *    WB_HEADER_STR then one WB_SAMPLE_STR per sample taken. Missing slot indexes are samples not taken.
+ * ======================================================================================================================
+ */
+#define WB_MINUTES          10       // Burst length
+#define WB_RATE_MIN         2        // Hz
+#define WB_RATE_MAX         10       // Hz
+#define WB_RING             256      // Samples buffered between SD writes, power of 2
+#define WB_RING_MASK        (WB_RING-1)
+#define WB_WRITE_AT         64       // Samples buffered before BackGroundWork() writes them
+#define WB_GUST_SECONDS     3
+#define WB_MIN_MEAN         0.5      // m/s, below this turbulence intensity and gust factor are not reported
+#define WB_NODATA           0xFFFF
+#define WB_ERR              -999.9
+
+typedef struct {
+  char magic[4];                       // "WB01"
+  uint32_t start;                      // Epoch of slot 0
+  uint16_t rate;                       // Slots per second
+  uint16_t slots;                      // Slots in the burst
+  float radius;                        // Anemometer calibration used for speed
+  float calibration;
+} WB_HEADER_STR;
+
+typedef struct {
+  uint16_t slot;                       // Slot index, slot covers start + slot / rate to the next slot
+  uint16_t speed;                      // cm/s
+  uint16_t angle;                      // AS5600 raw angle 0-4095, WB_NODATA on read error
+} WB_SAMPLE_STR;
+
+typedef struct {
+  bool active;                         // Burst in progress
+  uint32_t period_us;
+  uint32_t next_us;                    // End of the next slot, when it is sampled
+  uint16_t slot;                       // Next slot
+  uint16_t slots;
+  uint32_t start_window;               // Epoch / (wb_interval * 60) of the last burst started
+  uint32_t pulses;                     // anemometer_pulses at the last sample
+  WS_PERIOD_STR pulse;
+  WB_SAMPLE_STR ring[WB_RING];
+  uint16_t head;                       // Written by the sampler only
+  uint16_t tail;                       // Written by WB_Write() only
+  uint16_t lost;                       // Samples dropped with the ring full
+
+  // Online statistics
+  uint16_t n;
+  double mean;
+  double m2;
+  int64_t ns_sum;
+  int64_t ew_sum;
+  uint16_t angle_bad;
+  float gust_ring[WB_GUST_SECONDS * WB_RATE_MAX];
+  float gust_sum;
+  int gust_idx;
+  int gust_fill;                       // Consecutive slots in gust_ring
+  float gust;
+} WB_STR;
+
+typedef struct {
+  bool pending;                        // Set at the end of a burst, cleared when reported
+  uint16_t samples;
+  float ws;                            // Mean m/s
+  int wd;                              // Vector mean, -1 if any angle read failed
+  float sd;                            // Standard deviation m/s
+  float ti;                            // Turbulence intensity
+  float gust;                          // Highest 3s mean m/s
+  float gf;                            // Gust factor
+} WB_RESULT_STR;
+
+// Extern variables
+extern WB_STR wb;
+extern WB_RESULT_STR wb_result;
+
+// Function prototypes
+void WB_Poll();
+void WB_Delay(unsigned long ms);
+void WB_Service();
@@ -0,0 +1,30 @@
+/*
+ * ======================================================================================================================
+ *  cal.h - Calibration Streaming Definations
+ *
+ *  With the serial console enabled, typing "CAL" or "CAL <hz>" starts a binary stream of raw sensor records
+ *  on the USB serial port for calibration runs. Sending "Q" (or waiting CAL_MAX_MINUTES) stops it and normal
+ *  operation resumes. Text output is held off while streaming. See tools/cal_decode.py.
+ *
+ *  Record, little endian
+ *    0xA5 0x5A, type (CAL_TYPE_RAW), payload length, payload, CRC-16/CCITT-FALSE of type, length and payload
+ *  Payload
+ *    uint16 seq, uint32 millis, uint32 micros, uint32 anemometer pulses, uint32 micros of last pulse,
+ *    uint16 AS5600 raw angle (0xFFFF error), uint16 OP1 ADC, uint16 OP2 ADC (0xFFFF not sampled),
+ *    uint32 rain gauge 1 and 2 raw interrupts, float bmx1 pressure, temperature, humidity (read once a second)
+ * ======================================================================================================================
+ */
+#define CAL_RATE_DEFAULT    20       // Hz
+#define CAL_RATE_MIN        10
+#define CAL_RATE_MAX        50
+#define CAL_MAX_MINUTES     30
+#define CAL_SYNC1           0xA5
+#define CAL_SYNC2           0x5A
+#define CAL_TYPE_RAW        1
+#define CAL_PAYLOAD_SIZE    48
+#define CAL_CMD_SIZE        16
+
+// Extern variables
+
+// Function prototypes
+void CAL_Command();
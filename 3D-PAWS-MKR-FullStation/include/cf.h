@@ -61,27 +61,75 @@ lora_freq=915
 # 1 = no wind data
 nowind=0
 
+# Wind Products - 2 and 10 minute mean wind
+#   ws2m, wd2m, ws10m, wd10m
+# 10 minute gust and direction standard deviation
+#   wg10m, wgd10m, wdsd10m
+# 0 = disabled
+# 1 = enabled
+wind_products=0
+
+# Wind Speed Pulse Period - light wind speed from the
+# time between anemometer pulses, blended to the 1s
+# pulse count above 4 pulses a second
+# 0 = disabled, count pulses only
+# 1 = enabled
+ws_period=0
+
+# Wind Direction Oversample - AS5600 reads combined
+# as a circular mean for each 1s direction sample
+# 0,1 = single read, 2-16 reads 1ms apart
+wd_oversample=0
+
+# Wind Burst - 10 minute high rate wind samples
+# written to /WB/YYYY/MMDDHHMM.WB, results reported once
+# after each burst: wbws, wbwd, wbsd, wbgst, wbti, wbgf
+# wb_rate: samples per second, 0 = disabled, 2-10
+wb_rate=0
+# wb_interval: minutes between burst starts, 0 = 60
+wb_interval=60
+
 # Rain Gauge (rg1) - pin D1
 # Options 0,1
 rg1_enable=0
 
+# Rain Gauge 1 debounce in ms, 0 = default 500
+# Tips closer than this to the last tip are ignored
+rg1_debounce=0
+
 # OptionPin 1 - pin A1
 # 0 = No sensor
-# 1 = raw (op1r - average 5 samples spaced 10ms)
+# 1 = raw (op1r - average of the last 5 1s samples)
 # 2 = 2nd rain gauge (rg2)
 # 5 = 5m distance sensor (ds, dsr)
 # 10 = 10m distance sensor (ds, dsr)
 op1=0
 
+# Rain Gauge 2 debounce in ms, 0 = default 500
+rg2_debounce=0
+
+# Rain Products - per enabled gauge, N = 1 or 2
+#   rgNi1m, rgNi5m peak 1 and 5 minute intensity mm/h
+#   rgNrr rain rate mm/h from the tip interval
+#   rgNft, rgNlt epoch of first and last tip, 0 = none
+# 0 = disabled
+# 1 = enabled
+rg_products=0
+
 # OptionPin 2 - pin A2
 # 0 = No sensor (Pin in use if pm25aqi air quality detected)
-# 1 = raw (op2r - average 5 samples spaced 10ms)
+# 1 = raw (op2r - average of the last 5 1s samples)
 # 2 = read Voltaic battery voltage (vbv)
 op2=0
 
 # Distance sensor baseline. If positive, distance = baseline - ds_median
 ds_baseline=0
 
+# Distance sensor outlier rejection in mm, 0 = disabled
+# Samples further than this from the median are skipped,
+# 10 in a row are taken as a real change in level.
+ds_outlier=0
+
 # elevation used for MSLP
 elevation=0
 
@@ -114,6 +162,14 @@ daily_reboot=22
 
 # Reset after N attempts calling Send_http() and failing on GetCellEpochTime() or client.connect() functions.
 no_network_reset_count=60
+
+# Need to Send spool size, percent of the SD card free space at boot (1-90)
+# When it is full the oldest unsent observations are dropped
+n2s_pct=10
+
+# Sync the daily observation log to the SD card every N observations (1-60)
+# Also synced before modem resets and reboots
+log_sync=5
  * ======================================================================================================================
  */
 
@@ -160,16 +216,27 @@ extern int cf_lora_freq;
 
 // Instruments
 extern int cf_nowind;
+extern int cf_wind_products;
+extern int cf_ws_period;
+extern int cf_wd_oversample;
+extern int cf_wb_rate;
+extern int cf_wb_interval;
 extern int cf_rg1_enable;
+extern int cf_rg1_debounce;
+extern int cf_rg2_debounce;
+extern int cf_rg_products;
 extern int cf_op1;
 extern int cf_op2;
 extern int cf_ds_baseline;
+extern int cf_ds_outlier;
 extern int cf_elevation;
 
 // System Timing
 extern int cf_obs_period;
 extern int cf_daily_reboot;
 extern int cf_no_network_reset_count;
+extern int cf_n2s_pct;
+extern int cf_log_sync;
 extern char *cf_rtro;
 extern int cf_rtro_hour;
 extern int cf_rtro_minute;
@@ -34,6 +34,10 @@
    dst7=22.56 28:D0:86:36:04:00:00:52
   DSMUX 4 Found
 
+  Externally powered probes on all channels convert at the same time, one wait then each scratchpad is
+  read and CRC checked. A parasite powered probe needs the strong pullup on its channel for the whole
+  conversion, so those channels are converted one after the other while the others convert.
+
   Reported in INFO as "dsmux":"0,1,4,7"
 
   Reported in OBS as "dst0":22.6,"dst1":22.6,"dst4":22.7,"dst7":22.6
@@ -45,12 +49,17 @@
 #define DS18B20_CMD_SKIP_ROM 0xCC
 #define DS18B20_CMD_CONVERT_T 0x44
 #define DS18B20_CMD_READ_SCRATCHPAD 0xBE
+#define DS18B20_CMD_READ_POWER 0xB4
+#define DS18B20_CONVERSION_MS 750    // 12 bit resolution
 
 // Extern variables
 extern  Adafruit_DS248x ds248x;
 extern bool DSMUX_exists;
 extern bool dsmux_sensor_exists[DS248X_CHANNELS];
+extern bool dsmux_sensor_parasite[DS248X_CHANNELS];
 
 // Function prototypes
+bool dsmux_channel_exist(uint8_t channel);
+void dsmux_channel_begin(uint8_t channel);
 void dsmux_initialize();
 void dsmux_obs_do(int &sidx);
\ No newline at end of file
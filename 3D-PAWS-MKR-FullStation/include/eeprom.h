@@ -4,6 +4,8 @@
  * ======================================================================================================================
  */
 #define EEPROM_I2C_ADDR 0x50
+#define EEPROM_PAGE_SIZE 32         // 24LC32 page, FRAM has no pages
+#define EEPROM_WRITE_MS  10         // Longest EEPROM page write cycle
 
 /*
  * ======================================================================================================================
@@ -26,6 +28,8 @@ extern bool eeprom_valid;
 extern bool eeprom_exists;
 
 // Function prototype
+bool EEPROM_Read();
+void EEPROM_Save();
 unsigned long EEPROM_ChecksumCompute();
 void EEPROM_ChecksumUpdate();
 bool EEPROM_ChecksumValid();
@@ -0,0 +1,49 @@
+/*
+ * ======================================================================================================================
+ *  hotplug.h - Background Sensor Discovery Definations
+ *
+ *  The sensors found at boot are no longer the only ones used. HP_Service() probes one candidate each second:
+ *  each main bus sensor address, the Tinovi address on each mux channel and each DS2482 1-Wire channel. A pass
+ *  over all of them takes about 40 seconds.
+ *    A missing sensor that answers is brought online. A library begin() that allocates is only done once per
+ *    sensor, after that only the configuration it loses on power down is reapplied with sensor_reinitialize().
+ *    If it answers but does not start, it is left alone for HP_HOLD_PASSES passes.
+ *    An online sensor that does not answer for HP_MISS_LIMIT passes in a row is taken offline. Its observations
+ *    stop, the same as when it is not found at boot.
+ *    Each change is logged, and the next INFO is sent at once with "hp":"+VEML,-MCP2" listing the changes
+ *    since the last INFO.
+ * ======================================================================================================================
+ */
+#define HP_SIZE             40       // Candidates
+#define HP_MISS_LIMIT       3        // Passes without an answer before a sensor is taken offline
+#define HP_HOLD_PASSES      10       // Passes to skip a sensor that answers but does not start
+#define HP_CHANGES_SIZE     96
+
+typedef enum {
+  HP_BMX,                              // n 1-2
+  HP_MCP,                              // n 1-4
+  HP_HTU,
+  HP_HIH8,
+  HP_VEML,
+  HP_PM25,
+  HP_LPS,                              // n 1-2
+  HP_AS5600,
+  HP_TLW,
+  HP_TSM,                              // On the main bus when there is no mux
+  HP_I2C_44_47,                        // n address 0x44-0x47
+  HP_MUX_TSM,                          // n mux channel
+  HP_DST                               // n DS2482 channel
+} HP_TYPE;
+
+typedef struct {
+  HP_TYPE type;
+  uint8_t n;
+  uint8_t misses;                      // Passes in a row without an answer
+  uint8_t hold;                        // Passes left to skip
+  bool begun;                          // Library begin() done
+} HP_STR;
+
+// Function prototypes
+void HP_Initialize();
+void HP_Service();
+void HP_Info(char *msg, int size);
@@ -0,0 +1,70 @@
+/*
+ * ======================================================================================================================
+ *  i2c.h - I2C Bus Clock and Health Definations
+ *
+ *  Every transaction made through the Adafruit_BusIO drivers, and the raw Wire reads done with I2C_Write()
+ *  and I2C_Read(), is counted per address: transactions, NACKs, errors and bus time.
+ *    Errors are bus errors, lost arbitration and short reads. The SAMD Wire has no timeout of its own,
+ *    a stuck bus shows up as these errors.
+ *    After I2C_FAIL_LIMIT failures in a row on an address, I2C_Service() checks for SDA held low. Only then
+ *    it frees the bus by clocking SCL and sending a STOP, and reapplies the configuration of the sensors
+ *    that were failing with sensor_reinitialize(), in case the glitch also reset them. With SDA high the
+ *    failures are only counted, a missing or busy sensor does not restart the bus.
+ *    The counters are sent in INFO as "i2c":"addr(transactions/nacks/errors/avg us/max us),..." and
+ *    "i2cr":recoveries.
+ *
+ *  Bus clock - Devices known to handle fast mode are run at 400 kHz, all others at 100 kHz. I2C_Clock() is
+ *    called before each transaction and only changes the Wire clock when the device needs a different one.
+ *    While a mux channel is selected the Tinovi probe cables are on the bus, everything runs at 100 kHz.
+ *    An address that gets I2C_DEMOTE_LIMIT data NACKs or errors at 400 kHz is dropped to 100 kHz until
+ *    reboot, these show in INFO with an "s" after the address.
+ *
+ *  Queued transactions (i2cq.h) set the clock the same way and are counted the same way.
+ * ======================================================================================================================
+ */
+#define I2C_STATS_SIZE      24       // Addresses tracked
+#define I2C_FAIL_LIMIT      3        // Failures in a row before recovery
+#define I2C_HALF_CLOCK_US   5        // 100 kHz recovery clock
+#define I2C_CLOCK_STANDARD  100000   // Hz, Wire default
+#define I2C_CLOCK_FAST      400000   // Hz
+#define I2C_DEMOTE_LIMIT    3        // Errors at fast mode before the address is dropped to standard
+
+// Status, Wire endTransmission() return codes
+#define I2C_OK              0
+#define I2C_NACK_ADDR       2
+#define I2C_NACK_DATA       3
+#define I2C_ERROR           4
+
+typedef struct {
+  uint8_t addr;
+  bool pending;                        // Needs recovery and reinitialize
+  uint8_t fails;                       // Failures in a row
+  uint8_t fast_errs;                   // Data NACKs and errors at fast mode
+  bool demoted;                        // Dropped to standard mode, not yet reported
+  uint32_t clock;                      // Hz
+  unsigned long tx;                    // Transactions
+  unsigned long nack;
+  unsigned long err;                   // Bus error, arbitration lost or short read
+  unsigned long us_max;                // Longest transaction
+  uint64_t us_total;                   // Bus time of all transactions
+} I2C_STATS_STR;
+
+// Extern variables
+extern I2C_STATS_STR i2c_stats[I2C_STATS_SIZE];
+extern int i2c_stats_count;
+extern unsigned int i2c_recoveries;
+
+// Function prototypes
+void I2C_Begin();
+uint32_t I2C_ClockFor(uint8_t addr);
+bool I2C_ClockSet(uint32_t hz);
+void I2C_Clock(uint8_t addr);
+void I2C_ClockLimit(uint32_t hz);
+void I2C_ClockReset();
+void I2C_Count(uint8_t addr, uint8_t status, uint32_t start_us);
+uint8_t I2C_Write(uint8_t addr, const uint8_t *buf, int len, bool stop=true);
+int I2C_Read(uint8_t addr, uint8_t *buf, int len);
+bool I2C_SDALow();
+bool I2C_Recover();
+void I2C_Service();
+void I2C_Info(char *msg, int size);
@@ -0,0 +1,64 @@
+/*
+ * ======================================================================================================================
+ *  i2cq.h - Queued I2C Master Definations
+ *
+ *  Transactions are queued and run by the SERCOM with DMA, the CPU is free while the bytes are on the wire.
+ *    A transaction is an optional write then an optional read. pre (a control byte, register or memory address)
+ *    is sent ahead of tx, so callers need not copy their data behind it. A write on its own and a read run on
+ *    the SERCOM length counter, which NACKs the last byte read and sends the STOP. The write ahead of a read is
+ *    a register pointer of a byte or two, it is fed from the SERCOM interrupt and the read follows it with a
+ *    repeated START.
+ *    The SERCOM interrupt ends each phase and starts the next transaction, Wire's handler for the SERCOM still
+ *    runs while the queue is idle. The clock of each transaction is set as its SERCOM BAUD value when it is
+ *    submitted, so the interrupt only writes the register.
+ *    The caller owns the I2CQ_XFER_STR and its buffers until status is no longer I2CQ_PENDING. done() is
+ *    called after status is set, from the interrupts or from I2CQ_Poll() for a timeout, keep it short and do
+ *    not submit or wait from it. Every transaction is counted with I2C_Count().
+ *
+ *  Wire shares the SERCOM. I2C_Clock(), called before every Wire and Adafruit_BusIO transaction, waits for the
+ *  queue to empty and puts the SERCOM back the way Wire runs it. Only the OLED, EEPROM and AS5600 hot paths
+ *  queue, I2CQ_Transfer() is their blocking wrapper.
+ *
+ *  The DMA path is built with I2CQ_DMA set to 1, it has not yet run on a SAMD21. Without it, and other than on
+ *  the SAMD, a transaction runs on Wire when I2CQ_Poll() reaches it. The host tests use this, so a caller that
+ *  reads the result without waiting for it fails there too.
+ * ======================================================================================================================
+ */
+#define I2CQ_DMA           0        // 1 runs the queue on the SERCOM with DMA
+#define I2CQ_SIZE          16       // Transactions queued, a full OLED frame is 16
+#define I2CQ_MAX_LEN       255      // Bytes in a phase, the SERCOM length counter
+#define I2CQ_PRE_MAX       4        // Bytes written ahead of a read, from the interrupt
+#define I2CQ_PENDING       0xFF     // Status until the transaction is done, then an I2C_ status
+#define I2CQ_TIMEOUT_US    30000    // Longest transaction, 255 bytes at 100 kHz plus clock stretching
+
+// SAMD, the SERCOM is Wire's PERIPH_WIRE
+#define I2CQ_CH_TX         0        // DMA channels
+#define I2CQ_CH_RX         1
+
+typedef struct I2CQ_XFER_STR I2CQ_XFER_STR;
+typedef void (*I2CQ_DONE)(I2CQ_XFER_STR *x);
+
+struct I2CQ_XFER_STR {
+  uint8_t addr;
+  const uint8_t *pre;                  // Sent ahead of tx, NULL for none
+  uint16_t pre_len;
+  const uint8_t *tx;                   // Write phase, none when pre_len + tx_len is 0
+  uint16_t tx_len;
+  uint8_t *rx;                         // Read phase, none when rx_len is 0
+  uint16_t rx_len;
+  I2CQ_DONE done;                      // NULL for none
+  void *arg;                           // For done()
+  volatile uint8_t status;             // I2CQ_PENDING, then the I2C_ status
+  uint32_t clock;                      // Hz, set by I2CQ_Submit()
+  uint8_t baud;                        // SERCOM BAUD for clock, set by I2CQ_Submit()
+  uint32_t start_us;
+};
+
+// Function prototypes
+void I2CQ_Begin();
+bool I2CQ_Submit(I2CQ_XFER_STR *x);
+void I2CQ_Poll();
+uint8_t I2CQ_Wait(I2CQ_XFER_STR *x);
+void I2CQ_Idle();
+uint8_t I2CQ_Transfer(uint8_t addr, const uint8_t *pre, size_t pre_len, const uint8_t *tx, size_t tx_len,
+  uint8_t *rx, size_t rx_len);
@@ -0,0 +1,41 @@
+/*
+ * ======================================================================================================================
+ *  lux.h - Lux Sensor Service Definations
+ *
+ *  LUX_Service() is called every second from BackGroundWork() and keeps the latest lux from the VEML7700
+ *  and the B_LUX_V30B, so reading them for an observation never waits for a conversion.
+ *    The VEML7700 integrates continuously. Its gain and integration time follow the Vishay app note
+ *    auto range path as one list of steps, from least to most sensitive. The step is kept between reads
+ *    and moves by one when the count is out of range, instead of restarting the search every read.
+ *    After a step change no reading is taken until the old and two of the new integration times have passed.
+ *    A value not updated in LUX_STALE_MS is reported as missing.
+ * ======================================================================================================================
+ */
+#define LUX_STEPS           9        // VEML7700 gain and integration time steps
+#define LUX_STEP_START      2        // Gain 1/8 100ms, set by veml.begin()
+#define LUX_STEP_CORRECT    2        // Steps at gain 1/8 and below use the non linear correction
+#define LUX_ALS_LOW         100      // Counts at or below, step up
+#define LUX_ALS_HIGH        10000    // Counts above, step down
+#define LUX_STALE_MS        60000
+
+typedef struct {
+  int step;                            // Current VEML7700 step
+  unsigned long changed_ms;            // millis() of the last step change
+  unsigned long settle_ms;             // Wait after changed_ms before reading
+  bool vlx_ok;                         // vlx has been read
+  float vlx;                           // VEML7700 lux
+  unsigned long vlx_ms;                // millis() of vlx
+  bool blx_ok;                         // blx has been read
+  float blx;                           // B_LUX_V30B lux
+  unsigned long blx_ms;                // millis() of blx
+} LUX_STR;
+
+// Extern variables
+extern LUX_STR lux_service;
+
+// Function prototypes
+void LUX_Begin();
+void LUX_Restore();
+void LUX_Service();
+float LUX_VEML();
+float LUX_BLX();
@@ -38,4 +38,5 @@ extern unsigned long nextinfo;          // Time of Next INFO transmit
 // Function prototypes
 unsigned long time_to_next_obs();
 void HeartBeat();
+void BackGroundTasks();
 void BackGroundWork();
\ No newline at end of file
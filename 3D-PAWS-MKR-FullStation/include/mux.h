@@ -8,12 +8,19 @@
  * ======================================================================================================================
  *  A MUX enabled sensor can not also be on the main i2c bus.
  *    MUX Support Tinovi Soil Moisture sensors
+ *
+ *  Tinovi readings are taken in two passes. mux_trigger() visits each channel once and starts a reading on
+ *  every Tinovi sensor, the leaf wetness sensor on the main bus included. mux_wait() waits once for the
+ *  slowest, then mux_obs_do() visits each channel once more and reads all values in one request.
  * ======================================================================================================================
  */
 
 #define MUX_CHANNELS 8
 #define MAX_CHANNEL_SENSORS 10
 #define MUX_ADDR 0x70
+#define TINOVI_READ_START 0x01       // Start a reading, what newReading() sends before its wait
+#define TSM_READING_MS 400           // newReading() waits 300ms, 100ms more was given after it
+#define TLW_READING_MS 300           // newReading() waits 200ms, 100ms more was given after it
 
 typedef enum {
   UNKN, m_bmp, m_bme, m_b38, m_b39, m_htu, m_sht, m_mcp, m_hdc, m_lps, m_hih, m_tlw, m_tsm, m_si 
@@ -46,6 +53,10 @@ extern const char *sensor_type[];
 // Function prototypes
 void mux_deselect_all();
 void mux_channel_set(uint8_t channel);
+void mux_trigger();
+void mux_wait();
 void mux_obs_do(int &sidx);
+bool mux_tsm_begin(uint8_t c);
+bool mux_tsm_exist(uint8_t c);
 void mux_scan();
 void mux_initialize();
\ No newline at end of file
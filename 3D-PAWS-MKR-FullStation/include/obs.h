@@ -6,7 +6,7 @@
 #include <time.h>  // defines time_t
 
 #define OBSERVATION_INTERVAL      60   // Seconds
-#define MAX_SENSORS         48
+#define MAX_SENSORS         64
 #define MAX_OBS_SIZE  1024
 #define PUB_FAILS_BEFORE_ACTION 8
 
@@ -42,6 +42,8 @@ extern int OBS_PubFailCnt;
 // Function prototypes
 bool OBS_Send(char *obs);
 void OBS_Clear();
+bool OBS_Append(const char *format, ...);
+void OBS_AppendSensors();
 void OBS_N2S_Add();
 bool OBS_Build_JSON();
 void OBS_N2S_Save();
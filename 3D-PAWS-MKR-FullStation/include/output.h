@@ -17,6 +17,7 @@
 #define OLED_RESET          -1 // -1 = Not in use
 #define OLED32              (oled_type == OLED32_I2C_ADDRESS)
 #define OLED64              (oled_type == OLED64_I2C_ADDRESS)
+#define OLED_CELLS          8    // Cells queued at once, a full 128x64 frame is a page each
 
 // Extern variables
 extern int  SCE_PIN;
@@ -56,11 +56,21 @@
 #define QC_MAX_WD      360       // deg
 #define QC_ERR_WD      -999      // deg Error
 
+// Wind Direction Standard Deviation
+#define QC_MIN_WDSD    0.0       // deg
+#define QC_MAX_WDSD    104.0     // deg - Yamartino maximum 103.9
+#define QC_ERR_WDSD    -999.9    // deg Error
+
 // Rain Gauge 1 minute measurement 
 #define QC_MIN_RG      0         // mm
 #define QC_MAX_RG      30.0      // mm based on the world-record 1-minute rainfall in Maryland in 1956 (31.24 mm or 1.23")
 #define QC_ERR_RG      -999.9    // Rain Gauge Error
 
+// Rain Intensity and Rain Rate
+#define QC_MIN_RR      0         // mm/h
+#define QC_MAX_RR      1800.0    // mm/h, QC_MAX_RG over an hour
+#define QC_ERR_RR      -999.9    // Rain Rate Error
+
 // Elevation - Mount Everest measured from sea level 8,848.86
 #define QC_MIN_ELEV    -440      // m - Dead Sea, is currently about -439.78 meters (below sea level)
 #define QC_MAX_ELEV    8849      // m - Mount Everest measured from sea level 8,848.86
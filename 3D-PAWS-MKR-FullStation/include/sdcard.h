@@ -8,21 +8,78 @@
 #define SD_MASK_INTERRUPS  0  // Do not mask interrups around sd card operations 
 #define SD_ChipSelect      4  // GPIO 10 is Pin 10 on Feather and D5 on Particle Boron Board
 
+/*
+ *  Daily observation log - /OBS/YYYYMMDD.log is kept open for the day. A new one is preallocated for a day of
+ *    observations in one run of clusters, so writes do not update the FAT. The clusters hold what was last on
+ *    the card, they are zeroed a sector ahead of the data as observations are added. It is synced every
+ *    cf_log_sync observations and before modem resets, and cut to its data at rollover and before reboots.
+ *    0s follow the last observation. After a power loss the data ends at the last "\n" before a 0 or a byte
+ *    that can not be in an observation, a sector not written out or a line cut short is dropped at boot.
+ */
+#define SD_LOG_LINE_SIZE       640     // Bytes per observation to preallocate, over estimated
+#define SD_LOG_SECTOR          512
+
+/*
+ *  N2S - Need to Send spool
+ *    Observations that could not be sent are kept in segment files /N2S/XXXXXXXX.TXT, XXXXXXXX the segment
+ *    sequence number in hex. New ones are added to the newest segment, a new segment is started when the
+ *    next record would make it larger than SD_N2S_SEGMENT_SIZE. Sending starts at the oldest segment, which is
+ *    deleted once all of it has been sent.
+ *    Each record is "@LLLLCCCC payload\n", LLLL the payload length and CCCC its CRC-16 in hex. A record that
+ *    does not check is skipped and the reader moves on to the next "@".
+ *    When the spool reaches cf_n2s_pct percent of the SD free space at boot, the oldest segment is dropped.
+ *    eeprom.n2sfp is where sending left off, the low 16 bits of the segment sequence and the offset in it.
+ *    A N2SOBS.TXT from before the spool is moved into it at boot.
+ */
+#define SD_N2S_DIR             "/N2S"
+#define SD_N2S_SEGMENT_SIZE    32768   // Bytes, offsets must fit in 16 bits
+#define SD_N2S_SEGMENTS_MIN    4
+#define SD_N2S_SEGMENTS_MAX    4096    // 128MB
+#define SD_N2S_HEADER_SIZE     10      // "@LLLLCCCC "
+#define SD_N2S_EOF             -1      // SD_N2S_ReadRecord() returns
+#define SD_N2S_BAD             -2
+#define SD_N2S_SECTOR          512
+#define SD_N2S_CURSOR(seq, offset) ((((uint32_t)(seq) & 0xFFFF) << 16) | ((uint32_t)(offset) & 0xFFFF))
+
+/*
+ *  N2S reader - The spool is read one 512 byte sector at a time from sector aligned file positions, so SdFat
+ *    reads straight into buf. A record inside the sector is handed to the sender where it sits, its "\n"
+ *    replaced with a 0. The part of a record at the end of the sector is carried into hdr and obsbuf, and the
+ *    rest of it added from the next sector. base + pos is always the exact file position of the next record,
+ *    for eeprom.n2sfp.
+ */
+typedef struct {
+  File *fp;
+  uint32_t base;                       // File position of buf[0], sector aligned
+  int len;                             // Bytes in buf
+  int pos;                             // Next byte in buf
+  char hdr[SD_N2S_HEADER_SIZE];        // A header split across sectors
+  uint8_t buf[SD_N2S_SECTOR];
+} SD_N2S_READER;
+
 // Extern variables
 extern SdFat SD;
 extern File SD_fp;
 extern char SD_obsdir[];
 extern bool SD_exists;
 extern char SD_n2s_file[];
-extern uint32_t SD_n2s_max_filesz;
+extern uint32_t n2s_head;
+extern uint32_t n2s_tail;
+extern uint32_t n2s_bytes;
 extern char SD_crt_file[];
 extern char SD_OPTAQS_FILE[];
 extern char SD_INFO_FILE[];
 
 // Function prototypes
 void SD_initialize();
+void SD_LogSync();
+void SD_LogClose();
 void SD_LogObservation(char *observations);
-bool SD_N2S_Delete();
+void SD_N2S_Initialize();
+bool SD_N2S_Write(char *observation);
+void SD_N2S_ReaderStart(SD_N2S_READER *r, File *fp, uint32_t offset);
+uint32_t SD_N2S_ReaderPosition(SD_N2S_READER *r);
+int SD_N2S_ReadRecord(SD_N2S_READER *r, char **payload);
 void SD_NeedToSend_Add(char *observation);
 void SD_NeedToSend_Status(char *status);
 void SD_ClearRainTotals();
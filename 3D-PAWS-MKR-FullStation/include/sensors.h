@@ -198,9 +198,26 @@ extern PM25AQI_OBS_STR pm25aqi_obs;
 extern Adafruit_PM25AQI pmaq;
 extern bool PM25AQI_exists;
 
+/*
+ *  AQS - Air Quality Station, the PM25AQI is powered from OP2 and only run before each observation.
+ *    AQS_Service() is called every second. It powers the sensor on AQSWarmUpTime + AQS_SAMPLES + AQS_MARGIN
+ *    seconds before the observation is due, waits out the warm up, then takes one reading a second. The
+ *    sensor is powered off once AQS_SAMPLES readings are taken or the observation is AQS_MARGIN seconds away,
+ *    whichever is first. The observation interval is not changed.
+ */
+#define AQS_SAMPLES       10        // Readings averaged, the sensor updates once a second
+#define AQS_MARGIN        3         // Seconds, first reading after warm up is tossed and slack for the loop
+
+typedef enum {
+  AQS_OFF,
+  AQS_WARMING,
+  AQS_SAMPLING
+} AQS_STATE;
+
 extern bool AQS_Enabled;
 extern int AQSWarmUpTime;
-extern int AQS_Correction ;
+extern AQS_STATE aqs_state;
+extern unsigned long aqs_time;
 
 /*
  * ======================================================================================================================
@@ -241,10 +258,12 @@ extern bool TSM_exists;
 
 // Function prototype
 byte get_Bosch_ChipID (byte address);
+void bmx_begin(int n);
 void bmx_initialize();
 void bmx1_read(float &p, float &t, float &h);
 void bmx2_read(float &p, float &t, float &h);
 void htu21d_initialize();
+void mcp9808_begin(int n);
 void mcp9808_initialize();
 void hih8_initialize();
 bool hih8_getTempHumid(float *t, float *h);
@@ -266,8 +285,10 @@ void pm25aqi_clear();
 void pm25aqi_initialize();
 void pm25aqi_Produce_1m_Average() ;
 void pm25aqi_TakeReading();
-void pm25aqi_TakeReading_AQS();
+void AQS_Service();
+void lps_begin(int n);
 void lps_initialize();
+void sensor_reinitialize(uint8_t addr);
 void tlw_initialize();
 void tsm_initialize();
 
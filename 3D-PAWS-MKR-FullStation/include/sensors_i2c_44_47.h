@@ -42,6 +42,7 @@ typedef struct {
     uint8_t i2c_address;
     uint8_t id;
     char sn[I2C_44_77_SN_LEN];
+    I2C_44_47_SENSOR_TYPE begun;     // Type started with begin(), kept while the sensor is offline
     Adafruit_SHT31 sht3;
     Adafruit_SHT4x sht4;
     Adafruit_BMP5xx bmp5;
@@ -50,6 +51,7 @@ typedef struct {
 
 
 // Extern variables
+extern I2C_44_47_SENSOR_SLOT i2c_44_47_sensors[I2C_44_47_SENSOR_COUNT];
 extern bool SHT_1_exists;
 extern float sht1_humid ;
 extern float sht1_temp;
@@ -58,4 +60,7 @@ extern float sht1_temp;
 void sensor_i2c_44_47_info(char *rest, int size, const char *&comma);
 void sensor_i2c_44_47_statmon(int idx, char *buf);
 void sensor_i2c_44_47_obs_do(int &sidx);
+const char *sensor_i2c_44_47_name(int idx);
+void sensor_i2c_44_47_begin(uint8_t addr);
+void sensor_i2c_44_47_offline(uint8_t addr);
 void sensor_initialize_i2c_44_47();
\ No newline at end of file
@@ -0,0 +1,40 @@
+/*
+ * ======================================================================================================================
+ *  th.h - Temperature and Humidity Measurement Scheduler Definations
+ *
+ *  Reading each T/RH sensor with its library waits for that sensor's conversion before starting the next.
+ *  TH_Trigger() sends a single shot measurement command to every T/RH sensor, the conversions run while
+ *  OBS_Take() reads the other sensors, and TH_Collect() waits once for the longest conversion still
+ *  running then reads all the results with their CRC checked.
+ *    The HTU21DF only converts one quantity at a time, its humidity is triggered and collected after the
+ *    temperature.
+ *    The MCP9808 converts continuously and has nothing to trigger, it is read in OBS_Take() as before.
+ * ======================================================================================================================
+ */
+// Conversion times, datasheet maximums with margin
+#define TH_SHT3X_MS         20       // High repeatability
+#define TH_SHT4X_MS         10       // High precision, no heater
+#define TH_HDC302X_MS       20       // Trigger on demand, low power mode 0
+#define TH_HTU21DF_T_MS     50       // 14 bit temperature
+#define TH_HTU21DF_H_MS     20       // 12 bit humidity
+#define TH_HIH8_MS          45
+
+// th_result[] index, 0-3 are the i2c_44_47_sensors[] slots
+#define TH_HTU21DF          I2C_44_47_SENSOR_COUNT
+#define TH_HIH8             (I2C_44_47_SENSOR_COUNT+1)
+#define TH_DEVICES          (I2C_44_47_SENSOR_COUNT+2)
+
+typedef struct {
+  bool triggered;                      // Measurement command accepted
+  bool ok;                             // Read with good CRC
+  unsigned long ready_ms;              // millis() when the conversion is done
+  float t;
+  float h;
+} TH_RESULT_STR;
+
+// Extern variables
+extern TH_RESULT_STR th_result[TH_DEVICES];
+
+// Function prototypes
+void TH_Trigger();
+void TH_Collect();
@@ -35,18 +35,96 @@
 #define ANEMOMETER_IRQ_PIN  0        // D0
 #define WIND_READINGS       60       // One minute of 1s Samples
 
+/*
+ * Anemometer pulse period mode (ws_period=1)
+ *   The ISR also keeps the micros() of the first and last pulse in each 1s window. Speed is taken from the
+ *   time across the pulses, back to the last pulse of an earlier window, so a single pulse still gives a speed
+ *   and light wind is not stepped in 0.65 m/s counts. The period can only grow while no pulse arrives, giving
+ *   a decay to 0 at WS_PERIOD_TIMEOUT. From WS_PERIOD_BLEND_LO to WS_PERIOD_BLEND_HI pulses a window the
+ *   speed blends to the counted speed, which is used alone above that.
+ */
+#define WS_PERIOD_TIMEOUT   3000000  // us, longer than this between pulses is no wind
+#define WS_PERIOD_BLEND_LO  4        // Pulses per window
+#define WS_PERIOD_BLEND_HI  12
+
 typedef struct {
-  int direction;
+  uint32_t pulse_us;                   // Last pulse seen
+  uint32_t period;                     // us per pulse at the last sample with pulses, 0 = unknown
+  bool valid;
+} WS_PERIOD_STR;
+
+#define WIND_ANGLE_STEPS    4096     // AS5600 12 bit raw angle, 0.0879 degrees per step
+#define WIND_SIN_QUARTER    1024     // Raw angle steps in a quarter turn, size of the quarter wave sine table - 1
+#define WD_OVERSAMPLE_MAX   16       // Most AS5600 reads combined for one direction sample
+#define WD_OVERSAMPLE_US    1000     // Between oversample reads, about one AS5600 output update with slow filter 16x
+
+/*
+ * Sample vectors use Q15 sin/cos from the raw angle and speed in cm/s, so the running sums are exact integers.
+ */
+typedef struct {
+  int angle;                           // AS5600 raw angle 0-4095, -1 on read error
   float speed;
+  int32_t ns;                          // North South vector component of this sample, speed cm/s * cos(angle) Q15
+  int32_t ew;                          // East West vector component of this sample, speed cm/s * sin(angle) Q15
 } WIND_BUCKETS_STR;
 
+/*
+ * Running statistics are updated as each 1s sample is inserted and the oldest evicted, so the average, vector
+ * direction and gust are available at any moment in constant time.
+ *   gust_sum[]  - 3 sample speed sum for the window ending at that bucket
+ *   gust_dq[]   - Monotonic deque of window end sequence numbers, gust_sum decreasing from front to back.
+ *                 Front is the highest 3 sample window. On a tie the most recent window is kept.
+ */
 typedef struct {
   WIND_BUCKETS_STR bucket[WIND_READINGS];
   int bucket_idx;
+  unsigned long seq;                   // Sequence number of the most recent sample
+  int64_t ns_sum;                      // Running sum of bucket ns
+  int64_t ew_sum;                      // Running sum of bucket ew
+  double speed_sum;                    // Running sum of bucket speed, rebuilt each minute
+  int angle_bad;                       // Number of buckets with a -1 angle
+  int speed_nonzero;                   // Number of buckets with speed > 0
+  float gust_sum[WIND_READINGS];
+  unsigned long gust_dq[WIND_READINGS];
+  int gust_dq_head;
+  int gust_dq_count;
   float gust;
   int gust_direction;
 } WIND_STR;
 
+/*
+ * ======================================================================================================================
+ *  Wind Products - 2 and 10 minute mean wind, 10 minute gust and direction variability (sigma theta)
+ *
+ *  Each 1s sample is folded into the current 1 minute partial. After 60 samples the partial is pushed onto
+ *  a ring of the last 10 minutes. Windows are the most recent N completed minutes.
+ *    gust_sum   - Highest 3 sample sum of the windows ending in this minute, ties to the most recent
+ *    dir_count  - Samples with a valid angle and speed > 0, used for the unit vector sums (sigma theta)
+ * ======================================================================================================================
+ */
+#define WIND_PARTIALS       10       // Minutes of partials kept, longest product window
+
+typedef struct {
+  int samples;
+  int angle_bad;                       // Samples with a -1 angle
+  int speed_nonzero;                   // Samples with speed > 0
+  double speed_sum;
+  int64_t ns_sum;                      // Speed weighted vector sums, same units as the 1s buckets
+  int64_t ew_sum;
+  int dir_count;
+  int32_t sin_sum;                     // Unit vector sums Q15
+  int32_t cos_sum;
+  float gust_sum;
+  int gust_direction;                  // -1 if the gust window had a bad angle or no wind
+} WIND_PARTIAL_STR;
+
+typedef struct {
+  WIND_PARTIAL_STR current;            // Minute being built
+  WIND_PARTIAL_STR partial[WIND_PARTIALS];
+  int partial_idx;                     // Next partial to fill
+  int partial_count;                   // Completed partials, up to WIND_PARTIALS
+} WIND_PRODUCTS_STR;
+
 /*
  * ======================================================================================================================
  *  Option Pin Defination Setup
@@ -76,35 +154,116 @@ typedef struct {
 #define OP2_STATE_VOLTAIC    2
 
 
+/*
+ * ======================================================================================================================
+ *  Rain Gauge Tip Ring and Rain Rate Products
+ *
+ *  The rain gauge ISRs only push the millis() of each interrupt into a single producer / single consumer ring.
+ *  Rain_Drain() is the consumer, called from the main loop. It debounces the tips per gauge, counts the tips
+ *  for the next observation and keeps the products.
+ *    tip[]/head - written by the ISR only, tail - written by the main loop only. Ring size is a power of 2
+ *                 so the free running head and tail wrap cleanly. If the main loop is held up long
+ *                 enough to fill the ring the ISR falls back to counting debounced tips in overflow.
+ *    bin[]      - Accepted tips per second for the last 5 minutes. sum60 and sum300 are the running counts 
+ *                 of the last 60 and 300 bins. The peaks are the highest counts seen at any tip since the
+ *                 last observation, which is the peak 1 and 5 minute intensity.
+ * ======================================================================================================================
+ */
+#define RG_TIP_RING         64       // Tips buffered between drains, power of 2
+#define RG_TIP_MASK         (RG_TIP_RING-1)
+#define RG_BINS             300      // 1s bins, 5 minutes
+#define RG_DEBOUNCE_MS      500      // Default debounce, tips closer than this to the last accepted tip are ignored
+#define RG_RATE_TIMEOUT     3600000  // ms, no tip in this long and the tip interval rain rate is 0
+#define RG_TIP_MM           0.2f     // mm of rain per tip
+#define RG_WRAP_SEC         (0xFFFFFFFFUL/1000/2) // A second this far behind the newest bin is millis() wrapping
+
+typedef struct {
+  volatile uint32_t tip[RG_TIP_RING];
+  volatile uint32_t head;
+  uint32_t tail;
+  volatile uint32_t overflow;          // Tips the ISR could not queue, debounced in the ISR against overflow_ms
+  volatile uint32_t overflow_ms;
+  uint32_t overflow_seen;
+  uint32_t debounce;                   // ms
+  bool have_last;
+  bool have_prev;
+  uint32_t last_ms;                    // Last accepted tip
+  uint32_t prev_ms;                    // Accepted tip before last_ms
+  uint8_t bin[RG_BINS];
+  bool bin_valid;
+  uint32_t bin_sec;                    // millis()/1000 of the newest bin
+  unsigned int sum60;
+  unsigned int sum300;
+  unsigned int peak60;
+  unsigned int peak300;
+  unsigned int period_tips;            // Tips since last observation
+  uint32_t first_ms;                   // First and last tip since last observation
+  uint32_t period_last_ms;
+} RAIN_GAUGE_STR;
+
+typedef struct {
+  float intensity1m;                   // mm/h, peak 1 minute since last observation
+  float intensity5m;                   // mm/h, peak 5 minute since last observation
+  float rate;                          // mm/h, from the interval between the last tips
+  unsigned long first_tip;             // Epoch, 0 if no tip since last observation
+  unsigned long last_tip;
+} RAIN_PRODUCTS_STR;
+
 #define RAINGAUGE1_IRQ_PIN  1 // D1
 #define RAINGAUGE2_IRQ_PIN  OP1_PIN
 #define DISTANCE_GAUGE_PIN  OP1_PIN
 #define VOLTAIC_VOLTAGE_PIN OP2_PIN
 #define DG_BUCKETS          60
+#define DG_HALF             (DG_BUCKETS/2)
+#define DG_OUTLIER_LIMIT    10       // Consecutive outliers before we accept the level has really changed
+
+/*
+ * ======================================================================================================================
+ *  Distance Gauge Running Median
+ *    value[] is the ring of 1s samples in time order.
+ *    heap[] holds ring indexes. heap[0 to DG_HALF-1] is a max heap of the lower half of the values,
+ *    heap[DG_HALF to DG_BUCKETS-1] a min heap of the upper half. pos[] is where each ring index sits in heap[].
+ *    A new sample replaces the oldest in place so both heaps keep their size, median is the max heap root.
+ * ======================================================================================================================
+ */
+typedef struct {
+  unsigned int value[DG_BUCKETS];
+  uint8_t heap[DG_BUCKETS];
+  uint8_t pos[DG_BUCKETS];
+  int idx;                             // Next ring slot to fill (aka oldest sample)
+  int filled;                          // Samples accepted since DS_Clear(), up to DG_BUCKETS
+  int outlier_run;                     // Consecutive samples outside cf_ds_outlier of the median
+  unsigned long outliers;              // Samples rejected since DS_Clear()
+} DG_MEDIAN_STR;
 
 
 // Extern variables
-extern volatile bool TurnLedOff;                 // Set true in rain gauge interrupt
+extern bool TurnLedOff;                          // Set true when a rain gauge tip is counted
 
 extern volatile unsigned int anemometer_interrupt_count;
 extern unsigned long anemometer_interrupt_stime;
+extern volatile uint32_t anemometer_interrupt_first_us;
+extern volatile uint32_t anemometer_interrupt_last_us;
+extern volatile uint32_t anemometer_pulses;
+extern WS_PERIOD_STR ws_pulse;
+extern float ws_calibration;
+extern float ws_radius;
 
 extern bool AS5600_exists;
 extern int AS5600_ADR;
 
-extern volatile unsigned int raingauge1_interrupt_count;
+extern unsigned int raingauge1_interrupt_count;
 extern uint64_t raingauge1_interrupt_stime;
-extern volatile uint64_t raingauge1_interrupt_ltime;
-extern uint64_t raingauge1_interrupt_toi;
+extern RAIN_GAUGE_STR raingauge1;
 
-extern volatile unsigned int raingauge2_interrupt_count;
+extern unsigned int raingauge2_interrupt_count;
 extern uint64_t raingauge2_interrupt_stime;
-extern volatile uint64_t raingauge2_interrupt_ltime;
-extern uint64_t raingauge2_interrupt_toi;
+extern RAIN_GAUGE_STR raingauge2;
 
 extern bool ws_refresh;
 
 extern unsigned int dg_resolution_adjust;
+extern DG_MEDIAN_STR dg;
 
 // Function prototype
 void anemometer_interrupt_handler();
@@ -113,19 +272,39 @@ float raingauge1_sample();
 void raingauge2_interrupt_handler();
 float raingauge2_sample();
 bool RainEnabled();
+void Rain_Clear(RAIN_GAUGE_STR *g, int debounce);
+void Rain_Drain();
+void Rain_Products(RAIN_GAUGE_STR *g, RAIN_PRODUCTS_STR *p, unsigned long epoch);
+void Wind_PeriodClear(WS_PERIOD_STR *ps);
+float Wind_PeriodSpeed(WS_PERIOD_STR *ps, unsigned long count, uint32_t first_us, uint32_t last_us, uint32_t now_us);
 float Wind_SampleSpeed();
+void Wind_AngleRequest();
+int Wind_ReadAngle();
+int Wind_SampleAngle();
 int Wind_SampleDirection();
+int16_t Wind_Sin_Q15(int angle);
+int16_t Wind_Cos_Q15(int angle);
 int Wind_DirectionVector();
 float Wind_SpeedAverage();
 float Wind_Gust();
 int Wind_GustDirection();
 void Wind_GustUpdate();
+int Wind_WindowDirection(int idx);
 void Wind_TakeReading();
+void Wind_Clear();
+void Wind_ProductsFold(WIND_BUCKETS_STR *b, float gust_sum, int idx);
+bool Wind_ProductsSum(int minutes, WIND_PARTIAL_STR *t);
+bool Wind_ProductMean(int minutes, float *ws, int *wd);
+bool Wind_ProductGust(int minutes, float *wg, int *wgd);
+float Wind_ProductSigmaTheta(int minutes);
+uint32_t Wind_VectorToAngle(int64_t NS_vector_sum, int64_t EW_vector_sum);
+int Wind_VectorToDegrees(int64_t NS_vector_sum, int64_t EW_vector_sum);
 void as5600_initialize();
 float Pin_ReadAvg(int pin);
 float VoltaicVoltage(int pin);
 float VoltaicPercent(float half_cell_voltage);
 void DS_TakeReading();
 float DS_Median();
+void DS_Clear();
 void Wind_Distance_Air_Initialize();
 void OPT_AQS_Initialize();
\ No newline at end of file
@@ -19,12 +19,14 @@
 #include "include/output.h"
 #include "include/network.h"
 #include "include/support.h"
+#include "include/i2c.h"
 #include "include/time.h"
 #include "include/mkrboard.h"
 #include "include/lora.h"
 #include "include/obs.h"
 #include "include/main.h"
 #include "include/info.h"
+#include "include/hotplug.h"
 
 /*
  * ======================================================================================================================
@@ -202,6 +204,10 @@ void INFO_Perform() {
     else {
       sprintf (msg+strlen(msg), "%s!AS5600", comma);
     }
+
+    if (cf_wind_products) {
+      sprintf (msg+strlen(msg), "%sWIND10M", comma);
+    }
   }
   if (TLW_exists) {
     sprintf (msg+strlen(msg), "%sTLW", comma);
@@ -217,7 +223,7 @@ void INFO_Perform() {
     for (int c=0; c<MUX_CHANNELS; c++) {
       if (mux[c].inuse) {
         for (int s = 0; s < MAX_CHANNEL_SENSORS; s++) {
-          if (mux[c].sensor[s].type == m_tsm) {
+          if ((mux[c].sensor[s].type == m_tsm) && (mux[c].sensor[s].state == ONLINE)) {
             sprintf (msg+strlen(msg), "%sTSM%d(%d.%d)", comma, mux[c].sensor[s].id, c, s);
             comma=",";
           }
@@ -301,6 +307,12 @@ void INFO_Perform() {
    // Close off sensors
   sprintf (msg+strlen(msg), "\"");
 
+  // Sensors brought online or taken offline since the last INFO
+  HP_Info(msg, 1024-1);
+
+  // I2C bus health, room left for the closing }
+  I2C_Info(msg, 1024-1);
+
   // Adding closing }
   sprintf (msg+strlen(msg), "}");
 
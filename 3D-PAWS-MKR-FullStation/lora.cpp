@@ -14,6 +14,8 @@
 #include "include/output.h"
 #include "include/obs.h"
 #include "include/lora.h"
+#include "include/wrda.h"
+#include "include/burst.h"
 
 /*
  * ======================================================================================================================
@@ -468,7 +470,7 @@ void lora_msg_check() {
 void lora_msg_poll() {
   for (int i=0; i<3; i++) {
     lora_msg_check();
-    delay (250);
+    WB_Delay (250);
   }
 }
 
@@ -0,0 +1,137 @@
+/*
+ * ======================================================================================================================
+ * lux.cpp - Lux Sensor Service
+ * ======================================================================================================================
+ */
+#include <Arduino.h>
+
+#include "include/sensors.h"
+#include "include/lux.h"
+
+/*
+ * ======================================================================================================================
+ * Variables and Data Structures
+ * =======================================================================================================================
+ */
+LUX_STR lux_service;
+
+// VEML7700 steps from least to most sensitive, the app note auto range path
+const uint8_t lux_gain[LUX_STEPS] = {
+  VEML7700_GAIN_1_8, VEML7700_GAIN_1_8, VEML7700_GAIN_1_8, VEML7700_GAIN_1_4, VEML7700_GAIN_1,
+  VEML7700_GAIN_2, VEML7700_GAIN_2, VEML7700_GAIN_2, VEML7700_GAIN_2};
+const float lux_gain_value[LUX_STEPS] = {0.125, 0.125, 0.125, 0.25, 1, 2, 2, 2, 2};
+const uint8_t lux_it[LUX_STEPS] = {
+  VEML7700_IT_25MS, VEML7700_IT_50MS, VEML7700_IT_100MS, VEML7700_IT_100MS, VEML7700_IT_100MS,
+  VEML7700_IT_100MS, VEML7700_IT_200MS, VEML7700_IT_400MS, VEML7700_IT_800MS};
+const int lux_it_ms[LUX_STEPS] = {25, 50, 100, 100, 100, 100, 200, 400, 800};
+
+/*
+ * ======================================================================================================================
+ * Fuction Definations
+ * =======================================================================================================================
+ */
+
+/*
+ * ======================================================================================================================
+ * LUX_Step() - Set the VEML7700 gain and integration time without the library waits
+ * ======================================================================================================================
+ */
+void LUX_Step(int step) {
+  int old_it_ms = lux_it_ms[lux_service.step];
+
+  lux_service.step = step;
+  veml.setGain(lux_gain[step]);
+  veml.setIntegrationTime(lux_it[step], false);
+  lux_service.changed_ms = millis();
+  lux_service.settle_ms = old_it_ms + 2 * lux_it_ms[step];  // Finish the old, two of the new as readWait() does
+}
+
+/*
+ * ======================================================================================================================
+ * LUX_Begin() - Start at the step veml.begin() left the VEML7700 in
+ * ======================================================================================================================
+ */
+void LUX_Begin() {
+  memset(&lux_service, 0, sizeof(LUX_STR));
+  lux_service.step = LUX_STEP_START;
+  lux_service.changed_ms = millis();
+  lux_service.settle_ms = 2 * lux_it_ms[LUX_STEP_START];
+}
+
+/*
+ * ======================================================================================================================
+ * LUX_Restore() - Power on the VEML7700 and reapply the current step, after a bus recovery
+ * ======================================================================================================================
+ */
+void LUX_Restore() {
+  veml.enable(true);
+  LUX_Step(lux_service.step);
+}
+
+/*
+ * ======================================================================================================================
+ * LUX_VEML_Read() - Read the VEML7700 count at the current step, then move one step if it is out of range
+ * ======================================================================================================================
+ */
+void LUX_VEML_Read() {
+  int step = lux_service.step;
+  uint16_t als;
+  float lx;
+
+  if ((millis() - lux_service.changed_ms) < lux_service.settle_ms) {
+    return;
+  }
+
+  als = veml.readALS(false);
+
+  // Resolution of the library's getResolution(), 0.0036 lux per count at gain 2 and 800ms
+  lx = 0.0036 * (800.0 / lux_it_ms[step]) * (2.0 / lux_gain_value[step]) * als;
+  if (step <= LUX_STEP_CORRECT) {
+    lx = (((6.0135e-13 * lx - 9.3924e-9) * lx + 8.1488e-5) * lx + 1.0023) * lx;
+  }
+  lux_service.vlx = lx;
+  lux_service.vlx_ms = millis();
+  lux_service.vlx_ok = true;
+
+  if ((als <= LUX_ALS_LOW) && (step < (LUX_STEPS-1))) {
+    LUX_Step(step+1);
+  }
+  else if ((als > LUX_ALS_HIGH) && (step > 0)) {
+    LUX_Step(step-1);
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * LUX_Service() - Called every second from BackGroundWork(), update the latest lux values
+ * ======================================================================================================================
+ */
+void LUX_Service() {
+  float lx;
+
+  if (VEML7700_exists) {
+    LUX_VEML_Read();
+  }
+
+  if (BLX_exists) {
+    lx = blx_takereading();
+    if (lx >= 0) {
+      lux_service.blx = lx;
+      lux_service.blx_ms = millis();
+      lux_service.blx_ok = true;
+    }
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * LUX_VEML() / LUX_BLX() - Latest lux, NAN if never read or stale
+ * ======================================================================================================================
+ */
+float LUX_VEML() {
+  return ((lux_service.vlx_ok && ((millis() - lux_service.vlx_ms) < LUX_STALE_MS)) ? lux_service.vlx : NAN);
+}
+
+float LUX_BLX() {
+  return ((lux_service.blx_ok && ((millis() - lux_service.blx_ms) < LUX_STALE_MS)) ? lux_service.blx : NAN);
+}
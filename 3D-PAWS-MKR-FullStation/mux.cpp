@@ -9,6 +9,7 @@
 #include "include/output.h"
 #include "include/support.h"
 #include "include/main.h"
+#include "include/i2c.h"
 #include "include/mux.h"
 
 /*
@@ -20,6 +21,7 @@ bool MUX_exists = false;
 MULTIPLEXER_STR mux[MUX_CHANNELS];
 MULTIPLEXER_STR *mc;
 CH_SENSOR *chs;
+unsigned long mux_ready_ms = 0;       // millis() when the readings started by mux_trigger() are done
 const char *sensor_type[] = {"UNKN", "bmp", "bme", "b38", "b39", "htu", "sht", "mcp", "hdc", "lps", "hih", "tlw", "tsm", "si"};
 
 /*
@@ -34,9 +36,11 @@ const char *sensor_type[] = {"UNKN", "bmp", "bme", "b38", "b39", "htu", "sht", "
  *=======================================================================================================================
  */
 void mux_deselect_all() {
+  I2C_Clock(MUX_ADDR);
   Wire.beginTransmission(MUX_ADDR);
   Wire.write(0);
   Wire.endTransmission();  
+  I2C_ClockLimit(0);
 }
 
 /* 
@@ -50,6 +54,9 @@ void mux_channel_set(uint8_t channel) {
   sprintf (Buffer32Bytes, "MUX:CHANNEL:%d SET", channel);
   Output (Buffer32Bytes);
 */
+  // The probe cable on the channel is on the bus until mux_deselect_all()
+  I2C_ClockLimit(I2C_CLOCK_STANDARD);
+  I2C_Clock(MUX_ADDR);
   Wire.beginTransmission(MUX_ADDR);
   Wire.write(1 << channel);
   Wire.endTransmission();  
@@ -57,10 +64,72 @@ void mux_channel_set(uint8_t channel) {
 
 /* 
  *=======================================================================================================================
- * mux_obs_do() - do obs for mux devices
+ * tinovi_start() - Start a Tinovi reading without the wait in newReading()
+ *=======================================================================================================================
+ */
+bool tinovi_start(uint8_t address) {
+  I2C_Clock(address);
+  Wire.beginTransmission(address);
+  Wire.write(TINOVI_READ_START);
+  return (Wire.endTransmission() == 0);
+}
+
+/* 
+ *=======================================================================================================================
+ * mux_trigger() - Start a reading on every Tinovi sensor, each mux channel is selected once
+ *=======================================================================================================================
+ */
+void mux_trigger() {
+  mux_ready_ms = millis();
+
+  if (TLW_exists) {
+    tinovi_start(TLW_ADDRESS);
+    mux_ready_ms = millis() + TLW_READING_MS;
+  }
+
+  if (MUX_exists) {
+    for (int c=0; c<MUX_CHANNELS; c++) {
+      if (mux[c].inuse) {
+        mux_channel_set(c);
+        for (int s = 0; s < MAX_CHANNEL_SENSORS; s++) {
+          if ((mux[c].sensor[s].type == m_tsm) && (mux[c].sensor[s].state == ONLINE)) {
+            tinovi_start(mux[c].sensor[s].address);
+            mux_ready_ms = millis() + TSM_READING_MS;
+          }
+        }
+      }
+    }
+    mux_deselect_all(); // Other sensors are read before the results are collected
+  }
+  else if (TSM_exists) {
+    tinovi_start(TSM_ADDRESS);
+    mux_ready_ms = millis() + TSM_READING_MS;
+  }
+}
+
+/* 
+ *=======================================================================================================================
+ * mux_wait() - Wait for the readings started by mux_trigger(), returns at once if they are done
+ *=======================================================================================================================
+ */
+void mux_wait() {
+  long wait_ms = (long)(mux_ready_ms - millis());
+
+  if (wait_ms > 0) {
+    delay(wait_ms);
+  }
+}
+
+/* 
+ *=======================================================================================================================
+ * mux_obs_do() - do obs for mux devices, readings started by mux_trigger()
  *=======================================================================================================================
  */
 void mux_obs_do(int &sidx) {
+  float readings[4];  // e25, ec, temperature, vwc
+
+  mux_wait();
+
   if (MUX_exists) {
     Output("MUX:OBSDO");
  
@@ -70,29 +139,28 @@ void mux_obs_do(int &sidx) {
         for (int s = 0; s < MAX_CHANNEL_SENSORS; s++) {
 
           // Tinovi Soil Moisture
-          if (mux[c].sensor[s].type == m_tsm) {
-            tsm.newReading();
-            delay(100);
+          if ((mux[c].sensor[s].type == m_tsm) && (mux[c].sensor[s].state == ONLINE)) {
+            tsm.getData(readings);
 
             sprintf (Buffer32Bytes, "tsme25-%d", mux[c].sensor[s].id);
             strcpy (obs.sensor[sidx].id, Buffer32Bytes);
             obs.sensor[sidx].type = F_OBS;
-            obs.sensor[sidx].f_obs = (float) tsm.getE25();
+            obs.sensor[sidx].f_obs = (float) readings[0];
             obs.sensor[sidx++].inuse = true;
 
             sprintf (Buffer32Bytes, "tsmec-%d", mux[c].sensor[s].id);
             strcpy (obs.sensor[sidx].id, Buffer32Bytes);
             obs.sensor[sidx].type = F_OBS;
-            obs.sensor[sidx].f_obs = (float) tsm.getEC();
+            obs.sensor[sidx].f_obs = (float) readings[1];
             obs.sensor[sidx++].inuse = true;
 
             sprintf (Buffer32Bytes, "tsmvwc-%d", mux[c].sensor[s].id);
             strcpy (obs.sensor[sidx].id, Buffer32Bytes);
             obs.sensor[sidx].type = F_OBS;
-            obs.sensor[sidx].f_obs = (float) tsm.getVWC();
+            obs.sensor[sidx].f_obs = (float) readings[3];
             obs.sensor[sidx++].inuse = true; 
 
-            float t = tsm.getTemp();
+            float t = readings[2];
             t = (isnan(t) || (t < QC_MIN_T)  || (t > QC_MAX_T))  ? QC_ERR_T  : t;
 
             sprintf (Buffer32Bytes, "tsmt-%d", mux[c].sensor[s].id);
@@ -109,12 +177,12 @@ void mux_obs_do(int &sidx) {
   else {
     // No MUX so check main i2c bus for Sensor
     if (TSM_exists) {
-      tsm.newReading();
-      delay(100);
-      float e25 = tsm.getE25();
-      float ec = tsm.getEC();
-      float vwc = tsm.getVWC();
-      float t = tsm.getTemp();
+      I2C_Clock(TSM_ADDRESS);
+      tsm.getData(readings);
+      float e25 = readings[0];
+      float ec = readings[1];
+      float vwc = readings[3];
+      float t = readings[2];
       t = (isnan(t) || (t < QC_MIN_T)  || (t > QC_MAX_T))  ? QC_ERR_T  : t;
 
       strcpy (obs.sensor[sidx].id, "tsme25");
@@ -140,6 +208,52 @@ void mux_obs_do(int &sidx) {
   } // No MUX
 }
 
+/* 
+ *=======================================================================================================================
+ * mux_tsm_begin() - Start a Tinovi Soil Moisture sensor on the selected channel, true if found
+ *   Also used to bring a sensor back online, one back on its channel keeps its id.
+ *=======================================================================================================================
+ */
+bool mux_tsm_begin(uint8_t c) {
+  int s = 0;  // Tinovi is the only sensor type on a channel
+  int id = 0;
+
+  if (!I2C_Device_Exist(TSM_ADDRESS)) {
+    return (false);
+  }
+  tsm.init(TSM_ADDRESS);
+  I2C_ClockReset(); // init() does a Wire.begin()
+
+  if (mux[c].sensor[s].type != m_tsm) {
+    // Tinovi Soil Moisture sensor id counter
+    for (int i=0; i<MUX_CHANNELS; i++) {
+      if ((mux[i].sensor[s].type == m_tsm) && (mux[i].sensor[s].id > id)) {
+        id = mux[i].sensor[s].id;
+      }
+    }
+    mux[c].sensor[s].type = m_tsm;
+    mux[c].sensor[s].id = id+1; 
+    mux[c].sensor[s].address = TSM_ADDRESS;
+  }
+  mux[c].sensor[s].state = ONLINE;
+  mux[c].inuse = true;
+  return (true);
+}
+
+/* 
+ *=======================================================================================================================
+ * mux_tsm_exist() - Check for the Tinovi Soil Moisture sensor on a channel
+ *=======================================================================================================================
+ */
+bool mux_tsm_exist(uint8_t c) {
+  bool found;
+
+  mux_channel_set(c);
+  found = I2C_Device_Exist(TSM_ADDRESS);
+  mux_deselect_all();
+  return (found);
+}
+
 /* 
  *=======================================================================================================================
  * mux_scan() - detect connected sensors
@@ -149,24 +263,13 @@ void mux_scan() {
   if (MUX_exists) {
     Output("MUX:SCAN");
 
-    int tsm_id = 0; // Tinovi Soil Moisture sensor id counter
     for (int c=0; c<MUX_CHANNELS; c++) {
       mux_channel_set(c);
-      int s = 0;
 
       // Test for Tinovi Soil Moisture sensor
-      if (I2C_Device_Exist(TSM_ADDRESS)) {
-        tsm.init(TSM_ADDRESS);
-        mux[c].inuse = true;
-        // Tinovi Soil Moisture
-        mux[c].sensor[s].state = ONLINE;
-        mux[c].sensor[s].type = m_tsm;
-        mux[c].sensor[s].id = ++tsm_id; 
-        mux[c].sensor[s].address = TSM_ADDRESS;
-
-        sprintf (Buffer32Bytes, "  CH-%d.%d TSM OK", c, s);
+      if (mux_tsm_begin(c)) {
+        sprintf (Buffer32Bytes, "  CH-%d.0 TSM OK", c);
         Output (Buffer32Bytes);
-        s++;
       }
       else {         
         sprintf (Buffer32Bytes, "  CH-%d TSM NF", c);
@@ -188,6 +291,7 @@ void mux_scan() {
 void mux_initialize() {
   Output("MUX:INIT");
 
+  I2C_Clock(MUX_ADDR);
   Wire.beginTransmission(MUX_ADDR);
   if (Wire.endTransmission() == 0) {
     Output ("MUX OK");
@@ -11,6 +11,7 @@
 #include "include/output.h"
 #include "include/network.h"
 #include "include/main.h"
+#include "include/sdcard.h"
 
 /*
  * ======================================================================================================================
@@ -307,6 +308,7 @@ void onNetworkConnect() {
 void onNetworkDisconnect() {
   HeartBeat();
   Output(F("NW:Disconnect - Resetting Modem!"));
+  SD_LogSync();
   modem.hardReset();
   Output(F("NW:Disconnect - Waiting 12s"));
   delay(12000); // Give time for modem to reset
@@ -322,6 +324,7 @@ void onNetworkError() {
   if ((millis() - Time_of_last_hardreset) > (60*5*1000)) {
      
     Output(F("NW:Error - Resetting Modem!"));
+    SD_LogSync();
     modem.hardReset();
     Output(F("NW:Error - Waiting 12s"));
     delay(12000); // Give time for modem to reset
@@ -3,6 +3,7 @@
  *  obs.cpp - Observation Reporting Functions
  * ======================================================================================================================
  */
+#include <stdarg.h>
 
 #include "include/qc.h"
 #include "include/ssbits.h"
@@ -11,6 +12,7 @@
 #include "include/network.h"
 #include "include/lora.h"
 #include "include/wrda.h"
+#include "include/burst.h"
 #include "include/cf.h"
 #include "include/sdcard.h"
 #include "include/output.h"
@@ -19,7 +21,11 @@
 #include "include/support.h"
 #include "include/time.h"
 #include "include/sensors.h"
+#include "include/baro.h"
 #include "include/sensors_i2c_44_47.h"
+#include "include/th.h"
+#include "include/lux.h"
+#include "include/i2c.h"
 #include "include/main.h"
 #include "include/obs.h"
 
@@ -53,6 +59,67 @@ void OBS_Clear() {
   }
 }
 
+/*
+ * ======================================================================================================================
+ * OBS_Append() - Add to the JSON in obsbuf, all or nothing. Room is kept for the closing brace, so a field that
+ *                does not fit is left out and the JSON is still complete. Returns false if it was left out.
+ * ======================================================================================================================
+ */
+bool OBS_Append(const char *format, ...) {
+  int len = strlen(obsbuf);
+  int room = MAX_OBS_SIZE - len - 1;  // 1 for the closing }
+  int n;
+  va_list ap;
+
+  va_start(ap, format);
+  n = vsnprintf(obsbuf+len, room, format, ap);
+  va_end(ap);
+
+  if ((n < 0) || (n >= room)) {
+    obsbuf[len] = 0;
+    return (false);
+  }
+  return (true);
+}
+
+/*
+ * ======================================================================================================================
+ * OBS_AppendSensors() - Add the in use sensors to the JSON in obsbuf, report any that did not fit
+ * ======================================================================================================================
+ */
+void OBS_AppendSensors() {
+  int dropped = 0;
+  bool ok;
+
+  for (int s=0; s<MAX_SENSORS; s++) {
+    if (obs.sensor[s].inuse) {
+      switch (obs.sensor[s].type) {
+        case F_OBS :
+          ok = OBS_Append(",\"%s\":%.1f", obs.sensor[s].id, obs.sensor[s].f_obs);
+          break;
+        case I_OBS :
+          ok = OBS_Append(",\"%s\":%d", obs.sensor[s].id, obs.sensor[s].i_obs);
+          break;
+        case U_OBS :
+          ok = OBS_Append(",\"%s\":%lu", obs.sensor[s].id, obs.sensor[s].u_obs);
+          break;
+        default : // Should never happen
+          Output (F("WhyAmIHere?"));
+          ok = true;
+          break;
+      }
+      if (!ok) {
+        dropped++;
+      }
+    }
+  }
+
+  if (dropped) {
+    sprintf (msgbuf, "OBS->JSON %d DROPPED", dropped);
+    Output (msgbuf);
+  }
+}
+
 /*
  * ======================================================================================================================
  * OBS_N2S_Add() - Save OBS to N2S file
@@ -64,38 +131,21 @@ void OBS_N2S_Add() {
    
     memset(obsbuf, 0, sizeof(obsbuf));
 
-    sprintf (obsbuf, "{");
-    sprintf (obsbuf+strlen(obsbuf), "\"key\":\"%s\"", cf_apikey); 
-    sprintf (obsbuf+strlen(obsbuf), ",\"instrument_id\":%d", cf_instrument_id);
+    OBS_Append ("{");
+    OBS_Append ("\"key\":\"%s\"", cf_apikey); 
+    OBS_Append (",\"instrument_id\":%d", cf_instrument_id);
 
     tm *dt = gmtime(&obs.ts);
 
-    sprintf (obsbuf+strlen(obsbuf), ",\"at\":\"%d-%02d-%02dT%02d%:%02d%:%02d\"",
+    OBS_Append (",\"at\":\"%d-%02d-%02dT%02d%:%02d%:%02d\"",
       dt->tm_year+1900, dt->tm_mon+1,  dt->tm_mday, dt->tm_hour, dt->tm_min, dt->tm_sec);
       
-    sprintf (obsbuf+strlen(obsbuf), ",\"css\":%d", obs.css);
+    OBS_Append (",\"css\":%d", obs.css);
     obs.hth |= SSB_FROM_N2S; // Turn On Bit - Modify System Status and Set From Need to Send file bit
-    sprintf (obsbuf+strlen(obsbuf), ",\"hth\":%d", obs.hth);
-
-    for (int s=0; s<MAX_SENSORS; s++) {
-      if (obs.sensor[s].inuse) {
-        switch (obs.sensor[s].type) {
-          case F_OBS :
-            sprintf (obsbuf+strlen(obsbuf), ",\"%s\":%.1f", obs.sensor[s].id, obs.sensor[s].f_obs);
-            break;
-          case I_OBS :
-            sprintf (obsbuf+strlen(obsbuf), ",\"%s\":%d", obs.sensor[s].id, obs.sensor[s].i_obs);
-            break;
-          case U_OBS :
-            sprintf (obsbuf+strlen(obsbuf), ",\"%s\":%u", obs.sensor[s].id, obs.sensor[s].i_obs);
-            break;
-          default : // Should never happen
-            Output (F("WhyAmIHere?"));
-            break;
-        }
-      }
-    }
-    sprintf (obsbuf+strlen(obsbuf), "}");
+    OBS_Append (",\"hth\":%d", obs.hth);
+
+    OBS_AppendSensors();
+    strcat (obsbuf, "}");  // Room always kept by OBS_Append()
 
     Serial_writeln (obsbuf);
     SD_NeedToSend_Add(obsbuf); // Save to N2F File
@@ -119,38 +169,21 @@ bool OBS_Build_JSON() {
 
     // Save the Observation in JSON format
     
-    sprintf (obsbuf, "{");
-    sprintf (obsbuf+strlen(obsbuf), "\"key\":\"%s\"", cf_apikey); 
-    sprintf (obsbuf+strlen(obsbuf),",\"devid\":\"%s\"", DeviceID);
-    sprintf (obsbuf+strlen(obsbuf), ",\"instrument_id\":%d", cf_instrument_id);
+    OBS_Append ("{");
+    OBS_Append ("\"key\":\"%s\"", cf_apikey); 
+    OBS_Append (",\"devid\":\"%s\"", DeviceID);
+    OBS_Append (",\"instrument_id\":%d", cf_instrument_id);
 
     tm *dt = gmtime(&obs.ts); 
     
-    sprintf (obsbuf+strlen(obsbuf), ",\"at\":\"%d-%02d-%02dT%02d%:%02d%:%02d\"",
+    OBS_Append (",\"at\":\"%d-%02d-%02dT%02d%:%02d%:%02d\"",
       dt->tm_year+1900, dt->tm_mon+1,  dt->tm_mday, dt->tm_hour, dt->tm_min, dt->tm_sec);
 
-    sprintf (obsbuf+strlen(obsbuf), ",\"css\":%d", obs.css);
-    sprintf (obsbuf+strlen(obsbuf), ",\"hth\":%d", obs.hth);
+    OBS_Append (",\"css\":%d", obs.css);
+    OBS_Append (",\"hth\":%d", obs.hth);
     
-    for (int s=0; s<MAX_SENSORS; s++) {
-      if (obs.sensor[s].inuse) {
-        switch (obs.sensor[s].type) {
-          case F_OBS :
-            sprintf (obsbuf+strlen(obsbuf), ",\"%s\":%.1f", obs.sensor[s].id, obs.sensor[s].f_obs);
-            break;
-          case I_OBS :
-            sprintf (obsbuf+strlen(obsbuf), ",\"%s\":%d", obs.sensor[s].id, obs.sensor[s].i_obs);
-            break;
-          case U_OBS :
-            sprintf (obsbuf+strlen(obsbuf), ",\"%s\":%u", obs.sensor[s].id, obs.sensor[s].i_obs);
-            break;
-          default : // Should never happen
-            Output (F("WhyAmIHere?"));
-            break;
-        }
-      }
-    }
-    sprintf (obsbuf+strlen(obsbuf), "}");
+    OBS_AppendSensors();
+    strcat (obsbuf, "}");  // Room always kept by OBS_Append()
 
     Output(F("OBS->URL"));
     Serial_writeln (obsbuf);
@@ -191,6 +224,7 @@ void OBS_Take() {
   int sidx = 0;;
   float rg1 = 0.0;
   float rg2 = 0.0;
+  RAIN_PRODUCTS_STR rp1, rp2;
   unsigned long rg1ds;   // rain gauge delta seconds, seconds since last rain gauge observation logged
   unsigned long rg2ds;   // rain gauge delta seconds, seconds since last rain gauge observation logged
   float ws = 0.0;
@@ -211,17 +245,36 @@ void OBS_Take() {
 
   obs.inuse = true;
   obs.ts = Time_of_obs;     // Set in main loop no need to call stc.getEpoch();
+
+  // Start the T/RH conversions, they run while the sensors before TH_Collect() are read
+  TH_Trigger();
+
+  // Start the Tinovi readings, collected by the leaf wetness observation and mux_obs_do()
+  mux_trigger();
+
   obs.css = GetCellSignalStrength();
   obs.hth = SystemStatusBits;
 
   // Rain Gauge 1 - Each tip is 0.2mm of rain
   if (cf_rg1_enable) {
     rg1 = raingauge1_sample();
+    if (cf_rg_products) {
+      Rain_Products(&raingauge1, &rp1, obs.ts);
+      rp1.intensity1m = (isnan(rp1.intensity1m) || (rp1.intensity1m < QC_MIN_RR) || (rp1.intensity1m > QC_MAX_RR)) ? QC_ERR_RR : rp1.intensity1m;
+      rp1.intensity5m = (isnan(rp1.intensity5m) || (rp1.intensity5m < QC_MIN_RR) || (rp1.intensity5m > QC_MAX_RR)) ? QC_ERR_RR : rp1.intensity5m;
+      rp1.rate = (isnan(rp1.rate) || (rp1.rate < QC_MIN_RR) || (rp1.rate > QC_MAX_RR)) ? QC_ERR_RR : rp1.rate;
+    }
   }
 
   // Rain Gauge 2 - Each tip is 0.2mm of rain
   if (cf_op1 == OP1_STATE_RAIN) {
     rg2 = raingauge2_sample();
+    if (cf_rg_products) {
+      Rain_Products(&raingauge2, &rp2, obs.ts);
+      rp2.intensity1m = (isnan(rp2.intensity1m) || (rp2.intensity1m < QC_MIN_RR) || (rp2.intensity1m > QC_MAX_RR)) ? QC_ERR_RR : rp2.intensity1m;
+      rp2.intensity5m = (isnan(rp2.intensity5m) || (rp2.intensity5m < QC_MIN_RR) || (rp2.intensity5m > QC_MAX_RR)) ? QC_ERR_RR : rp2.intensity5m;
+      rp2.rate = (isnan(rp2.rate) || (rp2.rate < QC_MIN_RR) || (rp2.rate > QC_MAX_RR)) ? QC_ERR_RR : rp2.rate;
+    }
   }
 
   if (RainEnabled()) {
@@ -244,6 +297,33 @@ void OBS_Take() {
     obs.sensor[sidx].type = F_OBS;
     obs.sensor[sidx].f_obs = eeprom.rgp1;
     obs.sensor[sidx++].inuse = true;
+
+    if (cf_rg_products) {
+      strcpy (obs.sensor[sidx].id, "rg1i1m");
+      obs.sensor[sidx].type = F_OBS;
+      obs.sensor[sidx].f_obs = rp1.intensity1m;
+      obs.sensor[sidx++].inuse = true;
+
+      strcpy (obs.sensor[sidx].id, "rg1i5m");
+      obs.sensor[sidx].type = F_OBS;
+      obs.sensor[sidx].f_obs = rp1.intensity5m;
+      obs.sensor[sidx++].inuse = true;
+
+      strcpy (obs.sensor[sidx].id, "rg1rr");
+      obs.sensor[sidx].type = F_OBS;
+      obs.sensor[sidx].f_obs = rp1.rate;
+      obs.sensor[sidx++].inuse = true;
+
+      strcpy (obs.sensor[sidx].id, "rg1ft");
+      obs.sensor[sidx].type = U_OBS;
+      obs.sensor[sidx].u_obs = rp1.first_tip;
+      obs.sensor[sidx++].inuse = true;
+
+      strcpy (obs.sensor[sidx].id, "rg1lt");
+      obs.sensor[sidx].type = U_OBS;
+      obs.sensor[sidx].u_obs = rp1.last_tip;
+      obs.sensor[sidx++].inuse = true;
+    }
   }
 
   // Rain Gauge 2
@@ -262,6 +342,33 @@ void OBS_Take() {
     obs.sensor[sidx].type = F_OBS;
     obs.sensor[sidx].f_obs = eeprom.rgp2;
     obs.sensor[sidx++].inuse = true;
+
+    if (cf_rg_products) {
+      strcpy (obs.sensor[sidx].id, "rg2i1m");
+      obs.sensor[sidx].type = F_OBS;
+      obs.sensor[sidx].f_obs = rp2.intensity1m;
+      obs.sensor[sidx++].inuse = true;
+
+      strcpy (obs.sensor[sidx].id, "rg2i5m");
+      obs.sensor[sidx].type = F_OBS;
+      obs.sensor[sidx].f_obs = rp2.intensity5m;
+      obs.sensor[sidx++].inuse = true;
+
+      strcpy (obs.sensor[sidx].id, "rg2rr");
+      obs.sensor[sidx].type = F_OBS;
+      obs.sensor[sidx].f_obs = rp2.rate;
+      obs.sensor[sidx++].inuse = true;
+
+      strcpy (obs.sensor[sidx].id, "rg2ft");
+      obs.sensor[sidx].type = U_OBS;
+      obs.sensor[sidx].u_obs = rp2.first_tip;
+      obs.sensor[sidx++].inuse = true;
+
+      strcpy (obs.sensor[sidx].id, "rg2lt");
+      obs.sensor[sidx].type = U_OBS;
+      obs.sensor[sidx].u_obs = rp2.last_tip;
+      obs.sensor[sidx++].inuse = true;
+    }
   }
 
   if (cf_op1 == OP1_STATE_RAW) {
@@ -345,6 +452,108 @@ void OBS_Take() {
     obs.sensor[sidx].type = I_OBS;
     obs.sensor[sidx].i_obs = wd;
     obs.sensor[sidx++].inuse = true;
+
+    if (cf_wind_products) {
+      float sd;
+
+      // 2 Minute Wind Speed and Direction
+      if (!Wind_ProductMean(2, &ws, &wd)) {
+        ws = QC_ERR_WS;
+        wd = QC_ERR_WD;
+      }
+      ws = (isnan(ws) || (ws < QC_MIN_WS) || (ws > QC_MAX_WS)) ? QC_ERR_WS : ws;
+      strcpy (obs.sensor[sidx].id, "ws2m");
+      obs.sensor[sidx].type = F_OBS;
+      obs.sensor[sidx].f_obs = ws;
+      obs.sensor[sidx++].inuse = true;
+
+      wd = (isnan(wd) || (wd < QC_MIN_WD) || (wd > QC_MAX_WD)) ? QC_ERR_WD : wd;
+      strcpy (obs.sensor[sidx].id, "wd2m");
+      obs.sensor[sidx].type = I_OBS;
+      obs.sensor[sidx].i_obs = wd;
+      obs.sensor[sidx++].inuse = true;
+
+      // 10 Minute Wind Speed and Direction
+      if (!Wind_ProductMean(10, &ws, &wd)) {
+        ws = QC_ERR_WS;
+        wd = QC_ERR_WD;
+      }
+      ws = (isnan(ws) || (ws < QC_MIN_WS) || (ws > QC_MAX_WS)) ? QC_ERR_WS : ws;
+      strcpy (obs.sensor[sidx].id, "ws10m");
+      obs.sensor[sidx].type = F_OBS;
+      obs.sensor[sidx].f_obs = ws;
+      obs.sensor[sidx++].inuse = true;
+
+      wd = (isnan(wd) || (wd < QC_MIN_WD) || (wd > QC_MAX_WD)) ? QC_ERR_WD : wd;
+      strcpy (obs.sensor[sidx].id, "wd10m");
+      obs.sensor[sidx].type = I_OBS;
+      obs.sensor[sidx].i_obs = wd;
+      obs.sensor[sidx++].inuse = true;
+
+      // 10 Minute Wind Gust and Direction
+      if (!Wind_ProductGust(10, &ws, &wd)) {
+        ws = QC_ERR_WS;
+        wd = QC_ERR_WD;
+      }
+      ws = (isnan(ws) || (ws < QC_MIN_WS) || (ws > QC_MAX_WS)) ? QC_ERR_WS : ws;
+      strcpy (obs.sensor[sidx].id, "wg10m");
+      obs.sensor[sidx].type = F_OBS;
+      obs.sensor[sidx].f_obs = ws;
+      obs.sensor[sidx++].inuse = true;
+
+      wd = (isnan(wd) || (wd < QC_MIN_WD) || (wd > QC_MAX_WD)) ? QC_ERR_WD : wd;
+      strcpy (obs.sensor[sidx].id, "wgd10m");
+      obs.sensor[sidx].type = I_OBS;
+      obs.sensor[sidx].i_obs = wd;
+      obs.sensor[sidx++].inuse = true;
+
+      // 10 Minute Wind Direction Standard Deviation (Sigma Theta)
+      sd = Wind_ProductSigmaTheta(10);
+      sd = (isnan(sd) || (sd < QC_MIN_WDSD) || (sd > QC_MAX_WDSD)) ? QC_ERR_WDSD : sd;
+      strcpy (obs.sensor[sidx].id, "wdsd10m");
+      obs.sensor[sidx].type = F_OBS;
+      obs.sensor[sidx].f_obs = sd;
+      obs.sensor[sidx++].inuse = true;
+    }
+
+    // Wind Burst results, once after each burst
+    if (wb_result.pending) {
+      wb_result.ws = (isnan(wb_result.ws) || (wb_result.ws < QC_MIN_WS) || (wb_result.ws > QC_MAX_WS)) ? QC_ERR_WS : wb_result.ws;
+      wb_result.gust = (isnan(wb_result.gust) || (wb_result.gust < QC_MIN_WS) || (wb_result.gust > QC_MAX_WS)) ? QC_ERR_WS : wb_result.gust;
+      wb_result.wd = ((wb_result.wd < QC_MIN_WD) || (wb_result.wd > QC_MAX_WD)) ? QC_ERR_WD : wb_result.wd;
+
+      strcpy (obs.sensor[sidx].id, "wbws");
+      obs.sensor[sidx].type = F_OBS;
+      obs.sensor[sidx].f_obs = wb_result.ws;
+      obs.sensor[sidx++].inuse = true;
+
+      strcpy (obs.sensor[sidx].id, "wbwd");
+      obs.sensor[sidx].type = I_OBS;
+      obs.sensor[sidx].i_obs = wb_result.wd;
+      obs.sensor[sidx++].inuse = true;
+
+      strcpy (obs.sensor[sidx].id, "wbsd");
+      obs.sensor[sidx].type = F_OBS;
+      obs.sensor[sidx].f_obs = wb_result.sd;
+      obs.sensor[sidx++].inuse = true;
+
+      strcpy (obs.sensor[sidx].id, "wbgst");
+      obs.sensor[sidx].type = F_OBS;
+      obs.sensor[sidx].f_obs = wb_result.gust;
+      obs.sensor[sidx++].inuse = true;
+
+      strcpy (obs.sensor[sidx].id, "wbti");
+      obs.sensor[sidx].type = F_OBS;
+      obs.sensor[sidx].f_obs = wb_result.ti;
+      obs.sensor[sidx++].inuse = true;
+
+      strcpy (obs.sensor[sidx].id, "wbgf");
+      obs.sensor[sidx].type = F_OBS;
+      obs.sensor[sidx].f_obs = wb_result.gf;
+      obs.sensor[sidx++].inuse = true;
+
+      wb_result.pending = false;
+    }
   }
 
   //
@@ -402,6 +611,8 @@ void OBS_Take() {
     }
   }
 
+  TH_Collect();
+
   // Do Sensor observations for SHT31, SHT45, BMP581, HDC302x
   sensor_i2c_44_47_obs_do(sidx); 
 
@@ -412,7 +623,7 @@ void OBS_Take() {
     // HTU Humidity
     strcpy (obs.sensor[sidx].id, "hh1");
     obs.sensor[sidx].type = F_OBS;
-    h = htu.readHumidity();
+    h = th_result[TH_HTU21DF].h;
     h = (isnan(h) || (h < QC_MIN_RH) || (h > QC_MAX_RH)) ? QC_ERR_RH : h;
     obs.sensor[sidx].f_obs = h;
     obs.sensor[sidx++].inuse = true;
@@ -420,15 +631,15 @@ void OBS_Take() {
     // HTU Temperature
     strcpy (obs.sensor[sidx].id, "ht1");
     obs.sensor[sidx].type = F_OBS;
-    t = htu.readTemperature();
+    t = th_result[TH_HTU21DF].t;
     t = (isnan(t) || (t < QC_MIN_T)  || (t > QC_MAX_T))  ? QC_ERR_T  : t;
     obs.sensor[sidx].f_obs = t;
     obs.sensor[sidx++].inuse = true;
   }
 
   if (LPS_1_exists) {
-    float t = lps1.readTemperature();
-    float p = lps1.readPressure();
+    float p, t, h;
+    BARO_Read(&lps1_baro, p, t, h);  // Latest result of the continuous conversion
     t = (isnan(t) || (t < QC_MIN_T)  || (t > QC_MAX_T))  ? QC_ERR_T  : t;
     p = (isnan(p) || (p < QC_MIN_P)  || (p > QC_MAX_P))  ? QC_ERR_P  : p;
 
@@ -446,8 +657,8 @@ void OBS_Take() {
   }
 
   if (LPS_2_exists) {
-    float t = lps2.readTemperature();
-    float p = lps2.readPressure();
+    float p, t, h;
+    BARO_Read(&lps2_baro, p, t, h);  // Latest result of the continuous conversion
     t = (isnan(t) || (t < QC_MIN_T)  || (t > QC_MAX_T))  ? QC_ERR_T  : t;
     p = (isnan(p) || (p < QC_MIN_P)  || (p > QC_MAX_P))  ? QC_ERR_P  : p;
 
@@ -465,13 +676,8 @@ void OBS_Take() {
   }
   
   if (HIH8_exists) {
-    float t = 0.0;
-    float h = 0.0;
-    bool status = hih8_getTempHumid(&t, &h);
-    if (!status) {
-      t = -999.99;
-      h = 0.0;
-    }
+    float t = th_result[TH_HIH8].t;
+    float h = th_result[TH_HIH8].h;
     t = (isnan(t) || (t < QC_MIN_T)  || (t > QC_MAX_T))  ? QC_ERR_T  : t;
     h = (isnan(h) || (h < QC_MIN_RH) || (h > QC_MAX_RH)) ? QC_ERR_RH : h;
 
@@ -539,7 +745,7 @@ void OBS_Take() {
   }
 
   if (VEML7700_exists) {
-    float lux = veml.readLux(VEML_LUX_AUTO);
+    float lux = LUX_VEML();
     lux = (isnan(lux) || (lux < QC_MIN_VLX)  || (lux > QC_MAX_VLX))  ? QC_ERR_VLX  : lux;
 
     // VEML7700 Auto Lux Value
@@ -550,7 +756,7 @@ void OBS_Take() {
   }
 
   if (BLX_exists) {
-    float lux=blx_takereading();
+    float lux = LUX_BLX();
     lux = (isnan(lux) || (lux < QC_MIN_BLX)  || (lux > QC_MAX_BLX))  ? QC_ERR_BLX  : lux;
 
     // DFR BLUX30 Auto Lux Value
@@ -561,6 +767,13 @@ void OBS_Take() {
   }
 
   if (PM25AQI_exists) {
+    if (AQS_Enabled && ((aqs_state != AQS_OFF) || (pm25aqi_obs.count == 0))) {
+      // No duty cycle sample finished for this observation
+      pm25aqi_obs.e10 = -999;
+      pm25aqi_obs.e25 = -999;
+      pm25aqi_obs.e100 = -999;
+    }
+
     // Atmospheric Environmental PM1.0 concentration unit µg m3
     strcpy (obs.sensor[sidx].id, "pm1e10");
     obs.sensor[sidx].type = I_OBS;
@@ -626,10 +839,13 @@ void OBS_Take() {
 
   // Tinovi Leaf Wetness
   if (TLW_exists) {
-    tlw.newReading();
-    delay(100);
-    float w = tlw.getWet();
-    float t = tlw.getTemp();
+    float readings[2];  // wet, temperature
+
+    mux_wait();
+    I2C_Clock(TLW_ADDRESS);
+    tlw.getData(readings);
+    float w = readings[0];
+    float t = readings[1];
     t = (isnan(t) || (t < QC_MIN_T)  || (t > QC_MAX_T))  ? QC_ERR_T  : t;
 
     strcpy (obs.sensor[sidx].id, "tlww");
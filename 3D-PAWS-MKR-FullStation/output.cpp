@@ -9,6 +9,8 @@
 #include "include/mkrboard.h"
 #include "include/support.h"
 #include "include/main.h"
+#include "include/i2c.h"
+#include "include/i2cq.h"
 #include "include/output.h"
 
 /*
@@ -31,6 +33,12 @@ char oled_lines[8][23];
 Adafruit_SSD1306 display32(SCREEN_WIDTH, 32, &Wire, OLED_RESET);
 Adafruit_SSD1306 display64(SCREEN_WIDTH, 64, &Wire, OLED_RESET);
 
+// Queued cells, the window command and the data each. The data goes straight from the display buffer
+I2CQ_XFER_STR oled_xfer[OLED_CELLS][2];
+uint8_t oled_window[OLED_CELLS][7];
+uint8_t oled_data_stream = 0x40;      // Control byte ahead of the data
+int oled_cell = 0;                    // Next to use
+
 /*
  * ======================================================================================================================
  * Fuction Definations
@@ -38,6 +46,29 @@ Adafruit_SSD1306 display64(SCREEN_WIDTH, 64, &Wire, OLED_RESET);
  */
 
 
+/*
+ * ======================================================================================================================
+ * OLED_command() - Send a command through the queue, after any queued cells
+ * ======================================================================================================================
+ */
+void OLED_command(uint8_t c) {
+  uint8_t cmd[] = {0x00, c};
+
+  I2CQ_Transfer(oled_type, NULL, 0, cmd, sizeof(cmd), NULL, 0);
+}
+
+/*
+ * ======================================================================================================================
+ * OLED_wait() - Wait for the queued cells, the display buffer is not drawn in while they are sent from it
+ * ======================================================================================================================
+ */
+void OLED_wait() {
+  for (int i = 0; i < OLED_CELLS; i++) {
+    I2CQ_Wait(&oled_xfer[i][0]);
+    I2CQ_Wait(&oled_xfer[i][1]);
+  }
+}
+
 /*
  * ======================================================================================================================
  * OLED_sleepDisplay()
@@ -45,12 +76,7 @@ Adafruit_SSD1306 display64(SCREEN_WIDTH, 64, &Wire, OLED_RESET);
  */
 void OLED_sleepDisplay() {
   if (DisplayEnabled) {
-    if (OLED32) {
-      display32.ssd1306_command(SSD1306_DISPLAYOFF);
-    }
-    else {
-      display64.ssd1306_command(SSD1306_DISPLAYOFF);
-    }
+    OLED_command(SSD1306_DISPLAYOFF);
   }
 }
 
@@ -61,24 +87,55 @@ void OLED_sleepDisplay() {
  */
 void OLED_wakeDisplay() {
   if (DisplayEnabled) {
-    if (OLED32) {
-      display32.ssd1306_command(SSD1306_DISPLAYON);
-    }
-    else {
-      display64.ssd1306_command(SSD1306_DISPLAYON);
-    }
+    OLED_command(SSD1306_DISPLAYON);
   }
 }
 
 /*
  * ======================================================================================================================
- * OLED_spin() 
+ * OLED_DisplayCell() - Queue a strip of the buffer, one page (8 rows) high and up to a row wide, and return.
+ *                      The column and page window is set ahead of each strip. Only waits when the cell
+ *                      it reuses is still queued.
+ * ======================================================================================================================
+ */
+void OLED_DisplayCell(Adafruit_SSD1306 &display, uint8_t page, uint8_t col, uint8_t width) {
+  I2CQ_XFER_STR *x = oled_xfer[oled_cell];
+  uint8_t *w = oled_window[oled_cell];
+
+  I2CQ_Wait(&x[0]);
+  I2CQ_Wait(&x[1]);
+  oled_cell = (oled_cell + 1) % OLED_CELLS;
+
+  w[0] = 0x00;  // Command stream
+  w[1] = SSD1306_COLUMNADDR;
+  w[2] = col;
+  w[3] = col + width - 1;
+  w[4] = SSD1306_PAGEADDR;
+  w[5] = page;
+  w[6] = page;
+  memset (x, 0, 2 * sizeof(I2CQ_XFER_STR));
+  x[0].addr = oled_type;
+  x[0].tx = w;
+  x[0].tx_len = sizeof(oled_window[0]);
+  x[1].addr = oled_type;
+  x[1].pre = &oled_data_stream;
+  x[1].pre_len = 1;
+  x[1].tx = display.getBuffer() + (page * SCREEN_WIDTH) + col;
+  x[1].tx_len = width;
+  I2CQ_Submit(&x[0]);
+  I2CQ_Submit(&x[1]);
+}
+
+/*
+ * ======================================================================================================================
+ * OLED_spin() - Only the spinner cell is sent, not the whole display
  * ======================================================================================================================
  */
 void OLED_spin() {
   static int spin=0;
     
   if (DisplayEnabled) {
+    OLED_wait();
     if (OLED32) {
       display32.setTextColor(WHITE, BLACK); // Draw 'inverse' text
       display32.setCursor(120,24);
@@ -102,11 +159,12 @@ void OLED_spin() {
     }
     if (OLED32) {
       display32.print(msgp);
-      display32.display();
+      OLED_DisplayCell(display32, 3, 120, 8);
     }
     else {
       display64.print(msgp);
-      display64.display();
+      OLED_DisplayCell(display64, 3, 120, 8);
+      OLED_DisplayCell(display64, 7, 120, 8);
     }
     spin %= 4;
   }
@@ -114,11 +172,13 @@ void OLED_spin() {
 
 /*
  * ======================================================================================================================
- * OLED_update() -- Output oled in memory map to display
+ * OLED_update() -- Output oled in memory map to display. The pages are queued and sent while the caller
+ *                  carries on, display() would wait for all of them.
  * ======================================================================================================================
  */
 void OLED_update() {  
   if (DisplayEnabled) {
+    OLED_wait();
     if (OLED32) {
       display32.clearDisplay();
       display32.setCursor(0,0);             // Start at top-left corner
@@ -129,7 +189,9 @@ void OLED_update() {
       display32.print(oled_lines [2]);
       display32.setCursor(0,24);  
       display32.print(oled_lines [3]);
-      display32.display();
+      for (int page = 0; page < 4; page++) {
+        OLED_DisplayCell(display32, page, 0, SCREEN_WIDTH);
+      }
     }
     else {
       display64.clearDisplay();
@@ -149,8 +211,9 @@ void OLED_update() {
       display64.print(oled_lines [6]);
       display64.setCursor(0,56);  
       display64.print(oled_lines [7]);
-      display64.display();
-     
+      for (int page = 0; page < 8; page++) {
+        OLED_DisplayCell(display64, page, 0, SCREEN_WIDTH);
+      }
     }
   }
 }
@@ -384,6 +447,7 @@ void OLED_initialize() {
     if (I2C_Device_Exist (OLED32_I2C_ADDRESS)) {
       oled_type = OLED32_I2C_ADDRESS;
       display32.begin(SSD1306_SWITCHCAPVCC, OLED32_I2C_ADDRESS);
+      I2C_ClockReset(); // begin() leaves Wire at 100 kHz
       display32.clearDisplay();
       display32.setTextSize(1); // Draw 2X-scale text
       display32.setTextColor(WHITE);
@@ -396,6 +460,7 @@ void OLED_initialize() {
     else if (I2C_Device_Exist (OLED64_I2C_ADDRESS)) {
       oled_type = OLED64_I2C_ADDRESS;
       display64.begin(SSD1306_SWITCHCAPVCC, OLED64_I2C_ADDRESS);
+      I2C_ClockReset(); // begin() leaves Wire at 100 kHz
       display64.clearDisplay();
       display64.setTextSize(1); // Draw 2X-scale text
       display64.setTextColor(WHITE);
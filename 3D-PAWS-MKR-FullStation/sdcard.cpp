@@ -14,6 +14,7 @@
 #include "include/eeprom.h"
 #include "include/time.h"
 #include "include/main.h"
+#include "include/support.h"
 #include "include/cf.h"
 #include "include/output.h"
 #include "include/network.h"
@@ -24,12 +25,26 @@
 SdFat SD;                                   // File system object.
 File SD_fp;
 char SD_obsdir[] = "/OBS";                  // Observations stored in this directory. Created at power on if not exist
+char SD_logfile[44];                        // Daily observation log, kept open. Sized for any tm the format gets
+File SD_logfp;
+uint32_t SD_log_day = 0;                    // Days since 1970 of the open log, 0 none opened since boot
+uint32_t SD_log_size = 0;                   // Bytes of data, the file is preallocated longer
+uint32_t SD_log_zeroed = 0;                 // 0s from the data to here
+int SD_log_unsynced = 0;                    // Observations written since the last sync
 bool SD_exists = false;                     // Set to true if SD card found at boot
-char SD_n2s_file[] = "N2SOBS.TXT";          // Need To Send Observation file
-uint32_t SD_n2s_max_filesz = 512 * 60 * 48; // Keep a little over 1 day. When it fills, it is deleted and we start over.
+char SD_n2s_file[] = "N2SOBS.TXT";          // Need To Send file from before the spool, moved into it at boot
+
+uint32_t n2s_head = 0;                      // Oldest spool segment, 0 when the spool is empty
+uint32_t n2s_tail = 0;                      // Newest spool segment
+uint32_t n2s_tail_size = 0;                 // Bytes in the newest segment
+uint32_t n2s_bytes = 0;                     // Bytes in all segments
+uint32_t n2s_segments_max = SD_N2S_SEGMENTS_MIN;
+SD_N2S_READER n2s_reader;
 
 char SD_crt_file[] = "CRT.TXT";         // if file exists clear rain totals and delete file
 
+char SD_OPTAQS_FILE[] = "OPTAQS.TXT";   // if file exists we are a Air Quality Station
+
 char SD_INFO_FILE[] = "INFO.TXT";       // Store INFO information in this file. Every INFO call will overwrite content
 
 
@@ -74,15 +89,164 @@ void SD_initialize() {
 
 /* 
  *=======================================================================================================================
- * SD_LogObservation()
+ * SD_LogEnd() - Size of the data in a daily log, the file may be longer if it was not closed
+ *   The data ends at the last "\n" before the first 0 or the first byte that can not be in an observation.
  *=======================================================================================================================
  */
-void SD_LogObservation(char *observations) {
-  char SD_logfile[24];
+uint32_t SD_LogEnd(File &fp) {
+  uint8_t buf[256];
+  uint32_t pos = 0;
+  uint32_t end = 0;
+  int n;
+
+  fp.seek(0);
+  while ((n = fp.read(buf, sizeof(buf))) > 0) {
+    for (int i = 0; i < n; i++) {
+      if (buf[i] == '\n') {
+        end = pos + i + 1;
+      }
+      else if (((buf[i] < ' ') && (buf[i] != '\r')) || (buf[i] > '~')) {
+        return (end);
+      }
+    }
+    pos += n;
+  }
+  return (end);
+}
+
+/* 
+ *=======================================================================================================================
+ * SD_LogZero() - Zero from the data to the end of the sector after the one an observation ending at end reaches
+ *   The preallocated clusters hold whatever was last written to them. Zeroed a sector ahead as the log grows, a
+ *   sector of data written out before a power loss is followed by 0s, not old lines.
+ *=======================================================================================================================
+ */
+bool SD_LogZero(uint32_t end) {
+  uint8_t zero[SD_LOG_SECTOR];
+  uint32_t to = ((end / SD_LOG_SECTOR) + 2) * SD_LOG_SECTOR;
+  uint32_t pos = (SD_log_zeroed > SD_log_size) ? SD_log_zeroed : SD_log_size;
+  uint32_t n;
+
+  if (pos >= to) {
+    return (true);
+  }
+  memset(zero, 0, sizeof(zero));
+  SD_logfp.seek(pos);
+  for (; pos < to; pos += n) {
+    n = SD_LOG_SECTOR - (pos % SD_LOG_SECTOR);
+    if (SD_logfp.write(zero, n) != n) {
+      SD_logfp.seek(SD_log_size);
+      return (false);
+    }
+  }
+  SD_log_zeroed = to;
+  SD_logfp.seek(SD_log_size);
+  return (true);
+}
+
+/* 
+ *=======================================================================================================================
+ * SD_LogTrim() - Cut a daily log left open by a power loss or reset back to its data
+ *=======================================================================================================================
+ */
+void SD_LogTrim(char *path) {
   File fp;
+  uint32_t size;
+
+  fp = SD.open(path, O_RDWR);
+  if (fp) {
+    size = SD_LogEnd(fp);
+    if (size < fp.size()) {
+      fp.truncate(size);
+      sprintf (Buffer32Bytes, "SD:LOG TRIM %lu", (unsigned long) size);
+      Output (Buffer32Bytes);
+    }
+    fp.close();
+  }
+}
+
+/* 
+ *=======================================================================================================================
+ * SD_LogOpen() - Open the daily log for the day, continue at the end of its data
+ *=======================================================================================================================
+ */
+bool SD_LogOpen(uint32_t day) {
+  time_t ts;
+  tm *dt;
+  uint32_t size;
+  bool exists;
+
+  // At the first open since boot, yesterday's log may still be as it was left
+  if (SD_log_day == 0) {
+    ts = (time_t) (day - 1) * 86400;
+    dt = gmtime(&ts);
+    snprintf (SD_logfile, sizeof(SD_logfile), "%s/%4d%02d%02d.log", SD_obsdir,
+      dt->tm_year+1900, dt->tm_mon+1,  dt->tm_mday);
+    SD_LogTrim(SD_logfile);
+  }
+
+  ts = (time_t) day * 86400;
+  dt = gmtime(&ts);
+  snprintf (SD_logfile, sizeof(SD_logfile), "%s/%4d%02d%02d.log", SD_obsdir,
+    dt->tm_year+1900, dt->tm_mon+1,  dt->tm_mday);
+  Output (SD_logfile);
 
-  time_t ts = stc.getEpoch();
-  tm *dt = gmtime(&ts); 
+  exists = SD.exists(SD_logfile);
+  SD_logfp = SD.open(SD_logfile, O_RDWR | O_CREAT);
+  if (!SD_logfp) {
+    return (false);
+  }
+
+  if (exists) {
+    SD_log_size = SD_LogEnd(SD_logfp);
+  }
+  else {
+    SD_log_size = 0;
+    // The day of observations in one run of clusters
+    size = (uint32_t)(1440 / cf_obs_period) * SD_LOG_LINE_SIZE;
+    if (!SD_logfp.preAllocate(size)) {
+      Output (F("SD:LOG PREALLOC ERR"));
+    }
+  }
+  SD_log_zeroed = SD_log_size;        // What follows the data is not known
+  SD_logfp.seek(SD_log_size);
+  SD_log_day = day;
+  SD_log_unsynced = 0;
+  return (true);
+}
+
+/* 
+ *=======================================================================================================================
+ * SD_LogSync() - Write out what is logged, call before a modem reset
+ *=======================================================================================================================
+ */
+void SD_LogSync() {
+  if (SD_logfp && SD_log_unsynced) {
+    SD_logfp.sync();
+    SD_log_unsynced = 0;
+  }
+}
+
+/* 
+ *=======================================================================================================================
+ * SD_LogClose() - Cut the daily log to its data and close it, call at rollover and before a reboot
+ *=======================================================================================================================
+ */
+void SD_LogClose() {
+  if (SD_logfp) {
+    SD_logfp.truncate(SD_log_size);
+    SD_logfp.close();
+    SD_log_unsynced = 0;
+  }
+}
+
+/* 
+ *=======================================================================================================================
+ * SD_LogObservation()
+ *=======================================================================================================================
+ */
+void SD_LogObservation(char *observations) {
+  uint32_t day;
     
   if (!SD_exists) {
     Output (F("SD:NOT EXIST"));
@@ -93,86 +257,420 @@ void SD_LogObservation(char *observations) {
     Output (F("SD:STC NOT VALID"));
     return;
   }
-  
-  sprintf (SD_logfile, "%s/%4d%02d%02d.log", SD_obsdir, dt->tm_year+1900, dt->tm_mon+1,  dt->tm_mday);
-  Output (SD_logfile);
-   
-  fp = SD.open(SD_logfile, FILE_WRITE); 
-  if (fp) {
-    fp.println(observations);
-    fp.close();
+
+  day = stc.getEpoch() / 86400;
+  if (!SD_logfp || (day != SD_log_day)) {
+    SD_LogClose();
+    if (!SD_LogOpen(day)) {
+      SystemStatusBits |= SSB_SD;  // Turn On Bit - Note this will be reported on next observation
+      Output (F("SD:Open(Log)ERR"));
+      return;
+    }
+  }
+
+  // The 0s after it are its end marker
+  if (!SD_LogZero(SD_log_size + strlen(observations) + 2)) {
+    Output (F("SD:LOG ZERO ERR"));
+  }
+
+  if (SD_logfp.println(observations) > 0) {
+    SD_log_size = SD_logfp.position();
+
+    if (++SD_log_unsynced >= cf_log_sync) {
+      SD_LogSync();
+    }
     SystemStatusBits &= ~SSB_SD;  // Turn Off Bit
     Output (F("OBS Logged to SD"));
   }
   else {
+    // Reopened on the next observation
+    SD_logfp.close();
     SystemStatusBits |= SSB_SD;  // Turn On Bit - Note this will be reported on next observation
-    Output (F("SD:Open(Log)ERR"));
-    // At thins point we could set SD_exists to false and/or set a status bit to report it
-    // sd_initialize();  // Reports SD NOT Found. Library bug with SD
+    Output (F("SD:Write(Log)ERR"));
   }
 }
 
 /* 
  *=======================================================================================================================
- * SD_N2S_Delete()
+ * SD_N2S_Name() - Path of a spool segment
+ *=======================================================================================================================
+ */
+void SD_N2S_Name(char *path, uint32_t seq) {
+  sprintf (path, "%s/%08lX.TXT", SD_N2S_DIR, (unsigned long) seq);
+}
+
+/* 
+ *=======================================================================================================================
+ * SD_N2S_Hex() - Value of n hex digits, -1 if not hex
  *=======================================================================================================================
  */
-bool SD_N2S_Delete() {
-  bool result;
-
-  if (SD_exists && SD.exists(SD_n2s_file)) {
-    if (SD.remove (SD_n2s_file)) {
-      SystemStatusBits &= ~SSB_N2S; // Turn Off Bit
-      Output (F("N2S->DEL:OK"));
-      result = true;
+long SD_N2S_Hex(const char *s, int n) {
+  long v = 0;
+
+  for (int i = 0; i < n; i++) {
+    if (!isxdigit(s[i])) {
+      return (-1);
     }
-    else {
-      Output (F("N2S->DEL:ERR"));
-      SystemStatusBits |= SSB_SD; // Turn On Bit
-      result = false;
+    v = (v << 4) | (isdigit(s[i]) ? (s[i] - '0') : (toupper(s[i]) - 'A' + 10));
+  }
+  return (v);
+}
+
+/* 
+ *=======================================================================================================================
+ * SD_N2S_Drop() - Remove the oldest segment to make room, its observations are lost
+ *=======================================================================================================================
+ */
+void SD_N2S_Drop() {
+  char path[24];
+  File fp;
+
+  SD_N2S_Name(path, n2s_head);
+  fp = SD.open(path, FILE_READ);
+  if (fp) {
+    n2s_bytes -= (fp.size() < n2s_bytes) ? fp.size() : n2s_bytes;
+    fp.close();
+  }
+  SD.remove(path);
+  sprintf (Buffer32Bytes, "N2S:DROP %08lX", (unsigned long) n2s_head);
+  Output (Buffer32Bytes);
+
+  // eeprom.n2sfp no longer matches the head, sending starts at the top of the next segment
+  n2s_head++;
+}
+
+/* 
+ *=======================================================================================================================
+ * SD_N2S_Write() - Append a record to the newest segment
+ *=======================================================================================================================
+ */
+bool SD_N2S_Write(char *observation) {
+  char path[24];
+  char header[SD_N2S_HEADER_SIZE+1];
+  File fp;
+  int len = strlen(observation);
+  int rec = SD_N2S_HEADER_SIZE + len + 1;
+
+  if ((len == 0) || (len >= MAX_OBS_SIZE)) {
+    Output (F("N2S:REC SIZE ERR"));
+    return (false);
+  }
+
+  if (n2s_head == 0) {
+    n2s_head = n2s_tail = 1;   // Empty spool, numbering starts over
+    n2s_tail_size = 0;
+  }
+  else if ((n2s_tail_size + rec) > SD_N2S_SEGMENT_SIZE) {
+    n2s_tail++;
+    n2s_tail_size = 0;
+  }
+  while ((n2s_tail - n2s_head + 1) > n2s_segments_max) {
+    SD_N2S_Drop();
+  }
+
+  SD_N2S_Name(path, n2s_tail);
+  fp = SD.open(path, FILE_WRITE); // Created if it does not exist, writes at the end
+  if (!fp) {
+    return (false);
+  }
+  sprintf (header, "@%04X%04X ", len, crc16_ccitt(0xFFFF, (uint8_t *) observation, len));
+  fp.write(header, SD_N2S_HEADER_SIZE);
+  fp.write(observation, len);
+  fp.write('\n');
+  fp.close();
+
+  n2s_tail_size += rec;
+  n2s_bytes += rec;
+  return (true);
+}
+
+/* 
+ *=======================================================================================================================
+ * SD_N2S_ReaderSeek() - Move the reader to a file position, the sector is read unless it is the one in buf
+ *=======================================================================================================================
+ */
+void SD_N2S_ReaderSeek(SD_N2S_READER *r, uint32_t position) {
+  uint32_t base = position - (position % SD_N2S_SECTOR);
+  int got;
+
+  if ((base != r->base) || (r->len == 0)) {
+    r->fp->seek(base);
+    got = r->fp->read(r->buf, SD_N2S_SECTOR);
+    r->base = base;
+    r->len = (got > 0) ? got : 0;
+  }
+  r->pos = position - r->base;
+}
+
+/* 
+ *=======================================================================================================================
+ * SD_N2S_ReaderStart() - Start reading a segment at offset
+ *=======================================================================================================================
+ */
+void SD_N2S_ReaderStart(SD_N2S_READER *r, File *fp, uint32_t offset) {
+  r->fp = fp;
+  r->base = 0;
+  r->len = 0;
+  SD_N2S_ReaderSeek(r, offset);
+}
+
+/* 
+ *=======================================================================================================================
+ * SD_N2S_ReaderPosition() - File position of the next record
+ *=======================================================================================================================
+ */
+uint32_t SD_N2S_ReaderPosition(SD_N2S_READER *r) {
+  return (r->base + r->pos);
+}
+
+/* 
+ *=======================================================================================================================
+ * SD_N2S_ReaderNext() - Have a byte at pos, the next sector is read when buf is used up
+ *   Returns false at the end of the segment, a sector short of 512 bytes is the last one.
+ *=======================================================================================================================
+ */
+bool SD_N2S_ReaderNext(SD_N2S_READER *r) {
+  int got;
+
+  if (r->pos < r->len) {
+    return (true);
+  }
+  if (r->len < SD_N2S_SECTOR) {
+    return (false);
+  }
+  // The file is positioned at the end of the sector in buf
+  got = r->fp->read(r->buf, SD_N2S_SECTOR);
+  r->base += SD_N2S_SECTOR;
+  r->pos -= SD_N2S_SECTOR;
+  r->len = (got > 0) ? got : 0;
+  return (r->pos < r->len);
+}
+
+/* 
+ *=======================================================================================================================
+ * SD_N2S_ReaderCopy() - Carry n bytes of a record split across sectors into dst, false if the segment ends first
+ *=======================================================================================================================
+ */
+bool SD_N2S_ReaderCopy(SD_N2S_READER *r, char *dst, int n) {
+  int k;
+
+  while (n > 0) {
+    if (!SD_N2S_ReaderNext(r)) {
+      return (false);
+    }
+    k = r->len - r->pos;
+    if (k > n) {
+      k = n;
     }
+    memcpy(dst, &r->buf[r->pos], k);
+    dst += k;
+    r->pos += k;
+    n -= k;
   }
-  else {
-    SystemStatusBits &= ~SSB_N2S; // Turn Off Bit
-    Output (F("N2S->DEL:NF"));
-    result = true;
+  return (true);
+}
+
+/* 
+ *=======================================================================================================================
+ * SD_N2S_ReadRecord() - Read the next record, payload points to it in the sector buffer or in obsbuf
+ *   Returns the payload length, SD_N2S_EOF, or SD_N2S_BAD with the reader at the next "@"
+ *=======================================================================================================================
+ */
+int SD_N2S_ReadRecord(SD_N2S_READER *r, char **payload) {
+  uint32_t start;
+  char *h = NULL;
+  char *p = NULL;
+  uint8_t *at;
+  long len, crc;
+
+  if (!SD_N2S_ReaderNext(r)) {
+    return (SD_N2S_EOF);
   }
-  eeprom.n2sfp = 0;
-  EEPROM_Update();
-  return (result);
+  start = SD_N2S_ReaderPosition(r);
+
+  // The header where it sits, or carried into hdr when the sector ends in it
+  if ((r->len - r->pos) >= SD_N2S_HEADER_SIZE) {
+    h = (char *) &r->buf[r->pos];
+    r->pos += SD_N2S_HEADER_SIZE;
+  }
+  else if (SD_N2S_ReaderCopy(r, r->hdr, SD_N2S_HEADER_SIZE)) {
+    h = r->hdr;
+  }
+
+  if (h && (h[0] == '@') && (h[SD_N2S_HEADER_SIZE-1] == ' ')) {
+    len = SD_N2S_Hex(&h[1], 4);
+    crc = SD_N2S_Hex(&h[5], 4);
+    if ((len > 0) && (crc >= 0) && (len < MAX_OBS_SIZE)) {
+      // The payload and its "\n" where they sit, or carried into obsbuf
+      if ((r->len - r->pos) > len) {
+        p = (char *) &r->buf[r->pos];
+        r->pos += len + 1;
+      }
+      else if (SD_N2S_ReaderCopy(r, obsbuf, len + 1)) {
+        p = obsbuf;
+      }
+      if (p && (p[len] == '\n')) {
+        p[len] = 0;
+        if (crc16_ccitt(0xFFFF, (uint8_t *) p, len) == crc) {
+          *payload = p;
+          return (len);
+        }
+        return (SD_N2S_BAD);  // Already at the next record
+      }
+    }
+  }
+
+  // Bad header or a record cut short by a power loss, resync on the next "@"
+  SD_N2S_ReaderSeek(r, start + 1);
+  while (SD_N2S_ReaderNext(r)) {
+    at = (uint8_t *) memchr(&r->buf[r->pos], '@', r->len - r->pos);
+    if (at) {
+      r->pos = at - r->buf;
+      break;
+    }
+    r->pos = r->len;
+  }
+  return (SD_N2S_BAD);
 }
 
 /* 
  *=======================================================================================================================
- * SD_NeedToSend_Add()
+ * SD_N2S_Legacy() - Move the observations of a N2SOBS.TXT from before the spool into it
+ *   Called at boot before EEPROM_Validate() with eeprom holding what was read from the chip.
  *=======================================================================================================================
  */
-void SD_NeedToSend_Add(char *observation) {
+void SD_N2S_Legacy() {
+  File fp;
+  int len;
+  int moved = 0;
+  bool valid;
+
+  fp = SD.open(SD_n2s_file, FILE_READ);
+  if (!fp) {
+    return;
+  }
+
+  // The old cursor is a byte offset, a valid one says how much was already sent
+  valid = eeprom_exists && (EEPROM_ChecksumCompute() == eeprom.checksum);
+  if (valid && (eeprom.n2sfp < fp.size())) {
+    fp.seek(eeprom.n2sfp);
+  }
+
+  while ((len = fp.fgets(obsbuf, MAX_OBS_SIZE)) > 0) {
+    if ((obsbuf[len-1] != '\n') && (fp.position() < fp.size())) {
+      // Line longer than an observation, skip the rest of it
+      while (((len = fp.fgets(obsbuf, MAX_OBS_SIZE)) > 0) && (obsbuf[len-1] != '\n'));
+      continue;
+    }
+    // Written with println(), "\r\n" ended. The last line may have no end if the write was cut short
+    while ((len > 0) && ((obsbuf[len-1] == '\n') || (obsbuf[len-1] == '\r'))) {
+      obsbuf[--len] = 0;
+    }
+    if ((len > 0) && SD_N2S_Write(obsbuf)) {
+      moved++;
+    }
+  }
+  fp.close();
+  memset(obsbuf, 0, sizeof(obsbuf));
+
+  SD.remove(SD_n2s_file);
+  sprintf (Buffer32Bytes, "N2S:LEGACY %d", moved);
+  Output (Buffer32Bytes);
+
+  // Left as is the old offset could be taken for a position in the spool
+  if (valid) {
+    eeprom.n2sfp = 0;
+    EEPROM_ChecksumUpdate();
+    EEPROM_Save();
+  }
+}
+
+/* 
+ *=======================================================================================================================
+ * SD_N2S_Initialize() - Find the spool segments and size the spool, call after EEPROM_initialize()
+ *=======================================================================================================================
+ */
+void SD_N2S_Initialize() {
+  File dir;
   File fp;
+  char name[16];
+  char *end;
+  uint32_t seq;
+  uint64_t space;
+  int32_t clusters;
+
+  n2s_head = n2s_tail = 0;
+  n2s_tail_size = 0;
+  n2s_bytes = 0;
+  n2s_segments_max = SD_N2S_SEGMENTS_MIN;
 
   if (!SD_exists) {
     return;
   }
-  
-  fp = SD.open(SD_n2s_file, FILE_WRITE); // Open the file for reading and writing, starting at the end of the file.
-                                         // It will be created if it doesn't already exist.
-  if (fp) {  
-    if (fp.size() > SD_n2s_max_filesz) {
-      fp.close();
-      Output (F("N2S:Full"));
-      if (SD_N2S_Delete()) {
-        // Only call ourself again if we truely deleted the file. Otherwise infinate loop.
-        SD_NeedToSend_Add(observation); // Now go and log the data
+
+  if (!SD.exists(SD_N2S_DIR) && !SD.mkdir(SD_N2S_DIR)) {
+    Output (F("N2S:MKDIR ERR"));
+    SystemStatusBits |= SSB_SD;  // Turn On Bit
+    return;
+  }
+
+  dir = SD.open(SD_N2S_DIR);
+  while (fp.openNext(&dir, O_RDONLY)) {
+    fp.getName(name, sizeof(name));
+    seq = strtoul(name, &end, 16);
+    if (!fp.isDir() && seq && (end == &name[8]) && (strcasecmp(end, ".TXT") == 0)) {
+      if ((n2s_head == 0) || (seq < n2s_head)) {
+        n2s_head = seq;
       }
+      if (seq > n2s_tail) {
+        n2s_tail = seq;
+        n2s_tail_size = fp.size();
+      }
+      n2s_bytes += fp.size();
     }
-    else {
-      fp.println(observation); //Print data, followed by a carriage return and newline, to the File
-      fp.close();
-      SystemStatusBits &= ~SSB_SD;  // Turn Off Bit
-      SystemStatusBits |= SSB_N2S; // Turn on Bit that says there are entries in the N2S File
-      Output (F("N2S:OBS Added"));
+    fp.close();
+  }
+  dir.close();
+
+  // The spool may use its share of the free space plus what it already holds
+  clusters = SD.vol()->freeClusterCount();
+  if (clusters > 0) {
+    space = ((uint64_t) clusters * SD.vol()->bytesPerCluster() + n2s_bytes) * cf_n2s_pct / 100;
+    n2s_segments_max = space / SD_N2S_SEGMENT_SIZE;
+    if (n2s_segments_max < SD_N2S_SEGMENTS_MIN) {
+      n2s_segments_max = SD_N2S_SEGMENTS_MIN;
+    }
+    else if (n2s_segments_max > SD_N2S_SEGMENTS_MAX) {
+      n2s_segments_max = SD_N2S_SEGMENTS_MAX;
     }
   }
+
+  SD_N2S_Legacy();
+
+  if (n2s_head) {
+    SystemStatusBits |= SSB_N2S; // Turn on Bit that says there are entries in the N2S File
+  }
+  sprintf (msgbuf, "N2S:%lu-%lu %luB MAX %luSEG", 
+    (unsigned long) n2s_head, (unsigned long) n2s_tail, (unsigned long) n2s_bytes, (unsigned long) n2s_segments_max);
+  Output (msgbuf);
+}
+
+/* 
+ *=======================================================================================================================
+ * SD_NeedToSend_Add()
+ *=======================================================================================================================
+ */
+void SD_NeedToSend_Add(char *observation) {
+
+  if (!SD_exists) {
+    return;
+  }
+  
+  if (SD_N2S_Write(observation)) {
+    SystemStatusBits &= ~SSB_SD;  // Turn Off Bit
+    SystemStatusBits |= SSB_N2S; // Turn on Bit that says there are entries in the N2S File
+    Output (F("N2S:OBS Added"));
+  }
   else {
     SystemStatusBits |= SSB_SD;  // Turn On Bit - Note this will be reported on next observation
     Output (F("N2S:Open Error"));
@@ -183,21 +681,14 @@ void SD_NeedToSend_Add(char *observation) {
 
 /* 
  * =======================================================================================================================
- * SD_NeedToSend_Status() - Send back the state 
+ * SD_NeedToSend_Status() - Send back the state, bytes in the spool
  * =======================================================================================================================
  */
 void SD_NeedToSend_Status(char *status) {
 
   if (SD_exists) {
-    if (SD.exists(SD_n2s_file)) {
-      File fp = SD.open(SD_n2s_file, FILE_WRITE);
-      if (fp) {
-        sprintf (status, "%d", fp.size());
-        fp.close();
-      }
-      else {
-        sprintf (status, "-1");
-      }
+    if (n2s_head) {
+      sprintf (status, "%lu", (unsigned long) n2s_bytes);
     }
     else {
       sprintf (status, "\"NF\"");
@@ -261,6 +752,45 @@ void SD_UpdateInfoFile(char *info) {
   }
 }
 
+/* 
+ *=======================================================================================================================
+ * SD_N2S_Ack() - The head segment of size bytes has been sent, delete it
+ *=======================================================================================================================
+ */
+void SD_N2S_Ack(uint32_t size) {
+  char path[24];
+
+  SD_N2S_Name(path, n2s_head);
+
+  // Move the cursor first, a reset before the remove resends nothing
+  if (n2s_head == n2s_tail) {
+    eeprom.n2sfp = 0;
+  }
+  else {
+    eeprom.n2sfp = SD_N2S_CURSOR(n2s_head + 1, 0);
+  }
+  EEPROM_Update();
+
+  if (SD.exists(path) && !SD.remove(path)) {
+    Output (F("N2S->DEL:ERR"));
+    SystemStatusBits |= SSB_SD; // Turn On Bit
+  }
+  else {
+    Output (F("N2S->DEL:OK"));
+  }
+  n2s_bytes -= (size < n2s_bytes) ? size : n2s_bytes;
+
+  if (n2s_head == n2s_tail) {
+    n2s_head = n2s_tail = 0;
+    n2s_tail_size = 0;
+    n2s_bytes = 0;
+    SystemStatusBits &= ~SSB_N2S; // Turn Off Bit
+  }
+  else {
+    n2s_head++;
+  }
+}
+
 /* 
  *=======================================================================================================================
  * SD_N2S_Publish()
@@ -268,11 +798,13 @@ void SD_UpdateInfoFile(char *info) {
  */
 void SD_N2S_Publish() {
   File fp;
-  char ch;
-  int i;
+  char path[24];
+  char *payload;
+  uint32_t offset, size;
+  uint32_t tail, tail_size;
+  int len;
   int sent=0;
-
-  memset(obsbuf, 0, sizeof(obsbuf));
+  bool stop = false;
 
   Output (F("N2S Publish"));
 
@@ -280,115 +812,99 @@ void SD_N2S_Publish() {
   pinMode(LORA_SS, OUTPUT);
   digitalWrite(LORA_SS, HIGH);
   
-  if (SD_exists && SD.exists(SD_n2s_file)) {
-    Output (F("N2S:Exists"));
+  if (!SD_exists || !n2s_head) {
+    return;
+  }
+  Output (F("N2S:Exists"));
 
-    fp = SD.open(SD_n2s_file, FILE_READ); // Open the file for reading, starting at the beginning of the file.
+  // set timer on when we need to stop sending n2s obs
+  unsigned long  TimeFromNow;
+  if (cf_obs_period == 1) {
+    TimeFromNow = time_to_next_obs() - (15 * 1000); // stop sending 15s before next observation period if 1m obs
+  }
+  else {
+    TimeFromNow = time_to_next_obs() - (60 * 1000); // stop sending 1m before next observation period if not 1m obs
+  }
 
-    if (fp) {
-      // Delete Empty File or too small of file to be valid
-      if (fp.size()<=20) {
-        fp.close();
-        Output (F("N2S:Empty"));
-        SD_N2S_Delete();
+  // Pick up where we left off, a cursor from another segment means the start of the head segment
+  offset = ((eeprom.n2sfp >> 16) == (n2s_head & 0xFFFF)) ? (eeprom.n2sfp & 0xFFFF) : 0;
+
+  while (n2s_head && !stop) {
+    SD_N2S_Name(path, n2s_head);
+    size = 0;
+    tail = n2s_tail;
+    tail_size = n2s_tail_size;
+
+    if (SD.exists(path)) {
+      fp = SD.open(path, FILE_READ);
+      if (!fp) {
+        Output (F("N2S->OPEN:ERR"));
+        break;
       }
-      else {
-        if (eeprom.n2sfp) {
-          if (fp.size()<=eeprom.n2sfp) {
-            // Something wrong. Can not have a file position that is larger than the file
-            eeprom.n2sfp = 0; 
-          }
-          else {
-            fp.seek(eeprom.n2sfp);  // Seek to where we left off last time. 
-          }
-        } 
-
-        // Loop through each line / obs and transmit
-        
-        // set timer on when we need to stop sending n2s obs
-        unsigned long  TimeFromNow;
-        if (cf_obs_period == 1) {
-          TimeFromNow = time_to_next_obs() - (15 * 1000); // stop sending 15s before next observation period if 1m obs
+      if (offset > fp.size()) {
+        offset = 0;  // Something wrong. Can not have a position past the end of the segment
+      }
+      SD_N2S_ReaderStart(&n2s_reader, &fp, offset);
+
+      // Loop through each record / obs and transmit
+      while (true) {
+        len = SD_N2S_ReadRecord(&n2s_reader, &payload);
+        if (len == SD_N2S_EOF) {
+          break;
         }
-        else {
-          TimeFromNow = time_to_next_obs() - (60 * 1000); // stop sending 1m before next observation period if not 1m obs
+        if (len == SD_N2S_BAD) {
+          // Skip it, the records after it are still good
+          sprintf (Buffer32Bytes, "N2S[%d]->CRC:ERR", sent);
+          Output (Buffer32Bytes);
+          eeprom.n2sfp = SD_N2S_CURSOR(n2s_head, SD_N2S_ReaderPosition(&n2s_reader));
+          continue;
         }
 
-        i = 0;
-        while (fp.available() && (i < MAX_HTTP_SIZE )) {
-          ch = fp.read();
-
-          if (ch == 0x0A) {
+        Serial_writeln (payload);
             
-            Serial_writeln (obsbuf);
-            
-            if (Send_http(obsbuf, cf_webserver, cf_webserver_port, cf_urlpath, METHOD_GET, cf_apikey)) {
-              sprintf (Buffer32Bytes, "N2S[%d]->PUB:OK", sent++);
-              Output (Buffer32Bytes);
-              //Serial_writeln (obsbuf);
-
-              // setup for next line in file
-              i = 0;
-
-              // file position is at the start of the next observation or at eof
-              eeprom.n2sfp = fp.position();
-
-              BackGroundWork();
-              sprintf (Buffer32Bytes, "N2S[%d] Contunue", sent);
-              Output (Buffer32Bytes); 
-
-              if(millis() > TimeFromNow) {
-                // need to break out so new obs can be made
-                Output (F("N2S->TIME2EXIT"));
-                break;                
-              }
-            }
-            else {
-                sprintf (Buffer32Bytes, "N2S[%d]->PUB:ERR", sent);
-                Output (Buffer32Bytes);
-                // On transmit failure, stop processing file.
-                break;
-            }
-            
-            // At this point file pointer's position is at the first character of the next line or at eof
-            
-          } // Newline
-          else if (ch == 0x0D) { // CR, LF follows and will trigger the line to be processed       
-            obsbuf[i] = 0; // null terminate then wait for newline to be read to process OBS
+        if (Send_http(payload, cf_webserver, cf_webserver_port, cf_urlpath, METHOD_GET, cf_apikey)) {
+          sprintf (Buffer32Bytes, "N2S[%d]->PUB:OK", sent++);
+          Output (Buffer32Bytes);
+
+          // Reader position is at the start of the next record or at eof
+          eeprom.n2sfp = SD_N2S_CURSOR(n2s_head, SD_N2S_ReaderPosition(&n2s_reader));
+
+          BackGroundWork();
+          sprintf (Buffer32Bytes, "N2S[%d] Contunue", sent);
+          Output (Buffer32Bytes); 
+
+          if(millis() > TimeFromNow) {
+            // need to break out so new obs can be made
+            Output (F("N2S->TIME2EXIT"));
+            stop = true;
+            break;
           }
-          else {
-            obsbuf[i++] = ch;
-          }
-
-          // Check for buffer overrun
-          if (i >= MAX_HTTP_SIZE) {
-            sprintf (Buffer32Bytes, "N2S[%d]->BOR:ERR", sent);
-            Output (Buffer32Bytes);
-            fp.close();
-            SD_N2S_Delete(); // Bad data in the file so delete the file           
-            return;
-          }
-        } // end while 
-
-        if (fp.available() <= 20) {
-          // If at EOF or some invalid amount left then delete the file
-          fp.close();
-          SD_N2S_Delete();
         }
         else {
-          // At this point we sent 0 or more observations but there was a problem.
-          // eeprom.n2sfp was maintained in the above read loop. So we will close the
-          // file and next time this function is called we will seek to eeprom.n2sfp
-          // and start processing from there forward. 
-          fp.close();
-          EEPROM_Update(); // Update file postion in the eeprom.
+          sprintf (Buffer32Bytes, "N2S[%d]->PUB:ERR", sent);
+          Output (Buffer32Bytes);
+          // On transmit failure, stop processing. Next time we start from eeprom.n2sfp
+          stop = true;
+          break;
         }
       }
+      offset = SD_N2S_ReaderPosition(&n2s_reader);
+      size = fp.size();
+      fp.close();
+
+      if (stop) {
+        EEPROM_Update(); // Update file postion in the eeprom.
+        break;
+      }
+
+      // Records were added to this segment while sending, read on from where we are
+      if ((n2s_head == tail) && ((n2s_tail != tail) || (n2s_tail_size != tail_size))) {
+        continue;
+      }
     }
-    else {
-        Output (F("N2S->OPEN:ERR"));
-    }
+
+    // All of the head segment has been sent
+    SD_N2S_Ack(size);
+    offset = 0;
   }
 }
-
-
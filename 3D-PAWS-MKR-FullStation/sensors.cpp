@@ -12,6 +12,9 @@
 #include "include/cf.h"
 #include "include/sensors_i2c_44_47.h"
 #include "include/sensors.h"
+#include "include/baro.h"
+#include "include/lux.h"
+#include "include/i2c.h"
 
 /*
  * ======================================================================================================================
@@ -38,6 +41,8 @@ bool BMX_2_exists = false;
 byte BMX_1_type=BMX_TYPE_UNKNOWN;
 byte BMX_2_type=BMX_TYPE_UNKNOWN;
 const char *bmxtype[] = {"UNKN", "BMP280", "BME280", "BMP388", "BMP390"};
+BARO_STR bmx1_baro = {BARO_NONE, NULL};
+BARO_STR bmx2_baro = {BARO_NONE, NULL};
 
 /*
  * ======================================================================================================================
@@ -132,6 +137,8 @@ Adafruit_LPS35HW lps1;
 Adafruit_LPS35HW lps2;
 bool LPS_1_exists = false;
 bool LPS_2_exists = false;
+BARO_STR lps1_baro = {BARO_LPS35HW, &lps1};
+BARO_STR lps2_baro = {BARO_LPS35HW, &lps2};
 
 /*
  * ======================================================================================================================
@@ -157,7 +164,9 @@ bool TSM_exists = false;
  */
 bool AQS_Enabled = false;               // if file found this is set
 int AQSWarmUpTime = 35;                 // Seconds to wait wile sensor warms up from sleep
-int AQS_Correction = 0;                 // This will set to 30500ms for time we wait for sensor to initialize
+AQS_STATE aqs_state = AQS_OFF;
+unsigned long aqs_time = 0;             // millis() when the sensor was powered on
+unsigned long aqs_obs_time = 0;         // Time_of_next_obs the last sample was taken for
 
 /*
  * ======================================================================================================================
@@ -189,7 +198,7 @@ byte get_Bosch_ChipID (byte address) {
   // Check Register 0x00
   sprintf (msgbuf, "  I2C:%02X Reg:%02X", address, 0x00);
   Output (msgbuf);
-  Wire.begin();
+  I2C_Clock(address);
   Wire.beginTransmission(address);
   Wire.write(0x00);  // BM3 CHIPID REGISTER
   error = Wire.endTransmission();
@@ -233,7 +242,7 @@ byte get_Bosch_ChipID (byte address) {
   chip_id = 0;
   sprintf (msgbuf, "  I2C:%02X Reg:%02X", address, 0xD0);
   Output (msgbuf);
-  Wire.begin();
+  I2C_Clock(address);
   Wire.beginTransmission(address);
   Wire.write(0xD0);  // BM2 CHIPID REGISTER
   error = Wire.endTransmission();
@@ -287,33 +296,8 @@ void bmx1_read(float &p, float &t, float &h) {
   h = -999.9;
 
   if (BMX_1_exists) {
-    switch (BMX_1_type) {
-      case BMX_TYPE_BMP280 :
-        p = bmp1.readPressure()/100.0F;
-        t = bmp1.readTemperature();
-        break;
-        
-      case BMX_TYPE_BME280 :
-        p = bme1.readPressure()/100.0F;
-        t = bme1.readTemperature();
-        h = bme1.readHumidity(); 
-        break;
-
-      case BMX_TYPE_BMP390 :
-        p = bm31.readPressure()/100.0F;
-        t = bm31.readTemperature();
-        break;
-          
-      case BMX_TYPE_BMP388 :
-        p = bm31.readPressure()/100.0F;
-        t = bm31.readTemperature();
-        break;
-        
-      default: // WTF
-        Output ("bmx1_read (WTF)");
-        return;
-        break;
-    }
+    // Latest result of the continuous conversion, one burst read for all values
+    BARO_Read(&bmx1_baro, p, t, h);
     p = (isnan(p) || (p < QC_MIN_P)  || (p > QC_MAX_P))  ? QC_ERR_P  : p;
     t = (isnan(t) || (t < QC_MIN_T)  || (t > QC_MAX_T))  ? QC_ERR_T  : t;
     h = (isnan(h) || (h < QC_MIN_RH) || (h > QC_MAX_RH)) ? QC_ERR_RH : h;
@@ -332,33 +316,8 @@ void bmx2_read(float &p, float &t, float &h) {
   h = -999.9;
 
   if (BMX_2_exists) {
-    switch (BMX_2_type) {
-      case BMX_TYPE_BMP280 :
-        p = bmp2.readPressure()/100.0F;
-        t = bmp2.readTemperature();
-        break;
-        
-      case BMX_TYPE_BME280 :
-        p = bme2.readPressure()/100.0F;
-        t = bme2.readTemperature();
-        h = bme2.readHumidity(); 
-        break;
-
-      case BMX_TYPE_BMP390 :
-        p = bm32.readPressure()/100.0F;
-        t = bm32.readTemperature();
-        break;
-          
-      case BMX_TYPE_BMP388 :
-        p = bm32.readPressure()/100.0F;
-        t = bm32.readTemperature();
-        break;
-        
-      default: // WTF
-        Output ("bmx1_read (WTF)");
-        return;
-        break;
-    }
+    // Latest result of the continuous conversion, one burst read for all values
+    BARO_Read(&bmx2_baro, p, t, h);
     p = (isnan(p) || (p < QC_MIN_P)  || (p > QC_MAX_P))  ? QC_ERR_P  : p;
     t = (isnan(t) || (t < QC_MIN_T)  || (t > QC_MAX_T))  ? QC_ERR_T  : t;
     h = (isnan(h) || (h < QC_MIN_RH) || (h > QC_MAX_RH)) ? QC_ERR_RH : h;
@@ -367,124 +326,88 @@ void bmx2_read(float &p, float &t, float &h) {
 
 /* 
  *=======================================================================================================================
- * bmx_initialize() - Bosch sensor initialize
+ * bmx_begin() - Bosch sensor initialize, n is 1 or 2. Also used to bring a sensor back online
  *=======================================================================================================================
  */
-void bmx_initialize() {
-  Output("BMX:INIT");
-  
-  // 1st Bosch Sensor - Need to see which (BMP, BME, BM3) is plugged in
-  BMX_1_chip_id = get_Bosch_ChipID(BMX_ADDRESS_1);
-
-  switch (BMX_1_chip_id) {
+void bmx_begin(int n) {
+  uint8_t addr         = (n == 1) ? BMX_ADDRESS_1 : BMX_ADDRESS_2;
+  Adafruit_BMP280 &bmp = (n == 1) ? bmp1 : bmp2;
+  Adafruit_BME280 &bme = (n == 1) ? bme1 : bme2;
+  Adafruit_BMP3XX &bm3 = (n == 1) ? bm31 : bm32;
+  byte &chip_id        = (n == 1) ? BMX_1_chip_id : BMX_2_chip_id;
+  bool &exists         = (n == 1) ? BMX_1_exists : BMX_2_exists;
+  byte &type           = (n == 1) ? BMX_1_type : BMX_2_type;
+  BARO_STR &baro       = (n == 1) ? bmx1_baro : bmx2_baro;
+
+  // Need to see which (BMP, BME, BM3) is plugged in
+  chip_id = get_Bosch_ChipID(addr);
+  exists = false;
+
+  switch (chip_id) {
     case BMP280_CHIP_ID :
-      if (!bmp1.begin(BMX_ADDRESS_1)) { 
-        msgp = (char *) "BMP1 ERR";
-        BMX_1_exists = false;
+      if (!bmp.begin(addr)) { 
+        sprintf (Buffer32Bytes, "BMP%d ERR", n);
       }
       else {
-        BMX_1_exists = true;
-        BMX_1_type = BMX_TYPE_BMP280;
-        msgp = (char *) "BMP1 OK";
-        [[maybe_unused]] float p = bmp1.readPressure();
+        exists = true;
+        type = BMX_TYPE_BMP280;
+        sprintf (Buffer32Bytes, "BMP%d OK", n);
+        baro = {BARO_BMP280, &bmp};
+        BARO_Continuous(&baro);
       }
     break;
 
     case BME280_BMP390_CHIP_ID :
-      if (!bme1.begin(BMX_ADDRESS_1)) { 
-        if (!bm31.begin_I2C(BMX_ADDRESS_1)) {  // Perhaps it is a BMP390
-          msgp = (char *) "BMX1 ERR";
-          BMX_1_exists = false;
+      if (!bme.begin(addr)) { 
+        if (!bm3.begin_I2C(addr)) {  // Perhaps it is a BMP390
+          sprintf (Buffer32Bytes, "BMX%d ERR", n);
         }
         else {
-          BMX_1_exists = true;
-          BMX_1_type = BMX_TYPE_BMP390;
-          msgp = (char *) "BMP390_1 OK"; 
-          [[maybe_unused]] float p = bm31.readPressure();       
+          exists = true;
+          type = BMX_TYPE_BMP390;
+          sprintf (Buffer32Bytes, "BMP390_%d OK", n);
+          baro = {BARO_BMP3XX, &bm3};
+          BARO_Continuous(&baro);
         }      
       }
       else {
-        BMX_1_exists = true;
-        BMX_1_type = BMX_TYPE_BME280;
-        msgp = (char *) "BME280_1 OK";
-        [[maybe_unused]] float p = bme1.readPressure();
+        exists = true;
+        type = BMX_TYPE_BME280;
+        sprintf (Buffer32Bytes, "BME280_%d OK", n);
+        baro = {BARO_BME280, &bme};
+        BARO_Continuous(&baro);
       }
     break;
 
     case BMP388_CHIP_ID :
-      if (!bm31.begin_I2C(BMX_ADDRESS_1)) { 
-        msgp = (char *) "BM31 ERR";
-        BMX_1_exists = false;
+      if (!bm3.begin_I2C(addr)) { 
+        sprintf (Buffer32Bytes, "BM3%d ERR", n);
       }
       else {
-        BMX_1_exists = true;
-        BMX_1_type = BMX_TYPE_BMP388;
-        msgp = (char *) "BM31 OK";
-        [[maybe_unused]] float p = bm31.readPressure();
+        exists = true;
+        type = BMX_TYPE_BMP388;
+        sprintf (Buffer32Bytes, "BM3%d OK", n);
+        baro = {BARO_BMP3XX, &bm3};
+        BARO_Continuous(&baro);
       }
     break;
 
     default:
-      msgp = (char *) "BMX_1 NF";
+      sprintf (Buffer32Bytes, "BMX_%d NF", n);
     break;
   }
-  Output (msgp);
-
-  // 2nd Bosch Sensor - Need to see which (BMP, BME, BM3) is plugged in
-  BMX_2_chip_id = get_Bosch_ChipID(BMX_ADDRESS_2);
-  switch (BMX_2_chip_id) {
-    case BMP280_CHIP_ID :
-      if (!bmp2.begin(BMX_ADDRESS_2)) { 
-        msgp = (char *) "BMP2 ERR";
-        BMX_2_exists = false;
-      }
-      else {
-        BMX_2_exists = true;
-        BMX_2_type = BMX_TYPE_BMP280;
-        msgp = (char *) "BMP2 OK";
-        [[maybe_unused]] float p = bmp2.readPressure();
-      }
-    break;
-
-    case BME280_BMP390_CHIP_ID :
-      if (!bme2.begin(BMX_ADDRESS_2)) { 
-        if (!bm32.begin_I2C(BMX_ADDRESS_2)) {  // Perhaps it is a BMP390
-          msgp = (char *) "BMX2 ERR";
-          BMX_2_exists = false;
-        }
-        else {
-          BMX_2_exists = true;
-          BMX_2_type = BMX_TYPE_BMP390;
-          msgp = (char *) "BMP390_2 OK"; 
-          [[maybe_unused]] float p = bm32.readPressure();         
-        }
-      }
-      else {
-        BMX_2_exists = true;
-        BMX_2_type = BMX_TYPE_BME280;
-        msgp = (char *) "BME280_2 OK";
-        [[maybe_unused]] float p = bme2.readPressure();
-      }
-    break;
-
-    case BMP388_CHIP_ID :
-      if (!bm32.begin_I2C(BMX_ADDRESS_2)) { 
-        msgp = (char *) "BM32 ERR";
-        BMX_2_exists = false;
-      }
-      else {
-        BMX_2_exists = true;
-        BMX_2_type = BMX_TYPE_BMP388;
-        msgp = (char *) "BM32 OK";
-        [[maybe_unused]] float p = bm32.readPressure();
-      }
-    break;
+  Output (Buffer32Bytes);
+}
 
-    default:
-      msgp = (char *) "BMX_2 NF";
-    break;
-  }
-  Output (msgp);
+/* 
+ *=======================================================================================================================
+ * bmx_initialize() - Bosch sensor initialize
+ *=======================================================================================================================
+ */
+void bmx_initialize() {
+  Output("BMX:INIT");
+  bmx_begin(1);
+  bmx_begin(2);
 }
 
 /* 
@@ -509,59 +432,37 @@ void htu21d_initialize() {
 
 /* 
  *=======================================================================================================================
- * mcp9808_initialize() - MCP9808 sensor initialize
+ * mcp9808_begin() - MCP9808 sensor initialize, n is 1 to 4. Also used to bring a sensor back online
+ *   MCP9808 Precision I2C Temperature Sensor (I2C ADDRESS = 0x18 to 0x1B)
  *=======================================================================================================================
  */
-void mcp9808_initialize() {
-  Output("MCP9808:INIT");
-  
-  // 1st MCP9808 Precision I2C Temperature Sensor (I2C ADDRESS = 0x18)
-  mcp1 = Adafruit_MCP9808();
-  if (!mcp1.begin(MCP_ADDRESS_1)) {
-    msgp = (char *) "MCP1 NF";
-    MCP_1_exists = false;
-  }
-  else {
-    MCP_1_exists = true;
-    msgp = (char *) "MCP1 OK";
-  }
-  Output (msgp);
-
-  // 2nd MCP9808 Precision I2C Temperature Sensor (I2C ADDRESS = 0x19)
-  mcp2 = Adafruit_MCP9808();
-  if (!mcp2.begin(MCP_ADDRESS_2)) {
-    msgp = (char *) "MCP2 NF";
-    MCP_2_exists = false;
-  }
-  else {
-    MCP_2_exists = true;
-    msgp = (char *) "MCP2 OK";
-  }
-  Output (msgp);
-
-  // 3rd MCP9808 Precision I2C Temperature Sensor (I2C ADDRESS = 0x20)
-  mcp3 = Adafruit_MCP9808();
-  if (!mcp3.begin(MCP_ADDRESS_3)) {
-    msgp = (char *) "MCP3 NF";
-    MCP_3_exists = false;
+void mcp9808_begin(int n) {
+  Adafruit_MCP9808 *mcp[] = {&mcp1, &mcp2, &mcp3, &mcp4};
+  bool *exists[] = {&MCP_1_exists, &MCP_2_exists, &MCP_3_exists, &MCP_4_exists};
+  const uint8_t addr[] = {MCP_ADDRESS_1, MCP_ADDRESS_2, MCP_ADDRESS_3, MCP_ADDRESS_4};
+
+  if (!mcp[n-1]->begin(addr[n-1])) {
+    sprintf (Buffer32Bytes, "MCP%d NF", n);
+    *exists[n-1] = false;
   }
   else {
-    MCP_3_exists = true;
-    msgp = (char *) "MCP3 OK";
+    *exists[n-1] = true;
+    sprintf (Buffer32Bytes, "MCP%d OK", n);
   }
-  Output (msgp);
+  Output (Buffer32Bytes);
+}
 
-  // 4th MCP9808 Precision I2C Temperature Sensor (I2C ADDRESS = 0x21)
-  mcp4 = Adafruit_MCP9808();
-  if (!mcp4.begin(MCP_ADDRESS_4)) {
-    msgp = (char *) "MCP4 NF";
-    MCP_4_exists = false;
-  }
-  else {
-    MCP_4_exists = true;
-    msgp = (char *) "MCP4 OK";
+/* 
+ *=======================================================================================================================
+ * mcp9808_initialize() - MCP9808 sensor initialize
+ *=======================================================================================================================
+ */
+void mcp9808_initialize() {
+  Output("MCP9808:INIT");
+  
+  for (int n = 1; n <= 4; n++) {
+    mcp9808_begin(n);
   }
-  Output (msgp);
 }
 
 /* 
@@ -594,7 +495,7 @@ bool hih8_getTempHumid(float *t, float *h) {
     uint16_t humidityBuffer    = 0;
     uint16_t temperatureBuffer = 0;
   
-    Wire.begin();
+    I2C_Clock(HIH8000_ADDRESS);
     Wire.beginTransmission(HIH8000_ADDRESS);
 
     Wire.write(0x00); // set the register location for read request
@@ -647,6 +548,7 @@ void wbt_initialize() {
     Output ("WBT:OK");
   }
   else {
+    WBT_exists = false;
     Output ("WBT:NF");
   }
 }
@@ -704,6 +606,7 @@ void hi_initialize() {
     Output ("HI:OK");
   }
   else {
+    HI_exists = false;
     Output ("HI:NF");
   }
 }
@@ -808,6 +711,7 @@ void wbgt_initialize() {
     }
   }
   else {
+    WBGT_exists = false;
     Output ("WBGT:NF");
   }
 }
@@ -885,6 +789,7 @@ void lux_initialize() {
 
   if (veml.begin()) {
     VEML7700_exists = true;
+    LUX_Begin();
     msgp = (char *) "LUX OK";
   }
   else {
@@ -952,22 +857,15 @@ float blx_takereading() {
   float lux;
   uint32_t raw;
   uint8_t data[4]; // Array to hold the 4 bytes of data
-  const unsigned long timeout = 1000; // Timeout in milliseconds
-  unsigned long startTime;
 
+  I2C_Clock(BLX_ADDRESS);
   Wire.beginTransmission(BLX_ADDRESS);
   Wire.write(0x00); // Point to the data register address
   Wire.endTransmission(false); // false tells the I2C master to not release the bus between the write and read operations
 
-  // Request 4 bytes from the device
-  Wire.requestFrom(BLX_ADDRESS, 4);
-
-  startTime = millis(); // Record the start time
-  while (Wire.available() < 4) { // Wait for all bytes to be received
-    if (millis() - startTime > timeout) { // Check if timeout has been reached
-      return -1; // Return error code if timeout occurs
-    }
-    delay(1); // Short delay to prevent busy-waiting
+  // Request 4 bytes from the device, requestFrom() returns after the transfer so a short read will not improve by waiting
+  if (Wire.requestFrom(BLX_ADDRESS, 4) != 4) {
+    return -1; // Return error code on a short read
   }
 
   for (int i = 0; i < 4; i++) {
@@ -1020,6 +918,7 @@ void pm25aqi_clear() {
  */
 void pm25aqi_initialize() {
   Output("PM25AQI:INIT");
+  I2C_Clock(PM25AQI_ADDRESS);
   Wire.beginTransmission(PM25AQI_ADDRESS);
   if (Wire.endTransmission()) {
     msgp = (char *) "PM:NF";
@@ -1081,63 +980,100 @@ void pm25aqi_TakeReading() {
 
 /* 
  *=======================================================================================================================
- * pm25aqi_TakeReading_AQS() - Air Quality station, wake up sensor, wait 30s, skip 1st reading, take sample, put sensor to sleep
+ * AQS_Service() - Air Quality station, called every second. Wake up the sensor so warm up and sampling end just
+ *                 before the next observation, toss the 1st reading, take a reading a second, put sensor to sleep
  *=======================================================================================================================
  */
-void pm25aqi_TakeReading_AQS() {
-  if (PM25AQI_exists) {
-    PM25_AQI_Data aqid;
-
-    Output("AQS:WAKEUP");
-    digitalWrite(OP2_PIN, HIGH); // Wakeup Air Quality Sensor
-
-    // Clear readings
-    pm25aqi_clear();
+void AQS_Service() {
+  long to_obs = (long)(Time_of_next_obs - millis());   // ms, negative when the observation is late
+  PM25_AQI_Data aqid;
+
+  switch (aqs_state) {
+    case AQS_OFF :
+      if ((Time_of_next_obs != aqs_obs_time) && (to_obs <= (AQSWarmUpTime + AQS_SAMPLES + AQS_MARGIN) * 1000L)) {
+        Output("AQS:WAKEUP");
+        digitalWrite(OP2_PIN, HIGH); // Wakeup Air Quality Sensor
+        aqs_time = millis();
+        aqs_state = AQS_WARMING;
+      }
+      break;
+
+    case AQS_WARMING :
+      if ((millis() - aqs_time) >= (AQSWarmUpTime * 1000UL)) {
+        Output("AQS:Take Reading");
+        pm25aqi_clear();
+        if (PM25AQI_exists) {
+          pmaq.read(&aqid); // Toss 1st reading after wakeup
+        }
+        aqs_state = AQS_SAMPLING;
+      }
+      break;
+
+    case AQS_SAMPLING :
+      if (PM25AQI_exists) {
+        if (pmaq.read(&aqid)) {
+          pm25aqi_obs.count++;
+          pm25aqi_obs.e10  += aqid.pm10_env;
+          pm25aqi_obs.e25  += aqid.pm25_env;
+          pm25aqi_obs.e100 += aqid.pm100_env;
+        }
+        else {
+          pm25aqi_obs.fail_count++;
+        }
+      }
+      else {
+        pm25aqi_obs.fail_count++;
+      }
 
-    // Wait 30s for sensor to wakeup
-    for (int i=0; i<AQSWarmUpTime; i++) {
-      BackGroundWork(); // Delays 1s
-      if (SerialConsoleEnabled) Serial.print(".");  // Provide Serial Console some feedback as we loop and wait til next observation
-      OLED_spin();
-    }
-    if (SerialConsoleEnabled) Serial.println();
+      if (((pm25aqi_obs.count + pm25aqi_obs.fail_count) < AQS_SAMPLES) && (to_obs > 1000)) {
+        break;
+      }
 
-    Output("AQS:Take Reading");
-    
-    pmaq.read(&aqid); // Toss 1st reading after wakeup
-    
-    for (int i=0; i<11; i++) {
-      delay(800); // sensor takes reading every 1s, so wait for the next
-      if (pmaq.read(&aqid)) {
-        pm25aqi_obs.count++;
-        pm25aqi_obs.e10  += aqid.pm10_env;
-        pm25aqi_obs.e25  += aqid.pm25_env;
-        pm25aqi_obs.e100 += aqid.pm100_env;
+      Output("AQS:SLEEP");
+      digitalWrite(OP2_PIN, LOW); // Put to Sleep Air Quality Sensor
+      aqs_obs_time = Time_of_next_obs;
+      aqs_state = AQS_OFF;
+
+      if ((pm25aqi_obs.count == 0) || (pm25aqi_obs.fail_count > pm25aqi_obs.count)) {
+        // Fail if half our sample reads failed. - I think this is reasonable - rjb
+        Output("AQS:FAIL");
+        pm25aqi_obs.e10 = -999;
+        pm25aqi_obs.e25 = -999;
+        pm25aqi_obs.e100 = -999;
       }
       else {
-        pm25aqi_obs.fail_count++;
+        // Do average
+        Output("AQS:OK");
+        pm25aqi_obs.e10  = (pm25aqi_obs.e10 / pm25aqi_obs.count);
+        pm25aqi_obs.e25  = (pm25aqi_obs.e25 / pm25aqi_obs.count);
+        pm25aqi_obs.e100 = (pm25aqi_obs.e100 / pm25aqi_obs.count); 
       }
-    }
-    Output("AQS:SLEEP");
-    digitalWrite(OP2_PIN, LOW); // Put to Sleep Air Quality Sensor
-
-    if (pm25aqi_obs.fail_count > pm25aqi_obs.count) {
-      // Fail if half our sample reads failed. - I think this is reasonable - rjb
-      Output("AQS:FAIL");
-      pm25aqi_obs.e10 = -999;
-      pm25aqi_obs.e25 = -999;
-      pm25aqi_obs.e100 = -999;
-    }
-    else {
-      // Do average
-      Output("AQS:OK");
-      pm25aqi_obs.e10  = (pm25aqi_obs.e10 / pm25aqi_obs.count);
-      pm25aqi_obs.e25  = (pm25aqi_obs.e25 / pm25aqi_obs.count);
-      pm25aqi_obs.e100 = (pm25aqi_obs.e100 / pm25aqi_obs.count); 
-    }
+      break;
   }
 }
 
+/* 
+ *=======================================================================================================================
+ * lps_begin() - LPS35HW Pressure and Temperature initialize, n is 1 or 2
+ *   1st (I2C ADDRESS = 0x5D), 2nd (I2C ADDRESS = 0x5C). begin_I2C() allocates, call once per sensor.
+ *=======================================================================================================================
+ */
+void lps_begin(int n) {
+  Adafruit_LPS35HW &lps = (n == 1) ? lps1 : lps2;
+  bool &exists          = (n == 1) ? LPS_1_exists : LPS_2_exists;
+
+  if (!lps.begin_I2C((n == 1) ? LPS_ADDRESS_1 : LPS_ADDRESS_2, &Wire)) {
+    sprintf (Buffer32Bytes, "LPS%d NF", n);
+    exists = false;
+  }
+  else {
+    BARO_Continuous((n == 1) ? &lps1_baro : &lps2_baro);
+    exists = true;
+    sprintf (Buffer32Bytes, "LPS%d OK", n);
+  }
+  Output (Buffer32Bytes);
+}
+
 /* 
  *=======================================================================================================================
  * lps_initialize() - LPS35HW Pressure and Temperature initialize
@@ -1145,36 +1081,37 @@ void pm25aqi_TakeReading_AQS() {
  */
 void lps_initialize() {
   Output("LPS:INIT");
-  
-  // 1st LPS I2C Pressure/Temperature Sensor (I2C ADDRESS = 0x5D)
-  lps1 = Adafruit_LPS35HW();
-  if (!lps1.begin_I2C(LPS_ADDRESS_1, &Wire)) {
-    msgp = (char *) "LPS1 NF";
-    LPS_1_exists = false;
+  lps_begin(1);
+  lps_begin(2);
+}
+
+/* 
+ *=======================================================================================================================
+ * sensor_reinitialize() - Reapply the configuration a sensor loses if a bus glitch reset it
+ *   Called by I2C_Service() after repeated failures at the address. Sensors read single shot keep no
+ *   configuration and have nothing to redo. The library begin() functions allocate, so are not called again.
+ *=======================================================================================================================
+ */
+void sensor_reinitialize(uint8_t addr) {
+  if (BMX_1_exists && (addr == BMX_ADDRESS_1)) {
+    BARO_Continuous(&bmx1_baro);
   }
-  else {
-    [[maybe_unused]] float t,p;
-    t = lps1.readTemperature();
-    p = lps1.readPressure();
-    LPS_1_exists = true;
-    msgp = (char *) "LPS1 OK";
+  if (BMX_2_exists && (addr == BMX_ADDRESS_2)) {
+    BARO_Continuous(&bmx2_baro);
   }
-  Output (msgp);
-
-  // 2nd LPS I2C Pressure/Temperature Sensor (I2C ADDRESS = 0x5C)
-  lps2 = Adafruit_LPS35HW();
-  if (!lps2.begin_I2C(LPS_ADDRESS_2, &Wire)) {
-    msgp = (char *) "LPS2 NF";
-    LPS_2_exists = false;
+  if (LPS_1_exists && (addr == LPS_ADDRESS_1)) {
+    BARO_Continuous(&lps1_baro);
   }
-  else {
-    [[maybe_unused]] float t,p;
-    t = lps2.readTemperature();
-    p = lps2.readPressure();
-    LPS_2_exists = true;
-    msgp = (char *) "LPS2 OK";
+  if (LPS_2_exists && (addr == LPS_ADDRESS_2)) {
+    BARO_Continuous(&lps2_baro);
+  }
+  if (VEML7700_exists && (addr == VEML7700_ADDRESS)) {
+    LUX_Restore();
+  }
+  if ((addr >= 0x44) && (addr <= 0x47) && (i2c_44_47_sensors[addr-0x44].type == SENSOR_BMP581)) {
+    BARO_STR baro = {BARO_BMP5XX, &i2c_44_47_sensors[addr-0x44].bmp5};
+    BARO_Continuous(&baro);
   }
-  Output (msgp);
 }
 
 /* 
@@ -1240,6 +1177,7 @@ void mslp_initialize() {
     Output ("MSLP:OK");
   }
   else {
+    MSLP_exists = false;
     Output ("MSLP:NF");
   }
 }
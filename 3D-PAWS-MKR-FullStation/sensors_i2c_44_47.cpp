@@ -6,10 +6,13 @@
 #include "include/qc.h"
 #include "include/sensors.h"
 #include "include/sensors_i2c_44_47.h"
+#include "include/baro.h"
 #include "include/support.h"
 #include "include/output.h"
 #include "include/obs.h"
 #include "include/main.h"
+#include "include/th.h"
+#include "include/i2c.h"
 
 /*
  * ======================================================================================================================
@@ -35,6 +38,7 @@ float sht1_temp = 0.0;
  * =======================================================================================================================
  */
 bool readBytes(uint8_t addr, uint8_t *buf, size_t len, uint16_t timeoutMs = 1000) {
+  I2C_Clock(addr);
   Wire.requestFrom(addr, (uint8_t)len);
   unsigned long start = millis();
   size_t i = 0;
@@ -52,6 +56,7 @@ bool readBytes(uint8_t addr, uint8_t *buf, size_t len, uint16_t timeoutMs = 1000
  * =======================================================================================================================
  */
 bool sht31_probe(uint8_t addr) {
+  I2C_Clock(addr);
   Wire.beginTransmission(addr);
   Wire.write(0x37);
   Wire.write(0x80);
@@ -86,6 +91,7 @@ bool sht45_probe() {
  * =======================================================================================================================
  */
 bool bmp581_probe(uint8_t addr) {
+  I2C_Clock(addr);
   Wire.beginTransmission(addr);
   Wire.write(0x01);                    // CHIP_ID register = 0x50
   if (Wire.endTransmission(false) != 0) return false;
@@ -103,6 +109,7 @@ bool bmp581_probe(uint8_t addr) {
  * =======================================================================================================================
  */
 bool hdc302x_probe(uint8_t addr) {
+  I2C_Clock(addr);
   Wire.beginTransmission(addr);
   Wire.write(0x37);
   Wire.write(0x81);
@@ -191,6 +198,7 @@ uint32_t readSHT31SerialNumber(uint8_t i2cAddr) {
   const uint16_t READ_SERIAL_CMD = 0x3780;
 
   // 1. Send the command
+  I2C_Clock(i2cAddr);
   Wire.beginTransmission(i2cAddr);
   Wire.write(highByte(READ_SERIAL_CMD));
   Wire.write(lowByte(READ_SERIAL_CMD));
@@ -287,6 +295,21 @@ void sht4_detail(int idx) {
   }
 }
 
+/* 
+ *=======================================================================================================================
+ * sensor_i2c_44_47_name() - Type name of the sensor in the slot, nullptr if none
+ *=======================================================================================================================
+ */
+const char *sensor_i2c_44_47_name(int idx) {
+  switch (i2c_44_47_sensors[idx].type) {
+    case SENSOR_SHT31:   return ("SHT31");
+    case SENSOR_SHT45:   return ("SHT45");
+    case SENSOR_BMP581:  return ("BMP581");
+    case SENSOR_HDC302X: return ("HDC302X");
+    default: return (nullptr);
+  }
+}
+
 /* 
  *=======================================================================================================================
  * sensor_i2c_44_47_info() - 
@@ -295,15 +318,7 @@ void sht4_detail(int idx) {
 void sensor_i2c_44_47_info(char *rest, int size, const char *&comma) {
   for (uint8_t addr = 0x44; addr <= 0x47; addr++) {
     int idx = addr - 0x44;
-    const char *name = nullptr;
-
-    switch (i2c_44_47_sensors[idx].type) {
-      case SENSOR_SHT31:   name = "SHT31";   break;
-      case SENSOR_SHT45:   name = "SHT45";   break;
-      case SENSOR_BMP581:  name = "BMP581";  break;
-      case SENSOR_HDC302X: name = "HDC302X";  break;
-      default: break;
-    }
+    const char *name = sensor_i2c_44_47_name(idx);
 
     if (name) {
       int used = strlen(rest);
@@ -347,8 +362,7 @@ void sensor_i2c_44_47_statmon(int idx, char *buf) {
   switch (i2c_44_47_sensors[idx].type) {
     case SENSOR_SHT31: {
       Adafruit_SHT31 &sht3 = i2c_44_47_sensors[idx].sht3; // Create a Alias
-      t = sht3.readTemperature();
-      h = sht3.readHumidity();
+      sht3.readBoth(&t, &h);  // One conversion for both, NAN on error
       t = (isnan(t) || (t < QC_MIN_T)  || (t > QC_MAX_T))  ? QC_ERR_T  : t;
       h = (isnan(h) || (h < QC_MIN_RH) || (h > QC_MAX_RH)) ? QC_ERR_RH : h;
       sprintf (buf, "SHT31-%d T%.2f H%.2f", id, t, h);
@@ -366,9 +380,8 @@ void sensor_i2c_44_47_statmon(int idx, char *buf) {
       break;
     }
     case SENSOR_BMP581:{
-      Adafruit_BMP5xx &bmp5 = i2c_44_47_sensors[idx].bmp5;
-      t = bmp5.readTemperature();
-      p = bmp5.readPressure();
+      BARO_STR baro = {BARO_BMP5XX, &i2c_44_47_sensors[idx].bmp5};
+      BARO_Read(&baro, p, t, h);  // Latest result of the continuous conversion
       t = (isnan(t) || (t < QC_MIN_T)  || (t > QC_MAX_T))  ? QC_ERR_T  : t;
       p = (isnan(p) || (p < QC_MIN_P)  || (p > QC_MAX_P))  ? QC_ERR_P  : p;
       sprintf (buf, "BMP5-%d T%.2f P%.2f", id, t, p);
@@ -406,16 +419,15 @@ void sensor_i2c_44_47_obs_do(int &sidx) {
 
     switch (i2c_44_47_sensors[idx].type) {
       case SENSOR_SHT31 : {
-        Adafruit_SHT31 &sht3 = i2c_44_47_sensors[idx].sht3; // Create a Alias
         int id = i2c_44_47_sensors[idx].id;
         float t = 0.0;
         float h = 0.0;
 
-        // SHT3 Temperature
+        // SHT3 Temperature, measured by TH_Trigger() and TH_Collect()
         sprintf (Buffer32Bytes, "st%d", id);
         strcpy (obs.sensor[sidx].id, Buffer32Bytes);
         obs.sensor[sidx].type = F_OBS;
-        t = sht3.readTemperature();
+        t = th_result[idx].t;
         t = (isnan(t) || (t < QC_MIN_T)  || (t > QC_MAX_T))  ? QC_ERR_T  : t;
         obs.sensor[sidx].f_obs = t;
         obs.sensor[sidx++].inuse = true;
@@ -424,7 +436,7 @@ void sensor_i2c_44_47_obs_do(int &sidx) {
         sprintf (Buffer32Bytes, "sh%d", id);
         strcpy (obs.sensor[sidx].id, Buffer32Bytes);
         obs.sensor[sidx].type = F_OBS;
-        h = sht3.readHumidity();
+        h = th_result[idx].h;
         h = (isnan(h) || (h < QC_MIN_RH) || (h > QC_MAX_RH)) ? QC_ERR_RH : h;
         obs.sensor[sidx].f_obs = h;
         obs.sensor[sidx++].inuse = true;
@@ -439,15 +451,10 @@ void sensor_i2c_44_47_obs_do(int &sidx) {
       }
 
       case SENSOR_SHT45 : {
-        Adafruit_SHT4x &sht4 = i2c_44_47_sensors[idx].sht4;  // Create a Alias
         int id = i2c_44_47_sensors[idx].id;
-        sensors_event_t humidity, temp;
-        float t=0.0;
-        float h=0.0;
+        float t = th_result[idx].t;   // Measured by TH_Trigger() and TH_Collect()
+        float h = th_result[idx].h;
 
-        sht4.getEvent(&humidity, &temp);// populate temp and humidity objects with fresh data
-        t = temp.temperature;
-        h = humidity.relative_humidity;
         t = (isnan(t) || (t < QC_MIN_T)  || (t > QC_MAX_T))  ? QC_ERR_T  : t;
         h = (isnan(h) || (h < QC_MIN_RH) || (h > QC_MAX_RH)) ? QC_ERR_RH : h;
 
@@ -475,13 +482,11 @@ void sensor_i2c_44_47_obs_do(int &sidx) {
       }
 
       case SENSOR_BMP581 : {
-        Adafruit_BMP5xx &bmp5 = i2c_44_47_sensors[idx].bmp5;
+        BARO_STR baro = {BARO_BMP5XX, &i2c_44_47_sensors[idx].bmp5};
         int id = i2c_44_47_sensors[idx].id;
-        float t=0.0;
-        float p=0.0;
+        float t, p, h;
 
-        t = bmp5.readTemperature();
-        p = bmp5.readPressure();
+        BARO_Read(&baro, p, t, h);  // Latest result of the continuous conversion
         t = (isnan(t) || (t < QC_MIN_T)  || (t > QC_MAX_T))  ? QC_ERR_T  : t;
         p = (isnan(p) || (p < QC_MIN_P)  || (p > QC_MAX_P))  ? QC_ERR_P  : p;
 
@@ -507,12 +512,13 @@ void sensor_i2c_44_47_obs_do(int &sidx) {
       }
 
       case SENSOR_HDC302X : {
-        Adafruit_HDC302x &hdc = i2c_44_47_sensors[idx].hdc; // Create a Alias
         int id = i2c_44_47_sensors[idx].id;
         double t = -999.9;
         double h = -999.9;
 
-        if (hdc.readTemperatureHumidityOnDemand(t, h, TRIGGERMODE_LP0)) {
+        if (th_result[idx].ok) {  // Measured by TH_Trigger() and TH_Collect()
+          t = th_result[idx].t;
+          h = th_result[idx].h;
           t = (isnan(t) || (t < QC_MIN_T)  || (t > QC_MAX_T))  ? QC_ERR_T  : t;
           h = (isnan(h) || (h < QC_MIN_RH) || (h > QC_MAX_RH)) ? QC_ERR_RH : h;
         }
@@ -548,124 +554,167 @@ void sensor_i2c_44_47_obs_do(int &sidx) {
 
 /*
  * ======================================================================================================================
- * sensor_initialize_i2c_44_47() - 
+ * i2c_44_47_next_id() - Next obs tag id for the sensor family, ids of sensors gone offline stay taken
  * =======================================================================================================================
  */
-void sensor_initialize_i2c_44_47() {
-  Output ("INIT I2C 44-47");
-
-  int hd_count=0;   // obs tags hdt# hdh#
-  int s_count=0;    // obs tags st# sh#
-  int bmp_count=0;  // obs tags bt# bp# bh#
+int i2c_44_47_next_id(int idx, bool sht, bool hdc, bool bmp) {
+  int id = 0;
+
+  for (int i = 0; i < I2C_44_47_SENSOR_COUNT; i++) {
+    I2C_44_47_SENSOR_TYPE type = i2c_44_47_sensors[i].begun;
+    if ((i != idx) && (i2c_44_47_sensors[i].id > id) &&
+        ((sht && ((type == SENSOR_SHT31) || (type == SENSOR_SHT45))) ||
+         (hdc && (type == SENSOR_HDC302X)) ||
+         (bmp && (type == SENSOR_BMP581)))) {
+      id = i2c_44_47_sensors[i].id;
+    }
+  }
+  return (id+1);
+}
 
-  for (uint8_t addr = 0x44; addr <= 0x47; addr++) {
-    int idx = addr - 0x44;
+/*
+ * ======================================================================================================================
+ * sensor_i2c_44_47_begin() - Find the sensor type at the address and start it. Also used to bring a sensor back
+ *   online, the same type back at the address keeps its obs tag id.
+ * =======================================================================================================================
+ */
+void sensor_i2c_44_47_begin(uint8_t addr) {
+  int idx = addr - 0x44;
+  I2C_44_47_SENSOR_TYPE type = i2c_scan_sensor_type(addr);
+  bool same = (type != SENSOR_UNKNOWN) && (type == i2c_44_47_sensors[idx].begun);
+  int id = i2c_44_47_sensors[idx].id;
+
+  i2c_44_47_sensors[idx].type = type;
+  i2c_44_47_sensors[idx].i2c_address = addr;
+
+  switch (type) {
+    case SENSOR_SHT31 : {
+      if (!same) {
+        id = i2c_44_47_next_id(idx, true, false, false);   // obs tags st# sh#
+      }
+      Adafruit_SHT31 &sht3 = i2c_44_47_sensors[idx].sht3;  // Create a Alias 
+      if (!sht3.begin(addr)) {
+        sprintf (Buffer32Bytes, " Init SHT(%d) ERR", id);
+      }
+      else {
+        sprintf (Buffer32Bytes, " Init SHT(%d) OK", id);
+      }
+      Output (Buffer32Bytes);
+      snprintf (i2c_44_47_sensors[idx].sn, I2C_44_77_SN_LEN, "%lX", readSHT31SerialNumber(addr));
+      sht3_detail(idx);
+      if (id==1) {
+        SHT_1_exists = true;
+      }
+      break;
+    }
+    case SENSOR_SHT45 : {
+      if (!same) {
+        id = i2c_44_47_next_id(idx, true, false, false);   // obs tags st# sh#
+      }
+      Adafruit_SHT4x &sht4 = i2c_44_47_sensors[idx].sht4;  // Create a Alias 
+      if (!sht4.begin()) {
+        sprintf (Buffer32Bytes, " Init SHT(%d) ERR", id);
+        Output (Buffer32Bytes);
+      }
+      else {
+        sprintf (Buffer32Bytes, " Init SHT(%d) OK", id);
+        Output (Buffer32Bytes);
 
-    i2c_44_47_sensors[idx].type = i2c_scan_sensor_type(addr);
-    i2c_44_47_sensors[idx].i2c_address = addr;
+        // You can have 3 different precisions, higher precision takes longer
+        sht4.setPrecision(SHT4X_HIGH_PRECISION);
 
-    switch (i2c_44_47_sensors[idx].type) {
-      case SENSOR_SHT31 : {
-        s_count++;
-        i2c_44_47_sensors[idx].id = s_count;
-        Adafruit_SHT31 &sht3 = i2c_44_47_sensors[idx].sht3;  // Create a Alias 
-        if (!sht3.begin(addr)) {
-          sprintf (Buffer32Bytes, " Init SHT(%d) ERR", s_count);
-        }
-        else {
-          sprintf (Buffer32Bytes, " Init SHT(%d) OK", s_count);
-        }
-        Output (Buffer32Bytes);
-        snprintf (i2c_44_47_sensors[idx].sn, I2C_44_77_SN_LEN, "%lX", readSHT31SerialNumber(addr));
-        sht3_detail(idx);
-        if (s_count==1) {
+        // You can have 6 different heater settings
+        // higher heat and longer times uses more power
+        // and reads will take longer too!
+        sht4.setHeater(SHT4X_NO_HEATER);
+        snprintf (i2c_44_47_sensors[idx].sn, I2C_44_77_SN_LEN, "%lX", sht4.readSerial());
+        sht4_detail(idx);
+        if (id==1) {
           SHT_1_exists = true;
         }
-        break;
       }
-      case SENSOR_SHT45 : {
-        s_count++;
-        i2c_44_47_sensors[idx].id = s_count;
-        Adafruit_SHT4x &sht4 = i2c_44_47_sensors[idx].sht4;  // Create a Alias 
-        if (!sht4.begin()) {
-          sprintf (Buffer32Bytes, " Init SHT(%d) ERR", s_count);
-          Output (Buffer32Bytes);
-        }
-        else {
-          sprintf (Buffer32Bytes, " Init SHT(%d) OK", s_count);
-          Output (Buffer32Bytes);
+      break;
+    }
+    case SENSOR_BMP581 : {
+      Adafruit_BMP5xx &bmp5 = i2c_44_47_sensors[idx].bmp5;
+      BARO_STR baro = {BARO_BMP5XX, &bmp5};
 
-          // You can have 3 different precisions, higher precision takes longer
-          sht4.setPrecision(SHT4X_HIGH_PRECISION);
-
-          // You can have 6 different heater settings
-          // higher heat and longer times uses more power
-          // and reads will take longer too!
-          sht4.setHeater(SHT4X_NO_HEATER);
-          snprintf (i2c_44_47_sensors[idx].sn, I2C_44_77_SN_LEN, "%lX", sht4.readSerial());
-          sht4_detail(idx);
-          if (s_count==1) {
-            SHT_1_exists = true;
-          }
-        }
+      if (same) {
+        // begin() allocates, the sensor only needs its configuration back
+        BARO_Continuous(&baro);
+        sprintf (Buffer32Bytes, " Init BMP(%d) OK", id);
+        Output (Buffer32Bytes);
         break;
       }
-      case SENSOR_BMP581 : {
-        // Allow the bmp581 to be bmp1 or bmp2 tags. Otherwise it becomes 3,4
-        if (!BMX_1_exists && (bmp_count==0)) {
-          i2c_44_47_sensors[idx].id=1;
-          bmp_count=1;
-        }
-        else if (!BMX_2_exists && (bmp_count<2)) {
-          i2c_44_47_sensors[idx].id=2;
-          bmp_count=2;
-        }
-        else {
-          if (!bmp_count) {
-            bmp_count=2;  // we got here because BMX_1&2_exists, so we need to be 3 or more for the tag id
-          }
-          bmp_count++;
-          i2c_44_47_sensors[idx].id=bmp_count;
-        }
-        Adafruit_BMP5xx &bmp5 = i2c_44_47_sensors[idx].bmp5;
-        if (!bmp5.begin(addr, &Wire)) { 
-          sprintf (Buffer32Bytes, " Init BMP(%d) ERR", bmp_count);
-          Output (Buffer32Bytes);
-        }
-        else {
-          sprintf (Buffer32Bytes, " Init BMP(%d) OK", bmp_count);
-          Output (Buffer32Bytes);
-          // Configure sensor for optimal performance
-          bmp5.setTemperatureOversampling(BMP5XX_OVERSAMPLING_2X);
-          bmp5.setPressureOversampling(BMP5XX_OVERSAMPLING_16X);
-          bmp5.setIIRFilterCoeff(BMP5XX_IIR_FILTER_COEFF_3);
-          bmp5.setOutputDataRate(BMP5XX_ODR_50_HZ);
-          bmp5.setPowerMode(BMP5XX_POWERMODE_NORMAL);
-
-          bmp5.readPressure();
-        }
-        break;
+
+      // Allow the bmp581 to be bmp1 or bmp2 tags. Otherwise it becomes 3,4 (obs tags bt# bp# bh#)
+      id = i2c_44_47_next_id(idx, false, false, true);
+      if ((id == 1) && BMX_1_exists) {
+        id = 2;
       }
-      case SENSOR_HDC302X : {
-        hd_count++;
-        i2c_44_47_sensors[idx].id = hd_count;
-        Adafruit_HDC302x &hdc = i2c_44_47_sensors[idx].hdc; // Create a Alias
-        if (!hdc.begin(addr, &Wire)) {
-          sprintf (Buffer32Bytes, " Init HDC(%d) ERR", hd_count);
-        }
-        else {
-          double t,h;
-          hdc.readTemperatureHumidityOnDemand(t, h, TRIGGERMODE_LP0);
-          sprintf (Buffer32Bytes, " Init HDC(%d) OK", hd_count);
-        }
+      if ((id == 2) && BMX_2_exists) {
+        id = 3;
+      }
+      if (!bmp5.begin(addr, &Wire)) { 
+        sprintf (Buffer32Bytes, " Init BMP(%d) ERR", id);
         Output (Buffer32Bytes);
-        break;
       }
-      case SENSOR_UNKNOWN :
-      default : {
-        i2c_44_47_sensors[idx].id = 0;
-        break;
+      else {
+        sprintf (Buffer32Bytes, " Init BMP(%d) OK", id);
+        Output (Buffer32Bytes);
+        BARO_Continuous(&baro);
       }
+      break;
     }
+    case SENSOR_HDC302X : {
+      if (!same) {
+        id = i2c_44_47_next_id(idx, false, true, false);   // obs tags hdt# hdh#
+      }
+      Adafruit_HDC302x &hdc = i2c_44_47_sensors[idx].hdc; // Create a Alias
+      if (!hdc.begin(addr, &Wire)) {
+        sprintf (Buffer32Bytes, " Init HDC(%d) ERR", id);
+      }
+      else {
+        double t,h;
+        hdc.readTemperatureHumidityOnDemand(t, h, TRIGGERMODE_LP0);
+        sprintf (Buffer32Bytes, " Init HDC(%d) OK", id);
+      }
+      Output (Buffer32Bytes);
+      break;
+    }
+    case SENSOR_UNKNOWN :
+    default : {
+      return;                                              // Keep the id and type of a sensor that was here
+    }
+  }
+  i2c_44_47_sensors[idx].id = id;
+  i2c_44_47_sensors[idx].begun = type;
+}
+
+/*
+ * ======================================================================================================================
+ * sensor_i2c_44_47_offline() - Stop using the sensor at the address, its id and type are kept for its return
+ * =======================================================================================================================
+ */
+void sensor_i2c_44_47_offline(uint8_t addr) {
+  int idx = addr - 0x44;
+
+  if (((i2c_44_47_sensors[idx].type == SENSOR_SHT31) || (i2c_44_47_sensors[idx].type == SENSOR_SHT45)) &&
+      (i2c_44_47_sensors[idx].id == 1)) {
+    SHT_1_exists = false;
   }
-}
\ No newline at end of file
+  i2c_44_47_sensors[idx].type = SENSOR_UNKNOWN;
+}
+
+/*
+ * ======================================================================================================================
+ * sensor_initialize_i2c_44_47() - 
+ * =======================================================================================================================
+ */
+void sensor_initialize_i2c_44_47() {
+  Output ("INIT I2C 44-47");
+
+  for (uint8_t addr = 0x44; addr <= 0x47; addr++) {
+    sensor_i2c_44_47_begin(addr);
+  }
+}
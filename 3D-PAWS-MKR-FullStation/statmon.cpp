@@ -9,6 +9,7 @@
 #include "include/mkrboard.h"
 #include "include/sensors_i2c_44_47.h"
 #include "include/sensors.h"
+#include "include/lux.h"
 #include "include/wrda.h"
 #include "include/cf.h"
 #include "include/output.h"
@@ -56,11 +57,11 @@ void StationMonitor() {
     sprintf (msgbuf+strlen(msgbuf), "D:NF  S:NF");
   }
   
+  Rain_Drain();
   if (cf_rg1_enable) {
     sprintf (msgbuf+strlen(msgbuf), " R1:%02d", raingauge1_interrupt_count); 
     raingauge1_interrupt_count = 0;
     raingauge1_interrupt_stime = millis();
-    raingauge1_interrupt_ltime = 0;
   }
   else {
     sprintf (msgbuf+strlen(msgbuf), " R1:ND");
@@ -70,7 +71,6 @@ void StationMonitor() {
     sprintf (msgbuf+strlen(msgbuf), " 2:%02d", raingauge2_interrupt_count);
     raingauge2_interrupt_count = 0;
     raingauge2_interrupt_stime = millis();
-    raingauge2_interrupt_ltime = 0;
   }
   else {
     sprintf (msgbuf+strlen(msgbuf), " 2:ND");
@@ -86,8 +86,7 @@ void StationMonitor() {
   memset(msgbuf, 0, sizeof(msgbuf));
 
   if ((cf_op1 == OP1_STATE_DIST_5M) || (cf_op1 == OP1_STATE_DIST_10M)) {
-    float ds = DS_Median();
-    sprintf (msgbuf+strlen(msgbuf), "D:%4d %d", DS_Median(), anemometer_interrupt_count);
+    sprintf (msgbuf+strlen(msgbuf), "D:%4d %d", (int) DS_Median(), anemometer_interrupt_count);
   }
   else {
     sprintf (msgbuf+strlen(msgbuf), "D! W:%d", anemometer_interrupt_count);
@@ -167,8 +166,8 @@ void StationMonitor() {
 
   if (cycle == 8) {   
     if (HTU21DF_exists) {
-      float htu_humid = htu.readHumidity();
-      float htu_temp = htu.readTemperature();
+      float htu_humid, htu_temp;
+      htu.readBoth(&htu_temp, &htu_humid);
 
       sprintf (msgbuf, "HTU H:%0.2f T:%0.2f", htu_humid, htu_temp);
     }
@@ -179,7 +178,7 @@ void StationMonitor() {
 
   if (cycle == 9) {   
     if (VEML7700_exists) {
-      float lux = veml.readLux(VEML_LUX_AUTO);
+      float lux = LUX_VEML();
       lux = (isnan(lux)) ? 0.0 : lux;
         sprintf (msgbuf, "LX L%.2f", lux);
     }
@@ -216,13 +215,23 @@ void StationMonitor() {
     }
   }
 
+  if (cycle == 12) {
+    if (!cf_nowind) {
+      sprintf (msgbuf, "W%.1f %d G%.1f %d", 
+        Wind_SpeedAverage(), Wind_DirectionVector(), Wind_Gust(), Wind_GustDirection());
+    }
+    else {
+      sprintf (msgbuf, "WIND NE");
+    }
+  }
+
   len = (strlen (msgbuf) > 21) ? 21 : strlen (msgbuf);
   for (c=0; c<=len; c++) oled_lines [3][c] = *(msgbuf+c);
   Serial_writeln (msgbuf);
 
   // Give the use some time to read line 3 before changing
   if (count++ >= 5) {
-    cycle = ++cycle % 12; // << +1
+    cycle = ++cycle % 13; // << +1
     count = 0;
   }
   
@@ -10,6 +10,7 @@
 #include "include/mkrboard.h"
 #include "include/output.h"
 #include "include/main.h"
+#include "include/i2c.h"
 #include "include/support.h"
 
 /*
@@ -29,7 +30,8 @@
 bool I2C_Device_Exist(byte address) {
   byte error;
 
-  Wire.begin();                     // Connect to I2C as Master (no addess is passed to signal being a slave)
+  // Wire.begin() is done once in I2C_Begin()
+  I2C_Clock(address);
 
   Wire.beginTransmission(address);  // Begin a transmission to the I2C slave device with the given address. 
                                     // Subsequently, queue bytes for transmission with the write() function 
@@ -108,35 +110,6 @@ void FadeOff(unsigned int time,int decreament){
   }
 }
 
-/*
- * ======================================================================================================================
- * myswap()
- * ======================================================================================================================
- */
-void myswap(unsigned int *p, unsigned int *q) {
-  int t;
-   
-  t=*p; 
-  *p=*q; 
-  *q=t;
-}
-
-/*
- * ======================================================================================================================
- * mysort()
- * ======================================================================================================================
- */
-void mysort(unsigned int a[], unsigned int n) { 
-  unsigned int i, j;
-
-  for(i = 0;i < n-1;i++) {
-    for(j = 0;j < n-i-1;j++) {
-      if(a[j] > a[j+1])
-        myswap(&a[j],&a[j+1]);
-    }
-  }
-}
-
 /*
  * =======================================================================================================================
  * isnumeric() - check if string contains all digits
@@ -362,3 +335,18 @@ bool json_to_get_string_inplace(const char *cf_urlpath, char *obs) {
   return true;
 }
 
+
+/*
+ * ======================================================================================================================
+ * crc16_ccitt() - CRC-16/CCITT-FALSE, polynomial 0x1021, start with crc = 0xFFFF. Can be run over pieces in turn.
+ * ======================================================================================================================
+ */
+uint16_t crc16_ccitt(uint16_t crc, const uint8_t *data, size_t len) {
+  while (len--) {
+    crc ^= (uint16_t)(*data++) << 8;
+    for (int i=0; i<8; i++) {
+      crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+    }
+  }
+  return (crc);
+}
@@ -0,0 +1,203 @@
+/*
+ * ======================================================================================================================
+ * th.cpp - Temperature and Humidity Measurement Scheduler
+ * ======================================================================================================================
+ */
+#include <Arduino.h>
+
+#include "include/output.h"
+#include "include/sensors.h"
+#include "include/sensors_i2c_44_47.h"
+#include "include/i2c.h"
+#include "include/th.h"
+
+/*
+ * ======================================================================================================================
+ * Variables and Data Structures
+ * =======================================================================================================================
+ */
+TH_RESULT_STR th_result[TH_DEVICES];
+
+/*
+ * ======================================================================================================================
+ * Fuction Definations
+ * =======================================================================================================================
+ */
+
+/*
+ * ======================================================================================================================
+ * TH_CRC8() - CRC-8 polynomial 0x31, Sensirion starts with 0xFF, HTU21DF with 0x00
+ * ======================================================================================================================
+ */
+uint8_t TH_CRC8(uint8_t crc, const uint8_t *data, int len) {
+  while (len--) {
+    crc ^= *data++;
+    for (int i = 0; i < 8; i++) {
+      crc = (crc & 0x80) ? ((crc << 1) ^ 0x31) : (crc << 1);
+    }
+  }
+  return (crc);
+}
+
+/*
+ * ======================================================================================================================
+ * TH_Start() - Send a measurement command, the HIH8 measurement request has no command bytes
+ * ======================================================================================================================
+ */
+void TH_Start(int dev, uint8_t addr, const uint8_t *cmd, int len, unsigned long conversion_ms) {
+  th_result[dev].triggered = (I2C_Write(addr, cmd, len) == I2C_OK);
+  th_result[dev].ready_ms = millis() + conversion_ms;
+}
+
+/*
+ * ======================================================================================================================
+ * TH_Read() - Read len bytes of a finished conversion
+ * ======================================================================================================================
+ */
+bool TH_Read(uint8_t addr, uint8_t *buf, int len) {
+  return (I2C_Read(addr, buf, len) == len);
+}
+
+/*
+ * ======================================================================================================================
+ * TH_ReadSensirion() - SHT3x, SHT4x and HDC302x, temperature and humidity words each followed by a CRC
+ * ======================================================================================================================
+ */
+void TH_ReadSensirion(int dev, uint8_t addr, I2C_44_47_SENSOR_TYPE type) {
+  TH_RESULT_STR *r = &th_result[dev];
+  uint8_t buf[6];
+  uint16_t rt, rh;
+
+  if (!r->triggered || !TH_Read(addr, buf, 6) ||
+      (TH_CRC8(0xFF, buf, 2) != buf[2]) || (TH_CRC8(0xFF, buf+3, 2) != buf[5])) {
+    return;
+  }
+  rt = ((uint16_t)buf[0] << 8) | buf[1];
+  rh = ((uint16_t)buf[3] << 8) | buf[4];
+
+  r->t = -45.0 + 175.0 * rt / 65535.0;
+  if (type == SENSOR_SHT45) {
+    r->h = constrain(-6.0 + 125.0 * rh / 65535.0, 0.0, 100.0);
+  }
+  else {
+    r->h = 100.0 * rh / 65535.0;
+  }
+  r->ok = true;
+}
+
+/*
+ * ======================================================================================================================
+ * TH_ReadHTU() - HTU21DF 14 bit result with the 2 status bits cleared, false on read or CRC error
+ * ======================================================================================================================
+ */
+bool TH_ReadHTU(uint16_t *raw) {
+  uint8_t buf[3];
+
+  if (!TH_Read(HTU21DF_I2CADDR, buf, 3) || (TH_CRC8(0x00, buf, 2) != buf[2])) {
+    return (false);
+  }
+  *raw = (((uint16_t)buf[0] << 8) | buf[1]) & 0xFFFC;
+  return (true);
+}
+
+/*
+ * ======================================================================================================================
+ * TH_Trigger() - Start a single shot conversion on every T/RH sensor
+ * ======================================================================================================================
+ */
+void TH_Trigger() {
+  static const uint8_t sht3x_cmd[] = {0x24, 0x00};   // High repeatability, no clock stretching
+  static const uint8_t sht4x_cmd[] = {0xFD};         // High precision, no heater
+  static const uint8_t hdc302x_cmd[] = {0x24, 0x00}; // Trigger on demand, low power mode 0
+  static const uint8_t htu21df_cmd[] = {0xF3};       // Temperature, no hold master
+
+  for (int dev = 0; dev < TH_DEVICES; dev++) {
+    th_result[dev].triggered = false;
+    th_result[dev].ok = false;
+    th_result[dev].t = NAN;
+    th_result[dev].h = NAN;
+  }
+
+  for (int idx = 0; idx < I2C_44_47_SENSOR_COUNT; idx++) {
+    uint8_t addr = i2c_44_47_sensors[idx].i2c_address;
+
+    switch (i2c_44_47_sensors[idx].type) {
+      case SENSOR_SHT31 :
+        TH_Start(idx, addr, sht3x_cmd, sizeof(sht3x_cmd), TH_SHT3X_MS);
+        break;
+      case SENSOR_SHT45 :
+        TH_Start(idx, addr, sht4x_cmd, sizeof(sht4x_cmd), TH_SHT4X_MS);
+        break;
+      case SENSOR_HDC302X :
+        TH_Start(idx, addr, hdc302x_cmd, sizeof(hdc302x_cmd), TH_HDC302X_MS);
+        break;
+      default :
+        break;
+    }
+  }
+
+  if (HTU21DF_exists) {
+    TH_Start(TH_HTU21DF, HTU21DF_I2CADDR, htu21df_cmd, sizeof(htu21df_cmd), TH_HTU21DF_T_MS);
+  }
+
+  if (HIH8_exists) {
+    TH_Start(TH_HIH8, HIH8000_ADDRESS, NULL, 0, TH_HIH8_MS);
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * TH_Collect() - Wait once for the longest conversion still running, then read every triggered sensor
+ * ======================================================================================================================
+ */
+void TH_Collect() {
+  static const uint8_t htu21df_cmd[] = {0xF5};       // Humidity, no hold master
+  long wait_ms = 0, remaining;
+  uint16_t raw;
+  uint8_t buf[4];
+
+  for (int dev = 0; dev < TH_DEVICES; dev++) {
+    if (th_result[dev].triggered) {
+      remaining = (long)(th_result[dev].ready_ms - millis());
+      if (remaining > wait_ms) {
+        wait_ms = remaining;
+      }
+    }
+  }
+  if (wait_ms > 0) {
+    delay(wait_ms);
+  }
+
+  for (int idx = 0; idx < I2C_44_47_SENSOR_COUNT; idx++) {
+    switch (i2c_44_47_sensors[idx].type) {
+      case SENSOR_SHT31 :
+      case SENSOR_SHT45 :
+      case SENSOR_HDC302X :
+        TH_ReadSensirion(idx, i2c_44_47_sensors[idx].i2c_address, i2c_44_47_sensors[idx].type);
+        break;
+      default :
+        break;
+    }
+  }
+
+  if (th_result[TH_HIH8].triggered && TH_Read(HIH8000_ADDRESS, buf, 4) && ((buf[0] >> 6) == 0)) {
+    // Status 0 is a new result, 1 is stale data from the last measurement
+    th_result[TH_HIH8].h = ((((uint16_t)buf[0] << 8) | buf[1]) & 0x3FFF) * 6.10e-3;
+    th_result[TH_HIH8].t = ((((uint16_t)buf[2] << 8) | buf[3]) >> 2) * 1.007e-2 - 40.0;
+    th_result[TH_HIH8].ok = true;
+  }
+
+  if (th_result[TH_HTU21DF].triggered && TH_ReadHTU(&raw)) {
+    th_result[TH_HTU21DF].t = raw * 175.72 / 65536.0 - 46.85;
+
+    // The HTU21DF can only convert one quantity at a time
+    TH_Start(TH_HTU21DF, HTU21DF_I2CADDR, htu21df_cmd, sizeof(htu21df_cmd), TH_HTU21DF_H_MS);
+    if (th_result[TH_HTU21DF].triggered) {
+      delay(TH_HTU21DF_H_MS);
+      if (TH_ReadHTU(&raw)) {
+        th_result[TH_HTU21DF].h = raw * 125.0 / 65536.0 - 6.0;
+        th_result[TH_HTU21DF].ok = true;
+      }
+    }
+  }
+}
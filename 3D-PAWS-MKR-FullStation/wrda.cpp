@@ -18,13 +18,16 @@
 #include "include/sensors.h"
 #include "include/main.h"
 #include "include/wrda.h"
+#include "include/adc.h"
+#include "include/i2c.h"
+#include "include/i2cq.h"
 
 /*
  * ======================================================================================================================
  * Variables and Data Structures
  * =======================================================================================================================
  */
-volatile bool TurnLedOff = false;      // Set true in rain gauge interrupt
+bool TurnLedOff = false;               // Set true when a rain gauge tip is counted
 
 
 /*
@@ -32,7 +35,18 @@ volatile bool TurnLedOff = false;      // Set true in rain gauge interrupt
  *  Wind
  * ======================================================================================================================
  */
-WIND_STR wind;
+// Same state as Wind_Clear(), consistent before the first sample: 60 calm samples 0-59, all gust windows tie at 0
+WIND_STR wind = {
+  {},                                  // bucket
+  0,                                   // bucket_idx
+  WIND_READINGS-1,                     // seq
+  0, 0, 0.0, 0, 0,                     // ns_sum, ew_sum, speed_sum, angle_bad, speed_nonzero
+  {},                                  // gust_sum
+  {WIND_READINGS-1},                   // gust_dq
+  0, 1,                                // gust_dq_head, gust_dq_count
+  0.0, -1                              // gust, gust_direction
+};
+WIND_PRODUCTS_STR wind_products;
 
 /*
  * ======================================================================================================================
@@ -44,6 +58,94 @@ int       AS5600_ADR        = 0x36;
 const int AS5600_raw_ang_hi = 0x0c;
 const int AS5600_raw_ang_lo = 0x0d;
 
+// Angle read queued at the start of the 1s tasks, collected by Wind_TakeReading()
+I2CQ_XFER_STR wind_angle_xfer;
+uint8_t wind_angle_reg = AS5600_raw_ang_hi;
+uint8_t wind_angle_buf[2];
+bool wind_angle_queued = false;
+
+/*
+ * ======================================================================================================================
+ *  Wind Vector Trigonometry
+ *    Quarter wave sine table indexed by the AS5600 raw angle, sin(i * 90 / 1024 degrees) in Q15.
+ *    CORDIC arctangent table, atan(2^-i) in binary angle units where 2^32 is a full turn.
+ * ======================================================================================================================
+ */
+const int16_t wind_sin_q15[WIND_SIN_QUARTER+1] = {
+      0,    50,   101,   151,   201,   251,   302,   352,   402,   452,   503,   553,   603,   653,   704,   754,
+    804,   854,   905,   955,  1005,  1055,  1106,  1156,  1206,  1256,  1307,  1357,  1407,  1457,  1507,  1558,
+   1608,  1658,  1708,  1758,  1809,  1859,  1909,  1959,  2009,  2059,  2110,  2160,  2210,  2260,  2310,  2360,
+   2410,  2461,  2511,  2561,  2611,  2661,  2711,  2761,  2811,  2861,  2911,  2962,  3012,  3062,  3112,  3162,
+   3212,  3262,  3312,  3362,  3412,  3462,  3512,  3562,  3612,  3662,  3712,  3761,  3811,  3861,  3911,  3961,
+   4011,  4061,  4111,  4161,  4210,  4260,  4310,  4360,  4410,  4460,  4509,  4559,  4609,  4659,  4708,  4758,
+   4808,  4858,  4907,  4957,  5007,  5056,  5106,  5156,  5205,  5255,  5305,  5354,  5404,  5453,  5503,  5552,
+   5602,  5651,  5701,  5750,  5800,  5849,  5899,  5948,  5998,  6047,  6096,  6146,  6195,  6245,  6294,  6343,
+   6393,  6442,  6491,  6540,  6590,  6639,  6688,  6737,  6786,  6836,  6885,  6934,  6983,  7032,  7081,  7130,
+   7179,  7228,  7277,  7326,  7375,  7424,  7473,  7522,  7571,  7620,  7669,  7718,  7767,  7815,  7864,  7913,
+   7962,  8010,  8059,  8108,  8157,  8205,  8254,  8303,  8351,  8400,  8448,  8497,  8545,  8594,  8642,  8691,
+   8739,  8788,  8836,  8885,  8933,  8981,  9030,  9078,  9126,  9175,  9223,  9271,  9319,  9367,  9416,  9464,
+   9512,  9560,  9608,  9656,  9704,  9752,  9800,  9848,  9896,  9944,  9992, 10039, 10087, 10135, 10183, 10231,
+  10278, 10326, 10374, 10421, 10469, 10517, 10564, 10612, 10659, 10707, 10754, 10802, 10849, 10897, 10944, 10992,
+  11039, 11086, 11133, 11181, 11228, 11275, 11322, 11370, 11417, 11464, 11511, 11558, 11605, 11652, 11699, 11746,
+  11793, 11840, 11886, 11933, 11980, 12027, 12074, 12120, 12167, 12214, 12260, 12307, 12353, 12400, 12446, 12493,
+  12539, 12586, 12632, 12679, 12725, 12771, 12817, 12864, 12910, 12956, 13002, 13048, 13094, 13141, 13187, 13233,
+  13279, 13324, 13370, 13416, 13462, 13508, 13554, 13599, 13645, 13691, 13736, 13782, 13828, 13873, 13919, 13964,
+  14010, 14055, 14101, 14146, 14191, 14236, 14282, 14327, 14372, 14417, 14462, 14507, 14553, 14598, 14643, 14688,
+  14732, 14777, 14822, 14867, 14912, 14956, 15001, 15046, 15090, 15135, 15180, 15224, 15269, 15313, 15358, 15402,
+  15446, 15491, 15535, 15579, 15623, 15667, 15712, 15756, 15800, 15844, 15888, 15932, 15976, 16019, 16063, 16107,
+  16151, 16195, 16238, 16282, 16325, 16369, 16413, 16456, 16499, 16543, 16586, 16630, 16673, 16716, 16759, 16802,
+  16846, 16889, 16932, 16975, 17018, 17061, 17104, 17146, 17189, 17232, 17275, 17317, 17360, 17403, 17445, 17488,
+  17530, 17573, 17615, 17657, 17700, 17742, 17784, 17827, 17869, 17911, 17953, 17995, 18037, 18079, 18121, 18163,
+  18204, 18246, 18288, 18330, 18371, 18413, 18454, 18496, 18537, 18579, 18620, 18661, 18703, 18744, 18785, 18826,
+  18868, 18909, 18950, 18991, 19032, 19072, 19113, 19154, 19195, 19236, 19276, 19317, 19357, 19398, 19438, 19479,
+  19519, 19560, 19600, 19640, 19680, 19721, 19761, 19801, 19841, 19881, 19921, 19961, 20000, 20040, 20080, 20120,
+  20159, 20199, 20238, 20278, 20317, 20357, 20396, 20436, 20475, 20514, 20553, 20592, 20631, 20670, 20709, 20748,
+  20787, 20826, 20865, 20904, 20942, 20981, 21019, 21058, 21096, 21135, 21173, 21212, 21250, 21288, 21326, 21364,
+  21403, 21441, 21479, 21516, 21554, 21592, 21630, 21668, 21705, 21743, 21781, 21818, 21856, 21893, 21930, 21968,
+  22005, 22042, 22079, 22116, 22154, 22191, 22227, 22264, 22301, 22338, 22375, 22411, 22448, 22485, 22521, 22558,
+  22594, 22631, 22667, 22703, 22739, 22776, 22812, 22848, 22884, 22920, 22956, 22991, 23027, 23063, 23099, 23134,
+  23170, 23205, 23241, 23276, 23311, 23347, 23382, 23417, 23452, 23487, 23522, 23557, 23592, 23627, 23662, 23697,
+  23731, 23766, 23801, 23835, 23870, 23904, 23938, 23973, 24007, 24041, 24075, 24109, 24143, 24177, 24211, 24245,
+  24279, 24312, 24346, 24380, 24413, 24447, 24480, 24514, 24547, 24580, 24613, 24647, 24680, 24713, 24746, 24779,
+  24811, 24844, 24877, 24910, 24942, 24975, 25007, 25040, 25072, 25105, 25137, 25169, 25201, 25233, 25265, 25297,
+  25329, 25361, 25393, 25425, 25456, 25488, 25519, 25551, 25582, 25614, 25645, 25676, 25708, 25739, 25770, 25801,
+  25832, 25863, 25893, 25924, 25955, 25986, 26016, 26047, 26077, 26108, 26138, 26168, 26198, 26229, 26259, 26289,
+  26319, 26349, 26378, 26408, 26438, 26468, 26497, 26527, 26556, 26586, 26615, 26644, 26674, 26703, 26732, 26761,
+  26790, 26819, 26848, 26876, 26905, 26934, 26962, 26991, 27019, 27048, 27076, 27104, 27133, 27161, 27189, 27217,
+  27245, 27273, 27300, 27328, 27356, 27384, 27411, 27439, 27466, 27493, 27521, 27548, 27575, 27602, 27629, 27656,
+  27683, 27710, 27737, 27764, 27790, 27817, 27843, 27870, 27896, 27923, 27949, 27975, 28001, 28027, 28053, 28079,
+  28105, 28131, 28157, 28182, 28208, 28234, 28259, 28284, 28310, 28335, 28360, 28385, 28411, 28436, 28460, 28485,
+  28510, 28535, 28560, 28584, 28609, 28633, 28658, 28682, 28706, 28730, 28755, 28779, 28803, 28827, 28850, 28874,
+  28898, 28922, 28945, 28969, 28992, 29016, 29039, 29062, 29085, 29108, 29131, 29154, 29177, 29200, 29223, 29246,
+  29268, 29291, 29313, 29336, 29358, 29380, 29403, 29425, 29447, 29469, 29491, 29513, 29534, 29556, 29578, 29599,
+  29621, 29642, 29664, 29685, 29706, 29728, 29749, 29770, 29791, 29812, 29832, 29853, 29874, 29894, 29915, 29936,
+  29956, 29976, 29997, 30017, 30037, 30057, 30077, 30097, 30117, 30136, 30156, 30176, 30195, 30215, 30234, 30253,
+  30273, 30292, 30311, 30330, 30349, 30368, 30387, 30406, 30424, 30443, 30462, 30480, 30498, 30517, 30535, 30553,
+  30571, 30589, 30607, 30625, 30643, 30661, 30679, 30696, 30714, 30731, 30749, 30766, 30783, 30800, 30818, 30835,
+  30852, 30868, 30885, 30902, 30919, 30935, 30952, 30968, 30985, 31001, 31017, 31033, 31050, 31066, 31082, 31097,
+  31113, 31129, 31145, 31160, 31176, 31191, 31206, 31222, 31237, 31252, 31267, 31282, 31297, 31312, 31327, 31341,
+  31356, 31371, 31385, 31400, 31414, 31428, 31442, 31456, 31470, 31484, 31498, 31512, 31526, 31539, 31553, 31567,
+  31580, 31593, 31607, 31620, 31633, 31646, 31659, 31672, 31685, 31698, 31710, 31723, 31736, 31748, 31760, 31773,
+  31785, 31797, 31809, 31821, 31833, 31845, 31857, 31869, 31880, 31892, 31903, 31915, 31926, 31937, 31949, 31960,
+  31971, 31982, 31993, 32004, 32014, 32025, 32036, 32046, 32057, 32067, 32077, 32087, 32098, 32108, 32118, 32128,
+  32137, 32147, 32157, 32166, 32176, 32185, 32195, 32204, 32213, 32223, 32232, 32241, 32250, 32258, 32267, 32276,
+  32285, 32293, 32302, 32310, 32318, 32327, 32335, 32343, 32351, 32359, 32367, 32375, 32382, 32390, 32397, 32405,
+  32412, 32420, 32427, 32434, 32441, 32448, 32455, 32462, 32469, 32476, 32482, 32489, 32495, 32502, 32508, 32514,
+  32521, 32527, 32533, 32539, 32545, 32550, 32556, 32562, 32567, 32573, 32578, 32584, 32589, 32594, 32599, 32604,
+  32609, 32614, 32619, 32624, 32628, 32633, 32637, 32642, 32646, 32650, 32655, 32659, 32663, 32667, 32671, 32674,
+  32678, 32682, 32685, 32689, 32692, 32696, 32699, 32702, 32705, 32708, 32711, 32714, 32717, 32720, 32722, 32725,
+  32728, 32730, 32732, 32735, 32737, 32739, 32741, 32743, 32745, 32747, 32748, 32750, 32752, 32753, 32755, 32756,
+  32757, 32758, 32759, 32760, 32761, 32762, 32763, 32764, 32765, 32765, 32766, 32766, 32766, 32767, 32767, 32767,
+  32767
+};
+
+#define WIND_CORDIC_ITERATIONS 20
+const uint32_t wind_cordic_atan[WIND_CORDIC_ITERATIONS] = {
+  0x20000000, 0x12E4051E, 0x09FB385B, 0x051111D4, 0x028B0D43, 0x0145D7E1, 0x00A2F61E, 0x00517C55, 
+  0x0028BE53, 0x00145F2F, 0x000A2F98, 0x000517CC, 0x00028BE6, 0x000145F3, 0x0000A2FA, 0x0000517D, 
+  0x000028BE, 0x0000145F, 0x00000A30, 0x00000518
+};
+
 /*
  * ======================================================================================================================
  *  Wind Speed Calibration
@@ -61,35 +163,36 @@ bool ws_refresh = false;           // Set to true when we have delayed too long
  */
 volatile unsigned int anemometer_interrupt_count=0;
 unsigned long anemometer_interrupt_stime;
+volatile uint32_t anemometer_interrupt_first_us;  // First pulse this window, micros()
+volatile uint32_t anemometer_interrupt_last_us;   // Last pulse this window, micros()
+volatile uint32_t anemometer_pulses = 0;          // Pulses since power on, never cleared
+WS_PERIOD_STR ws_pulse;                           // Pulse history for Wind_SampleSpeed()
 
 /*
  * ======================================================================================================================
  *  Rain Gauge 1 - Optipolar Hall Effect Sensor SS451A
  * ======================================================================================================================
  */
-volatile unsigned int raingauge1_interrupt_count=0;
+unsigned int raingauge1_interrupt_count=0;  // Accepted tips, owned by the main loop
 uint64_t raingauge1_interrupt_stime; // Send Time
-volatile uint64_t raingauge1_interrupt_ltime; // Last Time
-uint64_t raingauge1_interrupt_toi;   // Time of Interrupt
+RAIN_GAUGE_STR raingauge1;
 
 /*
  * ======================================================================================================================
  *  Rain Gauge 2 - Optipolar Hall Effect Sensor SS451A
  * ======================================================================================================================
  */
-volatile unsigned int raingauge2_interrupt_count=0;
+unsigned int raingauge2_interrupt_count=0;  // Accepted tips, owned by the main loop
 uint64_t raingauge2_interrupt_stime; // Send Time
-volatile uint64_t raingauge2_interrupt_ltime; // Last Time
-uint64_t raingauge2_interrupt_toi;   // Time of Interrupt
+RAIN_GAUGE_STR raingauge2;
 
 /*
  * =======================================================================================================================
  *  Distance Gauge
  * =======================================================================================================================
  */
-unsigned int dg_bucket = 0;
 unsigned int dg_resolution_adjust = 2.5;                 // Default (2.5) is 10m sensor, (5 = 5m sensor)
-unsigned int dg_buckets[DG_BUCKETS];
+DG_MEDIAN_STR dg;
 
 /*
  * ======================================================================================================================
@@ -104,7 +207,207 @@ unsigned int dg_buckets[DG_BUCKETS];
  */
 void anemometer_interrupt_handler()
 {
+  uint32_t now = micros();
+
+  if (anemometer_interrupt_count == 0) {
+    anemometer_interrupt_first_us = now;
+  }
+  anemometer_interrupt_last_us = now;
   anemometer_interrupt_count++;
+  anemometer_pulses++;
+}
+
+/*
+ * ======================================================================================================================
+ *  Rain_Push() - Called from the rain gauge ISRs, queue the time of the interrupt. Only the ISR writes head
+ *                and only the main loop writes tail, so no locking is needed.
+ * ======================================================================================================================
+ */
+void Rain_Push(RAIN_GAUGE_STR *g) {
+  uint32_t now = millis();
+  uint32_t h = g->head;
+
+  if ((h - g->tail) < RG_TIP_RING) {
+    g->tip[h & RG_TIP_MASK] = now;
+    g->head = h + 1;
+  }
+  else if ((now - g->overflow_ms) > g->debounce) {
+    g->overflow_ms = now;
+    g->overflow++;
+  }
+}
+
+/*
+ * ======================================================================================================================
+ *  Rain_Clear() - Empty the tip ring and products, set the debounce in ms
+ * ======================================================================================================================
+ */
+void Rain_Clear(RAIN_GAUGE_STR *g, int debounce) {
+  noInterrupts();
+  memset(g, 0, sizeof(RAIN_GAUGE_STR));
+  g->debounce = debounce;
+  interrupts();
+}
+
+/*
+ * ======================================================================================================================
+ *  Rain_Advance() - Move the 1s bins forward to second sec, dropping the seconds that leave the 1 and 5 minute
+ *                   windows. A gap longer than the bins, or millis() wrapping, starts them over. A second
+ *                   before the newest bin, or from before millis() wrapped, leaves them as they are so they
+ *                   never move backwards.
+ * ======================================================================================================================
+ */
+void Rain_Advance(RAIN_GAUGE_STR *g, uint32_t sec) {
+  uint32_t s;
+
+  if (g->bin_valid && (((sec <= g->bin_sec) && ((g->bin_sec - sec) <= RG_WRAP_SEC)) ||
+                       ((sec > g->bin_sec) && ((sec - g->bin_sec) > RG_WRAP_SEC)))) {
+    return;
+  }
+
+  if (!g->bin_valid || (sec < g->bin_sec) || ((sec - g->bin_sec) >= RG_BINS)) {
+    memset(g->bin, 0, sizeof(g->bin));
+    g->sum60 = 0;
+    g->sum300 = 0;
+    g->bin_sec = sec;
+    g->bin_valid = true;
+    return;
+  }
+
+  for (s=g->bin_sec+1; s<=sec; s++) {
+    g->sum60 -= g->bin[(s + RG_BINS - 60) % RG_BINS];
+    g->sum300 -= g->bin[s % RG_BINS];
+    g->bin[s % RG_BINS] = 0;
+  }
+  g->bin_sec = sec;
+}
+
+/*
+ * ======================================================================================================================
+ *  Rain_Accept() - Count a tip at time ms unless it is within the debounce of the last accepted tip
+ *                  Overflow tips were debounced in the ISR and are always counted.
+ * ======================================================================================================================
+ */
+void Rain_Accept(RAIN_GAUGE_STR *g, unsigned int *count, uint32_t ms, bool debounced) {
+  uint32_t sec;
+  uint8_t *b;
+
+  if (!debounced && g->have_last && ((ms - g->last_ms) <= g->debounce)) {
+    return;
+  }
+
+  (*count)++;
+  digitalWrite(LED_PIN, HIGH);
+  TurnLedOff = true;
+
+  g->prev_ms = g->last_ms;
+  g->have_prev = g->have_last;
+  g->last_ms = ms;
+  g->have_last = true;
+
+  if (g->period_tips == 0) {
+    g->first_ms = ms;
+  }
+  g->period_last_ms = ms;
+  g->period_tips++;
+
+  // A tip queued just before the bins were moved on for an observation still counts in its own second. One 
+  // that sat in the ring for a minute or more, with the main loop held up, is counted in the newest second.
+  sec = ms / 1000;
+  Rain_Advance(g, sec);
+  if ((sec > g->bin_sec) || ((g->bin_sec - sec) >= 60)) {
+    sec = g->bin_sec;
+  }
+  b = &g->bin[sec % RG_BINS];
+  if (*b < 255) {
+    (*b)++;
+    g->sum60++;
+    g->sum300++;
+  }
+  if (g->sum60 > g->peak60) {
+    g->peak60 = g->sum60;
+  }
+  if (g->sum300 > g->peak300) {
+    g->peak300 = g->sum300;
+  }
+}
+
+/*
+ * ======================================================================================================================
+ *  Rain_DrainGauge() - Take all queued tips off one gauge's ring
+ * ======================================================================================================================
+ */
+void Rain_DrainGauge(RAIN_GAUGE_STR *g, unsigned int *count) {
+  uint32_t head = g->head;  // One read, tips queued after this are picked up next time
+  uint32_t overflow = g->overflow;
+
+  while (g->tail != head) {
+    Rain_Accept(g, count, g->tip[g->tail & RG_TIP_MASK], false);
+    g->tail++;
+  }
+
+  if (overflow != g->overflow_seen) {
+    sprintf (msgbuf, "RG:RING FULL %u", (unsigned int) (overflow - g->overflow_seen));
+    Output (msgbuf);
+    while (g->overflow_seen != overflow) {
+      Rain_Accept(g, count, millis(), true);
+      g->overflow_seen++;
+    }
+  }
+}
+
+/*
+ * ======================================================================================================================
+ *  Rain_Drain() - Called from the main loop, move queued tips from the ISR rings to the tip counts and products
+ * ======================================================================================================================
+ */
+void Rain_Drain() {
+  Rain_DrainGauge(&raingauge1, &raingauge1_interrupt_count);
+  Rain_DrainGauge(&raingauge2, &raingauge2_interrupt_count);
+}
+
+/*
+ * ======================================================================================================================
+ *  Rain_Products() - Rain products since the last observation, then start a new period
+ *    Intensity is the peak 1 or 5 minute tip count scaled to mm/h. The tip interval rate is one tip over the
+ *    longer of the last two tip interval and the time since the last tip, so it falls off once the rain stops
+ *    and resolves light rain that a 1 minute count can not. epoch is the time of the observation.
+ *    Called after raingaugeN_sample(), which drains the rings, so the products cover the same tips.
+ * ======================================================================================================================
+ */
+void Rain_Products(RAIN_GAUGE_STR *g, RAIN_PRODUCTS_STR *p, unsigned long epoch) {
+  uint32_t now, interval;
+
+  now = millis();
+  Rain_Advance(g, now / 1000);
+
+  p->intensity1m = g->peak60 * RG_TIP_MM * 60.0f;
+  p->intensity5m = g->peak300 * RG_TIP_MM * 12.0f;
+
+  p->rate = 0;
+  if (g->have_prev && ((now - g->last_ms) < RG_RATE_TIMEOUT)) {
+    interval = g->last_ms - g->prev_ms;
+    if ((now - g->last_ms) > interval) {
+      interval = now - g->last_ms;
+    }
+    if (interval > 0) {
+      p->rate = (RG_TIP_MM * 3600000.0f) / interval;
+    }
+  }
+
+  if (g->period_tips) {
+    p->first_tip = epoch - ((now - g->first_ms) / 1000);
+    p->last_tip  = epoch - ((now - g->period_last_ms) / 1000);
+  }
+  else {
+    p->first_tip = 0;
+    p->last_tip = 0;
+  }
+
+  // Next period starts with what is still in the windows
+  g->peak60 = g->sum60;
+  g->peak300 = g->sum300;
+  g->period_tips = 0;
 }
 
 /*
@@ -114,13 +417,7 @@ void anemometer_interrupt_handler()
  */
 void raingauge1_interrupt_handler()
 {
-  unsigned long now = millis();
-  if ((now - raingauge1_interrupt_ltime) > 500) { // Count tip if a half second has gone by since last interrupt
-    raingauge1_interrupt_ltime = now;
-    raingauge1_interrupt_count++;
-    digitalWrite(LED_PIN, HIGH);
-    TurnLedOff = true;
-  }
+  Rain_Push(&raingauge1);
 }
 
 /*
@@ -132,14 +429,12 @@ float raingauge1_sample() {
   unsigned long time_ms, rg1ds, count;
   float rg1;
 
-  noInterrupts();
+  Rain_Drain();
   time_ms = millis();
   rg1ds = (time_ms - raingauge1_interrupt_stime) / 1000;
   count = raingauge1_interrupt_count;
   raingauge1_interrupt_count = 0;
   raingauge1_interrupt_stime = time_ms;
-  raingauge1_interrupt_ltime = 0;
-  interrupts();
 
   rg1 = count * 0.2f;
   rg1 = (isnan(rg1) || (rg1 < QC_MIN_RG) || (rg1 > (((float)rg1ds / 60.0f) * QC_MAX_RG))) ? QC_ERR_RG : rg1;
@@ -154,13 +449,7 @@ float raingauge1_sample() {
  */
 void raingauge2_interrupt_handler()
 {
-  unsigned long now = millis();
-  if ((now - raingauge2_interrupt_ltime) > 500) { // Count tip if a half second has gone by since last interrupt
-    raingauge2_interrupt_ltime = now;
-    raingauge2_interrupt_count++;
-    digitalWrite(LED_PIN, HIGH);
-    TurnLedOff = true;
-  }
+  Rain_Push(&raingauge2);
 }
 
 /*
@@ -172,14 +461,12 @@ float raingauge2_sample() {
   unsigned long time_ms, rg2ds, count;
   float rg2;
 
-  noInterrupts();
+  Rain_Drain();
   time_ms = millis();
   rg2ds = (time_ms - raingauge2_interrupt_stime) / 1000;
   count = raingauge2_interrupt_count;
   raingauge2_interrupt_count = 0;
   raingauge2_interrupt_stime = time_ms;
-  raingauge2_interrupt_ltime = 0;
-  interrupts();
 
   rg2 = count * 0.2f;
   rg2 = (isnan(rg2) || (rg2 < QC_MIN_RG) || (rg2 > (((float)rg2ds / 60.0f) * QC_MAX_RG))) ? QC_ERR_RG : rg2;
@@ -201,6 +488,57 @@ bool RainEnabled() {
   }
 }
 
+/* 
+ *=======================================================================================================================
+ * Wind_PeriodClear() - Forget the pulse history, the next pulse starts a new period
+ *=======================================================================================================================
+ */
+void Wind_PeriodClear(WS_PERIOD_STR *ps) {
+  ps->valid = false;
+  ps->period = 0;
+}
+
+/* 
+ *=======================================================================================================================
+ * Wind_PeriodSpeed() - Wind speed from the time between anemometer pulses
+ *   count pulses arrived this window, the first at first_us and the last at last_us. When the pulse before
+ *   the window is recent the period covers count intervals from it, else count-1 intervals across the window.
+ *   The period used is never shorter than the time since the last pulse.
+ *=======================================================================================================================
+ */
+float Wind_PeriodSpeed(WS_PERIOD_STR *ps, unsigned long count, uint32_t first_us, uint32_t last_us, uint32_t now_us) {
+  uint32_t period, since;
+
+  if (count) {
+    if (ps->valid && ((first_us - ps->pulse_us) < WS_PERIOD_TIMEOUT)) {
+      ps->period = (last_us - ps->pulse_us) / count;
+    }
+    else if (count > 1) {
+      ps->period = (last_us - first_us) / (count - 1);
+    }
+    else {
+      ps->period = 0;  // Start from rest, one pulse is not a period
+    }
+    ps->pulse_us = last_us;
+    ps->valid = true;
+  }
+
+  if (!ps->valid || (ps->period == 0)) {
+    return (0.0f);
+  }
+
+  since = now_us - ps->pulse_us;
+  if (since >= WS_PERIOD_TIMEOUT) {
+    ps->valid = false;
+    ps->period = 0;
+    return (0.0f);
+  }
+  period = (since > ps->period) ? since : ps->period;
+
+  // Same as counting, one pulse per period: (pi * ws_radius) / (period / 1000000) * ws_calibration
+  return (((3.14156f * ws_radius) * 1000000.0f / (float) period) * ws_calibration);
+}
+
 /* 
  *=======================================================================================================================
  * Wind_SampleSpeed() - Return a wind speed based on interrupts and duration wind
@@ -212,12 +550,16 @@ bool RainEnabled() {
  */
 float Wind_SampleSpeed() {
   unsigned long time_ms, delta_ms, count;
-  float wind_speed;
+  uint32_t first_us, last_us, now_us;
+  float wind_speed, period_speed, w;
 
   noInterrupts();
   count = anemometer_interrupt_count;
   anemometer_interrupt_count = 0;
+  first_us = anemometer_interrupt_first_us;
+  last_us = anemometer_interrupt_last_us;
   time_ms = millis();
+  now_us = micros();
   interrupts();
 
   // Unsigned subtraction naturally wraps on rollover, so if time_ms has rolled past zero and anemometer_interrupt_stime 
@@ -233,97 +575,234 @@ float Wind_SampleSpeed() {
     wind_speed = 0.0f;
   }
 
+  if (cf_ws_period && (count < WS_PERIOD_BLEND_HI)) {
+    period_speed = Wind_PeriodSpeed(&ws_pulse, count, first_us, last_us, now_us);
+    if (count <= WS_PERIOD_BLEND_LO) {
+      wind_speed = period_speed;
+    }
+    else {
+      w = (float)(count - WS_PERIOD_BLEND_LO) / (WS_PERIOD_BLEND_HI - WS_PERIOD_BLEND_LO);
+      wind_speed = (w * wind_speed) + ((1.0f - w) * period_speed);
+    }
+  }
+  else if (cf_ws_period) {
+    Wind_PeriodSpeed(&ws_pulse, count, first_us, last_us, now_us); // Keep the pulse history current
+  }
+
   return wind_speed;
 }
 
-/* 
+/*
  *=======================================================================================================================
- * Wind_SampleDirection() -- Talk i2c to the AS5600 sensor and get direction
+ * Wind_AngleRequest() -- Queue a read of the AS5600 raw angle, the next Wind_ReadAngle() takes its result.
+ *                        The 1s tasks run on while it is on the wire.
  *=======================================================================================================================
  */
-int Wind_SampleDirection() {
-  int degree;
-  
-  // Read Raw Angle Low Byte
-  Wire.beginTransmission(AS5600_ADR);
-  Wire.write(AS5600_raw_ang_lo);
-  if (Wire.endTransmission()) {
-    //Output ("WD RD_LOW_ERR");
+void Wind_AngleRequest() {
+  if (wind_angle_queued) {
+    return;
   }
-  else if (Wire.requestFrom(AS5600_ADR, 1)) {
-    int AS5600_lo_raw = Wire.read();
-  
-    // Read Raw Angle High Byte
-    Wire.beginTransmission(AS5600_ADR);
-    Wire.write(AS5600_raw_ang_hi);
-    if (Wire.endTransmission()) {
-      // Output ("WD RD_HI_ERR");
+  memset (&wind_angle_xfer, 0, sizeof(wind_angle_xfer));
+  wind_angle_xfer.addr = AS5600_ADR;
+  wind_angle_xfer.pre = &wind_angle_reg;
+  wind_angle_xfer.pre_len = 1;
+  wind_angle_xfer.rx = wind_angle_buf;
+  wind_angle_xfer.rx_len = 2;
+  wind_angle_queued = I2CQ_Submit(&wind_angle_xfer);
+}
+
+/*
+ *=======================================================================================================================
+ * Wind_ReadAngle() -- Read the AS5600 12 bit raw angle 0-4095 in one transaction, -1 on error
+ *   Register pointer set to RAW ANGLE high, then a 2 byte read. The AS5600 auto increments to the low byte,
+ *   so both bytes come from the same conversion. Takes the queued read if there is one.
+ *=======================================================================================================================
+ */
+int Wind_ReadAngle() {
+  word raw;
+  uint8_t status;
+
+  if (wind_angle_queued) {
+    wind_angle_queued = false;
+    status = I2CQ_Wait(&wind_angle_xfer);
+  }
+  else {
+    status = I2CQ_Transfer(AS5600_ADR, &wind_angle_reg, 1, NULL, 0, wind_angle_buf, 2);
+  }
+  if (status != I2C_OK) {
+    return (-1);
+  }
+  raw = (wind_angle_buf[0] << 8) | wind_angle_buf[1];
+
+  // Do data integ check
+  if (raw < WIND_ANGLE_STEPS) {
+    return (raw);
+  }
+  return (-1);
+}
+
+/*
+ *=======================================================================================================================
+ * Wind_SampleAngle() -- Get the 12 bit raw angle 0-4095 from the AS5600 sensor, -1 on error
+ *   With cf_wd_oversample > 1 that many reads are taken WD_OVERSAMPLE_US apart and combined as a circular
+ *   mean, the direction of the sum of their unit vectors. Failed reads are left out.
+ *=======================================================================================================================
+ */
+int Wind_SampleAngle() {
+  int32_t ns = 0, ew = 0;
+  int angle, first = -1, good = 0;
+
+  if (cf_wd_oversample <= 1) {
+    return (Wind_ReadAngle());
+  }
+
+  for (int i=0; i<cf_wd_oversample; i++) {
+    if (i) {
+      delayMicroseconds(WD_OVERSAMPLE_US);
     }
-    else if (Wire.requestFrom(AS5600_ADR, 1)) {
-      word AS5600_hi_raw = Wire.read();
-      AS5600_hi_raw = AS5600_hi_raw << 8; //shift raw angle hi 8 left
-      AS5600_hi_raw = AS5600_hi_raw | AS5600_lo_raw; //AND high and low raw angle value
-
-      // Do data integ check
-      degree = (int) AS5600_hi_raw * 0.0879;
-      if ((degree >=0) && (degree <= 360)) {
-        return (degree);
-      }
-      else {
-        return (-1);
+    angle = Wind_ReadAngle();
+    if (angle != -1) {
+      if (good++ == 0) {
+        first = angle;
       }
+      ns += Wind_Cos_Q15(angle);
+      ew += Wind_Sin_Q15(angle);
     }
   }
-  return (-1); // Not the best value to return 
+
+  if ((good < 2) || ((ns == 0) && (ew == 0))) {
+    return (first);
+  }
+
+  // 2^32 per turn to raw angle steps, rounded
+  return (((Wind_VectorToAngle(ns, ew) + (1UL<<19)) >> 20) & (WIND_ANGLE_STEPS-1));
 }
 
-/* 
+/*
  *=======================================================================================================================
- * Wind_DirectionVector()
+ * Wind_SampleDirection() -- AS5600 raw angle rounded to degrees 0-359, -1 on error
  *=======================================================================================================================
  */
-int Wind_DirectionVector() {
-  double NS_vector_sum = 0.0;
-  double EW_vector_sum = 0.0;
-  double r;
-  float s;
-  int d, i, rtod;
-  bool ws_zero = true;
+int Wind_SampleDirection() {
+  int angle = Wind_SampleAngle();
 
-  for (i=0; i<WIND_READINGS; i++) {
-    d = wind.bucket[i].direction;
+  if (angle == -1) {
+    return (-1);
+  }
+  return ((((angle * 360) + (WIND_ANGLE_STEPS/2)) / WIND_ANGLE_STEPS) % 360);
+}
 
-    // if at any time 1 of the 60 wind direction readings is -1
-    // then the sensor was offline and we need to invalidate or data
-    // until it is clean with out any -1's
-    if (d == -1) {
-      return (-1);
-    }
-    
-    s = wind.bucket[i].speed;
+/*
+ *=======================================================================================================================
+ * Wind_Sin_Q15() - Sine of a raw angle 0-4095 from the quarter wave table
+ *=======================================================================================================================
+ */
+int16_t Wind_Sin_Q15(int angle) {
+  int i = angle & (WIND_SIN_QUARTER-1);
 
-    // Flag we have wind speed
-    if (s > 0) {
-      ws_zero = false;  
+  switch ((angle / WIND_SIN_QUARTER) & 3) {
+    case 0  : return ( wind_sin_q15[i]);
+    case 1  : return ( wind_sin_q15[WIND_SIN_QUARTER-i]);
+    case 2  : return (-wind_sin_q15[i]);
+    default : return (-wind_sin_q15[WIND_SIN_QUARTER-i]);
+  }
+}
+
+/*
+ *=======================================================================================================================
+ * Wind_Cos_Q15() - Cosine of a raw angle 0-4095, the sine a quarter turn ahead
+ *=======================================================================================================================
+ */
+int16_t Wind_Cos_Q15(int angle) {
+  return (Wind_Sin_Q15((angle + WIND_SIN_QUARTER) & (WIND_ANGLE_STEPS-1)));
+}
+
+/*
+ *=======================================================================================================================
+ * Wind_VectorToAngle() - Convert NS and EW vector sums to a direction in binary angle units, 2^32 per turn
+ *
+ *   CORDIC in vectoring mode. The vector is scaled so its larger component is 2^28 - 2^29, which leaves room
+ *   for the CORDIC gain (1.647) in 32 bits, then rotated onto the NS axis. The total rotation is the direction.
+ *=======================================================================================================================
+ */
+uint32_t Wind_VectorToAngle(int64_t NS_vector_sum, int64_t EW_vector_sum) {
+  int64_t m;
+  int32_t x, y, t;
+  uint32_t angle = 0;
+
+  if ((NS_vector_sum == 0) && (EW_vector_sum == 0)) {
+    return (0);
+  }
+
+  // Start in the right half plane, rotate 180 degrees if needed
+  if (NS_vector_sum < 0) {
+    NS_vector_sum = -NS_vector_sum;
+    EW_vector_sum = -EW_vector_sum;
+    angle = 0x80000000;
+  }
+
+  m = (NS_vector_sum > llabs(EW_vector_sum)) ? NS_vector_sum : llabs(EW_vector_sum);
+  while (m >= (1LL<<29)) {
+    m >>= 1;
+    NS_vector_sum >>= 1;
+    EW_vector_sum >>= 1;
+  }
+  while (m < (1LL<<28)) {
+    m <<= 1;
+    NS_vector_sum <<= 1;
+    EW_vector_sum <<= 1;
+  }
+  x = (int32_t) NS_vector_sum;
+  y = (int32_t) EW_vector_sum;
+
+  for (int i=0; i<WIND_CORDIC_ITERATIONS; i++) {
+    t = x;
+    if (y > 0) {
+      x += (y >> i);
+      y -= (t >> i);
+      angle += wind_cordic_atan[i];
+    }
+    else {
+      x -= (y >> i);
+      y += (t >> i);
+      angle -= wind_cordic_atan[i];
     }
-    r = (d * 71) / 4068.0;
-    
-    // North South Direction 
-    NS_vector_sum += cos(r) * s;
-    EW_vector_sum += sin(r) * s;
   }
-  rtod = (atan2(EW_vector_sum, NS_vector_sum)*4068.0)/71.0;
-  if (rtod<0) {
-    rtod = 360 + rtod;
+
+  return (angle);
+}
+
+/*
+ *=======================================================================================================================
+ * Wind_VectorToDegrees() - Convert NS and EW vector sums to a direction 0-359
+ *=======================================================================================================================
+ */
+int Wind_VectorToDegrees(int64_t NS_vector_sum, int64_t EW_vector_sum) {
+  uint32_t angle = Wind_VectorToAngle(NS_vector_sum, EW_vector_sum);
+
+  // 2^32 per turn to degrees, rounded
+  return ((int)((((uint64_t)angle * 360) + 0x80000000) >> 32) % 360);
+}
+
+/* 
+ *=======================================================================================================================
+ * Wind_DirectionVector() - Average of the 60 vectors, from the running NS and EW sums
+ *=======================================================================================================================
+ */
+int Wind_DirectionVector() {
+  // if at any time 1 of the 60 wind direction readings is -1
+  // then the sensor was offline and we need to invalidate or data
+  // until it is clean with out any -1's
+  if (wind.angle_bad) {
+    return (-1);
   }
 
   // If all the winds speeds are 0 then we return current wind direction or 0 on failure of that.
-  if (ws_zero) {
+  if (wind.speed_nonzero == 0) {
     return (Wind_SampleDirection()); // Can return -1
   }
-  else {
-    return (rtod);
-  }
+
+  return (Wind_VectorToDegrees(wind.ns_sum, wind.ew_sum));
 }
 
 /* 
@@ -332,12 +811,7 @@ int Wind_DirectionVector() {
  *=======================================================================================================================
  */
 float Wind_SpeedAverage() {
-  float wind_speed = 0.0;
-  for (int i=0; i<WIND_READINGS; i++) {
-    // sum wind speeds for later average
-    wind_speed += wind.bucket[i].speed;
-  }
-  return( wind_speed / (float) WIND_READINGS);
+  return( (float) wind.speed_sum / (float) WIND_READINGS);
 }
 
 /* 
@@ -365,92 +839,302 @@ int Wind_GustDirection() {
  *   Wind Gust Direction = Average of the 3 Vectors from the Wind Gust samples.
  * 
  *   Note: To handle the case of 2 or more gusts at the same speed but different directions
- *          Sstart with oldest reading and work forward to report most recent.
- * 
- *   Algorithm: 
- *     Start with oldest reading.
- *     Sum this reading with next 2.
- *     If greater than last, update last 
- * 
+ *         the most recent is reported. Wind_TakeReading() keeps the gust deque so its front is
+ *         the highest 3 sample window, ties resolved to the most recent.
  *=======================================================================================================================
  */
 void Wind_GustUpdate() {
-  int bucket = wind.bucket_idx; // Start at next bucket to fill (aka oldest reading)
-  float ws_sum = 0.0;
-  int ws_bucket = bucket;
-  float sum;
-
-  for (int i=0; i<(WIND_READINGS-2); i++) {  // subtract 2 because we are looking ahead at the next 2 buckets
-    // sum wind speeds 
-    sum = wind.bucket[bucket].speed +
-          wind.bucket[(bucket+1) % WIND_READINGS].speed +
-          wind.bucket[(bucket+2) % WIND_READINGS].speed;
-    if (sum >= ws_sum) {
-      ws_sum = sum;
-      ws_bucket = bucket;
-    }
-    bucket = (++bucket) % WIND_READINGS;
-  }
-  wind.gust = ws_sum/3;
-  
-  // Determine Gust Direction 
-  double NS_vector_sum = 0.0;
-  double EW_vector_sum = 0.0;
-  double r;
-  float s;
-  int d, i, rtod;
-  bool ws_zero = true;
+  unsigned long seq = wind.gust_dq[wind.gust_dq_head];
 
-  bucket = ws_bucket;
-  for (i=0; i<3; i++) {
-    d = wind.bucket[bucket].direction;
+  wind.gust = wind.gust_sum[seq % WIND_READINGS]/3;
+  wind.gust_direction = Wind_WindowDirection(seq % WIND_READINGS);
+}
 
+/* 
+ *=======================================================================================================================
+ * Wind_WindowDirection() - Average of the 3 vectors in the gust window ending at bucket idx
+ *=======================================================================================================================
+ */
+int Wind_WindowDirection(int idx) {
+  int bucket = (idx + WIND_READINGS - 2) % WIND_READINGS; // First of the 3 samples in the window
+  int64_t NS_vector_sum = 0;
+  int64_t EW_vector_sum = 0;
+  bool ws_zero = true;
+
+  for (int i=0; i<3; i++) {
     // if at any time any wind direction readings is -1
     // then the sensor was offline and we need to invalidate or data
     // until it is clean with out any -1's
-    if (d == -1) {
+    if (wind.bucket[bucket].angle == -1) {
       ws_zero = true;
       break;
     }
-    
-    s = wind.bucket[bucket].speed;
 
     // Flag we have wind speed
-    if (s > 0) {
+    if (wind.bucket[bucket].speed > 0) {
       ws_zero = false;  
     }
-    r = (d * 71) / 4068.0;
-    
-    // North South Direction 
-    NS_vector_sum += cos(r) * s;
-    EW_vector_sum += sin(r) * s;
+    NS_vector_sum += wind.bucket[bucket].ns;
+    EW_vector_sum += wind.bucket[bucket].ew;
 
-    bucket = (++bucket) % WIND_READINGS;
-  }
-
-  rtod = (atan2(EW_vector_sum, NS_vector_sum)*4068.0)/71.0;
-  if (rtod<0) {
-    rtod = 360 + rtod;
+    bucket = (bucket+1) % WIND_READINGS;
   }
 
   // If all the winds speeds are 0 or we has a -1 direction then set -1 dor direction.
   if (ws_zero) {
-    wind.gust_direction = -1;
+    return (-1);
   }
   else {
-    wind.gust_direction = rtod;
+    return (Wind_VectorToDegrees(NS_vector_sum, EW_vector_sum));
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * Wind_Clear() - Reset the wind ring to 60 calm samples and the running statistics to match
+ * ======================================================================================================================
+ */
+void Wind_Clear() {
+  memset(&wind, 0, sizeof(wind));
+  memset(&wind_products, 0, sizeof(wind_products));
+  wind.seq = WIND_READINGS-1;     // Treat the zeroed buckets as samples 0-59
+  wind.gust_dq[0] = wind.seq;     // All windows tie at 0, the most recent one is kept
+  wind.gust_dq_head = 0;
+  wind.gust_dq_count = 1;
+  wind.gust = 0.0;
+  wind.gust_direction = -1;
+}
+
+/*
+ * ======================================================================================================================
+ * Wind_ProductsFold() - Fold the 1s sample just saved in bucket b into the current 1 minute partial.
+ *                       gust_sum is the 3 sample window ending at bucket idx.
+ *                       After WIND_READINGS samples the partial is pushed on to the 10 minute ring.
+ * ======================================================================================================================
+ */
+void Wind_ProductsFold(WIND_BUCKETS_STR *b, float gust_sum, int idx) {
+  WIND_PARTIAL_STR *c = &wind_products.current;
+
+  if (c->samples == 0) {
+    c->gust_direction = -1;
+  }
+  c->samples++;
+  c->speed_sum += b->speed;
+  c->ns_sum += b->ns;
+  c->ew_sum += b->ew;
+  if (b->angle == -1) {
+    c->angle_bad++;
+  }
+  if (b->speed > 0) {
+    c->speed_nonzero++;
+    if (b->angle != -1) {
+      c->dir_count++;
+      c->sin_sum += Wind_Sin_Q15(b->angle);
+      c->cos_sum += Wind_Cos_Q15(b->angle);
+    }
+  }
+
+  if (gust_sum >= c->gust_sum) {
+    c->gust_sum = gust_sum;
+    c->gust_direction = Wind_WindowDirection(idx);
+  }
+
+  if (c->samples >= WIND_READINGS) {
+    wind_products.partial[wind_products.partial_idx] = *c;
+    wind_products.partial_idx = (wind_products.partial_idx+1) % WIND_PARTIALS;
+    if (wind_products.partial_count < WIND_PARTIALS) {
+      wind_products.partial_count++;
+    }
+    memset(c, 0, sizeof(WIND_PARTIAL_STR));
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * Wind_ProductsSum() - Combine the most recent N completed minutes, false if we do not have N yet
+ *                      The gust is the highest minute gust, ties to the most recent minute.
+ * ======================================================================================================================
+ */
+bool Wind_ProductsSum(int minutes, WIND_PARTIAL_STR *t) {
+  WIND_PARTIAL_STR *p;
+  int i, m;
+
+  if ((minutes < 1) || (minutes > wind_products.partial_count)) {
+    return (false);
+  }
+
+  memset(t, 0, sizeof(WIND_PARTIAL_STR));
+  t->gust_direction = -1;
+
+  // Oldest of the N minutes first
+  i = (wind_products.partial_idx + WIND_PARTIALS - minutes) % WIND_PARTIALS;
+  for (m=0; m<minutes; m++) {
+    p = &wind_products.partial[i];
+    t->samples       += p->samples;
+    t->angle_bad     += p->angle_bad;
+    t->speed_nonzero += p->speed_nonzero;
+    t->speed_sum     += p->speed_sum;
+    t->ns_sum        += p->ns_sum;
+    t->ew_sum        += p->ew_sum;
+    t->dir_count     += p->dir_count;
+    t->sin_sum       += p->sin_sum;
+    t->cos_sum       += p->cos_sum;
+    if (p->gust_sum >= t->gust_sum) {
+      t->gust_sum = p->gust_sum;
+      t->gust_direction = p->gust_direction;
+    }
+    i = (i+1) % WIND_PARTIALS;
+  }
+  return (true);
+}
+
+/*
+ * ======================================================================================================================
+ * Wind_ProductMean() - Mean wind speed and vector direction over the last N minutes
+ *                      Direction follows the 1 minute rules, -1 if any sample had a bad angle
+ *                      and the current direction if there was no wind.
+ * ======================================================================================================================
+ */
+bool Wind_ProductMean(int minutes, float *ws, int *wd) {
+  WIND_PARTIAL_STR t;
+
+  if (!Wind_ProductsSum(minutes, &t)) {
+    return (false);
+  }
+
+  *ws = (float) t.speed_sum / (float) t.samples;
+
+  if (t.angle_bad) {
+    *wd = -1;
+  }
+  else if (t.speed_nonzero == 0) {
+    *wd = Wind_SampleDirection(); // Can return -1
+  }
+  else {
+    *wd = Wind_VectorToDegrees(t.ns_sum, t.ew_sum);
+  }
+  return (true);
+}
+
+/*
+ * ======================================================================================================================
+ * Wind_ProductGust() - Highest 3s gust and its direction over the last N minutes
+ * ======================================================================================================================
+ */
+bool Wind_ProductGust(int minutes, float *wg, int *wgd) {
+  WIND_PARTIAL_STR t;
+
+  if (!Wind_ProductsSum(minutes, &t)) {
+    return (false);
+  }
+  *wg = t.gust_sum / 3;
+  *wgd = t.gust_direction;
+  return (true);
+}
+
+/*
+ * ======================================================================================================================
+ * Wind_ProductSigmaTheta() - Standard deviation of wind direction in degrees over the last N minutes, -1 if none
+ *
+ *   Yamartino single pass method from the unit vector sums of the samples with wind.
+ *     sa = mean sin, ca = mean cos, e = sqrt(1 - (sa^2 + ca^2))
+ *     sigma = asin(e) * (1 + (2/sqrt(3) - 1) * e^3)
+ * ======================================================================================================================
+ */
+float Wind_ProductSigmaTheta(int minutes) {
+  WIND_PARTIAL_STR t;
+  float sa, ca, e;
+
+  if (!Wind_ProductsSum(minutes, &t) || t.angle_bad || (t.dir_count < 2)) {
+    return (-1);
   }
+
+  sa = (float) t.sin_sum / (32767.0f * t.dir_count);
+  ca = (float) t.cos_sum / (32767.0f * t.dir_count);
+  e = 1.0f - ((sa * sa) + (ca * ca));
+  e = (e > 0.0f) ? sqrt(e) : 0.0f;
+  if (e > 1.0f) {
+    e = 1.0f;
+  }
+  return (asin(e) * (1.0f + (0.1547f * e * e * e)) * 57.29578f);
 }
 
 /*
  * ======================================================================================================================
- * Wind_TakeReading() - Wind direction and speed, measure every second             
+ * Wind_TakeReading() - Wind direction and speed, measure every second
+ *   Evict the oldest bucket from the running sums, store the new sample and add it to the sums.
+ *   The 3 sample sum ending at this sample is pushed on the gust deque, windows no longer
+ *   fully inside the 60 samples are dropped from the front.
  * ======================================================================================================================
  */
 void Wind_TakeReading() {
-  wind.bucket[wind.bucket_idx].direction = (int) Wind_SampleDirection();
-  wind.bucket[wind.bucket_idx].speed = Wind_SampleSpeed();
-  wind.bucket_idx = (++wind.bucket_idx) % WIND_READINGS; // Advance bucket index for next reading
+  WIND_BUCKETS_STR *b = &wind.bucket[wind.bucket_idx];
+  int a = Wind_SampleAngle();
+  float s = Wind_SampleSpeed();
+  int32_t cms = (int32_t) (s * 100.0f + 0.5f);   // Speed in cm/s for the integer vector
+
+  // Remove the oldest sample from the running sums
+  wind.ns_sum    -= b->ns;
+  wind.ew_sum    -= b->ew;
+  wind.speed_sum -= b->speed;
+  if (b->angle == -1) wind.angle_bad--;
+  if (b->speed > 0) wind.speed_nonzero--;
+
+  // Save the new sample
+  b->angle = a;
+  b->speed = s;
+  if (a == -1) {
+    b->ns = 0;
+    b->ew = 0;
+    wind.angle_bad++;
+  }
+  else {
+    b->ns = Wind_Cos_Q15(a) * cms;   // North South Direction
+    b->ew = Wind_Sin_Q15(a) * cms;
+  }
+  if (s > 0) wind.speed_nonzero++;
+
+  wind.ns_sum    += b->ns;
+  wind.ew_sum    += b->ew;
+  wind.speed_sum += b->speed;
+
+  wind.seq++;
+  wind.bucket_idx = (wind.bucket_idx+1) % WIND_READINGS; // Advance bucket index for next reading
+
+  // Once a minute rebuild the float speed sum, the add and subtract rounding would otherwise drift
+  if (wind.bucket_idx == 0) {
+    wind.speed_sum = 0.0;
+    for (int i = 0; i < WIND_READINGS; i++) {
+      wind.speed_sum += wind.bucket[i].speed;
+    }
+  }
+
+  // Gust window ending at this sample
+  int idx = wind.seq % WIND_READINGS;
+  float sum = wind.bucket[(idx + WIND_READINGS - 2) % WIND_READINGS].speed +
+              wind.bucket[(idx + WIND_READINGS - 1) % WIND_READINGS].speed +
+              wind.bucket[idx].speed;
+  wind.gust_sum[idx] = sum;
+
+  // Drop windows from the back that can never be the gust again, <= so the most recent wins a tie
+  while (wind.gust_dq_count && 
+         (wind.gust_sum[wind.gust_dq[(wind.gust_dq_head + wind.gust_dq_count - 1) % WIND_READINGS] % WIND_READINGS] <= sum)) {
+    wind.gust_dq_count--;
+  }
+  wind.gust_dq[(wind.gust_dq_head + wind.gust_dq_count) % WIND_READINGS] = wind.seq;
+  wind.gust_dq_count++;
+
+  // Drop windows from the front whose first sample has been evicted
+  while ((wind.seq - wind.gust_dq[wind.gust_dq_head]) > (WIND_READINGS-3)) {
+    wind.gust_dq_head = (wind.gust_dq_head+1) % WIND_READINGS;
+    wind.gust_dq_count--;
+  }
+
+  Wind_GustUpdate();
+
+  if (cf_wind_products) {
+    Wind_ProductsFold(b, sum, idx);
+  }
 }
 
 /* 
@@ -460,12 +1144,14 @@ void Wind_TakeReading() {
  */
 void as5600_initialize() {
   Output("AS5600:INIT");
+  I2C_Clock(AS5600_ADR);
   Wire.beginTransmission(AS5600_ADR);
   if (Wire.endTransmission()) {
     msgp = (char *) "WD:NF";
     AS5600_exists = false;
   }
   else {
+    AS5600_exists = true;
     msgp = (char *) "WD:OK";
   }
   Output (msgp);
@@ -473,17 +1159,11 @@ void as5600_initialize() {
 
 /* 
  *=======================================================================================================================
- * Pin_ReadAvg()
+ * Pin_ReadAvg() - Average of the pin's recent ADC service results, -1 if none
  *=======================================================================================================================
  */
 float Pin_ReadAvg(int pin) {
-  int numReadings = 5;
-  int totalValue = 0;
-  for (int i = 0; i < numReadings; i++) {
-    totalValue += analogRead(pin);
-    delay(10);  // Short delay between readings
-  }
-  return(totalValue / numReadings);
+  return (ADC_PinAvg(pin));  // Last 5 1s results from the ADC service, each a 16x hardware average
 }
 
 /* 
@@ -506,13 +1186,11 @@ float Pin_ReadAvg(int pin) {
  *=======================================================================================================================
  */
 float VoltaicVoltage(int pin) {
-  int numReadings = 5;
-  int totalValue = 0;
-  for (int i = 0; i < numReadings; i++) {
-    totalValue += analogRead(pin);
-    delay(10);  // Short delay between readings
+  float avg = ADC_PinAvg(pin);
+  if (avg < 0) {
+    return (-1);
   }
-  float voltage = (3.3 * (totalValue / (float)numReadings)) / 4095.0; 
+  float voltage = (3.3 * avg) / 4095.0; 
   return(voltage);
 }
 
@@ -540,26 +1218,156 @@ float VoltaicPercent(float half_cell_voltage) {
 
 /*
  * ======================================================================================================================
- * DS_TakeReading() - measure every second             
+ * DS_HeapSwap() - Swap two heap positions and keep the ring index to heap position map current
+ * ======================================================================================================================
+ */
+void DS_HeapSwap(int a, int b) {
+  uint8_t t = dg.heap[a];
+  dg.heap[a] = dg.heap[b];
+  dg.heap[b] = t;
+  dg.pos[dg.heap[a]] = a;
+  dg.pos[dg.heap[b]] = b;
+}
+
+/*
+ * ======================================================================================================================
+ * DS_HeapBefore() - True if heap position a belongs above heap position b
+ *                   Lower half is a max heap, upper half a min heap
+ * ======================================================================================================================
+ */
+bool DS_HeapBefore(int a, int b) {
+  if (a < DG_HALF) {
+    return (dg.value[dg.heap[a]] > dg.value[dg.heap[b]]);
+  }
+  return (dg.value[dg.heap[a]] < dg.value[dg.heap[b]]);
+}
+
+/*
+ * ======================================================================================================================
+ * DS_HeapSiftUp() - Move heap position p up toward the root of its half, return where it ended
+ * ======================================================================================================================
+ */
+int DS_HeapSiftUp(int p) {
+  int base = (p < DG_HALF) ? 0 : DG_HALF;
+  int parent;
+
+  while (p > base) {
+    parent = base + (p - base - 1) / 2;
+    if (!DS_HeapBefore(p, parent)) {
+      break;
+    }
+    DS_HeapSwap(p, parent);
+    p = parent;
+  }
+  return (p);
+}
+
+/*
+ * ======================================================================================================================
+ * DS_HeapSiftDown() - Move heap position p down its half
+ * ======================================================================================================================
+ */
+void DS_HeapSiftDown(int p) {
+  int base = (p < DG_HALF) ? 0 : DG_HALF;
+  int child, best;
+
+  for (;;) {
+    best = p;
+    child = base + (2 * (p - base)) + 1;
+    if ((child < base + DG_HALF) && DS_HeapBefore(child, best)) {
+      best = child;
+    }
+    child++;
+    if ((child < base + DG_HALF) && DS_HeapBefore(child, best)) {
+      best = child;
+    }
+    if (best == p) {
+      break;
+    }
+    DS_HeapSwap(p, best);
+    p = best;
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * DS_Clear() - Reset the ring to zeros, any split of equal values is a valid pair of heaps
+ * ======================================================================================================================
+ */
+void DS_Clear() {
+  memset(&dg, 0, sizeof(dg));
+  for (int i=0; i<DG_BUCKETS; i++) {
+    dg.heap[i] = i;
+    dg.pos[i] = i;
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * DS_TakeReading() - measure every second
+ *   The new sample replaces the oldest ring entry in its heap and is sifted into place. If that leaves the
+ *   lower half root above the upper half root the two roots are swapped and sifted down. O(log n).
+ *
+ *   Outlier rejection (cf_ds_outlier > 0) skips ultrasonic dropouts, samples more than cf_ds_outlier mm from the
+ *   median, once the ring is full. After DG_OUTLIER_LIMIT in a row every sample is accepted until one
+ *   lands near the median again, so a real change in level is followed.
  * ======================================================================================================================
  */
 void DS_TakeReading() {
-  dg_buckets[dg_bucket] = (int) analogRead(DISTANCE_GAUGE_PIN) * dg_resolution_adjust;
-  dg_bucket = (++dg_bucket) % DG_BUCKETS; // Advance bucket index for next reading
+  int raw = ADC_PinLatest(DISTANCE_GAUGE_PIN);  // 16x hardware average from the ADC service
+  unsigned int sample = raw * dg_resolution_adjust;
+  unsigned int old;
+  int k, p;
+
+  if (raw == -1) {
+    return;
+  }
+
+  if ((cf_ds_outlier > 0) && (dg.filled >= DG_BUCKETS)) {
+    unsigned int median = dg.value[dg.heap[0]];
+    unsigned int diff = (sample > median) ? (sample - median) : (median - sample);
+
+    if (diff > (unsigned int) cf_ds_outlier) {
+      if (dg.outlier_run < DG_OUTLIER_LIMIT) {
+        dg.outlier_run++;
+        dg.outliers++;
+        return;
+      }
+    }
+    else {
+      dg.outlier_run = 0;
+    }
+  }
+
+  k = dg.idx;
+  old = dg.value[k];
+  dg.value[k] = sample;
+  p = dg.pos[k];
+
+  if (sample != old) {
+    p = DS_HeapSiftUp(p);
+    DS_HeapSiftDown(p);
+  }
+
+  if (dg.value[dg.heap[0]] > dg.value[dg.heap[DG_HALF]]) {
+    DS_HeapSwap(0, DG_HALF);
+    DS_HeapSiftDown(0);
+    DS_HeapSiftDown(DG_HALF);
+  }
+
+  dg.idx = (dg.idx+1) % DG_BUCKETS; // Advance bucket index for next reading
+  if (dg.filled < DG_BUCKETS) {
+    dg.filled++;
+  }
 }
 
-/* 
- *=======================================================================================================================
- * DS_Median()
- *=======================================================================================================================
+/*
+ * ======================================================================================================================
+ * DS_Median() - Lower median of the 60 samples, root of the lower half heap. O(1)
+ * ======================================================================================================================
  */
 float DS_Median() {
-  int i;
-  
-  mysort(dg_buckets, DG_BUCKETS);
-  i = (DG_BUCKETS+1) / 2 - 1; // -1 as array indexing in C starts from 0
-  
-  return (dg_buckets[i]); 
+  return (dg.value[dg.heap[0]]);
 }
 
 /* 
@@ -573,11 +1381,10 @@ void Wind_Distance_Air_Initialize() {
   // Clear windspeed counter
   anemometer_interrupt_count = 0;
   anemometer_interrupt_stime = millis();
+  Wind_PeriodClear(&ws_pulse);
   
   // Init default values.
-  wind.gust = 0.0;
-  wind.gust_direction = -1;
-  wind.bucket_idx = 0;
+  Wind_Clear();
 
   // Take N 1s samples of wind speed and direction and fill arrays with values.
   if (!cf_nowind || PM25AQI_exists || (cf_op1==OP1_STATE_DIST_5M) || (cf_op1==OP1_STATE_DIST_10M)) {
@@ -611,7 +1418,7 @@ void Wind_Distance_Air_Initialize() {
   }
 
   if ((cf_op1==OP1_STATE_DIST_5M) || (cf_op1==OP1_STATE_DIST_10M)) {
-    sprintf (Buffer32Bytes, "DS:%d", DS_Median());
+    sprintf (Buffer32Bytes, "DS:%d", (int) DS_Median());
     Output (Buffer32Bytes);
   }
 }
@@ -624,7 +1431,12 @@ void Wind_Distance_Air_Initialize() {
 void OPT_AQS_Initialize() {
   Output ("OBSAQS:INIT");
   if (SD_exists) {
-    if (SD.exists(SD_OPTAQS_FILE)) {
+    if (SD.exists(SD_OPTAQS_FILE) && (cf_op2 != OP2_STATE_NULL)) {
+      // A2 is sampled by the ADC for op2, it can not also switch the sensor power
+      Output ("OPTAQS OP2 IN USE");
+      AQS_Enabled = false;
+    }
+    else if (SD.exists(SD_OPTAQS_FILE)) {
       Output ("OPTAQS Enabled");
 
       // Ware are a Air Quality Station so Clear Rain Totals from EEPROM
@@ -636,8 +1448,10 @@ void OPT_AQS_Initialize() {
 
       // We will only go in AQS mode if the sensor is truely there
       AQS_Enabled = true;
-      AQS_Correction = (AQSWarmUpTime + 10) * 1000;  // In ms. Correction to be subtracted from mainloop poll interval 
-                                                     // to account for the AQS warmup time and 10s for sampling
+
+      // Powered now so the sensor is found at boot, the first sample follows the warm up
+      aqs_time = millis();
+      aqs_state = AQS_WARMING;
     }
     else {
       Output ("OPTAQS NF");
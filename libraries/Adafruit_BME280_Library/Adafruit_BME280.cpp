@@ -337,13 +337,23 @@ bool Adafruit_BME280::isReadingCalibration(void) {
  *   @returns the temperature read from the device or NaN if sampling off
  */
 float Adafruit_BME280::readTemperature(void) {
-  int32_t var1, var2;
   if (_measReg.osrs_t == sensor_sampling::SAMPLING_NONE)
     return NAN;
 
   int32_t adc_T = read24(BME280_REGISTER_TEMPDATA);
   adc_T >>= 4;
 
+  return compensateTemperature(adc_T);
+}
+
+/*!
+ *   @brief  Compensates a raw temperature reading and sets t_fine
+ *   @param adc_T 20 bit raw temperature
+ *   @returns the temperature in degrees celsius
+ */
+float Adafruit_BME280::compensateTemperature(int32_t adc_T) {
+  int32_t var1, var2;
+
   var1 = (int32_t)((adc_T / 8) - ((int32_t)_bme280_calib.dig_T1 * 2));
   var1 = (var1 * ((int32_t)_bme280_calib.dig_T2)) / 2048;
   var2 = (int32_t)((adc_T / 16) - ((int32_t)_bme280_calib.dig_T1));
@@ -361,7 +371,6 @@ float Adafruit_BME280::readTemperature(void) {
  *   @returns the pressure value (in Pascal) or NaN if sampling off
  */
 float Adafruit_BME280::readPressure(void) {
-  int64_t var1, var2, var3, var4;
   if (_measReg.osrs_p == sensor_sampling::SAMPLING_NONE)
     return NAN;
 
@@ -370,6 +379,17 @@ float Adafruit_BME280::readPressure(void) {
   int32_t adc_P = read24(BME280_REGISTER_PRESSUREDATA);
   adc_P >>= 4;
 
+  return compensatePressure(adc_P);
+}
+
+/*!
+ *   @brief  Compensates a raw pressure reading, t_fine must be set first
+ *   @param adc_P 20 bit raw pressure
+ *   @returns the pressure in Pascal
+ */
+float Adafruit_BME280::compensatePressure(int32_t adc_P) {
+  int64_t var1, var2, var3, var4;
+
   var1 = ((int64_t)t_fine) - 128000;
   var2 = var1 * var1 * (int64_t)_bme280_calib.dig_P6;
   var2 = var2 + ((var1 * (int64_t)_bme280_calib.dig_P5) * 131072);
@@ -400,13 +420,23 @@ float Adafruit_BME280::readPressure(void) {
  *  @returns the humidity value read from the device or NaN if sampling off
  */
 float Adafruit_BME280::readHumidity(void) {
-  int32_t var1, var2, var3, var4, var5;
   if (_humReg.osrs_h == sensor_sampling::SAMPLING_NONE)
     return NAN;
 
   readTemperature(); // must be done first to get t_fine
 
   int32_t adc_H = read16(BME280_REGISTER_HUMIDDATA);
+  return compensateHumidity(adc_H);
+}
+
+/*!
+ *  @brief  Compensates a raw humidity reading, t_fine must be set first
+ *  @param adc_H 16 bit raw humidity
+ *  @returns the relative humidity in percent
+ */
+float Adafruit_BME280::compensateHumidity(int32_t adc_H) {
+  int32_t var1, var2, var3, var4, var5;
+
   var1 = t_fine - ((int32_t)76800);
   var2 = (int32_t)(adc_H * 16384);
   var3 = (int32_t)(((int32_t)_bme280_calib.dig_H4) * 1048576);
@@ -426,6 +456,49 @@ float Adafruit_BME280::readHumidity(void) {
   return (float)H / 1024.0;
 }
 
+/*!
+ *  @brief  Reads temperature, pressure and humidity from the same conversion
+ *          with one burst read. readPressure() and readHumidity() each read
+ *          the temperature again to get t_fine.
+ *  @param temperature temperature in degrees celsius, NaN if sampling off
+ *  @param pressure pressure in Pascal, NaN if sampling off
+ *  @param humidity relative humidity in percent, NaN if sampling off
+ *  @returns true on success
+ */
+bool Adafruit_BME280::readAll(float *temperature, float *pressure,
+                              float *humidity) {
+  uint8_t buffer[8];
+  bool ok;
+
+  if (i2c_dev) {
+    buffer[0] = uint8_t(BME280_REGISTER_PRESSUREDATA);
+    ok = i2c_dev->write_then_read(buffer, 1, buffer, 8);
+  } else {
+    buffer[0] = uint8_t(BME280_REGISTER_PRESSUREDATA | 0x80);
+    ok = spi_dev->write_then_read(buffer, 1, buffer, 8);
+  }
+  if (!ok)
+    return false;
+
+  int32_t adc_P = (uint32_t(buffer[0]) << 12) | (uint32_t(buffer[1]) << 4) |
+                  (buffer[2] >> 4);
+  int32_t adc_T = (uint32_t(buffer[3]) << 12) | (uint32_t(buffer[4]) << 4) |
+                  (buffer[5] >> 4);
+  int32_t adc_H = (uint32_t(buffer[6]) << 8) | buffer[7];
+
+  // Temperature first, it sets t_fine for the others
+  *temperature = compensateTemperature(adc_T);
+  *pressure = (_measReg.osrs_p == sensor_sampling::SAMPLING_NONE)
+                  ? NAN
+                  : compensatePressure(adc_P);
+  *humidity = (_humReg.osrs_h == sensor_sampling::SAMPLING_NONE)
+                  ? NAN
+                  : compensateHumidity(adc_H);
+  if (_measReg.osrs_t == sensor_sampling::SAMPLING_NONE)
+    *temperature = NAN;
+  return true;
+}
+
 /*!
  *   Calculates the altitude (in meters) from the specified atmospheric
  *   pressure (in hPa), and sea-level pressure (in hPa).
@@ -229,6 +229,7 @@ public:
   float readTemperature(void);
   float readPressure(void);
   float readHumidity(void);
+  bool readAll(float *temperature, float *pressure, float *humidity);
 
   float readAltitude(float seaLevel);
   float seaLevelForAltitude(float altitude, float pressure);
@@ -256,6 +257,9 @@ protected:
 
   void readCoefficients(void);
   bool isReadingCalibration(void);
+  float compensateTemperature(int32_t adc_T);
+  float compensatePressure(int32_t adc_P);
+  float compensateHumidity(int32_t adc_H);
 
   void write8(byte reg, byte value);
   uint8_t read8(byte reg);
@@ -246,13 +246,23 @@ void Adafruit_BMP280::readCoefficients() {
  * @return The temperature in degrees celsius.
  */
 float Adafruit_BMP280::readTemperature() {
-  int32_t var1, var2;
   if (!_sensorID)
     return NAN; // begin() not called yet
 
   int32_t adc_T = read24(BMP280_REGISTER_TEMPDATA);
   adc_T >>= 4;
 
+  return compensateTemperature(adc_T);
+}
+
+/*!
+ * Compensates a raw temperature reading and sets t_fine.
+ * @param adc_T 20 bit raw temperature.
+ * @return The temperature in degrees celsius.
+ */
+float Adafruit_BMP280::compensateTemperature(int32_t adc_T) {
+  int32_t var1, var2;
+
   var1 = ((((adc_T >> 3) - ((int32_t)_bmp280_calib.dig_T1 << 1))) *
           ((int32_t)_bmp280_calib.dig_T2)) >>
          11;
@@ -274,7 +284,6 @@ float Adafruit_BMP280::readTemperature() {
  * @return Barometric pressure in Pa.
  */
 float Adafruit_BMP280::readPressure() {
-  int64_t var1, var2, p;
   if (!_sensorID)
     return NAN; // begin() not called yet
 
@@ -284,6 +293,17 @@ float Adafruit_BMP280::readPressure() {
   int32_t adc_P = read24(BMP280_REGISTER_PRESSUREDATA);
   adc_P >>= 4;
 
+  return compensatePressure(adc_P);
+}
+
+/*!
+ * Compensates a raw pressure reading, t_fine must be set first.
+ * @param adc_P 20 bit raw pressure.
+ * @return Barometric pressure in Pa.
+ */
+float Adafruit_BMP280::compensatePressure(int32_t adc_P) {
+  int64_t var1, var2, p;
+
   var1 = ((int64_t)t_fine) - 128000;
   var2 = var1 * var1 * (int64_t)_bmp280_calib.dig_P6;
   var2 = var2 + ((var1 * (int64_t)_bmp280_calib.dig_P5) << 17);
@@ -305,6 +325,40 @@ float Adafruit_BMP280::readPressure() {
   return (float)p / 256;
 }
 
+/*!
+ * Reads temperature and pressure from the same conversion with one burst
+ * read, instead of the temperature read readPressure() repeats.
+ * @param temperature Temperature in degrees celsius.
+ * @param pressure Barometric pressure in Pa.
+ * @return True on success.
+ */
+bool Adafruit_BMP280::readAll(float *temperature, float *pressure) {
+  uint8_t buffer[6];
+  bool ok;
+
+  if (!_sensorID)
+    return false; // begin() not called yet
+
+  if (i2c_dev) {
+    buffer[0] = uint8_t(BMP280_REGISTER_PRESSUREDATA);
+    ok = i2c_dev->write_then_read(buffer, 1, buffer, 6);
+  } else {
+    buffer[0] = uint8_t(BMP280_REGISTER_PRESSUREDATA | 0x80);
+    ok = spi_dev->write_then_read(buffer, 1, buffer, 6);
+  }
+  if (!ok)
+    return false;
+
+  int32_t adc_P = (uint32_t(buffer[0]) << 12) | (uint32_t(buffer[1]) << 4) |
+                  (buffer[2] >> 4);
+  int32_t adc_T = (uint32_t(buffer[3]) << 12) | (uint32_t(buffer[4]) << 4) |
+                  (buffer[5] >> 4);
+
+  *temperature = compensateTemperature(adc_T);
+  *pressure = compensatePressure(adc_P);
+  return true;
+}
+
 /*!
  * @brief Calculates the approximate altitude using barometric pressure and the
  * supplied sea level hPa as a reference.
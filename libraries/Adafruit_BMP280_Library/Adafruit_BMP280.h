@@ -191,6 +191,7 @@ public:
 
   float readTemperature();
   float readPressure(void);
+  bool readAll(float *temperature, float *pressure);
   float readAltitude(float seaLevelhPa = 1013.25);
   float seaLevelForAltitude(float altitude, float atmospheric);
   float waterBoilingPoint(float pressure);
@@ -245,6 +246,8 @@ private:
   };
 
   void readCoefficients(void);
+  float compensateTemperature(int32_t adc_T);
+  float compensatePressure(int32_t adc_P);
   uint8_t spixfer(uint8_t x);
   void write8(byte reg, byte value);
   uint8_t read8(byte reg);
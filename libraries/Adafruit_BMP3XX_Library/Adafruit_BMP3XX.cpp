@@ -58,6 +58,7 @@ static int8_t cal_crc(uint8_t seed, uint8_t data);
 Adafruit_BMP3XX::Adafruit_BMP3XX(void) {
   _meas_end = 0;
   _filterEnabled = _tempOSEnabled = _presOSEnabled = false;
+  _normalMode = false;
 }
 
 /**************************************************************************/
@@ -240,6 +241,7 @@ bool Adafruit_BMP3XX::_init(void) {
 
   // don't do anything till we request a reading
   the_sensor.settings.op_mode = BMP3_MODE_FORCED;
+  _normalMode = false;
 
   return true;
 }
@@ -311,22 +313,73 @@ bool Adafruit_BMP3XX::performReading(void) {
   g_i2c_dev = i2c_dev;
   g_spi_dev = spi_dev;
   int8_t rslt;
+  /* Variable used to select the sensor component */
+  uint8_t sensor_comp = BMP3_TEMP | BMP3_PRESS;
+
+  /* In normal mode the sensor converts on its own, only read the result */
+  if (!_normalMode) {
+    if (!_setSettings())
+      return false;
+
+    /* Set the power mode */
+    the_sensor.settings.op_mode = BMP3_MODE_FORCED;
+#ifdef BMP3XX_DEBUG
+    Serial.println(F("Setting power mode"));
+#endif
+    rslt = bmp3_set_op_mode(&the_sensor);
+    if (rslt != BMP3_OK)
+      return false;
+  }
+
+  /* Variable used to store the compensated data */
+  struct bmp3_data data;
+
+  /* Temperature and Pressure data are read and stored in the bmp3_data instance
+   */
+#ifdef BMP3XX_DEBUG
+  Serial.println(F("Getting sensor data"));
+#endif
+  rslt = bmp3_get_sensor_data(sensor_comp, &data, &the_sensor);
+  if (rslt != BMP3_OK)
+    return false;
+
+  /*
+#ifdef BMP3XX_DEBUG
+  Serial.println(F("Analyzing sensor data"));
+#endif
+  rslt = analyze_sensor_data(&data);
+  if (rslt != BMP3_OK)
+    return false;
+    */
+
+  /* Save the temperature and pressure data */
+  temperature = data.temperature;
+  pressure = data.pressure;
+
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Writes the oversampling, IIR filter and ODR settings and enables
+   the pressure and temperature sensors.
+
+    @return True on success, False on failure
+*/
+/**************************************************************************/
+bool Adafruit_BMP3XX::_setSettings(void) {
   /* Used to select the settings user needs to change */
   uint16_t settings_sel = 0;
-  /* Variable used to select the sensor component */
-  uint8_t sensor_comp = 0;
 
   /* Select the pressure and temperature sensor to be enabled */
   the_sensor.settings.temp_en = BMP3_ENABLE;
   settings_sel |= BMP3_SEL_TEMP_EN;
-  sensor_comp |= BMP3_TEMP;
   if (_tempOSEnabled) {
     settings_sel |= BMP3_SEL_TEMP_OS;
   }
 
   the_sensor.settings.press_en = BMP3_ENABLE;
   settings_sel |= BMP3_SEL_PRESS_EN;
-  sensor_comp |= BMP3_PRESS;
   if (_presOSEnabled) {
     settings_sel |= BMP3_SEL_PRESS_OS;
   }
@@ -346,45 +399,31 @@ bool Adafruit_BMP3XX::performReading(void) {
 #ifdef BMP3XX_DEBUG
   Serial.println("Setting sensor settings");
 #endif
-  rslt = bmp3_set_sensor_settings(settings_sel, &the_sensor);
-
-  if (rslt != BMP3_OK)
-    return false;
+  return (bmp3_set_sensor_settings(settings_sel, &the_sensor) == BMP3_OK);
+}
 
-  /* Set the power mode */
-  the_sensor.settings.op_mode = BMP3_MODE_FORCED;
-#ifdef BMP3XX_DEBUG
-  Serial.println(F("Setting power mode"));
-#endif
-  rslt = bmp3_set_op_mode(&the_sensor);
-  if (rslt != BMP3_OK)
-    return false;
+/**************************************************************************/
+/*!
+    @brief Puts the sensor in normal mode, converting continuously at the
+   output data rate with the oversampling and IIR filter settings. After this
+   performReading() reads the latest result without starting a conversion.
 
-  /* Variable used to store the compensated data */
-  struct bmp3_data data;
+    @return True on success, False on failure, the ODR must be longer than
+   the conversion time of the oversampling settings
+*/
+/**************************************************************************/
+bool Adafruit_BMP3XX::startNormalMode(void) {
+  g_i2c_dev = i2c_dev;
+  g_spi_dev = spi_dev;
 
-  /* Temperature and Pressure data are read and stored in the bmp3_data instance
-   */
-#ifdef BMP3XX_DEBUG
-  Serial.println(F("Getting sensor data"));
-#endif
-  rslt = bmp3_get_sensor_data(sensor_comp, &data, &the_sensor);
-  if (rslt != BMP3_OK)
+  if (!_setSettings())
     return false;
 
-  /*
-#ifdef BMP3XX_DEBUG
-  Serial.println(F("Analyzing sensor data"));
-#endif
-  rslt = analyze_sensor_data(&data);
-  if (rslt != BMP3_OK)
+  the_sensor.settings.op_mode = BMP3_MODE_NORMAL;
+  if (bmp3_set_op_mode(&the_sensor) != BMP3_OK)
     return false;
-    */
-
-  /* Save the temperature and pressure data */
-  temperature = data.temperature;
-  pressure = data.pressure;
 
+  _normalMode = true;
   return true;
 }
 
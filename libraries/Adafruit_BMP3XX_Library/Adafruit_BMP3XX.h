@@ -58,7 +58,9 @@ public:
   bool setIIRFilterCoeff(uint8_t fs);
   bool setOutputDataRate(uint8_t odr);
 
-  /// Perform a reading in blocking mode
+  bool startNormalMode(void);
+
+  /// Perform a reading in blocking mode, or read the latest in normal mode
   bool performReading(void);
 
   /// Temperature (Celsius) assigned after calling performReading()
@@ -71,8 +73,10 @@ private:
   Adafruit_SPIDevice *spi_dev = NULL; ///< Pointer to SPI bus interface
 
   bool _init(void);
+  bool _setSettings(void);
 
   bool _filterEnabled, _tempOSEnabled, _presOSEnabled, _ODREnabled;
+  bool _normalMode;
   uint8_t _i2caddr;
   int32_t _sensorID;
   int8_t _cs;
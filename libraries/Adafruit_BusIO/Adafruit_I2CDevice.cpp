@@ -2,6 +2,9 @@
 
 // #define DEBUG_SERIAL Serial
 
+Adafruit_I2CDevice_Hook Adafruit_I2CDevice_hook = nullptr;
+Adafruit_I2CDevice_StartHook Adafruit_I2CDevice_start_hook = nullptr;
+
 /*!
  *    @brief  Create an I2C device at a given address
  *    @param  addr The 7-bit I2C address for the device
@@ -66,6 +69,9 @@ bool Adafruit_I2CDevice::detected(void) {
   }
 
   // A basic scanner, see if it ACK's
+  if (Adafruit_I2CDevice_start_hook) {
+    Adafruit_I2CDevice_start_hook(_addr);
+  }
   _wire->beginTransmission(_addr);
 #ifdef DEBUG_SERIAL
   DEBUG_SERIAL.print(F("Address 0x"));
@@ -112,6 +118,10 @@ bool Adafruit_I2CDevice::write(const uint8_t *buffer, size_t len, bool stop,
     return false;
   }
 
+  if (Adafruit_I2CDevice_start_hook) {
+    Adafruit_I2CDevice_start_hook(_addr);
+  }
+  uint32_t start_us = micros();
   _wire->beginTransmission(_addr);
 
   // Write the prefix data (usually an address)
@@ -158,7 +168,12 @@ bool Adafruit_I2CDevice::write(const uint8_t *buffer, size_t len, bool stop,
   }
 #endif
 
-  if (_wire->endTransmission(stop) == 0) {
+  uint8_t status = _wire->endTransmission(stop);
+  if (Adafruit_I2CDevice_hook) {
+    Adafruit_I2CDevice_hook(_addr, status, start_us);
+  }
+
+  if (status == 0) {
 #ifdef DEBUG_SERIAL
     DEBUG_SERIAL.println();
     // DEBUG_SERIAL.println("Sent!");
@@ -194,6 +209,10 @@ bool Adafruit_I2CDevice::read(uint8_t *buffer, size_t len, bool stop) {
 }
 
 bool Adafruit_I2CDevice::_read(uint8_t *buffer, size_t len, bool stop) {
+  if (Adafruit_I2CDevice_start_hook) {
+    Adafruit_I2CDevice_start_hook(_addr);
+  }
+  uint32_t start_us = micros();
 #if defined(TinyWireM_h)
   size_t recv = _wire->requestFrom((uint8_t)_addr, (uint8_t)len);
 #elif defined(ARDUINO_ARCH_MEGAAVR)
@@ -202,6 +221,11 @@ bool Adafruit_I2CDevice::_read(uint8_t *buffer, size_t len, bool stop) {
   size_t recv = _wire->requestFrom((uint8_t)_addr, (uint8_t)len, (uint8_t)stop);
 #endif
 
+  if (Adafruit_I2CDevice_hook) {
+    Adafruit_I2CDevice_hook(_addr, (recv == len) ? 0 : ((recv == 0) ? 2 : 4),
+                            start_us);
+  }
+
   if (recv != len) {
     // Not enough data available to fulfill our obligation!
 #ifdef DEBUG_SERIAL
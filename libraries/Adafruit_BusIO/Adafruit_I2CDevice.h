@@ -4,6 +4,19 @@
 #include <Arduino.h>
 #include <Wire.h>
 
+/*!  @brief  Called after each read or write transaction when set, for bus
+ *   health accounting. status is the endTransmission() code, 0 success, 2 or 3
+ *   NACK, 4 other error. A read is 2 when no bytes came back and 4 when short.
+ *   start_us is micros() at the start of the transaction. */
+typedef void (*Adafruit_I2CDevice_Hook)(uint8_t addr, uint8_t status,
+                                        uint32_t start_us);
+extern Adafruit_I2CDevice_Hook Adafruit_I2CDevice_hook;
+
+/*!  @brief  Called before each read, write or detect transaction when set,
+ *   to select the bus clock for the device at addr. */
+typedef void (*Adafruit_I2CDevice_StartHook)(uint8_t addr);
+extern Adafruit_I2CDevice_StartHook Adafruit_I2CDevice_start_hook;
+
 ///< The class which defines how we will talk to this device over I2C
 class Adafruit_I2CDevice {
 public:
@@ -83,6 +83,13 @@ bool Adafruit_DS248x::reset() {
 bool Adafruit_DS248x::selectChannel(uint8_t chan) {
   if (chan > 7)
     return false;
+
+  // Channel select is not accepted until 1-Wire activity has ended, a single
+  // bit write returns without waiting for its slot
+  if (!busyWait(1000)) {
+    return false; // Return false if the bus is busy after the timeout
+  }
+
   uint8_t channelcode = chan + (~chan << 4);
 
   uint8_t cmd[2] = {DS248X_CMD_CHANNEL_SELECT, channelcode};
@@ -112,6 +119,12 @@ bool Adafruit_DS248x::OneWireReset() {
     return false; // Return false if writing the command fails
   }
 
+  // Presence and short are sampled part way through the reset, wait for it
+  // to finish. At 400 kHz the status read is back before they are valid.
+  if (!busyWait(1000)) {
+    return false; // Return false if the bus is busy after the timeout
+  }
+
   // Read the status register to verify the reset
   uint8_t status = readStatus();
   return (status != 0xFF) && !shortDetected() && presencePulseDetected();
@@ -146,3 +146,44 @@ float Adafruit_HTU21DF::readHumidity(void) {
 
   return hum;
 }
+
+/**
+ * Performs a temperature then a humidity conversion. The sensor can only
+ * convert one at a time, the humidity waits only its own conversion time.
+ *
+ * @param temperature Degrees Celsius, NAN on failure.
+ * @param humidity Relative humidity in percent, NAN on failure.
+ * @return True if both were read.
+ */
+bool Adafruit_HTU21DF::readBoth(float *temperature, float *humidity) {
+  *temperature = readTemperature();
+  *humidity = NAN;
+  if (isnan(*temperature)) {
+    return false;
+  }
+
+  uint8_t cmd = HTU21DF_READHUM;
+  if (!i2c_dev->write(&cmd, 1)) {
+    return false;
+  }
+
+  delay(HTU21DF_HUM_MS);
+
+  uint8_t buf[3];
+  if (!i2c_dev->read(buf, 3)) {
+    return false;
+  }
+
+  uint16_t h = buf[0];
+  h <<= 8;
+  h |= buf[1] & 0b11111100;
+
+  float hum = h;
+  hum *= 125.0f;
+  hum /= 65536.0f;
+  hum -= 6.0f;
+
+  _last_humidity = hum;
+  *humidity = hum;
+  return true;
+}
@@ -17,6 +17,9 @@
 /** Read humidity register. */
 #define HTU21DF_READHUM (0xE5)
 
+/** Longest 12 bit humidity conversion in ms. */
+#define HTU21DF_HUM_MS (16)
+
 /** Write register command. */
 #define HTU21DF_WRITEREG (0xE6)
 
@@ -36,6 +39,7 @@ public:
   bool begin(TwoWire *theWire = &Wire);
   float readTemperature(void);
   float readHumidity(void);
+  bool readBoth(float *temperature, float *humidity);
   void reset(void);
 
 private:
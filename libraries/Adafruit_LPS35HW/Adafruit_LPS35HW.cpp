@@ -179,6 +179,33 @@ float Adafruit_LPS35HW::readPressure(void) {
   return (raw_pressure / 4096.0);
 }
 
+/**************************************************************************/
+/*!
+    @brief Reads pressure and temperature from the same conversion with one
+            burst read of the output registers.
+    @param temperature The temperature in degrees C
+    @param pressure The pressure in hPa, relative to the reference temperature
+    @return True on success
+*/
+/**************************************************************************/
+bool Adafruit_LPS35HW::readAll(float *temperature, float *pressure) {
+  uint8_t buffer[5];
+  Adafruit_BusIO_Register out = Adafruit_BusIO_Register(
+      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LPS35HW_PRESS_OUT_XL, 5);
+
+  if (!out.read(buffer, 5)) {
+    return false;
+  }
+  // 24 bit pressure, shifted to the top to sign extend
+  int32_t raw_pressure = (int32_t)(((uint32_t)buffer[2] << 24) |
+                                   ((uint32_t)buffer[1] << 16) |
+                                   ((uint32_t)buffer[0] << 8)) >>
+                         8;
+  *pressure = raw_pressure / 4096.0;
+  *temperature = (int16_t)(((uint16_t)buffer[4] << 8) | buffer[3]) / 100.0;
+  return true;
+}
+
 /**************************************************************************/
 /*!
     @brief Takes a new measurement while in one shot mode.
@@ -78,6 +78,7 @@ public:
   void reset(void);
   float readTemperature(void);
   float readPressure(void);
+  bool readAll(float *temperature, float *pressure);
   void setDataRate(LPS35HW_DataRate new_rate);
   void takeMeasurement(void);
   void zeroPressure(void);
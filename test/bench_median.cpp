@@ -0,0 +1,122 @@
+/*
+ * ======================================================================================================================
+ *  bench_median.cpp - Distance gauge running median against the bubble sort it replaced
+ *
+ *  The old DS_Median() bubble sorted the 60 sample ring on every call. Both are fed the same gauge samples
+ *  through DS_TakeReading(), the median has to match a sorted copy of the ring on every update, and the time
+ *  per update plus median is reported for each.
+ *    sort copy  - mysort() on a copy of the ring, the cost of a correct sort based median
+ *    sort ring  - mysort() on the ring in place as the old code did, cheap on already sorted data but it
+ *                 destroyed the time order
+ * ======================================================================================================================
+ */
+#include <Arduino.h>
+#include <chrono>
+#include "include/wrda.h"
+#include "test.h"
+
+#define UPDATES 100000
+
+/*
+ * ======================================================================================================================
+ * mysort() - The old support.cpp bubble sort
+ * ======================================================================================================================
+ */
+static void myswap(unsigned int *p, unsigned int *q) {
+  int t;
+
+  t=*p;
+  *p=*q;
+  *q=t;
+}
+
+static void mysort(unsigned int a[], unsigned int n) {
+  unsigned int i, j;
+
+  for(i = 0;i < n-1;i++) {
+    for(j = 0;j < n-i-1;j++) {
+      if(a[j] > a[j+1])
+        myswap(&a[j],&a[j+1]);
+    }
+  }
+}
+
+static double now_ns() {
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+ * ======================================================================================================================
+ * gauge_sample() - A slowly moving level with noise and the odd ultrasonic dropout to 0 or full range
+ * ======================================================================================================================
+ */
+static int gauge_sample(int i) {
+  int level = 1200 + (int) (300.0 * sin(i / 5000.0));
+
+  if ((rand() % 50) == 0) {
+    return (rand() & 1) ? 0 : 4095;
+  }
+  return level + (rand() % 21) - 10;
+}
+
+int main() {
+  static int samples[UPDATES];
+  unsigned int ring[DG_BUCKETS], copy[DG_BUCKETS];
+  volatile float sink = 0;
+  double t, heap_ns, copy_ns, ring_ns;
+  int bad = 0;
+
+  srand(29);
+  for (int i = 0; i < UPDATES; i++) {
+    samples[i] = gauge_sample(i);
+  }
+
+  // Running median, checked against a sorted copy of the ring after every update
+  DS_Clear();
+  memset(ring, 0, sizeof(ring));
+  for (int i = 0; i < UPDATES; i++) {
+    host_analog_set(DISTANCE_GAUGE_PIN, samples[i]);
+    DS_TakeReading();
+    ring[i % DG_BUCKETS] = samples[i] * dg_resolution_adjust;
+    memcpy(copy, ring, sizeof(copy));
+    mysort(copy, DG_BUCKETS);
+    if (DS_Median() != copy[(DG_BUCKETS+1) / 2 - 1]) {
+      bad++;
+    }
+  }
+  CHECK(bad == 0, "%d of %d medians differ from the sorted ring", bad, UPDATES);
+
+  DS_Clear();
+  t = now_ns();
+  for (int i = 0; i < UPDATES; i++) {
+    host_analog_set(DISTANCE_GAUGE_PIN, samples[i]);
+    DS_TakeReading();
+    sink = sink + DS_Median();
+  }
+  heap_ns = (now_ns() - t) / UPDATES;
+
+  memset(ring, 0, sizeof(ring));
+  t = now_ns();
+  for (int i = 0; i < UPDATES; i++) {
+    ring[i % DG_BUCKETS] = samples[i] * dg_resolution_adjust;
+    memcpy(copy, ring, sizeof(copy));
+    mysort(copy, DG_BUCKETS);
+    sink = sink + copy[(DG_BUCKETS+1) / 2 - 1];
+  }
+  copy_ns = (now_ns() - t) / UPDATES;
+
+  memset(ring, 0, sizeof(ring));
+  t = now_ns();
+  for (int i = 0; i < UPDATES; i++) {
+    ring[i % DG_BUCKETS] = samples[i] * dg_resolution_adjust;
+    mysort(ring, DG_BUCKETS);
+    sink = sink + ring[(DG_BUCKETS+1) / 2 - 1];
+  }
+  ring_ns = (now_ns() - t) / UPDATES;
+
+  printf("running median %8.1f ns/update\n", heap_ns);
+  printf("sort copy      %8.1f ns/update  %5.1fx\n", copy_ns, copy_ns / heap_ns);
+  printf("sort ring      %8.1f ns/update  %5.1fx\n", ring_ns, ring_ns / heap_ns);
+  CHECK(heap_ns < copy_ns, "running median is not faster than sorting a copy");
+  return TEST_END();
+}
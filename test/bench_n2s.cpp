@@ -0,0 +1,316 @@
+/*
+ * ======================================================================================================================
+ *  bench_n2s.cpp - N2S spool read rate, the sector reader against the readers it replaced
+ *
+ *  A backlog of observations is spooled with SD_N2S_Write() into segment files on the file backed SdFat stand-in,
+ *  one record with a bad CRC and one with a damaged header among them. Each reader reads all of the segments
+ *  REPEAT times, the records per second and the SdFat read() calls per record are reported.
+ *    line    - the old publish loop, fp.read() one byte at a time up to the "\n"
+ *    record  - the framed reader before the sector buffer, header, payload and "\n" each read from SdFat
+ *    sector  - SD_N2S_ReadRecord(), one 512 byte sector at a time
+ *  The sector reader has to return the same payloads, CRC errors and cursor positions as the record reader,
+ *  resume from any record's cursor, and be faster than the line reader.
+ * ======================================================================================================================
+ */
+#include <Arduino.h>
+#include <chrono>
+#include <sys/stat.h>
+#include "include/sdcard.h"
+#include "include/obs.h"
+#include "include/support.h"
+#include "test.h"
+
+#define RECORDS     400
+#define REPEAT      5
+#define BAD_CRC     37                 // Records damaged after they are spooled
+#define BAD_HEADER  211
+
+typedef struct {
+  const char *name;
+  unsigned long records;
+  unsigned long reads;
+  double ns;
+} BENCH_READER_STR;
+
+static uint32_t bad_offset[2];        // Where in its segment each damaged record starts
+static uint32_t bad_seq[2];
+static uint32_t cursors[RECORDS];     // Record reader cursor after each record, SD_N2S_CURSOR()
+static int cursor_count = 0;
+
+// sdcard.cpp
+extern uint32_t n2s_tail_size;
+extern uint32_t n2s_segments_max;
+long SD_N2S_Hex(const char *s, int n);
+
+static double now_ns() {
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+ * ======================================================================================================================
+ * seg_path() - Path of a spool segment, as SD_N2S_Name()
+ * ======================================================================================================================
+ */
+static void seg_path(char *path, uint32_t seq) {
+  sprintf(path, "%s/%08lX.TXT", SD_N2S_DIR, (unsigned long) seq);
+}
+
+/*
+ * ======================================================================================================================
+ * obs_text() - Observation i, a station URL from 120 to 1000 bytes so records cross sector boundaries
+ * ======================================================================================================================
+ */
+static int obs_text(int i, char *buf) {
+  int len = 120 + (i * 337) % 881;
+  int n = sprintf(buf, "/measurements/url_create?key=bench&instrument_id=%d&at=2025-10-19T%02d:%02d:00", i,
+    (i / 60) % 24, i % 60);
+
+  while (n < len) {
+    n += sprintf(&buf[n], "&s%d=%d.%d", n % 97, (i * n) % 1000, n % 10);
+  }
+  buf[len] = 0;
+  return (len);
+}
+
+/*
+ * ======================================================================================================================
+ * spool_clear() - Remove the segments of an earlier run
+ * ======================================================================================================================
+ */
+static void spool_clear() {
+  File dir, fp;
+  char name[16];
+  char path[32];
+
+  dir = SD.open(SD_N2S_DIR);
+  while (fp.openNext(&dir, O_RDONLY)) {
+    fp.getName(name, sizeof(name));
+    fp.close();
+    snprintf(path, sizeof(path), "%s/%s", SD_N2S_DIR, name);
+    SD.remove(path);
+  }
+  dir.close();
+}
+
+/*
+ * ======================================================================================================================
+ * spool() - Write the backlog and damage two records
+ * ======================================================================================================================
+ */
+static void spool() {
+  char obs[MAX_OBS_SIZE];
+  char path[24];
+  int len;
+  File fp;
+
+  mkdir(host_sd_root, 0755);
+  SD.mkdir(SD_N2S_DIR);
+  spool_clear();
+  SD_exists = true;
+  n2s_head = n2s_tail = 0;
+  n2s_bytes = 0;
+  n2s_segments_max = SD_N2S_SEGMENTS_MAX;
+
+  for (int i = 0; i < RECORDS; i++) {
+    len = obs_text(i, obs);
+    CHECK(SD_N2S_Write(obs), "write %d", i);
+    if ((i == BAD_CRC) || (i == BAD_HEADER)) {
+      bad_seq[i == BAD_HEADER] = n2s_tail;
+      bad_offset[i == BAD_HEADER] = n2s_tail_size - (SD_N2S_HEADER_SIZE + len + 1);
+    }
+  }
+
+  // A payload byte for a CRC error, the header "@" for a resync on the next record
+  for (int b = 0; b < 2; b++) {
+    seg_path(path, bad_seq[b]);
+    fp = SD.open(path, O_RDWR);
+    fp.seek(bad_offset[b] + ((b) ? 0 : SD_N2S_HEADER_SIZE + 20));
+    fp.write((uint8_t) '#');
+    fp.close();
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * line_read() - The old publish loop, one byte at a time to the "\n", records not checked
+ * ======================================================================================================================
+ */
+static int line_read(File &fp, char *buf, int size) {
+  int i = 0;
+  int ch;
+
+  while ((ch = fp.read()) >= 0) {
+    if (ch == '\n') {
+      buf[i] = 0;
+      return (i);
+    }
+    if (i < size - 1) {
+      buf[i++] = ch;
+    }
+  }
+  return (SD_N2S_EOF);
+}
+
+/*
+ * ======================================================================================================================
+ * record_read() - The framed reader before the sector buffer
+ * ======================================================================================================================
+ */
+static int record_read(File &fp, char *buf, int size) {
+  char header[SD_N2S_HEADER_SIZE];
+  uint32_t start = fp.position();
+  long len, crc;
+  int n;
+
+  n = fp.read(header, SD_N2S_HEADER_SIZE);
+  if (n <= 0) {
+    return (SD_N2S_EOF);
+  }
+  if ((n == SD_N2S_HEADER_SIZE) && (header[0] == '@') && (header[SD_N2S_HEADER_SIZE-1] == ' ')) {
+    len = SD_N2S_Hex(&header[1], 4);
+    crc = SD_N2S_Hex(&header[5], 4);
+    if ((len > 0) && (crc >= 0) && (len < size) && (fp.read(buf, len) == len) && (fp.read() == '\n')) {
+      buf[len] = 0;
+      if (crc16_ccitt(0xFFFF, (uint8_t *) buf, len) == crc) {
+        return (len);
+      }
+      return (SD_N2S_BAD);
+    }
+  }
+
+  fp.seek(start + 1);
+  while ((n = fp.read()) >= 0) {
+    if (n == '@') {
+      fp.seek(fp.position() - 1);
+      break;
+    }
+  }
+  return (SD_N2S_BAD);
+}
+
+/*
+ * ======================================================================================================================
+ * run() - Read all of the segments with a reader, check to match the sector reader against the record reader
+ * ======================================================================================================================
+ */
+static void run(BENCH_READER_STR *b, int which, bool check) {
+  static SD_N2S_READER reader;
+  static char ref[MAX_OBS_SIZE];
+  char buf[MAX_OBS_SIZE];
+  char path[24];
+  char *payload;
+  double start;
+  unsigned long reads = host_sd_reads;
+  int len, rlen;
+  int bad = 0;
+  File fp, rfp;
+
+  start = now_ns();
+  for (uint32_t seq = n2s_head; seq <= n2s_tail; seq++) {
+    seg_path(path, seq);
+    fp = SD.open(path, FILE_READ);
+    if (which == 2) {
+      SD_N2S_ReaderStart(&reader, &fp, 0);
+    }
+    while (true) {
+      switch (which) {
+        case 0 :  len = line_read(fp, buf, sizeof(buf)); break;
+        case 1 :  len = record_read(fp, buf, sizeof(buf)); break;
+        default : len = SD_N2S_ReadRecord(&reader, &payload); break;
+      }
+      if (len == SD_N2S_EOF) {
+        break;
+      }
+      if (len == SD_N2S_BAD) {
+        bad++;
+      }
+      else {
+        b->records++;
+      }
+      if (which == 1) {
+        cursors[cursor_count++ % RECORDS] = SD_N2S_CURSOR(seq, fp.position());
+      }
+
+      if (check) {
+        if (!rfp) {
+          rfp = SD.open(path, FILE_READ);
+        }
+        rlen = record_read(rfp, ref, sizeof(ref));
+        CHECK(len == rlen, "%08lX record ends %lu, %d expected %d", (unsigned long) seq,
+          (unsigned long) SD_N2S_ReaderPosition(&reader), len, rlen);
+        CHECK((len < 0) || (memcmp(payload, ref, len + 1) == 0), "%08lX payload ending %lu", (unsigned long) seq,
+          (unsigned long) SD_N2S_ReaderPosition(&reader));
+        CHECK(SD_N2S_ReaderPosition(&reader) == rfp.position(), "%08lX cursor %lu expected %lu", (unsigned long) seq,
+          (unsigned long) SD_N2S_ReaderPosition(&reader), (unsigned long) rfp.position());
+      }
+    }
+    fp.close();
+    rfp.close();
+  }
+  b->ns += now_ns() - start;
+  b->reads += host_sd_reads - reads;
+
+  if (which) {
+    CHECK(bad == 2, "%s %d bad records", b->name, bad);
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * resume() - From every record's cursor the sector reader reads the record after it
+ * ======================================================================================================================
+ */
+static void resume() {
+  SD_N2S_READER reader;
+  char ref[MAX_OBS_SIZE];
+  char path[24];
+  char *payload;
+  int len, rlen;
+  File fp, rfp;
+
+  for (int i = 0; i < RECORDS - 2; i++) {
+    seg_path(path, cursors[i] >> 16);
+    fp = SD.open(path, FILE_READ);
+    rfp = SD.open(path, FILE_READ);
+    SD_N2S_ReaderStart(&reader, &fp, cursors[i] & 0xFFFF);
+    rfp.seek(cursors[i] & 0xFFFF);
+    len = SD_N2S_ReadRecord(&reader, &payload);
+    rlen = record_read(rfp, ref, sizeof(ref));
+    CHECK((len == rlen) && ((len < 0) || (memcmp(payload, ref, len + 1) == 0)) &&
+      (SD_N2S_ReaderPosition(&reader) == rfp.position()), "resume at %08lX %d, %d expected %d",
+      (unsigned long) (cursors[i] >> 16), (int) (cursors[i] & 0xFFFF), len, rlen);
+    fp.close();
+    rfp.close();
+  }
+}
+
+int main() {
+  BENCH_READER_STR b[3] = {{"line", 0, 0, 0}, {"record", 0, 0, 0}, {"sector", 0, 0, 0}};
+
+  spool();
+  CHECK(n2s_tail > n2s_head, "spool of one segment");
+
+  run(&b[1], 1, false);                // Cursors for resume()
+  run(&b[2], 2, true);
+  resume();
+
+  for (int i = 0; i < 3; i++) {
+    b[i] = {b[i].name, 0, 0, 0};
+  }
+  for (int r = 0; r < REPEAT; r++) {
+    for (int i = 0; i < 3; i++) {
+      run(&b[i], i, false);
+    }
+  }
+
+  printf("N2S spool read, %d records %lu bytes in %lu segments\n", RECORDS, (unsigned long) n2s_bytes,
+    (unsigned long) (n2s_tail - n2s_head + 1));
+  for (int i = 0; i < 3; i++) {
+    printf("  %-7s %10.0f records/s  %7.2f reads/record\n", b[i].name, b[i].records / (b[i].ns / 1e9),
+      (double) b[i].reads / b[i].records);
+  }
+  CHECK(b[2].reads * 2 < b[1].reads, "sector reader %lu reads, record reader %lu", b[2].reads, b[1].reads);
+  CHECK(b[2].ns < b[0].ns, "not faster %.0f ns against %.0f ns", b[2].ns, b[0].ns);
+
+  return TEST_END();
+}
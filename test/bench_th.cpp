@@ -0,0 +1,191 @@
+/*
+ * ======================================================================================================================
+ *  bench_th.cpp - T/RH observation time, TH_Trigger()/TH_Collect() against the serial library reads it replaced
+ *
+ *  A station with an SHT45, an SHT31, an HDC3022, an HTU21DF and an HIH8 on the bus emulator, each model converting
+ *  with its datasheet conversion time. The old OBS_Take() read them one after the other through their libraries:
+ *  SHT31 readTemperature() and readHumidity() each measure, HTU21DF the same with hold master, SHT4x getEvent(),
+ *  HDC302x readTemperatureHumidityOnDemand() and the HIH8 data read. The new code triggers all of them, waits once
+ *  for the longest conversion and reads the results.
+ *    Both are run for OBSERVATIONS observations in simulated time, the values have to match what was set on the
+ *    models and the new code has to take no longer than the longest conversion plus the HTU21DF humidity stage.
+ * ======================================================================================================================
+ */
+#include <Arduino.h>
+#include "include/qc.h"
+#include "include/i2c.h"
+#include "include/sensors.h"
+#include "include/sensors_i2c_44_47.h"
+#include "include/th.h"
+#include "include/output.h"
+#include "emu.h"
+#include "test.h"
+
+#define OBSERVATIONS  10
+#define T_TOL         0.05             // C
+#define RH_TOL        0.1              // %
+#define HIH8_T_TOL    0.05             // 14 bit result
+#define HIH8_RH_TOL   0.2
+
+static EmuSHT4x sht45(0x44);
+static EmuSHT3x sht31(0x45);
+static EmuHDC302x hdc(0x46);
+static EmuHTU21DF htu21;
+static EmuHIH8 hih8;
+
+typedef struct {
+  const char *name;
+  float *t;                            // Set on the model
+  float *rh;
+  float t_tol;
+  float rh_tol;
+  uint64_t serial_us;                  // Time of its library read, summed over the observations
+} BENCH_DEV_STR;
+
+static BENCH_DEV_STR bench_devs[TH_DEVICES] = {
+  {"SHT45",   &sht45.t, &sht45.rh, T_TOL, RH_TOL, 0},
+  {"SHT31",   &sht31.t, &sht31.rh, T_TOL, RH_TOL, 0},
+  {"HDC302x", &hdc.t,   &hdc.rh,   T_TOL, RH_TOL, 0},
+  {NULL,      NULL,     NULL,      0,     0,      0},
+  {"HTU21DF", &htu21.t, &htu21.rh, T_TOL, RH_TOL, 0},
+  {"HIH8",    &hih8.t,  &hih8.rh,  HIH8_T_TOL, HIH8_RH_TOL, 0}
+};
+
+/*
+ * ======================================================================================================================
+ * serial_read() - The library read the old OBS_Take() did for a device
+ * ======================================================================================================================
+ */
+static bool serial_read(int dev, float *t, float *h) {
+  I2C_44_47_SENSOR_SLOT *s = (dev < I2C_44_47_SENSOR_COUNT) ? &i2c_44_47_sensors[dev] : NULL;
+
+  switch (dev) {
+    case TH_HTU21DF :
+      *h = htu.readHumidity();
+      *t = htu.readTemperature();
+      return (true);
+    case TH_HIH8 :
+      // The old read sent no measurement request of its own, the data came from the last one
+      return (hih8_getTempHumid(t, h));
+  }
+
+  switch (s->type) {
+    case SENSOR_SHT31 :
+      *t = s->sht3.readTemperature();
+      *h = s->sht3.readHumidity();
+      return (true);
+    case SENSOR_SHT45 : {
+      sensors_event_t humidity, temp;
+      bool ok = s->sht4.getEvent(&humidity, &temp);
+      *t = temp.temperature;
+      *h = humidity.relative_humidity;
+      return (ok);
+    }
+    case SENSOR_HDC302X : {
+      double dt, dh;
+      bool ok = s->hdc.readTemperatureHumidityOnDemand(dt, dh, TRIGGERMODE_LP0);
+      *t = dt;
+      *h = dh;
+      return (ok);
+    }
+    default :
+      return (false);
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * set_values() - New values on every model for an observation
+ * ======================================================================================================================
+ */
+static void set_values(int obs) {
+  for (int dev = 0; dev < TH_DEVICES; dev++) {
+    if (bench_devs[dev].name) {
+      *bench_devs[dev].t = 10.0 + 1.5 * obs + dev;
+      *bench_devs[dev].rh = 30.0 + 4.0 * obs + dev;
+    }
+  }
+}
+
+int main() {
+  uint64_t serial_us = 0, th_us = 0, start, us;
+  uint64_t serial_bus_us, th_bus_us;
+  float t, h;
+
+  EMU_Attach(&sht45);
+  EMU_Attach(&sht31);
+  EMU_Attach(&hdc);
+  EMU_Attach(&htu21);
+  EMU_Attach(&hih8);
+  delay(20);                           // Power up
+
+  I2C_Begin();
+  OLED_initialize();                   // None on the bus, turns the display output off
+  sensor_initialize_i2c_44_47();
+  htu21d_initialize();
+  hih8_initialize();
+  CHECK((i2c_44_47_sensors[0].type == SENSOR_SHT45) && (i2c_44_47_sensors[1].type == SENSOR_SHT31) &&
+    (i2c_44_47_sensors[2].type == SENSOR_HDC302X) && HTU21DF_exists && HIH8_exists, "station not found");
+
+  // Old, each sensor read in turn through its library
+  EMU_StatsClear();
+  for (int obs = 0; obs < OBSERVATIONS; obs++) {
+    set_values(obs);
+    hih8_getTempHumid(&t, &h);         // The previous observation's read, it leaves a measurement request
+    delay(60000);                      // Observation interval
+
+    for (int dev = 0; dev < TH_DEVICES; dev++) {
+      BENCH_DEV_STR *b = &bench_devs[dev];
+      if (!b->name) {
+        continue;
+      }
+      start = host_time_us();
+      CHECK(serial_read(dev, &t, &h), "%s serial read", b->name);
+      us = host_time_us() - start;
+      b->serial_us += us;
+      serial_us += us;
+      CHECK((fabs(t - *b->t) < b->t_tol) && (fabs(h - *b->rh) < b->rh_tol), "%s serial %.2f %.2f set %.2f %.2f",
+        b->name, t, h, *b->t, *b->rh);
+    }
+  }
+  serial_bus_us = EMU_Total().us;
+
+  // New, triggered together and collected once
+  EMU_StatsClear();
+  for (int obs = 0; obs < OBSERVATIONS; obs++) {
+    set_values(obs);
+    delay(60000);
+
+    start = host_time_us();
+    TH_Trigger();
+    TH_Collect();
+    us = host_time_us() - start;
+    th_us += us;
+    CHECK(us <= (TH_HTU21DF_T_MS + TH_HTU21DF_H_MS + 2) * 1000ULL, "TH_Trigger/TH_Collect %llu us",
+      (unsigned long long) us);
+
+    for (int dev = 0; dev < TH_DEVICES; dev++) {
+      BENCH_DEV_STR *b = &bench_devs[dev];
+      if (b->name) {
+        CHECK(th_result[dev].ok && (fabs(th_result[dev].t - *b->t) < b->t_tol) &&
+          (fabs(th_result[dev].h - *b->rh) < b->rh_tol), "%s %.2f %.2f set %.2f %.2f", b->name, th_result[dev].t,
+          th_result[dev].h, *b->t, *b->rh);
+      }
+    }
+  }
+  th_bus_us = EMU_Total().us;
+
+  printf("T/RH read time per observation, simulated\n");
+  for (int dev = 0; dev < TH_DEVICES; dev++) {
+    if (bench_devs[dev].name) {
+      printf("  %-8s  %8.2f ms\n", bench_devs[dev].name, bench_devs[dev].serial_us / 1000.0 / OBSERVATIONS);
+    }
+  }
+  printf("  serial    %8.2f ms  bus %6.2f ms\n", serial_us / 1000.0 / OBSERVATIONS,
+    serial_bus_us / 1000.0 / OBSERVATIONS);
+  printf("  trigger   %8.2f ms  bus %6.2f ms\n", th_us / 1000.0 / OBSERVATIONS, th_bus_us / 1000.0 / OBSERVATIONS);
+  CHECK(th_us < serial_us / 2, "not faster %llu us against %llu us", (unsigned long long) th_us,
+    (unsigned long long) serial_us);
+
+  return TEST_END();
+}
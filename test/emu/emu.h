@@ -0,0 +1,581 @@
+/*
+ * ======================================================================================================================
+ *  emu.h - Host I2C bus emulator
+ *
+ *  Register level models of the station's I2C parts on a simulated bus, the host Wire sends every transaction
+ *  here a byte at a time.
+ *    Timing - START, STOP and each byte with its ACK take their clocks at the Wire clock, host time moves by
+ *      that much, so bus time shows up in micros() as it does on the board. A device stretching SCL adds its
+ *      stretch. Models convert against host time with the datasheet conversion times, a part that is still
+ *      converting NACKs its address, stretches SCL or returns old data as the real part does.
+ *    Faults - scripted per address with EMU_Fault(): address or data NACKs, short or corrupted reads, clock
+ *      stretching, SDA held low until SCL is clocked, a power glitch that resets the part and an unplugged
+ *      part. SDA held low is seen on the SDA pin until I2C_Recover() clocks it free.
+ *    Counters - transactions, NACKs, errors, data bytes and bus time per address, printed by EMU_Report().
+ *
+ *  Devices are attached to the main bus with EMU_Attach() or behind a PCA9548 channel with EmuPCA9548::attach().
+ *  Every attached device with the address that can be reached gets the transaction, ACKs and read bytes are
+ *  wired-AND as on the bus.
+ * ======================================================================================================================
+ */
+#ifndef HOST_EMU_H
+#define HOST_EMU_H
+
+#include <Arduino.h>
+#include <vector>
+
+#define EMU_ADDRS          128
+#define EMU_WIRE_ERROR     4           // Wire endTransmission() other error, bus held
+
+typedef enum {
+  EMU_NACK_ADDR,                       // Address not acknowledged
+  EMU_NACK_DATA,                       // Write byte param not acknowledged
+  EMU_SHORT_READ,                      // Read ends after param bytes
+  EMU_CORRUPT,                         // Read byte param has its low bit flipped
+  EMU_STRETCH,                         // SCL held param us before the first data byte
+  EMU_HOLD_SDA,                        // Transaction lost, SDA held low until param SCL clocks free it, 0 never
+  EMU_RESET,                           // Power glitch before the transaction, the part loses its configuration
+  EMU_UNPLUG                           // Part gone until EMU_Plug()
+} EMU_FAULT_TYPE;
+
+typedef struct {
+  uint8_t addr;
+  EMU_FAULT_TYPE type;
+  uint32_t param;
+  uint32_t count;                      // Transactions faulted, 0 for all of them
+  uint32_t after;                      // Transactions to the address let through first
+  uint64_t at_us;                      // Not armed before this host time
+  uint32_t seen;                       // Transactions to the address since armed
+  uint32_t applied;
+} EMU_FAULT_STR;
+
+typedef struct {
+  unsigned long tx;
+  unsigned long nack;
+  unsigned long err;                   // Bus held or short read
+  unsigned long bytes;                 // Data bytes, not the address
+  uint64_t us;                         // Bus time with clock stretching
+} EMU_STATS_STR;
+
+/*
+ * ======================================================================================================================
+ * EmuDevice - An I2C part, the bus calls these as the master drives it
+ * ======================================================================================================================
+ */
+class EmuDevice {
+public:
+  EmuDevice(uint8_t addr, const char *name) : addr(addr), name(name) {}
+  virtual ~EmuDevice() {}
+
+  virtual bool start(bool read) { (void) read; return true; }  // Address matched, false NACKs it
+  virtual bool write(uint8_t b) { (void) b; return true; }     // false NACKs the byte
+  virtual uint8_t read() { return 0xFF; }
+  virtual uint32_t stretch_us() { return 0; }                  // SCL held before the first read byte
+  virtual void stop() {}                                       // STOP or repeated START
+  virtual void reset() {}                                      // Power on
+
+  uint8_t addr;
+  const char *name;
+  bool present = true;
+  uint32_t max_hz = 1000000;           // Data bytes NACK above this clock, a marginal part or long cable
+
+protected:
+  uint64_t now() { return host_time_us(); }
+};
+
+/*
+ * ======================================================================================================================
+ * EmuRegs - 8 bit register file, the first byte written sets the pointer, reads and writes move it with next()
+ *   With pairs set every written data byte is followed by the next register address, the Bosch write format.
+ * ======================================================================================================================
+ */
+class EmuRegs : public EmuDevice {
+public:
+  bool start(bool read) override;
+  bool write(uint8_t b) override;
+  uint8_t read() override;
+
+protected:
+  EmuRegs(uint8_t addr, const char *name, bool pairs = false) : EmuDevice(addr, name), pairs_(pairs) {}
+  virtual uint8_t get(uint8_t reg) { return regs_[reg]; }
+  virtual bool put(uint8_t reg, uint8_t v) { regs_[reg] = v; return true; }
+  virtual uint8_t next(uint8_t reg) { return reg + 1; }
+  virtual void latch() {}                                      // Read started, shadow the data registers
+  void set24(uint8_t reg, uint32_t v, bool msb_first);
+
+  uint8_t regs_[256] = {};
+  uint8_t ptr_ = 0;
+  bool pointer_ = false;               // Next written byte is a register address
+  bool pairs_;
+};
+
+/*
+ * ======================================================================================================================
+ * Sensirion style command parts - SHT3x, SHT4x, HDC302x, HTU21DF
+ *   A command of cmd_len bytes starts a conversion or a register read, the reply is read as 16 bit words each
+ *   followed by a CRC-8. Reading before the conversion is done NACKs the address, or stretches SCL until it
+ *   is for a clock stretching command.
+ * ======================================================================================================================
+ */
+class EmuSensirion : public EmuDevice {
+public:
+  float t = 20.0;                      // C
+  float rh = 50.0;                     // %
+
+  bool start(bool read) override;
+  bool write(uint8_t b) override;
+  uint8_t read() override;
+  uint32_t stretch_us() override;
+  void stop() override;
+
+protected:
+  EmuSensirion(uint8_t addr, const char *name, int cmd_len, uint8_t crc_init)
+    : EmuDevice(addr, name), cmd_len_(cmd_len), crc_init_(crc_init) {}
+  virtual bool command(uint16_t cmd) = 0;                      // Whole command received, false NACKs its last byte
+  virtual bool data(uint8_t b) { (void) b; return false; }     // Bytes after the command
+  void reply(const uint16_t *words, int n, uint32_t conversion_us = 0, bool stretch = false);
+  void busy(uint32_t us) { ready_us_ = now() + us; out_n_ = out_pos_ = 0; }
+  bool ready() { return now() >= ready_us_; }
+  uint16_t raw(float v, float offset, float span);
+
+  int cmd_len_;
+  uint8_t crc_init_;
+  uint8_t cmd_[2] = {};
+  int cmd_n_ = 0;
+  uint16_t cmd_last_ = 0;
+  uint8_t out_[9] = {};
+  int out_n_ = 0;
+  int out_pos_ = 0;
+  bool stretch_ = false;
+  uint64_t ready_us_ = 0;
+};
+
+// SHT31 / SHT35, single shot, periodic and ART modes, status, heater and serial number
+class EmuSHT3x : public EmuSensirion {
+public:
+  EmuSHT3x(uint8_t addr = 0x44) : EmuSensirion(addr, "SHT3x", 2, 0xFF) { reset(); }
+  void reset() override;
+  uint32_t serial = 0x0A1B2C3D;
+
+protected:
+  bool command(uint16_t cmd) override;
+  void measure(uint32_t us, bool stretch);
+  uint16_t status_ = 0;
+  uint32_t period_us_ = 0;             // Periodic mode, 0 single shot
+  uint64_t period_start_ = 0;
+  uint32_t meas_us_ = 0;
+  uint64_t fetched_ = 0;               // Periodic results already read
+};
+
+// SHT40 / SHT45, one byte commands, precision and heater pulses
+class EmuSHT4x : public EmuSensirion {
+public:
+  EmuSHT4x(uint8_t addr = 0x44) : EmuSensirion(addr, "SHT4x", 1, 0xFF) { reset(); }
+  void reset() override { busy(1000); }
+  uint32_t serial = 0x11223344;
+  unsigned long heater_pulses = 0;
+
+protected:
+  bool command(uint16_t cmd) override;
+};
+
+// HDC3020 / HDC3021 / HDC3022, trigger on demand in four power modes, auto mode, heater and offsets
+class EmuHDC302x : public EmuSensirion {
+public:
+  EmuHDC302x(uint8_t addr = 0x44) : EmuSensirion(addr, "HDC302x", 2, 0xFF) { reset(); }
+  void reset() override;
+
+protected:
+  bool command(uint16_t cmd) override;
+  bool data(uint8_t b) override;
+  void words(uint16_t *w);
+  uint16_t status_ = 0;
+  uint16_t heater_ = 0;
+  uint16_t offsets_ = 0;
+  uint8_t data_[3] = {};
+  int data_n_ = 0;
+  uint32_t period_us_ = 0;             // Auto mode, 0 trigger on demand
+  uint64_t period_start_ = 0;
+  uint64_t fetched_ = 0;
+};
+
+// HTU21D-F, hold master (clock stretch) and no hold (NACK until ready) measurements, user register
+class EmuHTU21DF : public EmuSensirion {
+public:
+  EmuHTU21DF(uint8_t addr = 0x40) : EmuSensirion(addr, "HTU21DF", 1, 0x00) { reset(); }
+  void reset() override { user_ = 0x02; busy(15000); }
+
+protected:
+  bool command(uint16_t cmd) override;
+  bool data(uint8_t b) override;
+  uint8_t user_ = 0x02;
+  bool user_write_ = false;
+};
+
+/*
+ * ======================================================================================================================
+ * EmuHIH8 - Honeywell HIH8000, any write starts a 36.65ms measurement, reads return 4 bytes with a stale flag
+ * ======================================================================================================================
+ */
+class EmuHIH8 : public EmuDevice {
+public:
+  EmuHIH8(uint8_t addr = 0x27) : EmuDevice(addr, "HIH8") { reset(); }
+  float t = 20.0;
+  float rh = 50.0;
+
+  bool start(bool read) override;
+  uint8_t read() override;
+  void reset() override { done_us_ = 0; fetched_ = true; }
+
+private:
+  uint8_t out_[4] = {};
+  int out_pos_ = 0;
+  uint64_t done_us_ = 0;
+  bool fetched_ = true;
+};
+
+/*
+ * ======================================================================================================================
+ * Bosch barometers - BMP280, BME280, BMP388, BMP390, BMP581
+ *   Raw counts are found from the set values through the datasheet compensation with the model's calibration,
+ *   so the drivers read back what was set. Data registers are latched at each completed conversion.
+ * ======================================================================================================================
+ */
+class EmuBMx280 : public EmuRegs {
+public:
+  EmuBMx280(uint8_t addr, bool bme) : EmuRegs(addr, bme ? "BME280" : "BMP280", true), bme_(bme) { reset(); }
+  float t = 20.0;                      // C
+  float p = 1013.25;                   // hPa
+  float rh = 50.0;                     // %, BME280
+  void reset() override;
+
+protected:
+  uint8_t get(uint8_t reg) override;
+  bool put(uint8_t reg, uint8_t v) override;
+  void latch() override;
+  void update();
+  uint32_t meas_us();
+  uint32_t tsb_us();
+  int32_t comp_t(int32_t adc, int32_t *t_fine);
+  int64_t comp_p(int32_t adc, int32_t t_fine);
+  uint32_t comp_h(int32_t adc, int32_t t_fine);
+  bool bme_;
+  uint64_t nvm_us_ = 0;                // Calibration copy done
+  uint64_t conv_start_ = 0;
+  uint64_t conv_done_ = 0;             // Last conversion already latched
+};
+
+class EmuBMP3 : public EmuRegs {
+public:
+  EmuBMP3(uint8_t addr, bool bmp390) : EmuRegs(addr, bmp390 ? "BMP390" : "BMP388", true), chip_(bmp390 ? 0x60 : 0x50) {
+    reset();
+  }
+  float t = 20.0;
+  float p = 1013.25;
+  void reset() override;
+
+protected:
+  uint8_t get(uint8_t reg) override;
+  bool put(uint8_t reg, uint8_t v) override;
+  void latch() override;
+  void update();
+  uint32_t meas_us();
+  double comp_t(uint32_t adc);
+  double comp_p(uint32_t adc, double t_lin);
+  uint8_t chip_;
+  uint64_t conv_start_ = 0;
+  uint64_t conv_done_ = 0;
+};
+
+class EmuBMP5 : public EmuRegs {
+public:
+  EmuBMP5(uint8_t addr = 0x47) : EmuRegs(addr, "BMP581") { reset(); }
+  float t = 20.0;
+  float p = 1013.25;
+  void reset() override;
+
+protected:
+  uint8_t get(uint8_t reg) override;
+  bool put(uint8_t reg, uint8_t v) override;
+  void latch() override;
+  void update();
+  uint32_t meas_us();
+  uint32_t period_us();
+  uint64_t conv_start_ = 0;
+  uint64_t conv_done_ = 0;
+};
+
+/*
+ * ======================================================================================================================
+ * Register parts - LPS35HW, MCP9808, VEML7700, AS5600
+ * ======================================================================================================================
+ */
+class EmuLPS35HW : public EmuRegs {
+public:
+  EmuLPS35HW(uint8_t addr = 0x5D) : EmuRegs(addr, "LPS35HW") { reset(); }
+  float t = 20.0;
+  float p = 1013.25;
+  void reset() override;
+
+protected:
+  uint8_t get(uint8_t reg) override;
+  bool put(uint8_t reg, uint8_t v) override;
+  uint8_t next(uint8_t reg) override { return (regs_[0x11] & 0x10) ? reg + 1 : reg; }
+  void latch() override { update(); }
+  void update();
+  uint64_t reset_us_ = 0;              // SWRESET bit clears
+  uint64_t conv_start_ = 0;
+  uint64_t conv_done_ = 0;
+  uint64_t one_shot_us_ = 0;
+};
+
+// 16 bit registers behind a pointer byte, MCP9808 is MSB first, VEML7700 LSB first
+class EmuWords : public EmuDevice {
+public:
+  bool start(bool read) override;
+  bool write(uint8_t b) override;
+  uint8_t read() override;
+  void stop() override;
+
+protected:
+  EmuWords(uint8_t addr, const char *name, bool msb_first) : EmuDevice(addr, name), msb_first_(msb_first) {}
+  virtual uint16_t get(uint8_t reg) { return words_[reg & 0x0F]; }
+  virtual void put(uint8_t reg, uint16_t v) { words_[reg & 0x0F] = v; }
+  virtual int width(uint8_t reg) { (void) reg; return 2; }
+  uint16_t words_[16] = {};
+  uint8_t ptr_ = 0;
+  int n_ = 0;                          // Bytes since the pointer or the start of the read
+  uint16_t in_ = 0;
+  uint16_t out_ = 0;
+  bool msb_first_;
+};
+
+class EmuMCP9808 : public EmuWords {
+public:
+  EmuMCP9808(uint8_t addr = 0x18) : EmuWords(addr, "MCP9808", true) { reset(); }
+  float t = 20.0;
+  void reset() override;
+
+protected:
+  uint16_t get(uint8_t reg) override;
+  void put(uint8_t reg, uint16_t v) override;
+  int width(uint8_t reg) override { return (reg == 0x08) ? 1 : 2; }
+  uint32_t conv_us() { static const uint32_t us[4] = {30000, 65000, 130000, 250000}; return us[words_[8] & 3]; }
+  uint64_t conv_start_ = 0;
+};
+
+class EmuVEML7700 : public EmuWords {
+public:
+  EmuVEML7700(uint8_t addr = 0x10) : EmuWords(addr, "VEML7700", false) { reset(); }
+  float lux = 300.0;
+  void reset() override;
+
+protected:
+  uint16_t get(uint8_t reg) override;
+  void put(uint8_t reg, uint16_t v) override;
+  uint32_t it_us();
+  uint32_t cycle_us();
+  uint16_t count();
+  uint64_t cycle_start_ = 0;
+  uint16_t als_ = 0;                   // Count of the integration before the last configuration write
+};
+
+class EmuAS5600 : public EmuRegs {
+public:
+  EmuAS5600(uint8_t addr = 0x36) : EmuRegs(addr, "AS5600") { reset(); }
+  float deg = 0.0;                     // Magnet angle
+  bool magnet = true;
+  void reset() override;
+
+protected:
+  uint8_t get(uint8_t reg) override;
+  bool put(uint8_t reg, uint8_t v) override;
+  uint8_t next(uint8_t reg) override;
+  void latch() override;
+};
+
+/*
+ * ======================================================================================================================
+ * EmuPCA9548 - 8 channel I2C mux, the control byte connects channels to the main bus
+ * ======================================================================================================================
+ */
+class EmuPCA9548 : public EmuDevice {
+public:
+  EmuPCA9548(uint8_t addr = 0x70) : EmuDevice(addr, "PCA9548") {}
+  void attach(int channel, EmuDevice *dev) { channels[channel & 7].push_back(dev); }
+
+  bool write(uint8_t b) override { control = b; return true; }
+  uint8_t read() override { return control; }
+  void reset() override { control = 0; }
+
+  uint8_t control = 0;
+  std::vector<EmuDevice *> channels[8];
+};
+
+/*
+ * ======================================================================================================================
+ * EmuDS18B20 - 1-Wire temperature probe at the time slot level, external or parasite powered
+ *   A parasite probe browns out and reads the 85C power on value unless the strong pullup is on for the
+ *   whole conversion.
+ * ======================================================================================================================
+ */
+class EmuDS18B20 {
+public:
+  EmuDS18B20(uint64_t serial, bool parasite = false);
+  float t = 20.0;
+  bool parasite;
+  bool present = true;
+  uint8_t rom[8];
+
+  bool reset();                        // Reset pulse, true for a presence pulse
+  bool slot(bool w);                   // Write w, 1 is also a read slot, returns the line
+  void pullup(bool on);                // Strong pullup from the DS2482
+  void power_on();
+
+private:
+  typedef enum { IDLE, ROM_CMD, MATCH, SEARCH, FUNC, RX, TX, CONVERT, INACTIVE } STATE;
+  void byte(uint8_t b);
+  void send(const uint8_t *buf, int bits, STATE after);
+  void finish();
+
+  STATE state_ = IDLE;
+  STATE after_ = IDLE;                 // State once the bits to send are out
+  uint8_t sp_[9];                      // Scratchpad
+  uint8_t rx_ = 0;
+  int rx_bits_ = 0;
+  int rx_left_ = 0;                    // Write scratchpad bytes to come
+  uint8_t tx_[9];
+  int tx_bits_ = 0;                    // Bits to send
+  int tx_pos_ = 0;
+  int search_bit_ = 0;
+  int search_phase_ = 0;
+  bool match_ok_ = true;
+  uint64_t conv_start_ = 0;
+  uint64_t conv_end_ = 0;
+  bool strong_ = false;
+  bool brownout_ = false;
+};
+
+/*
+ * ======================================================================================================================
+ * EmuDS2482 - DS2482-800 8 channel I2C to 1-Wire bridge, 1-Wire commands take their time slots with 1WB set
+ * ======================================================================================================================
+ */
+class EmuDS2482 : public EmuDevice {
+public:
+  EmuDS2482(uint8_t addr = 0x1F) : EmuDevice(addr, "DS2482") { reset(); }
+  void attach(int channel, EmuDS18B20 *probe) { probes[channel & 7].push_back(probe); }
+
+  bool start(bool read) override;
+  bool write(uint8_t b) override;
+  uint8_t read() override;
+  void stop() override;
+  void reset() override;
+
+  std::vector<EmuDS18B20 *> probes[8];
+  unsigned long ow_resets = 0;
+
+private:
+  bool command();
+  void run(uint32_t us);
+  uint8_t status();
+  bool slot(bool w);
+  void spu_end();
+  uint8_t cmd_[2] = {};
+  int n_ = 0;
+  uint8_t status_ = 0x18;
+  uint8_t data_ = 0;
+  uint8_t config_ = 0;
+  uint8_t channel_ = 0;
+  uint8_t pointer_ = 0xF0;
+  uint64_t busy_us_ = 0;
+  bool ppd_ = false;                   // Presence and short from the running reset, sampled at tMSP
+  bool sd_ = false;
+  bool ppd_old_ = false;               // From the reset before, read until tMSP
+  bool sd_old_ = false;
+  uint64_t msp_us_ = 0;
+  bool spu_on_ = false;                // Strong pullup on until the next 1-Wire command
+};
+
+/*
+ * ======================================================================================================================
+ * EmuEEPROM - 24LC32 style EEPROM or I2C FRAM with a two byte address
+ *   An EEPROM write is committed at STOP and wraps in its page, the part NACKs its address for the write cycle.
+ *   FRAM has no pages and no write cycle.
+ * ======================================================================================================================
+ */
+class EmuEEPROM : public EmuDevice {
+public:
+  EmuEEPROM(uint8_t addr, const char *name, uint32_t size, uint32_t page, uint32_t write_us);
+  static EmuEEPROM *EEPROM24LC32(uint8_t addr = 0x50) { return new EmuEEPROM(addr, "24LC32", 4096, 32, 5000); }
+  static EmuEEPROM *FRAM(uint8_t addr = 0x50) { return new EmuEEPROM(addr, "FRAM", 32768, 0, 0); }
+
+  bool start(bool read) override;
+  bool write(uint8_t b) override;
+  uint8_t read() override;
+  void stop() override;
+
+  std::vector<uint8_t> mem;
+  unsigned long write_cycles = 0;
+
+private:
+  uint32_t page_;
+  uint32_t write_us_;
+  uint32_t ptr_ = 0;
+  int n_ = 0;                          // Bytes written in this transaction
+  std::vector<std::pair<uint32_t, uint8_t>> pending_;
+  uint64_t busy_us_ = 0;
+};
+
+/*
+ * ======================================================================================================================
+ * EmuSSD1306 - 128x32 or 128x64 OLED controller, commands and display RAM
+ * ======================================================================================================================
+ */
+class EmuSSD1306 : public EmuDevice {
+public:
+  EmuSSD1306(uint8_t addr = 0x3C, int height = 32) : EmuDevice(addr, "SSD1306"), pages(height / 8) { reset(); }
+
+  bool start(bool read) override;
+  bool write(uint8_t b) override;
+  void stop() override { control_ = true; }
+  void reset() override;
+
+  int pages;
+  uint8_t ram[8][128];
+  bool on = false;
+  unsigned long data_bytes = 0;
+
+private:
+  void cmd(uint8_t b);
+  void data(uint8_t b);
+  bool control_ = true;                // Next byte is a control byte
+  bool continuation_ = false;
+  bool data_mode_ = false;
+  uint8_t cmd_[8] = {};
+  int cmd_n_ = 0;
+  int cmd_args_ = 0;
+  int mode_ = 2;                       // 0 horizontal, 1 vertical, 2 page addressing
+  int col_ = 0, col_start_ = 0, col_end_ = 127;
+  int page_ = 0, page_start_ = 0, page_end_ = 7;
+};
+
+// Bus
+void EMU_Attach(EmuDevice *dev);
+void EMU_Detach(EmuDevice *dev);
+void EMU_Clear();
+void EMU_Plug(EmuDevice *dev);
+void EMU_Fault(uint8_t addr, EMU_FAULT_TYPE type, uint32_t param=0, uint32_t count=1, uint32_t after=0,
+  uint64_t at_us=0);
+void EMU_FaultsClear();
+EMU_STATS_STR EMU_Stats(uint8_t addr);
+EMU_STATS_STR EMU_Total();
+void EMU_StatsClear();
+void EMU_Report(const char *title);
+uint8_t EMU_Write(uint32_t hz, uint8_t addr, const uint8_t *buf, size_t len, bool stop);
+size_t EMU_Read(uint32_t hz, uint8_t addr, uint8_t *buf, size_t len, bool stop);
+bool EMU_SDALow();
+void EMU_SCLClock();
+uint8_t EMU_CRC8(uint8_t crc, const uint8_t *data, int len);
+
+#endif
@@ -0,0 +1,483 @@
+/*
+ * ======================================================================================================================
+ *  emu_bosch.cpp - Bosch barometers: BMP280, BME280, BMP388, BMP390, BMP581
+ * ======================================================================================================================
+ */
+#include "emu.h"
+
+/*
+ * ======================================================================================================================
+ * EMU_Solve() - Raw count in [lo, hi] whose compensated value is nearest target, the compensation is monotonic
+ * ======================================================================================================================
+ */
+template <typename F>
+static int64_t EMU_Solve(int64_t lo, int64_t hi, double target, F f) {
+  bool rising = f(hi) > f(lo);
+
+  while (hi - lo > 1) {
+    int64_t mid = (lo + hi) / 2;
+    if ((f(mid) < target) == rising) {
+      lo = mid;
+    }
+    else {
+      hi = mid;
+    }
+  }
+  return (fabs(f(lo) - target) <= fabs(f(hi) - target)) ? lo : hi;
+}
+
+// Oversampling register code to samples, 0 is skipped
+static int EMU_Osr(int code) {
+  return code ? (1 << (min(code, 5) - 1)) : 0;
+}
+
+/*
+ * ======================================================================================================================
+ * EmuBMx280 - Datasheet example calibration, integer compensation from the datasheet
+ * ======================================================================================================================
+ */
+static const uint16_t bmx_t1 = 27504;
+static const int16_t bmx_t2 = 26435, bmx_t3 = -1000;
+static const uint16_t bmx_p1 = 36477;
+static const int16_t bmx_p2 = -10685, bmx_p3 = 3024, bmx_p4 = 2855, bmx_p5 = 140, bmx_p6 = -7, bmx_p7 = 15500,
+  bmx_p8 = -14600, bmx_p9 = 6000;
+static const uint8_t bmx_h1 = 75, bmx_h3 = 0;
+static const int16_t bmx_h2 = 370, bmx_h4 = 305, bmx_h5 = 50;
+static const int8_t bmx_h6 = 30;
+
+void EmuBMx280::reset() {
+  const int16_t cal[12] = {(int16_t) bmx_t1, bmx_t2, bmx_t3, (int16_t) bmx_p1, bmx_p2, bmx_p3, bmx_p4, bmx_p5, bmx_p6,
+    bmx_p7, bmx_p8, bmx_p9};
+
+  memset(regs_, 0, sizeof(regs_));
+  for (int i = 0; i < 12; i++) {
+    regs_[0x88 + 2*i] = cal[i] & 0xFF;
+    regs_[0x89 + 2*i] = (cal[i] >> 8) & 0xFF;
+  }
+  regs_[0xD0] = bme_ ? 0x60 : 0x58;
+  if (bme_) {
+    regs_[0xA1] = bmx_h1;
+    regs_[0xE1] = bmx_h2 & 0xFF;
+    regs_[0xE2] = bmx_h2 >> 8;
+    regs_[0xE3] = bmx_h3;
+    regs_[0xE4] = bmx_h4 >> 4;
+    regs_[0xE5] = (bmx_h4 & 0x0F) | ((bmx_h5 & 0x0F) << 4);
+    regs_[0xE6] = bmx_h5 >> 4;
+    regs_[0xE7] = bmx_h6;
+  }
+  set24(0xF7, 0x800000, true);
+  set24(0xFA, 0x800000, true);
+  regs_[0xFD] = 0x80;
+  nvm_us_ = now() + 2000;            // NVM copied to the image registers
+  conv_start_ = conv_done_ = 0;
+}
+
+// Measurement time, datasheet typical
+uint32_t EmuBMx280::meas_us() {
+  int t = EMU_Osr((regs_[0xF4] >> 5) & 7);
+  int p = EMU_Osr((regs_[0xF4] >> 2) & 7);
+  int h = bme_ ? EMU_Osr(regs_[0xF2] & 7) : 0;
+
+  return 1250 + 2300 * t + (p ? 2300 * p + 575 : 0) + (h ? 2300 * h + 575 : 0);
+}
+
+int32_t EmuBMx280::comp_t(int32_t adc, int32_t *t_fine) {
+  int32_t var1 = ((((adc >> 3) - ((int32_t) bmx_t1 << 1))) * ((int32_t) bmx_t2)) >> 11;
+  int32_t var2 = (((((adc >> 4) - ((int32_t) bmx_t1)) * ((adc >> 4) - ((int32_t) bmx_t1))) >> 12) *
+    ((int32_t) bmx_t3)) >> 14;
+  *t_fine = var1 + var2;
+  return (*t_fine * 5 + 128) >> 8;
+}
+
+int64_t EmuBMx280::comp_p(int32_t adc, int32_t t_fine) {
+  int64_t var1, var2, p;
+
+  var1 = ((int64_t) t_fine) - 128000;
+  var2 = var1 * var1 * (int64_t) bmx_p6;
+  var2 = var2 + ((var1 * (int64_t) bmx_p5) << 17);
+  var2 = var2 + (((int64_t) bmx_p4) << 35);
+  var1 = ((var1 * var1 * (int64_t) bmx_p3) >> 8) + ((var1 * (int64_t) bmx_p2) << 12);
+  var1 = (((((int64_t) 1) << 47) + var1)) * ((int64_t) bmx_p1) >> 33;
+  if (var1 == 0) {
+    return 0;
+  }
+  p = 1048576 - adc;
+  p = (((p << 31) - var2) * 3125) / var1;
+  var1 = (((int64_t) bmx_p9) * (p >> 13) * (p >> 13)) >> 25;
+  var2 = (((int64_t) bmx_p8) * p) >> 19;
+  p = ((p + var1 + var2) >> 8) + (((int64_t) bmx_p7) << 4);
+  return p;
+}
+
+uint32_t EmuBMx280::comp_h(int32_t adc, int32_t t_fine) {
+  int32_t v = t_fine - ((int32_t) 76800);
+
+  v = (((((adc << 14) - (((int32_t) bmx_h4) << 20) - (((int32_t) bmx_h5) * v)) + ((int32_t) 16384)) >> 15) *
+    (((((((v * ((int32_t) bmx_h6)) >> 10) * (((v * ((int32_t) bmx_h3)) >> 11) + ((int32_t) 32768))) >> 10) +
+    ((int32_t) 2097152)) * ((int32_t) bmx_h2) + 8192) >> 14));
+  v = (v - (((((v >> 15) * (v >> 15)) >> 7) * ((int32_t) bmx_h1)) >> 4));
+  v = (v < 0) ? 0 : v;
+  v = (v > 419430400) ? 419430400 : v;
+  return (uint32_t) (v >> 12);
+}
+
+// Data registers get the result of the last conversion that has finished
+void EmuBMx280::update() {
+  int mode = regs_[0xF4] & 3;
+  uint64_t end;
+  int32_t adc_t, t_fine;
+
+  if (mode == 0) {
+    return;
+  }
+  if (now() < conv_start_ + meas_us()) {
+    return;
+  }
+  if (mode == 3) {
+    uint64_t cycle = meas_us() + tsb_us();
+    end = conv_start_ + meas_us() + (now() - conv_start_ - meas_us()) / cycle * cycle;
+  }
+  else {
+    end = conv_start_ + meas_us();
+    regs_[0xF4] &= ~3;               // Forced mode goes back to sleep
+  }
+  if (end == conv_done_) {
+    return;
+  }
+  conv_done_ = end;
+
+  adc_t = EMU_Solve(0, 0xFFFFF, t * 100.0, [&](int64_t a) { int32_t tf; return (double) comp_t(a, &tf); });
+  comp_t(adc_t, &t_fine);
+  if ((regs_[0xF4] >> 5) & 7) {
+    set24(0xFA, adc_t << 4, true);
+  }
+  if ((regs_[0xF4] >> 2) & 7) {
+    set24(0xF7, EMU_Solve(0, 0xFFFFF, p * 100.0 * 256.0, [&](int64_t a) { return (double) comp_p(a, t_fine); }) << 4,
+      true);
+  }
+  if (bme_ && (regs_[0xF2] & 7)) {
+    uint32_t adc_h = EMU_Solve(0, 0xFFFF, rh * 1024.0, [&](int64_t a) { return (double) comp_h(a, t_fine); });
+    regs_[0xFD] = adc_h >> 8;
+    regs_[0xFE] = adc_h & 0xFF;
+  }
+}
+
+void EmuBMx280::latch() {
+  update();
+}
+
+uint8_t EmuBMx280::get(uint8_t reg) {
+  if (reg == 0xF3) {
+    int mode = regs_[0xF4] & 3;
+    bool measuring = false;
+    if (mode == 3) {
+      measuring = ((now() - conv_start_) % (meas_us() + tsb_us())) < meas_us();
+    }
+    else if (mode) {
+      measuring = now() < conv_start_ + meas_us();
+    }
+    return (measuring ? 0x08 : 0) | ((now() < nvm_us_) ? 0x01 : 0);
+  }
+  return regs_[reg];
+}
+
+bool EmuBMx280::put(uint8_t reg, uint8_t v) {
+  switch (reg) {
+    case 0xE0 :
+      if (v == 0xB6) reset();
+      break;
+    case 0xF4 :
+      update();
+      regs_[reg] = v;
+      if (v & 3) {
+        conv_start_ = now();
+      }
+      break;
+    case 0xF2 :
+      if (bme_) regs_[reg] = v & 7;
+      break;
+    case 0xF5 :
+      regs_[reg] = v & 0xFD;
+      break;
+  }
+  return true;
+}
+
+// Standby between normal mode conversions, the BME280 has 10 and 20ms where the BMP280 has 2 and 4s
+uint32_t EmuBMx280::tsb_us() {
+  static const uint32_t bmp[8] = {500, 62500, 125000, 250000, 500000, 1000000, 2000000, 4000000};
+  static const uint32_t bme[8] = {500, 62500, 125000, 250000, 500000, 1000000, 10000, 20000};
+  int sb = regs_[0xF5] >> 5;
+
+  return bme_ ? bme[sb] : bmp[sb];
+}
+
+/*
+ * ======================================================================================================================
+ * EmuBMP3 - Typical part calibration, double precision compensation as bmp3.c
+ * ======================================================================================================================
+ */
+static const uint8_t bmp3_cal[21] = {
+  0x8D, 0x6B,                        // T1 27533
+  0x79, 0x4B,                        // T2 19321
+  0xF6,                              // T3 -10
+  0x9D, 0x0C,                        // P1 3229
+  0x36, 0x0A,                        // P2 2614
+  0x23,                              // P3 35
+  0x01,                              // P4 1
+  0x38, 0x63,                        // P5 25400
+  0x74, 0x78,                        // P6 30836
+  0x03,                              // P7 3
+  0xFB,                              // P8 -5
+  0x0A, 0x10,                        // P9 4106
+  0x07,                              // P10 7
+  0xC4                               // P11 -60
+};
+
+// Trimming CRC as the Adafruit driver checks it
+static uint8_t EMU_BMP3_CRC() {
+  uint8_t crc = 0xFF;
+
+  for (int i = 0; i < 21; i++) {
+    uint8_t d = bmp3_cal[i];
+    for (int b = 0; b < 8; b++) {
+      bool x = (crc & 0x80) ^ (d & 0x80);
+      crc = (crc & 0x7F) << 1;
+      d = (d & 0x7F) << 1;
+      crc ^= x ? 0x1D : 0;
+    }
+  }
+  return crc ^ 0xFF;
+}
+
+void EmuBMP3::reset() {
+  memset(regs_, 0, sizeof(regs_));
+  regs_[0x00] = chip_;
+  regs_[0x01] = 0x01;
+  regs_[0x03] = 0x10;                // CMD_RDY
+  regs_[0x10] = 0x01;                // POR detected
+  regs_[0x1A] = 0x00;
+  regs_[0x1C] = 0x02;
+  regs_[0x1F] = 0x00;
+  regs_[0x30] = EMU_BMP3_CRC();
+  memcpy(&regs_[0x31], bmp3_cal, sizeof(bmp3_cal));
+  set24(0x04, 0x800000, false);
+  set24(0x07, 0x800000, false);
+  conv_start_ = conv_done_ = 0;
+}
+
+uint32_t EmuBMP3::meas_us() {
+  uint8_t pwr = regs_[0x1B];
+  uint32_t us = 234;
+
+  if (pwr & 0x01) us += 392 + (1 << (regs_[0x1C] & 7)) * 2020;
+  if (pwr & 0x02) us += 313 + (1 << ((regs_[0x1C] >> 3) & 7)) * 2020;
+  return us;
+}
+
+double EmuBMP3::comp_t(uint32_t adc) {
+  double t1 = (double) ((bmp3_cal[1] << 8) | bmp3_cal[0]) / 0.00390625;
+  double t2 = (double) ((bmp3_cal[3] << 8) | bmp3_cal[2]) / 1073741824.0;
+  double t3 = (double) (int8_t) bmp3_cal[4] / 281474976710656.0;
+  double pd1 = (double) adc - t1;
+
+  return pd1 * t2 + pd1 * pd1 * t3;
+}
+
+double EmuBMP3::comp_p(uint32_t adc, double t_lin) {
+  const uint8_t *c = bmp3_cal;
+  double p1 = (double) ((int16_t) ((c[6] << 8) | c[5]) - 16384) / 1048576.0;
+  double p2 = (double) ((int16_t) ((c[8] << 8) | c[7]) - 16384) / 536870912.0;
+  double p3 = (double) (int8_t) c[9] / 4294967296.0;
+  double p4 = (double) (int8_t) c[10] / 137438953472.0;
+  double p5 = (double) ((c[12] << 8) | c[11]) / 0.125;
+  double p6 = (double) ((c[14] << 8) | c[13]) / 64.0;
+  double p7 = (double) (int8_t) c[15] / 256.0;
+  double p8 = (double) (int8_t) c[16] / 32768.0;
+  double p9 = (double) (int16_t) ((c[18] << 8) | c[17]) / 281474976710656.0;
+  double p10 = (double) (int8_t) c[19] / 281474976710656.0;
+  double p11 = (double) (int8_t) c[20] / 36893488147419103232.0;
+  double u = adc;
+  double out1 = p5 + p6 * t_lin + p7 * t_lin * t_lin + p8 * t_lin * t_lin * t_lin;
+  double out2 = u * (p1 + p2 * t_lin + p3 * t_lin * t_lin + p4 * t_lin * t_lin * t_lin);
+
+  return out1 + out2 + u * u * (p9 + p10 * t_lin) + u * u * u * p11;
+}
+
+void EmuBMP3::update() {
+  int mode = (regs_[0x1B] >> 4) & 3;
+  uint64_t end;
+  uint32_t adc_t;
+
+  if ((mode == 0) || (now() < conv_start_ + meas_us())) {
+    return;
+  }
+  if (mode == 3) {
+    uint64_t period = 5000ULL << (regs_[0x1D] & 0x1F);
+    end = conv_start_ + meas_us() + (now() - conv_start_ - meas_us()) / period * period;
+  }
+  else {
+    end = conv_start_ + meas_us();
+    regs_[0x1B] &= ~0x30;
+  }
+  if (end == conv_done_) {
+    return;
+  }
+  conv_done_ = end;
+
+  adc_t = EMU_Solve(0, 0xFFFFFF, t, [&](int64_t a) { return comp_t(a); });
+  if (regs_[0x1B] & 0x02) {
+    set24(0x07, adc_t, false);
+    regs_[0x03] |= 0x40;
+  }
+  if (regs_[0x1B] & 0x01) {
+    double t_lin = comp_t(adc_t);
+    set24(0x04, EMU_Solve(0, 0xFFFFFF, p * 100.0, [&](int64_t a) { return comp_p(a, t_lin); }), false);
+    regs_[0x03] |= 0x20;
+  }
+  regs_[0x11] |= 0x08;
+}
+
+void EmuBMP3::latch() {
+  update();
+}
+
+uint8_t EmuBMP3::get(uint8_t reg) {
+  uint8_t v = regs_[reg];
+
+  switch (reg) {
+    case 0x04 : regs_[0x03] &= ~0x60; break;             // Reading the data clears data ready
+    case 0x10 :
+    case 0x11 : regs_[reg] = 0; break;                   // Clear on read
+  }
+  return v;
+}
+
+bool EmuBMP3::put(uint8_t reg, uint8_t v) {
+  switch (reg) {
+    case 0x7E :
+      if (v == 0xB6) {
+        reset();
+      }
+      else if (v != 0xB0) {
+        regs_[0x02] |= 0x02;         // Command error
+      }
+      break;
+    case 0x1B :
+      update();
+      regs_[reg] = v & 0x33;
+      if (((v >> 4) & 3) == 3) {
+        uint32_t period = 5000UL << (regs_[0x1D] & 0x1F);
+        if (meas_us() > period) {
+          regs_[0x02] |= 0x04;       // Configuration error, stays asleep
+          regs_[reg] &= ~0x30;
+          break;
+        }
+      }
+      if (v & 0x30) {
+        conv_start_ = now();
+      }
+      break;
+    case 0x15 : case 0x16 : case 0x17 : case 0x18 : case 0x19 : case 0x1A : case 0x1C : case 0x1D : case 0x1F :
+      regs_[reg] = v;
+      break;
+  }
+  return true;
+}
+
+/*
+ * ======================================================================================================================
+ * EmuBMP5 - Temperature in 1/65536 C and pressure in 1/64 Pa, no calibration to apply
+ * ======================================================================================================================
+ */
+void EmuBMP5::reset() {
+  memset(regs_, 0, sizeof(regs_));
+  regs_[0x01] = 0x50;
+  regs_[0x02] = 0x32;
+  regs_[0x27] = 0x10;                // POR or soft reset complete
+  regs_[0x28] = 0x02;                // NVM ready
+  regs_[0x36] = 0x00;
+  regs_[0x37] = 0x70;                // 1 Hz, standby with deep standby allowed
+  conv_start_ = conv_done_ = 0;
+}
+
+// Measurement time from the datasheet ODR limits, about 1.3ms per pressure and 0.4ms per temperature sample
+uint32_t EmuBMP5::meas_us() {
+  int osr_t = regs_[0x36] & 7;
+  int osr_p = (regs_[0x36] >> 3) & 7;
+  uint32_t us = 300 + 400 * (1 << osr_t);
+
+  if (regs_[0x36] & 0x40) {
+    us += 1300 * (1 << osr_p);
+  }
+  return us;
+}
+
+uint32_t EmuBMP5::period_us() {
+  static const float hz[32] = {240, 218.5, 199.1, 179.2, 160, 149.3, 140, 129.8, 120, 110.1, 100.2, 89.6, 80, 70, 60,
+    50, 45, 40, 35, 30, 25, 20, 15, 10, 5, 4, 3, 2, 1, 0.5, 0.25, 0.125};
+  uint32_t us = lround(1000000.0 / hz[(regs_[0x37] >> 2) & 0x1F]);
+
+  // Continuous runs back to back, normal mode can not go faster than the oversampling allows
+  return ((regs_[0x37] & 3) == 3) ? meas_us() : max(us, meas_us());
+}
+
+void EmuBMP5::update() {
+  int mode = regs_[0x37] & 3;
+  uint64_t end;
+
+  if ((mode == 0) || (now() < conv_start_ + meas_us())) {
+    return;
+  }
+  if (mode == 2) {
+    end = conv_start_ + meas_us();
+    regs_[0x37] &= ~3;               // Forced back to standby
+  }
+  else {
+    end = conv_start_ + meas_us() + (now() - conv_start_ - meas_us()) / period_us() * period_us();
+  }
+  if (end == conv_done_) {
+    return;
+  }
+  conv_done_ = end;
+
+  set24(0x1D, (uint32_t) lround(t * 65536.0) & 0xFFFFFF, false);
+  set24(0x20, (regs_[0x36] & 0x40) ? (uint32_t) lround(p * 100.0 * 64.0) : 0, false);
+  regs_[0x27] |= 0x01;
+}
+
+void EmuBMP5::latch() {
+  update();
+}
+
+uint8_t EmuBMP5::get(uint8_t reg) {
+  uint8_t v = regs_[reg];
+
+  if (reg == 0x27) {
+    regs_[reg] = 0;                  // Clear on read
+  }
+  if (reg == 0x38) {
+    v = (regs_[0x36] & 0x3F) | ((meas_us() <= period_us()) ? 0x80 : 0);
+  }
+  return v;
+}
+
+bool EmuBMP5::put(uint8_t reg, uint8_t v) {
+  switch (reg) {
+    case 0x7E :
+      if (v == 0xB6) reset();
+      break;
+    case 0x37 :
+      update();
+      regs_[reg] = v;
+      if (v & 3) {
+        conv_start_ = now();
+      }
+      break;
+    case 0x13 : case 0x14 : case 0x15 : case 0x16 : case 0x18 : case 0x2B : case 0x30 : case 0x31 : case 0x32 :
+    case 0x33 : case 0x34 : case 0x35 : case 0x36 :
+      regs_[reg] = v;
+      break;
+  }
+  return true;
+}
@@ -0,0 +1,436 @@
+/*
+ * ======================================================================================================================
+ *  emu_bus.cpp - Host I2C bus emulator: routing through the muxes, bit timing, faults and counters
+ * ======================================================================================================================
+ */
+#include "emu.h"
+
+#define EMU_FAULTS_SIZE 32
+
+static std::vector<EmuDevice *> emu_bus;
+static EMU_FAULT_STR emu_faults[EMU_FAULTS_SIZE];
+static int emu_faults_count = 0;
+static EMU_STATS_STR emu_stats[EMU_ADDRS];
+static uint64_t emu_ps = 0;            // Bus time not yet moved into host time
+static bool emu_held = false;          // A device holds SDA low
+static uint32_t emu_held_clocks = 0;   // SCL clocks until it lets go, 0 never
+
+/*
+ * ======================================================================================================================
+ * EMU_Attach() / EMU_Detach() / EMU_Clear() / EMU_Plug() - Devices on the main bus
+ * ======================================================================================================================
+ */
+void EMU_Attach(EmuDevice *dev) {
+  emu_bus.push_back(dev);
+}
+
+void EMU_Detach(EmuDevice *dev) {
+  for (size_t i = 0; i < emu_bus.size(); i++) {
+    if (emu_bus[i] == dev) {
+      emu_bus.erase(emu_bus.begin() + i);
+      return;
+    }
+  }
+}
+
+void EMU_Clear() {
+  emu_bus.clear();
+  EMU_FaultsClear();
+  EMU_StatsClear();
+  emu_held = false;
+}
+
+// Plugged back in, it powers up
+void EMU_Plug(EmuDevice *dev) {
+  dev->reset();
+  dev->present = true;
+}
+
+/*
+ * ======================================================================================================================
+ * EMU_Fault() / EMU_FaultsClear() - Script a fault on an address
+ * ======================================================================================================================
+ */
+void EMU_Fault(uint8_t addr, EMU_FAULT_TYPE type, uint32_t param, uint32_t count, uint32_t after, uint64_t at_us) {
+  if (emu_faults_count < EMU_FAULTS_SIZE) {
+    emu_faults[emu_faults_count++] = {addr, type, param, count, after, at_us, 0, 0};
+  }
+}
+
+void EMU_FaultsClear() {
+  emu_faults_count = 0;
+}
+
+/*
+ * ======================================================================================================================
+ * EMU_Stats() / EMU_Total() / EMU_StatsClear() / EMU_Report() - Bus counters
+ * ======================================================================================================================
+ */
+EMU_STATS_STR EMU_Stats(uint8_t addr) {
+  return emu_stats[addr & 0x7F];
+}
+
+EMU_STATS_STR EMU_Total() {
+  EMU_STATS_STR t = {};
+
+  for (int a = 0; a < EMU_ADDRS; a++) {
+    t.tx += emu_stats[a].tx;
+    t.nack += emu_stats[a].nack;
+    t.err += emu_stats[a].err;
+    t.bytes += emu_stats[a].bytes;
+    t.us += emu_stats[a].us;
+  }
+  return t;
+}
+
+void EMU_StatsClear() {
+  memset(emu_stats, 0, sizeof(emu_stats));
+}
+
+static const char *EMU_Name(uint8_t addr);
+
+void EMU_Report(const char *title) {
+  EMU_STATS_STR t = EMU_Total();
+
+  printf("%s\n", title);
+  printf("  ADDR DEVICE      TX     NACK  ERR   BYTES   BUS_US\n");
+  for (int a = 0; a < EMU_ADDRS; a++) {
+    EMU_STATS_STR *s = &emu_stats[a];
+    if (s->tx) {
+      printf("  0x%02X %-10s %6lu %5lu %4lu %7lu %8llu\n", a, EMU_Name(a), s->tx, s->nack, s->err, s->bytes,
+        (unsigned long long) s->us);
+    }
+  }
+  printf("  ALL             %6lu %5lu %4lu %7lu %8llu\n", t.tx, t.nack, t.err, t.bytes, (unsigned long long) t.us);
+}
+
+/*
+ * ======================================================================================================================
+ * EMU_Reach() - Devices at addr on the main bus and on the mux channels switched in, recursively
+ * ======================================================================================================================
+ */
+static void EMU_Reach(const std::vector<EmuDevice *> &bus, uint8_t addr, std::vector<EmuDevice *> &out, int depth) {
+  for (EmuDevice *d : bus) {
+    if (!d->present) {
+      continue;
+    }
+    if (d->addr == addr) {
+      out.push_back(d);
+    }
+    EmuPCA9548 *mux = dynamic_cast<EmuPCA9548 *>(d);
+    if (mux && (depth < 4)) {
+      for (int c = 0; c < 8; c++) {
+        if (mux->control & (1 << c)) {
+          EMU_Reach(mux->channels[c], addr, out, depth + 1);
+        }
+      }
+    }
+  }
+}
+
+static const char *EMU_Name(uint8_t addr) {
+  std::vector<EmuDevice *> devs;
+
+  EMU_Reach(emu_bus, addr, devs, 0);
+  if (devs.empty()) {
+    // Behind a mux channel that is now off, look everywhere
+    for (EmuDevice *d : emu_bus) {
+      EmuPCA9548 *mux = dynamic_cast<EmuPCA9548 *>(d);
+      for (int c = 0; mux && (c < 8); c++) {
+        for (EmuDevice *m : mux->channels[c]) {
+          if (m->addr == addr) return m->name;
+        }
+      }
+    }
+    return "-";
+  }
+  return devs[0]->name;
+}
+
+/*
+ * ======================================================================================================================
+ * EMU_Clocks() - Move host time by SCL clocks at hz, the fraction of a microsecond is carried
+ * ======================================================================================================================
+ */
+static uint64_t EMU_Clocks(uint32_t hz, uint32_t clocks) {
+  uint64_t us;
+
+  emu_ps += (uint64_t) clocks * 1000000000000ULL / (hz ? hz : 100000);
+  us = emu_ps / 1000000;
+  emu_ps %= 1000000;
+  host_advance_us(us);
+  return us;
+}
+
+/*
+ * ======================================================================================================================
+ * EMU_Faults() - Faults armed for this transaction to addr, applied in the order scripted
+ * ======================================================================================================================
+ */
+static int EMU_Faults(uint8_t addr, EMU_FAULT_STR **hits) {
+  int n = 0;
+
+  for (int i = 0; i < emu_faults_count; i++) {
+    EMU_FAULT_STR *f = &emu_faults[i];
+    if ((f->addr != addr) || (host_time_us() < f->at_us)) {
+      continue;
+    }
+    if (f->seen++ < f->after) {
+      continue;
+    }
+    if (f->count && (f->applied >= f->count)) {
+      continue;
+    }
+    f->applied++;
+    hits[n++] = f;
+  }
+  return n;
+}
+
+typedef struct {
+  bool nack_addr;
+  int nack_data;                       // Byte index, -1 none
+  int short_read;
+  int corrupt;
+  uint32_t stretch;
+} EMU_TX_STR;
+
+/*
+ * ======================================================================================================================
+ * EMU_Begin() - Address phase of a transaction shared by writes and reads
+ *   Returns 0 with devs filled in, or the Wire error with the transaction counted.
+ * ======================================================================================================================
+ */
+static uint8_t EMU_Begin(uint32_t hz, uint8_t addr, bool read, std::vector<EmuDevice *> &devs, EMU_TX_STR *tx,
+    uint64_t *us) {
+  EMU_FAULT_STR *hits[EMU_FAULTS_SIZE];
+  EMU_STATS_STR *s = &emu_stats[addr & 0x7F];
+  bool ack = false;
+  int n;
+
+  s->tx++;
+  *tx = {false, -1, -1, -1, 0};
+
+  if (emu_held) {
+    // The master cannot make a START, SAMD Wire reports a bus error
+    *us += EMU_Clocks(hz, 1);
+    s->err++;
+    s->us += *us;
+    return (EMU_WIRE_ERROR);
+  }
+
+  EMU_Reach(emu_bus, addr, devs, 0);
+  n = EMU_Faults(addr, hits);
+  for (int i = 0; i < n; i++) {
+    EMU_FAULT_STR *f = hits[i];
+    switch (f->type) {
+      case EMU_NACK_ADDR :  tx->nack_addr = true; break;
+      case EMU_NACK_DATA :  tx->nack_data = f->param; break;
+      case EMU_SHORT_READ : tx->short_read = f->param; break;
+      case EMU_CORRUPT :    tx->corrupt = f->param; break;
+      case EMU_STRETCH :    tx->stretch += f->param; break;
+      case EMU_RESET :
+        for (EmuDevice *d : devs) d->reset();
+        break;
+      case EMU_UNPLUG :
+        for (EmuDevice *d : devs) d->present = false;
+        devs.clear();
+        break;
+      case EMU_HOLD_SDA :
+        // Lost part way through, the device keeps driving a 0 bit
+        *us += EMU_Clocks(hz, 1 + 9);
+        emu_held = true;
+        emu_held_clocks = f->param;
+        s->err++;
+        s->us += *us;
+        return (EMU_WIRE_ERROR);
+    }
+  }
+
+  // START and the address byte with its ACK
+  *us += EMU_Clocks(hz, 1 + 9);
+  for (EmuDevice *d : devs) {
+    ack |= d->start(read);
+  }
+  if (!ack || tx->nack_addr) {
+    *us += EMU_Clocks(hz, 1);        // STOP
+    for (EmuDevice *d : devs) d->stop();
+    s->nack++;
+    s->us += *us;
+    return (2);
+  }
+  return (0);
+}
+
+/*
+ * ======================================================================================================================
+ * EMU_Write() - Master write, returns the Wire endTransmission() status
+ * ======================================================================================================================
+ */
+uint8_t EMU_Write(uint32_t hz, uint8_t addr, const uint8_t *buf, size_t len, bool stop) {
+  EMU_STATS_STR *s = &emu_stats[addr & 0x7F];
+  std::vector<EmuDevice *> devs;
+  EMU_TX_STR tx;
+  uint64_t us = 0;
+  uint8_t status;
+
+  status = EMU_Begin(hz, addr, false, devs, &tx, &us);
+  if (status) {
+    return (status);
+  }
+
+  if (tx.stretch) {
+    host_advance_us(tx.stretch);
+    us += tx.stretch;
+  }
+
+  for (size_t i = 0; i < len; i++) {
+    bool ack = false;
+    us += EMU_Clocks(hz, 9);
+    s->bytes++;
+    for (EmuDevice *d : devs) {
+      // Too fast for the part, it sees garbage and does not ACK
+      ack |= (hz <= d->max_hz) ? d->write(buf[i]) : false;
+    }
+    if (!ack || ((int) i == tx.nack_data)) {
+      us += EMU_Clocks(hz, 1);
+      for (EmuDevice *d : devs) d->stop();
+      s->nack++;
+      s->us += us;
+      return (3);
+    }
+  }
+
+  if (stop) {
+    us += EMU_Clocks(hz, 1);
+  }
+  for (EmuDevice *d : devs) d->stop();
+  s->us += us;
+  return (0);
+}
+
+/*
+ * ======================================================================================================================
+ * EMU_Read() - Master read, returns the bytes received as Wire requestFrom() does
+ * ======================================================================================================================
+ */
+size_t EMU_Read(uint32_t hz, uint8_t addr, uint8_t *buf, size_t len, bool stop) {
+  EMU_STATS_STR *s = &emu_stats[addr & 0x7F];
+  std::vector<EmuDevice *> devs;
+  EMU_TX_STR tx;
+  uint64_t us = 0;
+  uint32_t stretch;
+  size_t n;
+
+  if (EMU_Begin(hz, addr, true, devs, &tx, &us)) {
+    return (0);
+  }
+
+  stretch = tx.stretch;
+  for (EmuDevice *d : devs) {
+    stretch = max(stretch, d->stretch_us());
+  }
+  if (stretch) {
+    host_advance_us(stretch);
+    us += stretch;
+  }
+
+  n = ((tx.short_read >= 0) && ((size_t) tx.short_read < len)) ? tx.short_read : len;
+  for (size_t i = 0; i < n; i++) {
+    uint8_t b = 0xFF;
+    us += EMU_Clocks(hz, 9);
+    for (EmuDevice *d : devs) {
+      b &= (hz <= d->max_hz) ? d->read() : 0xFF;
+    }
+    if ((int) i == tx.corrupt) {
+      b ^= 0x01;
+    }
+    buf[i] = b;
+  }
+  s->bytes += n;
+
+  if (stop || (n < len)) {
+    us += EMU_Clocks(hz, 1);
+  }
+  for (EmuDevice *d : devs) d->stop();
+  if (n < len) {
+    s->err++;
+  }
+  s->us += us;
+  return (n);
+}
+
+/*
+ * ======================================================================================================================
+ * EMU_SDALow() / EMU_SCLClock() - The bus lines as the pins see them with Wire stopped
+ * ======================================================================================================================
+ */
+bool EMU_SDALow() {
+  return (emu_held);
+}
+
+void EMU_SCLClock() {
+  if (emu_held && emu_held_clocks && (--emu_held_clocks == 0)) {
+    emu_held = false;
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * EMU_CRC8() - CRC-8 polynomial 0x31, MSB first, the Sensirion and TI word check
+ * ======================================================================================================================
+ */
+uint8_t EMU_CRC8(uint8_t crc, const uint8_t *data, int len) {
+  for (int i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++) {
+      crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : (crc << 1);
+    }
+  }
+  return (crc);
+}
+
+/*
+ * ======================================================================================================================
+ * EmuRegs - Register pointer and auto increment
+ * ======================================================================================================================
+ */
+bool EmuRegs::start(bool read) {
+  if (read) {
+    latch();
+  }
+  else {
+    pointer_ = true;
+  }
+  return true;
+}
+
+bool EmuRegs::write(uint8_t b) {
+  bool ok;
+
+  if (pointer_) {
+    ptr_ = b;
+    pointer_ = false;
+    return true;
+  }
+  ok = put(ptr_, b);
+  if (pairs_) {
+    pointer_ = true;
+  }
+  else {
+    ptr_ = next(ptr_);
+  }
+  return ok;
+}
+
+uint8_t EmuRegs::read() {
+  uint8_t v = get(ptr_);
+  ptr_ = next(ptr_);
+  return v;
+}
+
+void EmuRegs::set24(uint8_t reg, uint32_t v, bool msb_first) {
+  for (int i = 0; i < 3; i++) {
+    regs_[(uint8_t) (reg + i)] = (v >> (msb_first ? 16 - 8 * i : 8 * i)) & 0xFF;
+  }
+}
@@ -0,0 +1,65 @@
+/*
+ * ======================================================================================================================
+ *  emu_mem.cpp - Two byte address memories: 24LC32 EEPROM and I2C FRAM
+ * ======================================================================================================================
+ */
+#include "emu.h"
+
+EmuEEPROM::EmuEEPROM(uint8_t addr, const char *name, uint32_t size, uint32_t page, uint32_t write_us)
+  : EmuDevice(addr, name), mem(size, 0xFF), page_(page), write_us_(write_us) {}
+
+// Busy in the write cycle, the address is not acknowledged
+bool EmuEEPROM::start(bool read) {
+  if (now() < busy_us_) {
+    return false;
+  }
+  n_ = read ? 2 : 0;
+  pending_.clear();
+  return true;
+}
+
+bool EmuEEPROM::write(uint8_t b) {
+  uint32_t page_base;
+
+  switch (n_++) {
+    case 0 :
+      ptr_ = (b << 8) % mem.size();
+      return true;
+    case 1 :
+      ptr_ = (ptr_ | b) % mem.size();
+      return true;
+  }
+  if (page_ == 0) {
+    mem[ptr_] = b;                   // FRAM, written as it arrives
+    ptr_ = (ptr_ + 1) % mem.size();
+    return true;
+  }
+  // The address counter wraps in the page, later bytes overwrite the first ones
+  pending_.push_back({ptr_, b});
+  page_base = ptr_ - (ptr_ % page_);
+  ptr_ = page_base + ((ptr_ + 1) % page_);
+  return true;
+}
+
+uint8_t EmuEEPROM::read() {
+  uint8_t b = mem[ptr_];
+
+  ptr_ = (ptr_ + 1) % mem.size();
+  return b;
+}
+
+// A page write starts at STOP
+void EmuEEPROM::stop() {
+  if (!pending_.empty()) {
+    for (auto &w : pending_) {
+      mem[w.first] = w.second;
+    }
+    pending_.clear();
+    write_cycles++;
+    busy_us_ = now() + write_us_;
+  }
+  else if ((page_ == 0) && (n_ > 2)) {
+    write_cycles++;
+  }
+  n_ = 0;
+}
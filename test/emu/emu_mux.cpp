@@ -0,0 +1,375 @@
+/*
+ * ======================================================================================================================
+ *  emu_mux.cpp - DS2482-800 1-Wire bridge and the DS18B20 probes on its channels
+ * ======================================================================================================================
+ */
+#include "emu.h"
+
+// DS2482 status bits
+#define DS_1WB   0x01
+#define DS_PPD   0x02
+#define DS_SD    0x04
+#define DS_LL    0x08
+#define DS_RST   0x10
+#define DS_SBR   0x20
+#define DS_TSB   0x40
+#define DS_DIR   0x80
+#define DS_SPU   0x04                  // Config
+
+// 1-Wire standard speed timing
+#define OW_RESET_US  1148              // tRSTL + tRSTH
+#define OW_MSP_US    630               // Presence sampled
+#define OW_SLOT_US   69
+
+/*
+ * ======================================================================================================================
+ * EMU_OWCRC8() - Dallas 1-Wire CRC-8
+ * ======================================================================================================================
+ */
+static uint8_t EMU_OWCRC8(const uint8_t *data, int len) {
+  uint8_t crc = 0;
+
+  for (int i = 0; i < len; i++) {
+    uint8_t b = data[i];
+    for (int j = 0; j < 8; j++) {
+      crc = ((crc ^ b) & 0x01) ? ((crc >> 1) ^ 0x8C) : (crc >> 1);
+      b >>= 1;
+    }
+  }
+  return (crc);
+}
+
+/*
+ * ======================================================================================================================
+ * EmuDS18B20
+ * ======================================================================================================================
+ */
+EmuDS18B20::EmuDS18B20(uint64_t serial, bool parasite) : parasite(parasite) {
+  rom[0] = 0x28;
+  for (int i = 1; i < 7; i++) {
+    rom[i] = (serial >> (8 * (i - 1))) & 0xFF;
+  }
+  rom[7] = EMU_OWCRC8(rom, 7);
+  power_on();
+}
+
+void EmuDS18B20::power_on() {
+  const uint8_t sp[8] = {0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10};   // 85C
+
+  memcpy(sp_, sp, 8);
+  sp_[8] = EMU_OWCRC8(sp_, 8);
+  state_ = IDLE;
+  conv_end_ = 0;
+  strong_ = false;
+}
+
+// Conversion finished, or a parasite probe that lost power part way
+void EmuDS18B20::finish() {
+  if (!conv_end_ || (host_time_us() < conv_end_)) {
+    return;
+  }
+  conv_end_ = 0;
+  if (brownout_) {
+    brownout_ = false;
+    power_on();
+    return;
+  }
+  int res = (sp_[4] >> 5) & 3;
+  int16_t raw = (int16_t) lround(t * 16.0) & ~((1 << (3 - res)) - 1);
+  sp_[0] = raw & 0xFF;
+  sp_[1] = (raw >> 8) & 0xFF;
+  sp_[8] = EMU_OWCRC8(sp_, 8);
+}
+
+bool EmuDS18B20::reset() {
+  finish();
+  if (!present) {
+    return false;
+  }
+  state_ = ROM_CMD;
+  rx_ = 0;
+  rx_bits_ = 0;
+  return true;
+}
+
+void EmuDS18B20::send(const uint8_t *buf, int bits, STATE after) {
+  memcpy(tx_, buf, (bits + 7) / 8);
+  tx_bits_ = bits;
+  tx_pos_ = 0;
+  after_ = after;
+  state_ = TX;
+}
+
+// A whole byte received in the current state
+void EmuDS18B20::byte(uint8_t b) {
+  static const uint8_t zero = 0, one = 1;
+
+  switch (state_) {
+    case ROM_CMD :
+      switch (b) {
+        case 0x33 : send(rom, 64, FUNC); break;
+        case 0xCC : state_ = FUNC; break;
+        case 0x55 : state_ = MATCH; match_ok_ = true; search_bit_ = 0; break;
+        case 0xF0 : state_ = SEARCH; search_bit_ = 0; search_phase_ = 0; break;
+        default :   state_ = INACTIVE; break;
+      }
+      break;
+    case FUNC :
+      switch (b) {
+        case 0x44 :
+          conv_start_ = host_time_us();
+          conv_end_ = conv_start_ + (93750UL << ((sp_[4] >> 5) & 3));
+          brownout_ = parasite && !strong_;
+          state_ = CONVERT;
+          break;
+        case 0xBE : send(sp_, 72, IDLE); break;
+        case 0x4E : state_ = RX; rx_left_ = 3; break;
+        case 0xB4 : send(parasite ? &zero : &one, 1, IDLE); break;
+        case 0x48 :
+        case 0xB8 : state_ = IDLE; break;
+        default :   state_ = INACTIVE; break;
+      }
+      break;
+    case RX :
+      sp_[5 - rx_left_] = b;         // TH, TL, config
+      if (--rx_left_ == 0) {
+        sp_[4] = (sp_[4] & 0x60) | 0x1F;
+        sp_[8] = EMU_OWCRC8(sp_, 8);
+        state_ = IDLE;
+      }
+      break;
+    default :
+      break;
+  }
+}
+
+bool EmuDS18B20::slot(bool w) {
+  bool bit;
+
+  finish();
+  switch (state_) {
+    case ROM_CMD :
+    case FUNC :
+    case RX :
+      rx_ = (rx_ >> 1) | (w ? 0x80 : 0);
+      if (++rx_bits_ == 8) {
+        rx_bits_ = 0;
+        byte(rx_);
+      }
+      return w;
+    case MATCH :
+      match_ok_ = match_ok_ && (w == ((rom[search_bit_ / 8] >> (search_bit_ % 8)) & 1));
+      if (++search_bit_ == 64) {
+        state_ = match_ok_ ? FUNC : INACTIVE;
+      }
+      return w;
+    case SEARCH :
+      bit = (rom[search_bit_ / 8] >> (search_bit_ % 8)) & 1;
+      switch (search_phase_++) {
+        case 0 : return w && bit;
+        case 1 : return w && !bit;
+      }
+      search_phase_ = 0;
+      if (w != bit) {
+        state_ = INACTIVE;
+      }
+      else if (++search_bit_ == 64) {
+        state_ = FUNC;
+      }
+      return w;
+    case TX :
+      bit = (tx_[tx_pos_ / 8] >> (tx_pos_ % 8)) & 1;
+      if (++tx_pos_ == tx_bits_) {
+        state_ = after_;
+      }
+      return w && bit;
+    case CONVERT :
+      // An external probe holds read slots low until done, a parasite one can not
+      return w && (parasite || !conv_end_);
+    default :
+      return w;
+  }
+}
+
+// The strong pullup has to cover a parasite conversion from its start to its end
+void EmuDS18B20::pullup(bool on) {
+  finish();
+  if (on && conv_end_ && (host_time_us() - conv_start_ <= 10)) {
+    brownout_ = false;
+  }
+  if (!on && conv_end_ && parasite) {
+    brownout_ = true;
+  }
+  strong_ = on;
+}
+
+/*
+ * ======================================================================================================================
+ * EmuDS2482
+ * ======================================================================================================================
+ */
+void EmuDS2482::reset() {
+  status_ = DS_RST | DS_LL;
+  config_ = 0;
+  channel_ = 0;
+  pointer_ = 0xF0;
+  busy_us_ = msp_us_ = 0;
+  ppd_ = sd_ = ppd_old_ = sd_old_ = false;
+  n_ = 0;
+  spu_end();
+}
+
+bool EmuDS2482::start(bool read) {
+  (void) read;
+  n_ = 0;
+  return true;
+}
+
+// The byte count each command takes, 1-Wire commands are refused while the bus is busy
+bool EmuDS2482::write(uint8_t b) {
+  int len;
+
+  if (n_ >= 2) {
+    return false;
+  }
+  cmd_[n_++] = b;
+  switch (cmd_[0]) {
+    case 0xF0 : case 0xB4 : case 0x96 : len = 1; break;
+    case 0xE1 : case 0xD2 : case 0xC3 : case 0xA5 : case 0x87 : case 0x78 : len = 2; break;
+    default :   return false;
+  }
+  if ((n_ == 1) && (now() < busy_us_) && (cmd_[0] != 0xE1) && (cmd_[0] != 0xF0)) {
+    return false;
+  }
+  if (n_ == len) {
+    return command();
+  }
+  return true;
+}
+
+uint8_t EmuDS2482::read() {
+  static const uint8_t readback[8] = {0xB8, 0xB1, 0xAA, 0xA3, 0x9C, 0x95, 0x8E, 0x87};
+
+  switch (pointer_) {
+    case 0xE1 : return data_;
+    case 0xC3 : return readback[channel_];
+    case 0xD2 : return config_;
+  }
+  return status();
+}
+
+void EmuDS2482::stop() {
+  n_ = 0;
+}
+
+uint8_t EmuDS2482::status() {
+  uint8_t s = status_ & ~(DS_1WB | DS_PPD | DS_SD);
+  bool sampled = now() >= msp_us_;
+
+  if (now() < busy_us_) {
+    s |= DS_1WB;
+  }
+  // Presence and short are held from the last reset until this one samples them
+  if (sampled ? ppd_ : ppd_old_) s |= DS_PPD;
+  if (sampled ? sd_ : sd_old_) s |= DS_SD;
+  return s;
+}
+
+void EmuDS2482::run(uint32_t us) {
+  busy_us_ = now() + us;
+  pointer_ = 0xF0;
+}
+
+void EmuDS2482::spu_end() {
+  if (spu_on_) {
+    for (EmuDS18B20 *p : probes[channel_]) p->pullup(false);
+    spu_on_ = false;
+    config_ &= ~DS_SPU;
+  }
+}
+
+bool EmuDS2482::slot(bool w) {
+  bool line = w;
+
+  for (EmuDS18B20 *p : probes[channel_]) {
+    line = p->slot(w) && line;
+  }
+  return line;
+}
+
+bool EmuDS2482::command() {
+  static const uint8_t codes[8] = {0xF0, 0xE1, 0xD2, 0xC3, 0xB4, 0xA5, 0x96, 0x87};
+  uint8_t p = cmd_[1];
+  bool id, cmp, dir;
+
+  switch (cmd_[0]) {
+    case 0xF0 :                      // Device reset
+      reset();
+      return true;
+    case 0xE1 :                      // Set read pointer
+      if ((p != 0xF0) && (p != 0xE1) && (p != 0xC3) && (p != 0xD2)) return false;
+      pointer_ = p;
+      return true;
+    case 0xD2 :                      // Write configuration, upper nibble the complement
+      if ((p >> 4) != ((~p) & 0x0F)) return false;
+      config_ = p & 0x0F;
+      if (!(config_ & DS_SPU)) spu_end();
+      status_ &= ~DS_RST;
+      pointer_ = 0xD2;
+      return true;
+    case 0xC3 :                      // Channel select
+      for (int c = 0; c < 8; c++) {
+        if (codes[c] == p) {
+          spu_end();
+          channel_ = c;
+          pointer_ = 0xC3;
+          return true;
+        }
+      }
+      return false;
+  }
+
+  // 1-Wire commands, the strong pullup from the last write ends here
+  spu_end();
+  status_ &= ~DS_RST;
+  switch (cmd_[0]) {
+    case 0xB4 :
+      ow_resets++;
+      ppd_old_ = ppd_;
+      sd_old_ = sd_;
+      ppd_ = false;
+      for (EmuDS18B20 *d : probes[channel_]) ppd_ = d->reset() || ppd_;
+      sd_ = false;
+      msp_us_ = now() + OW_MSP_US;
+      run(OW_RESET_US);
+      break;
+    case 0xA5 :
+      for (int i = 0; i < 8; i++) slot((p >> i) & 1);
+      run(8 * OW_SLOT_US);
+      break;
+    case 0x96 :
+      data_ = 0;
+      for (int i = 0; i < 8; i++) data_ |= slot(true) << i;
+      run(8 * OW_SLOT_US);
+      break;
+    case 0x87 :
+      status_ = (status_ & ~DS_SBR) | (slot(p & 0x80) ? DS_SBR : 0);
+      run(OW_SLOT_US);
+      break;
+    case 0x78 :
+      id = slot(true);
+      cmp = slot(true);
+      dir = (id == cmp) ? (p & 0x80) : id;
+      slot(dir);
+      status_ = (status_ & ~(DS_SBR | DS_TSB | DS_DIR)) | (id ? DS_SBR : 0) | (cmp ? DS_TSB : 0) | (dir ? DS_DIR : 0);
+      run(3 * OW_SLOT_US);
+      break;
+  }
+
+  // Strong pullup after a write byte or bit when asked for
+  if ((config_ & DS_SPU) && ((cmd_[0] == 0xA5) || (cmd_[0] == 0x87))) {
+    spu_on_ = true;
+    for (EmuDS18B20 *d : probes[channel_]) d->pullup(true);
+  }
+  return true;
+}
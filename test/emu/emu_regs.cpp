@@ -0,0 +1,307 @@
+/*
+ * ======================================================================================================================
+ *  emu_regs.cpp - Register parts: LPS35HW, MCP9808, VEML7700, AS5600
+ * ======================================================================================================================
+ */
+#include "emu.h"
+
+/*
+ * ======================================================================================================================
+ * EmuLPS35HW - Output data rate from CTRL_REG1, one shot from CTRL_REG2, new data flags in STATUS
+ * ======================================================================================================================
+ */
+#define LPS_ONE_SHOT_US 14000
+
+void EmuLPS35HW::reset() {
+  memset(regs_, 0, sizeof(regs_));
+  regs_[0x0F] = 0xB1;
+  regs_[0x11] = 0x10;                // IF_ADD_INC
+  conv_start_ = conv_done_ = one_shot_us_ = 0;
+}
+
+void EmuLPS35HW::update() {
+  static const uint32_t period[8] = {0, 1000000, 100000, 40000, 20000, 13333, 0, 0};
+  uint32_t us = period[(regs_[0x10] >> 4) & 7];
+  bool fresh = false;
+
+  if (us && (now() >= conv_start_ + us)) {
+    uint64_t end = conv_start_ + (now() - conv_start_) / us * us;
+    if (end != conv_done_) {
+      conv_done_ = end;
+      fresh = true;
+    }
+  }
+  if (one_shot_us_ && (now() >= one_shot_us_)) {
+    one_shot_us_ = 0;
+    regs_[0x11] &= ~0x01;
+    fresh = true;
+  }
+  if (fresh) {
+    set24(0x28, (uint32_t) lround(p * 4096.0) & 0xFFFFFF, false);
+    regs_[0x2B] = (uint16_t) lround(t * 100.0) & 0xFF;
+    regs_[0x2C] = ((uint16_t) lround(t * 100.0)) >> 8;
+    regs_[0x27] |= 0x03;
+  }
+}
+
+uint8_t EmuLPS35HW::get(uint8_t reg) {
+  switch (reg) {
+    case 0x11 :
+      update();
+      return regs_[reg] | ((now() < reset_us_) ? 0x04 : 0);
+    case 0x2A :
+      regs_[0x27] &= ~0x01;          // Reading the output clears the new data flags
+      break;
+    case 0x2C :
+      regs_[0x27] &= ~0x02;
+      break;
+  }
+  return regs_[reg];
+}
+
+bool EmuLPS35HW::put(uint8_t reg, uint8_t v) {
+  switch (reg) {
+    case 0x10 :
+      update();
+      if ((v & 0x70) != (regs_[0x10] & 0x70)) {
+        conv_start_ = now();
+      }
+      regs_[reg] = v & 0x7F;
+      break;
+    case 0x11 :
+      if (v & 0x84) {
+        reset();                     // BOOT or SWRESET, the bit reads back set for a moment
+        reset_us_ = now() + 20;
+        break;
+      }
+      regs_[reg] = v & 0x7B;
+      if ((v & 0x01) && !(regs_[0x10] & 0x70)) {
+        one_shot_us_ = now() + LPS_ONE_SHOT_US;
+      }
+      break;
+    case 0x0B : case 0x0C : case 0x0D : case 0x12 : case 0x14 : case 0x15 : case 0x16 : case 0x17 : case 0x18 :
+    case 0x19 : case 0x1A :
+      regs_[reg] = v;
+      break;
+  }
+  return true;
+}
+
+/*
+ * ======================================================================================================================
+ * EmuWords - Pointer byte then 16 bit words, the read repeats the word
+ * ======================================================================================================================
+ */
+bool EmuWords::start(bool read) {
+  n_ = read ? 0 : -1;
+  if (read) {
+    out_ = get(ptr_);
+  }
+  return true;
+}
+
+bool EmuWords::write(uint8_t b) {
+  int w = width(ptr_);
+
+  if (n_ < 0) {
+    ptr_ = b;
+    n_ = 0;
+    return true;
+  }
+  if (w == 1) {
+    put(ptr_, b);
+  }
+  else if ((n_ % 2) == 0) {
+    in_ = b;
+  }
+  else {
+    put(ptr_, msb_first_ ? ((in_ << 8) | b) : ((b << 8) | in_));
+  }
+  n_++;
+  return true;
+}
+
+uint8_t EmuWords::read() {
+  int i = n_++ % width(ptr_);
+
+  if (width(ptr_) == 1) {
+    return out_ & 0xFF;
+  }
+  return ((i == 0) == msb_first_) ? (out_ >> 8) : (out_ & 0xFF);
+}
+
+void EmuWords::stop() {
+  n_ = 0;
+}
+
+/*
+ * ======================================================================================================================
+ * EmuMCP9808 - Ambient temperature at the resolution set, converting continuously unless shut down
+ * ======================================================================================================================
+ */
+void EmuMCP9808::reset() {
+  memset(words_, 0, sizeof(words_));
+  words_[6] = 0x0054;
+  words_[7] = 0x0400;
+  words_[8] = 0x03;
+  conv_start_ = now();
+}
+
+static float EMU_MCP_Limit(uint16_t w) {
+  return (int16_t) ((w & 0x1FFC) << 3) / 128.0;
+}
+
+uint16_t EmuMCP9808::get(uint8_t reg) {
+  if ((reg & 0x0F) == 5) {
+    static const float step[4] = {0.5, 0.25, 0.125, 0.0625};
+    uint16_t v;
+    float q;
+
+    if (now() < conv_start_ + conv_us()) {
+      return 0;                      // First conversion after power on or wake up
+    }
+    q = floor(t / step[words_[8] & 3]) * step[words_[8] & 3];
+    v = (int16_t) lround(q * 16) & 0x1FFF;
+    if (t >= EMU_MCP_Limit(words_[4])) v |= 0x8000;
+    if (t > EMU_MCP_Limit(words_[2])) v |= 0x4000;
+    if (t < EMU_MCP_Limit(words_[3])) v |= 0x2000;
+    return v;
+  }
+  return words_[reg & 0x0F];
+}
+
+void EmuMCP9808::put(uint8_t reg, uint16_t v) {
+  switch (reg & 0x0F) {
+    case 1 :
+      if ((words_[1] & 0x0100) && !(v & 0x0100)) {
+        conv_start_ = now();         // Wake up
+      }
+      words_[1] = v & 0x07FF;
+      break;
+    case 2 : case 3 : case 4 :
+      words_[reg & 0x0F] = v & 0x1FFC;
+      break;
+    case 8 :
+      words_[8] = v & 3;
+      break;
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * EmuVEML7700 - The count of the last finished integration, the sensor response is the library correction undone
+ * ======================================================================================================================
+ */
+void EmuVEML7700::reset() {
+  memset(words_, 0, sizeof(words_));
+  words_[0] = 0x0001;                // Shut down
+  words_[7] = 0xC481;
+  cycle_start_ = now();
+  als_ = 0;
+}
+
+uint32_t EmuVEML7700::it_us() {
+  switch ((words_[0] >> 6) & 0x0F) {
+    case 0x0C : return 25000;
+    case 0x08 : return 50000;
+    case 0x01 : return 200000;
+    case 0x02 : return 400000;
+    case 0x03 : return 800000;
+  }
+  return 100000;
+}
+
+// Integration plus the power save wait
+uint32_t EmuVEML7700::cycle_us() {
+  static const uint32_t psm_us[4] = {500000, 1000000, 2000000, 4000000};
+
+  return it_us() + ((words_[3] & 1) ? psm_us[(words_[3] >> 1) & 3] : 0);
+}
+
+uint16_t EmuVEML7700::count() {
+  static const float gain[4] = {1.0, 2.0, 0.125, 0.25};
+  float res = 0.0036 * (800000.0 / it_us()) * (2.0 / gain[(words_[0] >> 11) & 3]);
+  float lo = 0, hi = lux, u;
+
+  if ((words_[0] & 1) || (now() < cycle_start_ + cycle_us())) {
+    return als_;                     // Shut down or the first integration is not done
+  }
+  // The sensor reads low at high light, find the uncorrected lux the library formula brings back to lux
+  for (int i = 0; i < 40; i++) {
+    u = (lo + hi) / 2;
+    if ((((6.0135e-13 * u - 9.3924e-9) * u + 8.1488e-5) * u + 1.0023) * u < lux) lo = u; else hi = u;
+  }
+  return (uint16_t) min(65535L, lround(lo / res));
+}
+
+uint16_t EmuVEML7700::get(uint8_t reg) {
+  switch (reg & 0x0F) {
+    case 4 : return count();
+    case 5 : return (uint16_t) min(65535L, (long) count() * 13 / 10);
+    case 6 : return 0;
+  }
+  return words_[reg & 0x0F];
+}
+
+void EmuVEML7700::put(uint8_t reg, uint16_t v) {
+  switch (reg & 0x0F) {
+    case 0 :
+      als_ = count();                // The register keeps the old count until the new integration is done
+      words_[0] = v & 0x1BF3;
+      cycle_start_ = now();
+      break;
+    case 1 : case 2 : case 3 :
+      words_[reg & 0x0F] = v;
+      break;
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * EmuAS5600 - Raw and scaled angle, the 16 bit outputs wrap the pointer back to their high byte
+ * ======================================================================================================================
+ */
+void EmuAS5600::reset() {
+  memset(regs_, 0, sizeof(regs_));
+  regs_[0x1A] = 0x80;                // AGC
+  regs_[0x1B] = 0x08;                // Magnitude
+  latch();
+}
+
+void EmuAS5600::latch() {
+  uint16_t raw = lround(deg / 360.0 * 4096.0) & 0x0FFF;
+  uint16_t zpos = ((regs_[0x01] << 8) | regs_[0x02]) & 0x0FFF;
+  uint16_t mpos = ((regs_[0x03] << 8) | regs_[0x04]) & 0x0FFF;
+  uint16_t mang = ((regs_[0x05] << 8) | regs_[0x06]) & 0x0FFF;
+  uint16_t range = mpos ? ((mpos - zpos) & 0x0FFF) : mang;
+  uint16_t angle = (raw - zpos) & 0x0FFF;
+
+  if (range) {
+    angle = min(4095, angle * 4096 / range);
+  }
+  regs_[0x0B] = magnet ? 0x20 : 0x10;
+  regs_[0x0C] = raw >> 8;
+  regs_[0x0D] = raw & 0xFF;
+  regs_[0x0E] = angle >> 8;
+  regs_[0x0F] = angle & 0xFF;
+}
+
+uint8_t EmuAS5600::get(uint8_t reg) {
+  return regs_[reg];
+}
+
+bool EmuAS5600::put(uint8_t reg, uint8_t v) {
+  if ((reg >= 0x01) && (reg <= 0x08)) {
+    regs_[reg] = v;
+  }
+  return true;
+}
+
+uint8_t EmuAS5600::next(uint8_t reg) {
+  switch (reg) {
+    case 0x0D : return 0x0C;
+    case 0x0F : return 0x0E;
+    case 0x1C : return 0x1B;
+  }
+  return reg + 1;
+}
@@ -0,0 +1,360 @@
+/*
+ * ======================================================================================================================
+ *  emu_sensirion.cpp - Command and CRC word parts: SHT3x, SHT4x, HDC302x, HTU21DF, and the HIH8000
+ * ======================================================================================================================
+ */
+#include "emu.h"
+
+/*
+ * ======================================================================================================================
+ * EmuSensirion - Command bytes in, CRC words out
+ * ======================================================================================================================
+ */
+bool EmuSensirion::start(bool read) {
+  if (!ready() && !stretch_) {
+    return false;                    // Converting, the part does not answer
+  }
+  if (read) {
+    out_pos_ = 0;
+    return (out_n_ > 0);
+  }
+  cmd_n_ = 0;
+  return true;
+}
+
+bool EmuSensirion::write(uint8_t b) {
+  if (cmd_n_ < cmd_len_) {
+    cmd_[cmd_n_++] = b;
+    if (cmd_n_ < cmd_len_) {
+      return true;
+    }
+    cmd_last_ = (cmd_len_ == 2) ? ((cmd_[0] << 8) | cmd_[1]) : cmd_[0];
+    return command(cmd_last_);
+  }
+  return data(b);
+}
+
+uint8_t EmuSensirion::read() {
+  return (out_pos_ < out_n_) ? out_[out_pos_++] : 0xFF;
+}
+
+uint32_t EmuSensirion::stretch_us() {
+  return (stretch_ && !ready()) ? (uint32_t) (ready_us_ - now()) : 0;
+}
+
+// The result is read once
+void EmuSensirion::stop() {
+  if (out_pos_) {
+    out_n_ = out_pos_ = 0;
+    stretch_ = false;
+  }
+}
+
+void EmuSensirion::reply(const uint16_t *words, int n, uint32_t conversion_us, bool stretch) {
+  for (int i = 0; i < n; i++) {
+    out_[3*i] = words[i] >> 8;
+    out_[3*i+1] = words[i] & 0xFF;
+    out_[3*i+2] = EMU_CRC8(crc_init_, &out_[3*i], 2);
+  }
+  out_n_ = 3 * n;
+  out_pos_ = 0;
+  ready_us_ = now() + conversion_us;
+  stretch_ = stretch;
+}
+
+uint16_t EmuSensirion::raw(float v, float offset, float span) {
+  return (uint16_t) lround(constrain((v + offset) / span, 0.0, 1.0) * 65535);
+}
+
+/*
+ * ======================================================================================================================
+ * EmuSHT3x
+ * ======================================================================================================================
+ */
+void EmuSHT3x::reset() {
+  status_ = 0x8010;                  // Alert pending and reset detected
+  period_us_ = 0;
+  stretch_ = false;
+  busy(1000);
+}
+
+void EmuSHT3x::measure(uint32_t us, bool stretch) {
+  uint16_t w[2] = {raw(t, 45, 175), raw(rh, 0, 100)};
+  reply(w, 2, us, stretch);
+}
+
+bool EmuSHT3x::command(uint16_t cmd) {
+  uint16_t w[2];
+
+  if (period_us_) {
+    // Periodic mode takes only fetch, break and reset
+    if (cmd == 0xE000) {
+      uint64_t n = (now() >= period_start_ + meas_us_) ? (now() - period_start_ - meas_us_) / period_us_ + 1 : 0;
+      if (n > fetched_) {
+        fetched_ = n;
+        measure(0, false);
+      }
+      else {
+        out_n_ = 0;                  // No new data, the read NACKs
+      }
+      return true;
+    }
+    if ((cmd != 0x3093) && (cmd != 0x30A2)) {
+      return false;
+    }
+  }
+
+  switch (cmd) {
+    case 0x2400 : measure(15500, false); return true;    // Single shot high, medium, low repeatability
+    case 0x240B : measure(6500, false); return true;
+    case 0x2416 : measure(4500, false); return true;
+    case 0x2C06 : measure(15500, true); return true;     // The same with clock stretching
+    case 0x2C0D : measure(6500, true); return true;
+    case 0x2C10 : measure(4500, true); return true;
+    case 0x3093 : period_us_ = 0; busy(1000); return true;
+    case 0x30A2 : reset(); status_ = 0x0010; busy(1500); return true;
+    case 0x3041 : status_ &= ~0x8C10; return true;
+    case 0x306D : status_ |= 0x2000; return true;
+    case 0x3066 : status_ &= ~0x2000; return true;
+    case 0xF32D : w[0] = status_; reply(w, 1); return true;
+    case 0x3780 :
+    case 0x3682 :
+      w[0] = serial >> 16;
+      w[1] = serial & 0xFFFF;
+      reply(w, 2);
+      return true;
+    case 0x2B32 : cmd = 0x2737; break;                   // ART, 4 Hz on the board, run as 10 Hz
+  }
+
+  // Periodic, the high byte is the rate
+  switch (cmd >> 8) {
+    case 0x20 : period_us_ = 2000000; break;
+    case 0x21 : period_us_ = 1000000; break;
+    case 0x22 : period_us_ = 500000; break;
+    case 0x23 : period_us_ = 250000; break;
+    case 0x27 : period_us_ = 100000; break;
+    default :   return false;
+  }
+  meas_us_ = 15500;
+  period_start_ = now();
+  fetched_ = 0;
+  out_n_ = 0;
+  return true;
+}
+
+/*
+ * ======================================================================================================================
+ * EmuSHT4x
+ * ======================================================================================================================
+ */
+bool EmuSHT4x::command(uint16_t cmd) {
+  uint16_t w[2] = {raw(t, 45, 175), raw(rh, 6, 125)};
+  uint32_t us;
+
+  switch (cmd) {
+    case 0xFD : us = 8300; break;                        // High, medium, low precision
+    case 0xF6 : us = 4500; break;
+    case 0xE0 : us = 1700; break;
+    case 0x39 : case 0x2F : case 0x1E :                  // Heater 1s then a high precision measurement
+      heater_pulses++;
+      us = 1100000;
+      break;
+    case 0x32 : case 0x24 : case 0x15 :                  // Heater 0.1s
+      heater_pulses++;
+      us = 110000;
+      break;
+    case 0x94 :
+      reset();
+      return true;
+    case 0x89 :
+      w[0] = serial >> 16;
+      w[1] = serial & 0xFFFF;
+      us = 1000;
+      break;
+    default :
+      return false;
+  }
+  reply(w, 2, us);
+  return true;
+}
+
+/*
+ * ======================================================================================================================
+ * EmuHDC302x
+ * ======================================================================================================================
+ */
+void EmuHDC302x::reset() {
+  status_ = 0x0010;                  // Reset detected
+  heater_ = 0;
+  offsets_ = 0;
+  period_us_ = 0;
+  out_n_ = 0;
+  ready_us_ = now();                 // Soft reset is done by the next transaction
+}
+
+void EmuHDC302x::words(uint16_t *w) {
+  w[0] = raw(t, 45, 175);
+  w[1] = raw(rh, 0, 100);
+}
+
+bool EmuHDC302x::command(uint16_t cmd) {
+  uint16_t w[3];
+
+  data_n_ = 0;
+  if (period_us_ && (cmd == 0xE000)) {
+    uint64_t n = (now() >= period_start_) ? (now() - period_start_) / period_us_ : 0;
+    if (n > fetched_) {
+      fetched_ = n;
+      words(w);
+      reply(w, 2);
+    }
+    else {
+      out_n_ = 0;
+    }
+    return true;
+  }
+
+  switch (cmd) {
+    case 0x2400 : words(w); reply(w, 2, 12500); return true;   // Trigger on demand, low power modes 0-3
+    case 0x240B : words(w); reply(w, 2, 7500); return true;
+    case 0x2416 : words(w); reply(w, 2, 5000); return true;
+    case 0x24FF : words(w); reply(w, 2, 3700); return true;
+    case 0x3093 : period_us_ = 0; return true;
+    case 0x30A2 : reset(); return true;
+    case 0x3041 : status_ &= ~0x8C13; return true;
+    case 0xF32D : w[0] = status_; reply(w, 1); return true;
+    case 0x306D : status_ |= 0x2000; return true;
+    case 0x3066 : status_ &= ~0x2000; return true;
+    case 0x306E : return true;                                  // Heater power follows
+    case 0x3781 : w[0] = 0x3000; reply(w, 1); return true;
+    case 0x3683 : w[0] = 0x1234; reply(w, 1); return true;      // NIST id
+    case 0x3684 : w[0] = 0x5678; reply(w, 1); return true;
+    case 0x3685 : w[0] = 0x9ABC; reply(w, 1); return true;
+    case 0xA004 : w[0] = offsets_; reply(w, 1); return true;    // Read, or program with the data that follows
+  }
+  if ((cmd >> 8) == 0x61) {
+    return true;                                                // Alert thresholds follow
+  }
+  if ((cmd >> 8) == 0xE1) {
+    w[0] = 0;
+    reply(w, 1);
+    return true;
+  }
+
+  switch (cmd >> 8) {
+    case 0x20 : period_us_ = 2000000; break;                    // Auto measurement mode
+    case 0x21 : period_us_ = 1000000; break;
+    case 0x22 : period_us_ = 500000; break;
+    case 0x23 : period_us_ = 250000; break;
+    case 0x27 : period_us_ = 100000; break;
+    default :   return false;
+  }
+  period_start_ = now() + 12500;
+  fetched_ = 0;
+  out_n_ = 0;
+  return true;
+}
+
+// MSB, LSB, CRC after the heater, offset and alert commands
+bool EmuHDC302x::data(uint8_t b) {
+  if ((cmd_last_ != 0x306E) && (cmd_last_ != 0xA004) && ((cmd_last_ >> 8) != 0x61)) {
+    return false;
+  }
+  if (data_n_ >= 3) {
+    return false;
+  }
+  data_[data_n_++] = b;
+  if (data_n_ < 3) {
+    return true;
+  }
+  if (EMU_CRC8(crc_init_, data_, 2) != data_[2]) {
+    return false;
+  }
+  if (cmd_last_ == 0x306E) heater_ = (data_[0] << 8) | data_[1];
+  if (cmd_last_ == 0xA004) offsets_ = (data_[0] << 8) | data_[1];
+  out_n_ = 0;
+  return true;
+}
+
+/*
+ * ======================================================================================================================
+ * EmuHTU21DF - Resolution from the user register sets the conversion times
+ * ======================================================================================================================
+ */
+bool EmuHTU21DF::command(uint16_t cmd) {
+  static const uint32_t t_us[4] = {50000, 13000, 25000, 7000};
+  static const uint32_t h_us[4] = {16000, 3000, 5000, 8000};
+  int res = ((user_ >> 6) & 2) | (user_ & 1);
+  uint16_t w;
+
+  user_write_ = false;
+  switch (cmd) {
+    case 0xE3 :
+    case 0xF3 :
+      w = raw(t, 46.85, 175.72) & 0xFFFC;
+      reply(&w, 1, t_us[res], cmd == 0xE3);
+      return true;
+    case 0xE5 :
+    case 0xF5 :
+      w = (raw(rh, 6, 125) & 0xFFFC) | 0x02;
+      reply(&w, 1, h_us[res], cmd == 0xE5);
+      return true;
+    case 0xE7 :
+      out_[0] = user_;
+      out_n_ = 1;
+      out_pos_ = 0;
+      return true;
+    case 0xE6 :
+      user_write_ = true;
+      return true;
+    case 0xFE :
+      reset();
+      return true;
+  }
+  return false;
+}
+
+bool EmuHTU21DF::data(uint8_t b) {
+  if (!user_write_) {
+    return false;
+  }
+  user_ = (user_ & 0x38) | (b & 0xC7);     // Bits 3-5 are reserved
+  user_write_ = false;
+  return true;
+}
+
+/*
+ * ======================================================================================================================
+ * EmuHIH8 - A write is a measurement request, a read fetches the last result
+ * ======================================================================================================================
+ */
+bool EmuHIH8::start(bool read) {
+  if (!read) {
+    if (now() >= done_us_) {
+      done_us_ = now() + 36650;
+      fetched_ = false;
+    }
+    return true;
+  }
+
+  uint16_t h = lround(constrain(rh, 0, 100) / 100.0 * 16382);
+  uint16_t tt = lround((constrain(t, -40, 125) + 40) / 165.0 * 16382) << 2;
+  bool stale = (now() < done_us_) || fetched_;
+
+  if (done_us_ == 0) {
+    h = tt = 0;                      // Nothing measured since power on
+  }
+  out_[0] = (stale ? 0x40 : 0x00) | (h >> 8);
+  out_[1] = h & 0xFF;
+  out_[2] = tt >> 8;
+  out_[3] = tt & 0xFF;
+  out_pos_ = 0;
+  if (now() >= done_us_) {
+    fetched_ = true;
+  }
+  return true;
+}
+
+uint8_t EmuHIH8::read() {
+  return out_[out_pos_++ & 3];
+}
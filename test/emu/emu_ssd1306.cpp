@@ -0,0 +1,115 @@
+/*
+ * ======================================================================================================================
+ *  emu_ssd1306.cpp - SSD1306 OLED controller: control bytes, commands with their arguments, display RAM addressing
+ * ======================================================================================================================
+ */
+#include "emu.h"
+
+void EmuSSD1306::reset() {
+  memset(ram, 0, sizeof(ram));
+  on = false;
+  control_ = true;
+  continuation_ = false;
+  data_mode_ = false;
+  cmd_n_ = cmd_args_ = 0;
+  mode_ = 2;
+  col_ = col_start_ = 0;
+  col_end_ = 127;
+  page_ = page_start_ = 0;
+  page_end_ = 7;
+}
+
+// Write only, the controller does not answer a read on I2C
+bool EmuSSD1306::start(bool read) {
+  control_ = true;
+  return !read;
+}
+
+bool EmuSSD1306::write(uint8_t b) {
+  if (control_) {
+    // Co bit clear, the rest of the transaction is this kind of byte. Set, one byte then another control byte
+    continuation_ = b & 0x80;
+    data_mode_ = b & 0x40;
+    control_ = false;
+    return true;
+  }
+  if (data_mode_) {
+    data(b);
+  }
+  else {
+    cmd(b);
+  }
+  if (continuation_) {
+    control_ = true;
+  }
+  return true;
+}
+
+// Argument bytes that follow each command
+static int EMU_SSD1306_Args(uint8_t c) {
+  switch (c) {
+    case 0x20 : case 0x81 : case 0x8D : case 0xA8 : case 0xD3 : case 0xD5 : case 0xD9 : case 0xDA : case 0xDB :
+      return 1;
+    case 0x21 : case 0x22 : case 0xA3 :
+      return 2;
+    case 0x29 : case 0x2A :
+      return 5;
+    case 0x26 : case 0x27 :
+      return 6;
+  }
+  return 0;
+}
+
+void EmuSSD1306::cmd(uint8_t b) {
+  if (cmd_n_ == 0) {
+    cmd_args_ = EMU_SSD1306_Args(b);
+  }
+  cmd_[cmd_n_++] = b;
+  if (cmd_n_ <= cmd_args_) {
+    return;
+  }
+  cmd_n_ = 0;
+
+  switch (cmd_[0]) {
+    case 0xAE : on = false; return;
+    case 0xAF : on = true; return;
+    case 0x20 : mode_ = cmd_[1] & 3; return;
+    case 0x21 :
+      col_start_ = col_ = cmd_[1] & 0x7F;
+      col_end_ = cmd_[2] & 0x7F;
+      return;
+    case 0x22 :
+      page_start_ = page_ = cmd_[1] & 7;
+      page_end_ = cmd_[2] & 7;
+      return;
+  }
+  if (mode_ == 2) {
+    // Page addressing, the start column nibbles and the page
+    if (cmd_[0] <= 0x0F) col_ = (col_ & 0xF0) | cmd_[0];
+    else if (cmd_[0] <= 0x1F) col_ = (col_ & 0x0F) | ((cmd_[0] & 0x07) << 4);
+    else if ((cmd_[0] & 0xF8) == 0xB0) page_ = cmd_[0] & 7;
+  }
+}
+
+void EmuSSD1306::data(uint8_t b) {
+  ram[page_][col_] = b;
+  data_bytes++;
+
+  switch (mode_) {
+    case 0 :                         // Horizontal, across the window then the next page
+      if (col_++ >= col_end_) {
+        col_ = col_start_;
+        page_ = (page_ >= page_end_) ? page_start_ : page_ + 1;
+      }
+      break;
+    case 1 :                         // Vertical, down the pages then the next column
+      if (page_++ >= page_end_) {
+        page_ = page_start_;
+        col_ = (col_ >= col_end_) ? col_start_ : col_ + 1;
+      }
+      break;
+    default :                        // Page, the column wraps in the page
+      col_ = (col_ + 1) & 0x7F;
+      break;
+  }
+}
@@ -0,0 +1,146 @@
+/*
+ * ======================================================================================================================
+ *  Arduino.h - Host stand-in for the Arduino SAMD core
+ *
+ *  Enough of the core for the station code and the vendored libraries to build and run on Linux. Time is
+ *  simulated: millis()/micros() only move when delay(), delayMicroseconds() or host_advance_us() move them,
+ *  so tests are repeatable and bus time from the I2C emulator shows up in the clock.
+ * ======================================================================================================================
+ */
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+#ifndef ARDUINO
+#define ARDUINO 10819
+#endif
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef uint16_t word;
+
+#define HIGH            1
+#define LOW             0
+#define INPUT           0
+#define OUTPUT          1
+#define INPUT_PULLUP    2
+#define INPUT_PULLDOWN  3
+#define CHANGE          2
+#define FALLING         3
+#define RISING          4
+
+enum BitOrder { LSBFIRST = 0, MSBFIRST = 1 };
+
+#define DEC             10
+#define HEX             16
+#define OCT             8
+#define BIN             2
+
+#define PI              3.1415926535897932384626433832795
+#define HALF_PI         1.5707963267948966192313216916398
+#define TWO_PI          6.283185307179586476925286766559
+#define DEG_TO_RAD      0.017453292519943295769236907684886
+#define RAD_TO_DEG      57.295779513082320876798154814105
+
+// MKR pin numbers
+#define LED_BUILTIN     6
+#define PIN_WIRE_SDA    11
+#define PIN_WIRE_SCL    12
+#define SS              24
+#define PIN_A0          15
+enum { A0 = 15, A1, A2, A3, A4, A5, A6 };
+#define NUM_DIGITAL_PINS 32
+
+#define PROGMEM
+#define PGM_P           const char *
+#define PSTR(s)         (s)
+#ifndef pgm_read_byte                // Adafruit_SSD1306.cpp has its own
+#define pgm_read_byte(addr)   (*(const uint8_t *)(addr))
+#endif
+#define pgm_read_word(addr)   (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr)  (*(const uint32_t *)(addr))
+#define pgm_read_ptr(addr)    (*(void * const *)(addr))
+#define strcpy_P        strcpy
+#define strncpy_P       strncpy
+#define strcmp_P        strcmp
+#define strlen_P        strlen
+#define memcpy_P        memcpy
+#define sprintf_P       sprintf
+#define snprintf_P      snprintf
+
+class __FlashStringHelper;
+#define F(s)            (reinterpret_cast<const __FlashStringHelper *>(s))
+#define FPSTR(p)        (reinterpret_cast<const __FlashStringHelper *>(p))
+
+#define highByte(w)     ((uint8_t) ((w) >> 8))
+#define lowByte(w)      ((uint8_t) ((w) & 0xff))
+#define bitRead(v, b)   (((v) >> (b)) & 0x01)
+#define bitSet(v, b)    ((v) |= (1UL << (b)))
+#define bitClear(v, b)  ((v) &= ~(1UL << (b)))
+#define bitWrite(v, b, x) ((x) ? bitSet(v, b) : bitClear(v, b))
+#define bit(b)          (1UL << (b))
+#define _BV(b)          (1UL << (b))
+#define constrain(x, lo, hi) ((x) < (lo) ? (lo) : ((x) > (hi) ? (hi) : (x)))
+#define radians(d)      ((d) * DEG_TO_RAD)
+#define degrees(r)      ((r) * RAD_TO_DEG)
+#define sq(x)           ((x) * (x))
+
+#ifdef __cplusplus
+template <class T, class L> static inline auto min(const T &a, const L &b) -> decltype((b < a) ? b : a) {
+  return (b < a) ? b : a;
+}
+template <class T, class L> static inline auto max(const T &a, const L &b) -> decltype((b < a) ? b : a) {
+  return (a < b) ? b : a;
+}
+#endif
+
+// Simulated clock
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+void host_advance_us(uint64_t us);
+uint64_t host_time_us();
+
+// Pins, recorded so tests can look at them
+void pinMode(uint32_t pin, uint32_t mode);
+void digitalWrite(uint32_t pin, uint32_t value);
+int digitalRead(uint32_t pin);
+int analogRead(uint32_t pin);
+void analogWrite(uint32_t pin, int value);
+void analogReadResolution(int bits);
+void analogWriteResolution(int bits);
+void attachInterrupt(uint32_t pin, void (*isr)(void), uint32_t mode);
+void detachInterrupt(uint32_t pin);
+#define digitalPinToInterrupt(p) (p)
+void host_pin_set(uint32_t pin, int value);
+void host_analog_set(uint32_t pin, int value);
+bool host_i2c_sda_held();             // A device on the I2C emulator holds SDA low
+void host_i2c_scl_clock();            // SCL clocked by hand with Wire stopped
+
+static inline void interrupts() {}
+static inline void noInterrupts() {}
+static inline void __disable_irq() {}
+static inline void __enable_irq() {}
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+#ifdef __cplusplus
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "HardwareSerial.h"
+#endif
+
+#endif
@@ -0,0 +1,31 @@
+/*
+ * ======================================================================================================================
+ *  Arduino_ConnectionHandler.h - Host stand-in, the Arduino_DebugUtils level output.cpp sets and the connection
+ *    state network.h declares
+ * ======================================================================================================================
+ */
+#ifndef HOST_ARDUINO_CONNECTIONHANDLER_H
+#define HOST_ARDUINO_CONNECTIONHANDLER_H
+
+#include <Arduino.h>
+
+static int const DBG_NONE    = -1;
+static int const DBG_ERROR   =  0;
+static int const DBG_WARNING =  1;
+static int const DBG_INFO    =  2;
+static int const DBG_DEBUG   =  3;
+static int const DBG_VERBOSE =  4;
+
+static inline void setDebugMessageLevel(int const debug_level) { (void) debug_level; }
+
+enum class NetworkConnectionState : unsigned int {
+  INIT          = 0,
+  CONNECTING    = 1,
+  CONNECTED     = 2,
+  DISCONNECTING = 3,
+  DISCONNECTED  = 4,
+  CLOSED        = 5,
+  ERROR         = 6
+};
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ * ======================================================================================================================
+ *  HardwareSerial.h - Host stand-in for the USB and UART serial ports
+ *
+ *  Output goes to stdout when host_serial_echo is set, otherwise it is dropped. Input comes from
+ *  host_serial_input().
+ * ======================================================================================================================
+ */
+#ifndef HOST_ARDUINO_H
+#include "Arduino.h"
+#else
+#ifndef HOST_HARDWARESERIAL_H
+#define HOST_HARDWARESERIAL_H
+
+#include "Stream.h"
+
+#define SERIAL_8N1 0x06
+
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud) { (void) baud; }
+  void begin(unsigned long baud, uint16_t config) { (void) baud; (void) config; }
+  void end() {}
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+  int availableForWrite() override { return 64; }
+  operator bool() { return true; }
+  uint32_t baud() { return 115200; }
+};
+
+typedef HardwareSerial Serial_;
+typedef HardwareSerial Uart;
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern bool host_serial_echo;
+void host_serial_input(const char *s);
+
+#endif
+#endif
@@ -0,0 +1,14 @@
+/*
+ * ======================================================================================================================
+ *  RH_RF95.h - Host stand-in, only the class lora.h declares rf95 with
+ * ======================================================================================================================
+ */
+#ifndef HOST_RH_RF95_H
+#define HOST_RH_RF95_H
+
+#include <Arduino.h>
+
+class RH_RF95 {
+};
+
+#endif
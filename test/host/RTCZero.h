@@ -0,0 +1,62 @@
+/*
+ * ======================================================================================================================
+ *  RTCZero.h - Host stand-in for the SAMD RTC, counts from the set epoch with the simulated clock
+ * ======================================================================================================================
+ */
+#ifndef HOST_RTCZERO_H
+#define HOST_RTCZERO_H
+
+#include <Arduino.h>
+#include <time.h>
+
+typedef void (*voidFuncPtr)(void);
+
+class RTCZero {
+public:
+  enum Alarm_Match { MATCH_OFF, MATCH_SS, MATCH_MMSS, MATCH_HHMMSS, MATCH_DHHMMSS, MATCH_MMDDHHMMSS, MATCH_YYMMDDHHMMSS };
+
+  void begin(bool resetTime = false) { if (resetTime) setEpoch(0); }
+  void enableAlarm(Alarm_Match match) { (void) match; }
+  void disableAlarm() {}
+  void attachInterrupt(voidFuncPtr callback) { (void) callback; }
+  void detachInterrupt() {}
+  void standbyMode() {}
+
+  uint8_t getSeconds() { return tm().tm_sec; }
+  uint8_t getMinutes() { return tm().tm_min; }
+  uint8_t getHours() { return tm().tm_hour; }
+  uint8_t getDay() { return tm().tm_mday; }
+  uint8_t getMonth() { return tm().tm_mon + 1; }
+  uint8_t getYear() { return tm().tm_year - 100; }
+
+  void setTime(uint8_t hours, uint8_t minutes, uint8_t seconds) {
+    struct tm t = tm();
+    t.tm_hour = hours; t.tm_min = minutes; t.tm_sec = seconds;
+    setEpoch(timegm(&t));
+  }
+  void setDate(uint8_t day, uint8_t month, uint8_t year) {
+    struct tm t = tm();
+    t.tm_mday = day; t.tm_mon = month - 1; t.tm_year = year + 100;
+    setEpoch(timegm(&t));
+  }
+  void setAlarmTime(uint8_t hours, uint8_t minutes, uint8_t seconds) { (void) hours; (void) minutes; (void) seconds; }
+  void setAlarmEpoch(uint32_t ts) { (void) ts; }
+
+  uint32_t getEpoch() { return base_ + (uint32_t) ((host_time_us() - set_us_) / 1000000); }
+  uint32_t getY2kEpoch() { return getEpoch() - 946684800UL; }
+  void setEpoch(uint32_t ts) { base_ = ts; set_us_ = host_time_us(); }
+  void setY2kEpoch(uint32_t ts) { setEpoch(ts + 946684800UL); }
+  bool isConfigured() { return true; }
+
+private:
+  struct tm tm() {
+    time_t e = getEpoch();
+    struct tm t;
+    gmtime_r(&e, &t);
+    return t;
+  }
+  uint32_t base_ = 0;
+  uint64_t set_us_ = 0;
+};
+
+#endif
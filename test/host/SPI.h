@@ -0,0 +1,40 @@
+/*
+ * ======================================================================================================================
+ *  SPI.h - Host stand-in for the SPI bus, nothing is attached
+ * ======================================================================================================================
+ */
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include <Arduino.h>
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x01
+#define SPI_MODE2 0x02
+#define SPI_MODE3 0x03
+
+class SPISettings {
+public:
+  SPISettings() {}
+  SPISettings(uint32_t clock, BitOrder order, uint8_t mode) { (void) clock; (void) order; (void) mode; }
+  SPISettings(uint32_t clock, uint8_t order, uint8_t mode) { (void) clock; (void) order; (void) mode; }
+};
+
+class SPIClass {
+public:
+  void begin() {}
+  void end() {}
+  void beginTransaction(SPISettings s) { (void) s; }
+  void endTransaction() {}
+  uint8_t transfer(uint8_t data) { (void) data; return 0xff; }
+  uint16_t transfer16(uint16_t data) { (void) data; return 0xffff; }
+  void transfer(void *buf, size_t count) { memset(buf, 0xff, count); }
+  void setBitOrder(BitOrder order) { (void) order; }
+  void setDataMode(uint8_t mode) { (void) mode; }
+  void setClockDivider(uint8_t div) { (void) div; }
+  void usingInterrupt(int n) { (void) n; }
+};
+
+extern SPIClass SPI;
+
+#endif
@@ -0,0 +1,221 @@
+/*
+ * ======================================================================================================================
+ *  SdFat.cpp - Host stand-in for SdFat, backed by a directory on the host file system
+ * ======================================================================================================================
+ */
+#include <SdFat.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+
+char host_sd_root[HOST_SD_ROOT_SIZE] = "sd";
+unsigned long host_sd_reads = 0;
+unsigned long host_sd_bytes = 0;
+
+/*
+ * ======================================================================================================================
+ * host_sd_path() - Card path to host path
+ * ======================================================================================================================
+ */
+static void host_sd_path(const char *path, char *out, size_t size) {
+  if (snprintf(out, size, "%s/%s", host_sd_root, (path[0] == '/') ? path + 1 : path) >= (int) size) {
+    out[0] = 0;
+  }
+}
+
+uint32_t FsVolume::freeClusterCount() {
+  struct statvfs s;
+  if (statvfs(host_sd_root, &s) != 0) {
+    return 0;
+  }
+  return (uint32_t) (((uint64_t) s.f_bavail * s.f_frsize) / SD_CLUSTER_SIZE);
+}
+
+bool FsFile::open(const char *path, int oflag) {
+  struct stat st;
+
+  close();
+  host_sd_path(path, path_, sizeof(path_));
+  if ((stat(path_, &st) == 0) && S_ISDIR(st.st_mode)) {
+    dp_ = opendir(path_);
+    dir_ = (dp_ != nullptr);
+    return dir_;
+  }
+  append_ = (oflag & O_APPEND) != 0;
+  fd_ = ::open(path_, oflag & ~O_APPEND, 0644);
+  if ((fd_ >= 0) && append_) {
+    lseek(fd_, 0, SEEK_END);
+  }
+  return fd_ >= 0;
+}
+
+bool FsFile::openNext(FsFile *dir, int oflag) {
+  struct dirent *de;
+  char path[sizeof(path_) + 256];
+
+  close();
+  if (!dir || !dir->dir_) {
+    return false;
+  }
+  while ((de = readdir((DIR *) dir->dp_)) != nullptr) {
+    if (strcmp(de->d_name, ".") && strcmp(de->d_name, "..")) {
+      snprintf(path, sizeof(path), "%s/%s", dir->path_ + strlen(host_sd_root) + 1, de->d_name);
+      return open(path, oflag);
+    }
+  }
+  return false;
+}
+
+bool FsFile::close() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+  if (dp_) {
+    closedir((DIR *) dp_);
+  }
+  fd_ = -1;
+  dp_ = nullptr;
+  dir_ = false;
+  return true;
+}
+
+size_t FsFile::getName(char *name, size_t size) {
+  const char *p = strrchr(path_, '/');
+  snprintf(name, size, "%s", (p) ? p + 1 : path_);
+  return strlen(name);
+}
+
+int FsFile::available() {
+  uint64_t s = size(), p = position();
+  return (s > p) ? (int) min(s - p, (uint64_t) 0x7fff) : 0;
+}
+
+int FsFile::read() {
+  uint8_t c;
+  return (read(&c, 1) == 1) ? c : -1;
+}
+
+int FsFile::peek() {
+  uint64_t p = position();
+  int c = read();
+  seek(p);
+  return c;
+}
+
+int FsFile::read(void *buf, size_t count) {
+  if (fd_ < 0) {
+    return -1;
+  }
+  int n = ::read(fd_, buf, count);
+  host_sd_reads++;
+  host_sd_bytes += (n > 0) ? n : 0;
+  return n;
+}
+
+size_t FsFile::write(const uint8_t *buf, size_t size) {
+  if (fd_ < 0) {
+    return 0;
+  }
+  if (append_) {
+    lseek(fd_, 0, SEEK_END);
+  }
+  int n = ::write(fd_, buf, size);
+  return (n > 0) ? n : 0;
+}
+
+int FsFile::fgets(char *str, int num, const char *delim) {
+  int n = 0;
+  int c;
+
+  while ((n < num - 1) && ((c = read()) >= 0)) {
+    str[n++] = c;
+    if (delim ? (strchr(delim, c) != nullptr) : (c == '\n')) {
+      break;
+    }
+  }
+  str[n] = 0;
+  return n;
+}
+
+bool FsFile::seek(uint64_t pos) {
+  return (fd_ >= 0) && (lseek(fd_, pos, SEEK_SET) == (off_t) pos);
+}
+
+uint64_t FsFile::position() {
+  return (fd_ >= 0) ? lseek(fd_, 0, SEEK_CUR) : 0;
+}
+
+uint64_t FsFile::size() {
+  struct stat st;
+  return ((fd_ >= 0) && (fstat(fd_, &st) == 0)) ? st.st_size : 0;
+}
+
+bool FsFile::truncate(uint64_t length) {
+  return (fd_ >= 0) && (ftruncate(fd_, length) == 0) && seek(min(position(), length));
+}
+
+// Like the card, the length is allocated and the file size set, whatever was in the space is left there.
+// Here that is an old observation log, lines a reader can not tell from new ones.
+bool FsFile::preAllocate(uint64_t length) {
+  static const char stale[] = "{\"at\":\"2020-01-01T00:00:00\",\"stale\":1}\r\n";
+
+  if ((fd_ < 0) || (size() != 0) || (ftruncate(fd_, length) != 0)) {
+    return false;
+  }
+  for (uint64_t pos = 0; pos < length; pos += sizeof(stale) - 1) {
+    if (pwrite(fd_, stale, min((uint64_t) sizeof(stale) - 1, length - pos), pos) < 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool FsFile::sync() {
+  return fd_ >= 0;
+}
+
+bool SdFat::exists(const char *path) {
+  char p[256];
+  struct stat st;
+  host_sd_path(path, p, sizeof(p));
+  return stat(p, &st) == 0;
+}
+
+bool SdFat::mkdir(const char *path, bool pFlag) {
+  char p[256];
+  host_sd_path(path, p, sizeof(p));
+  if (pFlag) {
+    for (char *s = p + strlen(host_sd_root) + 1; (s = strchr(s, '/')) != nullptr; s++) {
+      *s = 0;
+      ::mkdir(p, 0755);
+      *s = '/';
+    }
+  }
+  return ::mkdir(p, 0755) == 0;
+}
+
+bool SdFat::remove(const char *path) {
+  char p[256];
+  host_sd_path(path, p, sizeof(p));
+  return unlink(p) == 0;
+}
+
+bool SdFat::rename(const char *from, const char *to) {
+  char f[256], t[256];
+  host_sd_path(from, f, sizeof(f));
+  host_sd_path(to, t, sizeof(t));
+  return ::rename(f, t) == 0;
+}
+
+bool SdFat::rmdir(const char *path) {
+  char p[256];
+  host_sd_path(path, p, sizeof(p));
+  return ::rmdir(p) == 0;
+}
+
+File SdFat::open(const char *path, int oflag) {
+  File f;
+  f.open(path, oflag);
+  return f;
+}
@@ -0,0 +1,103 @@
+/*
+ * ======================================================================================================================
+ *  SdFat.h - Host stand-in for SdFat, backed by a directory on the host file system
+ *
+ *  Paths are taken under host_sd_root. Sector and cluster sizes are those of a FAT32 formatted card so the
+ *  station's sector aligned reads line up the same as on the card. host_sd_reads/host_sd_bytes count the read()
+ *  calls and bytes moved so benchmarks can compare access patterns. preAllocate() leaves old log lines in the
+ *  space, as clusters reused on a card would be.
+ * ======================================================================================================================
+ */
+#ifndef HOST_SDFAT_H
+#define HOST_SDFAT_H
+
+#include <Arduino.h>
+#include <fcntl.h>
+
+#define SD_SECTOR_SIZE      512
+#define SD_CLUSTER_SIZE     32768
+
+#define FILE_READ           O_RDONLY
+#define FILE_WRITE          (O_RDWR | O_CREAT | O_APPEND)
+#ifndef O_AT_END
+#define O_AT_END            O_APPEND
+#endif
+
+#define SD_SCK_MHZ(m)       ((m) * 1000000UL)
+
+#define HOST_SD_ROOT_SIZE   256
+extern char host_sd_root[HOST_SD_ROOT_SIZE];
+extern unsigned long host_sd_reads;
+extern unsigned long host_sd_bytes;
+
+class FsVolume {
+public:
+  uint32_t freeClusterCount();
+  uint32_t bytesPerCluster() { return SD_CLUSTER_SIZE; }
+};
+
+class FsFile : public Stream {
+public:
+  FsFile() {}
+  ~FsFile() {}
+  bool open(const char *path, int oflag = O_RDONLY);
+  bool openNext(FsFile *dir, int oflag = O_RDONLY);
+  bool close();
+  bool isOpen() const { return (fd_ >= 0) || dir_; }
+  operator bool() const { return isOpen(); }
+  bool isDir() const { return dir_; }
+  size_t getName(char *name, size_t size);
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  int read(void *buf, size_t count);
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *buf, size_t size) override;
+  size_t write(const char *str) { return write((const uint8_t *) str, strlen(str)); }
+  using Print::write;
+  int fgets(char *str, int num, const char *delim = nullptr);
+
+  bool seek(uint64_t pos);
+  bool seekSet(uint64_t pos) { return seek(pos); }
+  uint64_t position();
+  uint64_t curPosition() { return position(); }
+  uint64_t size();
+  uint64_t fileSize() { return size(); }
+  bool truncate(uint64_t length);
+  bool truncate() { return truncate(position()); }
+  bool preAllocate(uint64_t length);
+  bool sync();
+  void flush() override { sync(); }
+
+private:
+  int fd_ = -1;
+  bool dir_ = false;
+  void *dp_ = nullptr;
+  char path_[256] = "";
+  bool append_ = false;
+};
+
+typedef FsFile File;
+typedef FsFile File32;
+typedef FsFile ExFile;
+
+class SdFat {
+public:
+  bool begin(uint32_t cs, uint32_t clock = SD_SCK_MHZ(50)) { (void) cs; (void) clock; return true; }
+  bool exists(const char *path);
+  bool mkdir(const char *path, bool pFlag = true);
+  bool remove(const char *path);
+  bool rename(const char *from, const char *to);
+  bool rmdir(const char *path);
+  File open(const char *path, int oflag = O_RDONLY);
+  FsVolume *vol() { return &vol_; }
+
+private:
+  FsVolume vol_;
+};
+
+typedef SdFat SdFs;
+typedef SdFat SdFat32;
+
+#endif
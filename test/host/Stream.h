@@ -0,0 +1,38 @@
+/*
+ * ======================================================================================================================
+ *  Stream.h - Host stand-in for the Arduino Stream class
+ * ======================================================================================================================
+ */
+#ifndef HOST_ARDUINO_H
+#include "Arduino.h"
+#else
+#ifndef HOST_STREAM_H
+#define HOST_STREAM_H
+
+#include "Print.h"
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long timeout) { _timeout = timeout; }
+  unsigned long getTimeout() { return _timeout; }
+  size_t readBytes(char *buffer, size_t length);
+  size_t readBytes(uint8_t *buffer, size_t length) { return readBytes((char *) buffer, length); }
+  size_t readBytesUntil(char terminator, char *buffer, size_t length);
+  size_t readBytesUntil(char terminator, uint8_t *buffer, size_t length) {
+    return readBytesUntil(terminator, (char *) buffer, length);
+  }
+  String readString();
+  String readStringUntil(char terminator);
+  long parseInt();
+  float parseFloat();
+
+protected:
+  unsigned long _timeout = 1000;
+};
+
+#endif
+#endif
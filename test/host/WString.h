@@ -0,0 +1,94 @@
+/*
+ * ======================================================================================================================
+ *  WString.h - Host stand-in for the Arduino String class
+ * ======================================================================================================================
+ */
+#ifndef HOST_ARDUINO_H
+#include "Arduino.h"
+#else
+#ifndef HOST_WSTRING_H
+#define HOST_WSTRING_H
+
+#include <string>
+
+class String {
+public:
+  String(const char *s = "") : s_((s) ? s : "") {}
+  String(const __FlashStringHelper *s) : s_((const char *) s) {}
+  String(const String &o) = default;
+  String(char c) : s_(1, c) {}
+  String(unsigned char n, unsigned char base = 10) { fromUnsigned(n, base); }
+  String(int n, unsigned char base = 10) { fromSigned(n, base); }
+  String(unsigned int n, unsigned char base = 10) { fromUnsigned(n, base); }
+  String(long n, unsigned char base = 10) { fromSigned(n, base); }
+  String(unsigned long n, unsigned char base = 10) { fromUnsigned(n, base); }
+  String(float n, unsigned char digits = 2) { fromDouble(n, digits); }
+  String(double n, unsigned char digits = 2) { fromDouble(n, digits); }
+  String &operator=(const String &o) = default;
+
+  bool reserve(unsigned int size) { s_.reserve(size); return true; }
+  unsigned int length() const { return s_.size(); }
+  const char *c_str() const { return s_.c_str(); }
+  char charAt(unsigned int i) const { return (i < s_.size()) ? s_[i] : 0; }
+  void setCharAt(unsigned int i, char c) { if (i < s_.size()) s_[i] = c; }
+  char operator[](unsigned int i) const { return charAt(i); }
+  char &operator[](unsigned int i) { return s_[i]; }
+  void toCharArray(char *buf, unsigned int size, unsigned int index = 0) const {
+    getBytes((unsigned char *) buf, size, index);
+  }
+  void getBytes(unsigned char *buf, unsigned int size, unsigned int index = 0) const;
+
+  bool concat(const String &o) { s_ += o.s_; return true; }
+  bool concat(const char *o) { s_ += (o) ? o : ""; return true; }
+  bool concat(char c) { s_ += c; return true; }
+  String &operator+=(const String &o) { s_ += o.s_; return *this; }
+  String &operator+=(const char *o) { s_ += (o) ? o : ""; return *this; }
+  String &operator+=(char c) { s_ += c; return *this; }
+  String &operator+=(int n) { return *this += String(n); }
+  String &operator+=(unsigned int n) { return *this += String(n); }
+  String &operator+=(long n) { return *this += String(n); }
+  String &operator+=(unsigned long n) { return *this += String(n); }
+  friend String operator+(const String &a, const String &b) { String r(a); r += b; return r; }
+  friend String operator+(const String &a, const char *b) { String r(a); r += b; return r; }
+  friend String operator+(const char *a, const String &b) { String r(a); r += b; return r; }
+  friend String operator+(const String &a, char b) { String r(a); r += b; return r; }
+
+  bool equals(const String &o) const { return s_ == o.s_; }
+  bool equals(const char *o) const { return s_ == ((o) ? o : ""); }
+  bool equalsIgnoreCase(const String &o) const;
+  bool operator==(const String &o) const { return equals(o); }
+  bool operator==(const char *o) const { return equals(o); }
+  bool operator!=(const String &o) const { return !equals(o); }
+  bool operator!=(const char *o) const { return !equals(o); }
+  bool startsWith(const String &o) const { return s_.compare(0, o.s_.size(), o.s_) == 0; }
+  bool endsWith(const String &o) const {
+    return (s_.size() >= o.s_.size()) && (s_.compare(s_.size() - o.s_.size(), o.s_.size(), o.s_) == 0);
+  }
+
+  int indexOf(char c, unsigned int from = 0) const { size_t i = s_.find(c, from); return (i == std::string::npos) ? -1 : (int) i; }
+  int indexOf(const String &o, unsigned int from = 0) const { size_t i = s_.find(o.s_, from); return (i == std::string::npos) ? -1 : (int) i; }
+  int lastIndexOf(char c) const { size_t i = s_.rfind(c); return (i == std::string::npos) ? -1 : (int) i; }
+  String substring(unsigned int from) const { return (from < s_.size()) ? String(s_.substr(from).c_str()) : String(); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to) { unsigned int t = from; from = to; to = t; }
+    return (from < s_.size()) ? String(s_.substr(from, to - from).c_str()) : String();
+  }
+  void replace(const String &from, const String &to);
+  void remove(unsigned int index) { if (index < s_.size()) s_.erase(index); }
+  void remove(unsigned int index, unsigned int count) { if (index < s_.size()) s_.erase(index, count); }
+  void toLowerCase() { for (auto &c : s_) c = tolower(c); }
+  void toUpperCase() { for (auto &c : s_) c = toupper(c); }
+  void trim();
+  long toInt() const { return atol(s_.c_str()); }
+  float toFloat() const { return atof(s_.c_str()); }
+  double toDouble() const { return atof(s_.c_str()); }
+
+private:
+  void fromSigned(long n, unsigned char base);
+  void fromUnsigned(unsigned long n, unsigned char base);
+  void fromDouble(double n, unsigned char digits);
+  std::string s_;
+};
+
+#endif
+#endif
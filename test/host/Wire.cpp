@@ -0,0 +1,64 @@
+/*
+ * ======================================================================================================================
+ *  Wire.cpp - Host stand-in for the SAMD TwoWire I2C master, transactions go to the I2C emulator (emu/)
+ * ======================================================================================================================
+ */
+#include <Wire.h>
+#include <SPI.h>
+#include "emu.h"
+
+TwoWire Wire;
+SPIClass SPI;
+unsigned long host_wire_begins = 0;
+
+void TwoWire::beginTransmission(uint8_t address) {
+  tx_addr_ = address;
+  tx_len_ = 0;
+  tx_active_ = true;
+}
+
+// 0 ok, 2 address NACK, 3 data NACK, 4 bus error
+uint8_t TwoWire::endTransmission(bool stopBit) {
+  tx_active_ = false;
+  return EMU_Write(clock_, tx_addr_, tx_, tx_len_, stopBit);
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, size_t quantity, bool stopBit) {
+  rx_pos_ = 0;
+  rx_len_ = EMU_Read(clock_, address, rx_, min(quantity, (size_t) WIRE_BUFFER_LENGTH), stopBit);
+  return rx_len_;
+}
+
+// Nothing buffered takes a moment, so a caller polling with a millis() timeout gets to the end of it
+int TwoWire::available() {
+  if (rx_pos_ >= rx_len_) {
+    host_advance_us(1);
+  }
+  return rx_len_ - rx_pos_;
+}
+
+size_t TwoWire::write(uint8_t data) {
+  if (!tx_active_ || (tx_len_ >= WIRE_BUFFER_LENGTH)) {
+    return 0;
+  }
+  tx_[tx_len_++] = data;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t quantity) {
+  size_t n = 0;
+  while ((n < quantity) && write(data[n])) {
+    n++;
+  }
+  return n;
+}
+
+// The SERCOM takes the lines, the bus pull ups hold them high
+void TwoWire::begin() {
+  host_wire_begins++;
+  pinMode(PIN_WIRE_SCL, INPUT_PULLUP);
+  pinMode(PIN_WIRE_SDA, INPUT_PULLUP);
+}
+
+bool host_i2c_sda_held() { return EMU_SDALow(); }
+void host_i2c_scl_clock() { EMU_SCLClock(); }
@@ -0,0 +1,52 @@
+/*
+ * ======================================================================================================================
+ *  Wire.h - Host stand-in for the SAMD TwoWire I2C master
+ * ======================================================================================================================
+ */
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <Arduino.h>
+
+#define WIRE_BUFFER_LENGTH 256
+#define BUFFER_LENGTH      WIRE_BUFFER_LENGTH
+
+class TwoWire : public Stream {
+public:
+  void begin();
+  void end() {}
+  void setClock(uint32_t clock) { clock_ = clock; }
+  uint32_t getClock() { return clock_; }
+
+  void beginTransmission(uint8_t address);
+  uint8_t endTransmission(bool stopBit = true);
+  uint8_t requestFrom(uint8_t address, size_t quantity, bool stopBit);
+  uint8_t requestFrom(uint8_t address, size_t quantity) { return requestFrom(address, quantity, true); }
+
+  size_t write(uint8_t data) override;
+  size_t write(const uint8_t *data, size_t quantity) override;
+  using Print::write;
+  size_t write(int n) { return write((uint8_t) n); }
+  size_t write(unsigned int n) { return write((uint8_t) n); }
+  size_t write(long n) { return write((uint8_t) n); }
+  size_t write(unsigned long n) { return write((uint8_t) n); }
+  int available() override;
+  int read() override { return (rx_pos_ < rx_len_) ? rx_[rx_pos_++] : -1; }
+  int peek() override { return (rx_pos_ < rx_len_) ? rx_[rx_pos_] : -1; }
+  void flush() override {}
+
+private:
+  uint32_t clock_ = 100000;
+  uint8_t tx_addr_ = 0;
+  uint8_t tx_[WIRE_BUFFER_LENGTH];
+  size_t tx_len_ = 0;
+  bool tx_active_ = false;
+  uint8_t rx_[WIRE_BUFFER_LENGTH];
+  size_t rx_len_ = 0;
+  size_t rx_pos_ = 0;
+};
+
+extern TwoWire Wire;
+extern unsigned long host_wire_begins;   // Wire.begin() calls, each takes the lines back from the pins
+
+#endif
@@ -0,0 +1,268 @@
+/*
+ * ======================================================================================================================
+ *  host.cpp - Host stand-in for the Arduino SAMD core: simulated clock, pins, serial, Print, Stream and String
+ * ======================================================================================================================
+ */
+#include <Arduino.h>
+#include <stdarg.h>
+#include <string>
+
+/*
+ * ======================================================================================================================
+ * Simulated clock
+ * ======================================================================================================================
+ */
+static uint64_t host_us = 0;
+
+void host_advance_us(uint64_t us) { host_us += us; }
+uint64_t host_time_us() { return host_us; }
+// 32 bit like the SAMD, so millis() and micros() wrap where they do on the board
+unsigned long millis() { return (uint32_t) (host_us / 1000); }
+unsigned long micros() { return (uint32_t) host_us; }
+void delay(unsigned long ms) { host_us += (uint64_t) ms * 1000; yield(); }
+void delayMicroseconds(unsigned int us) { host_us += us; }
+void __attribute__((weak)) yield() {}
+
+/*
+ * ======================================================================================================================
+ * Pins
+ * ======================================================================================================================
+ */
+static int host_pins[NUM_DIGITAL_PINS];
+static int host_modes[NUM_DIGITAL_PINS];
+static int host_analog[NUM_DIGITAL_PINS];
+
+// SCL let go or driven high after being driven low, one clock for a device holding SDA
+static void host_scl(uint32_t pin, bool was_low, bool high) {
+  if ((pin == PIN_WIRE_SCL) && was_low && high) host_i2c_scl_clock();
+}
+
+void pinMode(uint32_t pin, uint32_t mode) {
+  if (pin >= NUM_DIGITAL_PINS) return;
+  host_scl(pin, (host_modes[pin] == OUTPUT) && (host_pins[pin] == LOW), mode != OUTPUT);
+  host_modes[pin] = mode;
+  if (mode == INPUT_PULLUP) host_pins[pin] = HIGH;
+}
+void digitalWrite(uint32_t pin, uint32_t value) {
+  if (pin >= NUM_DIGITAL_PINS) return;
+  if (host_modes[pin] == OUTPUT) host_scl(pin, host_pins[pin] == LOW, value != LOW);
+  host_pins[pin] = value;
+}
+int digitalRead(uint32_t pin) {
+  if (pin >= NUM_DIGITAL_PINS) return LOW;
+  if ((pin == PIN_WIRE_SDA) && (host_modes[pin] != OUTPUT) && host_i2c_sda_held()) return LOW;
+  return host_pins[pin];
+}
+int analogRead(uint32_t pin) { return (pin < NUM_DIGITAL_PINS) ? host_analog[pin] : 0; }
+void analogWrite(uint32_t pin, int value) { (void) pin; (void) value; }
+void analogReadResolution(int bits) { (void) bits; }
+void analogWriteResolution(int bits) { (void) bits; }
+void attachInterrupt(uint32_t pin, void (*isr)(void), uint32_t mode) { (void) pin; (void) isr; (void) mode; }
+void detachInterrupt(uint32_t pin) { (void) pin; }
+void host_pin_set(uint32_t pin, int value) { if (pin < NUM_DIGITAL_PINS) host_pins[pin] = value; }
+void host_analog_set(uint32_t pin, int value) { if (pin < NUM_DIGITAL_PINS) host_analog[pin] = value; }
+
+long random(long howbig) { return (howbig > 0) ? (rand() % howbig) : 0; }
+long random(long howsmall, long howbig) { return (howbig > howsmall) ? howsmall + random(howbig - howsmall) : howsmall; }
+void randomSeed(unsigned long seed) { srand(seed); }
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+/*
+ * ======================================================================================================================
+ * Serial
+ * ======================================================================================================================
+ */
+HardwareSerial Serial;
+HardwareSerial Serial1;
+bool host_serial_echo = false;
+static std::string host_serial_in;
+
+void host_serial_input(const char *s) { host_serial_in += s; }
+int HardwareSerial::available() { return host_serial_in.size(); }
+int HardwareSerial::peek() { return host_serial_in.empty() ? -1 : (uint8_t) host_serial_in[0]; }
+int HardwareSerial::read() {
+  if (host_serial_in.empty()) return -1;
+  int c = (uint8_t) host_serial_in[0];
+  host_serial_in.erase(0, 1);
+  return c;
+}
+size_t HardwareSerial::write(uint8_t c) {
+  if (host_serial_echo) fputc(c, stdout);
+  return 1;
+}
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+  if (host_serial_echo) fwrite(buffer, 1, size, stdout);
+  return size;
+}
+
+/*
+ * ======================================================================================================================
+ * Print
+ * ======================================================================================================================
+ */
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while (size--) n += write(*buffer++);
+  return n;
+}
+
+size_t Print::printNumber(unsigned long long n, int base, bool negative) {
+  char buf[68];
+  char *p = &buf[sizeof(buf) - 1];
+
+  if (base < 2) base = 10;
+  *p = 0;
+  do {
+    int d = n % base;
+    *--p = (d < 10) ? ('0' + d) : ('A' + d - 10);
+    n /= base;
+  } while (n);
+  if (negative) *--p = '-';
+  return write(p);
+}
+
+size_t Print::print(const __FlashStringHelper *s) { return write((const char *) s); }
+size_t Print::print(const String &s) { return write(s.c_str(), s.length()); }
+size_t Print::print(const char s[]) { return write(s); }
+size_t Print::print(char c) { return write((uint8_t) c); }
+size_t Print::print(unsigned char n, int base) { return printNumber(n, base, false); }
+size_t Print::print(int n, int base) { return print((long long) n, base); }
+size_t Print::print(unsigned int n, int base) { return printNumber(n, base, false); }
+size_t Print::print(long n, int base) { return print((long long) n, base); }
+size_t Print::print(unsigned long n, int base) { return printNumber(n, base, false); }
+size_t Print::print(long long n, int base) {
+  if ((base == 10) && (n < 0)) return printNumber(-(unsigned long long) n, 10, true);
+  return printNumber((unsigned long long) n, base, false);
+}
+size_t Print::print(unsigned long long n, int base) { return printNumber(n, base, false); }
+size_t Print::print(double n, int digits) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", digits, n);
+  return write(buf);
+}
+size_t Print::print(const Printable &p) { return p.printTo(*this); }
+
+size_t Print::println() { return write("\r\n"); }
+size_t Print::println(const __FlashStringHelper *s) { return print(s) + println(); }
+size_t Print::println(const String &s) { return print(s) + println(); }
+size_t Print::println(const char s[]) { return print(s) + println(); }
+size_t Print::println(char c) { return print(c) + println(); }
+size_t Print::println(unsigned char n, int base) { return print(n, base) + println(); }
+size_t Print::println(int n, int base) { return print(n, base) + println(); }
+size_t Print::println(unsigned int n, int base) { return print(n, base) + println(); }
+size_t Print::println(long n, int base) { return print(n, base) + println(); }
+size_t Print::println(unsigned long n, int base) { return print(n, base) + println(); }
+size_t Print::println(long long n, int base) { return print(n, base) + println(); }
+size_t Print::println(unsigned long long n, int base) { return print(n, base) + println(); }
+size_t Print::println(double n, int digits) { return print(n, digits) + println(); }
+size_t Print::println(const Printable &p) { return print(p) + println(); }
+
+size_t Print::printf(const char *format, ...) {
+  char buf[512];
+  va_list ap;
+  va_start(ap, format);
+  vsnprintf(buf, sizeof(buf), format, ap);
+  va_end(ap);
+  return write(buf);
+}
+
+/*
+ * ======================================================================================================================
+ * Stream
+ * ======================================================================================================================
+ */
+size_t Stream::readBytes(char *buffer, size_t length) {
+  size_t n = 0;
+  int c;
+  while ((n < length) && ((c = read()) >= 0)) buffer[n++] = c;
+  return n;
+}
+
+size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length) {
+  size_t n = 0;
+  int c;
+  while ((n < length) && ((c = read()) >= 0) && (c != terminator)) buffer[n++] = c;
+  return n;
+}
+
+String Stream::readString() {
+  String s;
+  int c;
+  while ((c = read()) >= 0) s += (char) c;
+  return s;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String s;
+  int c;
+  while (((c = read()) >= 0) && (c != terminator)) s += (char) c;
+  return s;
+}
+
+long Stream::parseInt() { return readString().toInt(); }
+float Stream::parseFloat() { return readString().toFloat(); }
+
+/*
+ * ======================================================================================================================
+ * String
+ * ======================================================================================================================
+ */
+void String::getBytes(unsigned char *buf, unsigned int size, unsigned int index) const {
+  if (!size || !buf) return;
+  unsigned int n = 0;
+  while ((n < size - 1) && ((index + n) < s_.size())) {
+    buf[n] = s_[index + n];
+    n++;
+  }
+  buf[n] = 0;
+}
+
+bool String::equalsIgnoreCase(const String &o) const {
+  return (s_.size() == o.s_.size()) && (strcasecmp(s_.c_str(), o.s_.c_str()) == 0);
+}
+
+void String::replace(const String &from, const String &to) {
+  if (from.s_.empty()) return;
+  size_t i = 0;
+  while ((i = s_.find(from.s_, i)) != std::string::npos) {
+    s_.replace(i, from.s_.size(), to.s_);
+    i += to.s_.size();
+  }
+}
+
+void String::trim() {
+  size_t a = s_.find_first_not_of(" \t\r\n");
+  size_t b = s_.find_last_not_of(" \t\r\n");
+  s_ = (a == std::string::npos) ? "" : s_.substr(a, b - a + 1);
+}
+
+void String::fromSigned(long n, unsigned char base) {
+  if ((base == 10) && (n < 0)) {
+    fromUnsigned(-(unsigned long) n, 10);
+    s_.insert(0, 1, '-');
+  }
+  else {
+    fromUnsigned((unsigned long) n, base);
+  }
+}
+
+void String::fromUnsigned(unsigned long n, unsigned char base) {
+  char buf[68];
+  char *p = &buf[sizeof(buf) - 1];
+  if (base < 2) base = 10;
+  *p = 0;
+  do {
+    int d = n % base;
+    *--p = (d < 10) ? ('0' + d) : ('a' + d - 10);
+    n /= base;
+  } while (n);
+  s_ = p;
+}
+
+void String::fromDouble(double n, unsigned char digits) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", digits, n);
+  s_ = buf;
+}
@@ -0,0 +1,16 @@
+/*
+ * ======================================================================================================================
+ *  wiring_private.h - Host stand-in, there is no pin multiplexer
+ * ======================================================================================================================
+ */
+#ifndef HOST_WIRING_PRIVATE_H
+#define HOST_WIRING_PRIVATE_H
+
+#include <Arduino.h>
+
+enum EPioType { PIO_NOT_A_PIN = -1, PIO_EXTINT, PIO_ANALOG, PIO_SERCOM, PIO_SERCOM_ALT, PIO_TIMER, PIO_TIMER_ALT,
+                PIO_COM, PIO_AC_CLK, PIO_DIGITAL, PIO_INPUT, PIO_INPUT_PULLUP, PIO_OUTPUT };
+
+static inline int pinPeripheral(uint32_t pin, EPioType type) { (void) pin; (void) type; return 0; }
+
+#endif
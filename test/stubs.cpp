@@ -0,0 +1,176 @@
+/*
+ * ======================================================================================================================
+ *  stubs.cpp - Weak stand-ins for the station modules a host test does not link
+ *
+ *  A test links the firmware modules it exercises, their definitions replace these. The rest of the station
+ *  is reduced to quiet defaults: output goes to stdout when host_serial_echo is set, config is the CONFIG.TXT
+ *  default.
+ * ======================================================================================================================
+ */
+#include <Arduino.h>
+#include "include/qc.h"
+#include "include/cf.h"
+#include "include/sdcard.h"
+#include "include/output.h"
+#include "include/sensors.h"
+#include "include/main.h"
+#include "include/adc.h"
+#include "include/eeprom.h"
+#include "include/time.h"
+#include "include/i2c.h"
+#include "include/ssbits.h"
+#include "include/obs.h"
+#include "include/support.h"
+#include "include/i2cq.h"
+#include "include/network.h"
+
+#define WEAK __attribute__((weak))
+
+// .ino
+WEAK char msgbuf[MAX_MSGBUF_SIZE];
+WEAK char *msgp;
+WEAK char Buffer32Bytes[32];
+WEAK void BackGroundWork() {}
+WEAK unsigned long Time_of_next_obs = 0;
+WEAK unsigned long time_to_next_obs() { return 60000; }
+
+// cf.cpp
+WEAK int cf_nowind = 0;
+WEAK int cf_wind_products = 0;
+WEAK int cf_ws_period = 0;
+WEAK int cf_wd_oversample = 1;
+WEAK int cf_rg1_enable = 0;
+WEAK int cf_op1 = 0;
+WEAK int cf_op2 = 0;
+WEAK int cf_ds_outlier = 0;
+WEAK int cf_elevation = 0;
+WEAK int cf_rtro_hour = 0;
+WEAK int cf_rtro_minute = 0;
+WEAK int cf_obs_period = 1;
+WEAK int cf_n2s_pct = 10;
+WEAK int cf_log_sync = 5;
+WEAK char *cf_webserver = NULL;
+WEAK int cf_webserver_port = 80;
+WEAK char *cf_urlpath = NULL;
+WEAK char *cf_apikey = NULL;
+
+// output.cpp
+WEAK bool SerialConsoleEnabled = false;
+WEAK void OLED_spin() {}
+WEAK void Output(const char *str) {
+  if (host_serial_echo) {
+    printf("%s\n", str);
+  }
+}
+WEAK void Output(const __FlashStringHelper *str) { Output((const char *) str); }
+WEAK void Serial_writeln(const char *str) { Output(str); }
+
+// sdcard.cpp
+WEAK SdFat SD;
+WEAK bool SD_exists = false;
+WEAK char SD_OPTAQS_FILE[] = "OPTAQS.TXT";
+
+// sensors.cpp
+WEAK PM25AQI_OBS_STR pm25aqi_obs;
+WEAK bool PM25AQI_exists = false;
+WEAK bool AQS_Enabled = false;
+WEAK AQS_STATE aqs_state = AQS_OFF;
+WEAK unsigned long aqs_time = 0;
+
+// adc.cpp
+WEAK float ADC_PinAvg(int pin) { return analogRead(pin); }
+WEAK int ADC_PinLatest(int pin) { return analogRead(pin); }
+
+// eeprom.cpp
+WEAK EEPROM_NVM eeprom;
+WEAK bool eeprom_exists = false;
+WEAK void EEPROM_ClearRainTotals(uint32_t current_time) { (void) current_time; }
+WEAK unsigned long EEPROM_ChecksumCompute() { return 0; }
+WEAK void EEPROM_ChecksumUpdate() {}
+WEAK void EEPROM_Save() {}
+WEAK void EEPROM_Update() {}
+WEAK void EEPROM_Dump() {}
+
+// network.cpp, every send goes through
+WEAK bool Send_http(char *msg, char *webserver, int webserver_port, char *webserver_path, int webserver_method,
+    char *webserver_xapikey) {
+  return true;
+}
+
+// time.cpp
+WEAK uint32_t rtc_unixtime() { return 1760832000 + millis() / 1000; }
+
+// i2c.cpp
+WEAK void I2C_Clock(uint8_t addr) {}
+WEAK uint8_t I2C_Write(uint8_t addr, const uint8_t *buf, int len, bool stop) {
+  Wire.beginTransmission(addr);
+  Wire.write(buf, len);
+  return Wire.endTransmission(stop);
+}
+WEAK int I2C_Read(uint8_t addr, uint8_t *buf, int len) {
+  int n = Wire.requestFrom(addr, (size_t) len);
+  for (int i = 0; i < n; i++) {
+    buf[i] = Wire.read();
+  }
+  return n;
+}
+
+// i2cq.cpp, a transaction runs when submitted
+WEAK uint8_t I2CQ_Transfer(uint8_t addr, const uint8_t *pre, size_t pre_len, const uint8_t *tx, size_t tx_len,
+    uint8_t *rx, size_t rx_len) {
+  uint8_t buf[I2CQ_MAX_LEN];
+  uint8_t status = I2C_OK;
+
+  if (pre_len + tx_len) {
+    memcpy(buf, pre, pre_len);
+    memcpy(buf + pre_len, tx, tx_len);
+    status = I2C_Write(addr, buf, pre_len + tx_len);
+  }
+  if ((status == I2C_OK) && rx_len && (I2C_Read(addr, rx, rx_len) != (int) rx_len)) {
+    status = I2C_ERROR;
+  }
+  return status;
+}
+WEAK bool I2CQ_Submit(I2CQ_XFER_STR *x) {
+  x->status = I2CQ_Transfer(x->addr, x->pre, x->pre_len, x->tx, x->tx_len, x->rx, x->rx_len);
+  if (x->done) {
+    x->done(x);
+  }
+  return true;
+}
+WEAK uint8_t I2CQ_Wait(I2CQ_XFER_STR *x) { return x->status; }
+WEAK void I2CQ_Idle() {}
+
+// obs.cpp
+WEAK OBSERVATION_STR obs;
+WEAK char obsbuf[MAX_OBS_SIZE];
+WEAK float bmx_1_pressure = 0.0;
+
+// support.cpp
+WEAK bool I2C_Device_Exist(byte address) {
+  I2C_Clock(address);
+  Wire.beginTransmission(address);
+  return (Wire.endTransmission() == 0);
+}
+
+// The CRC-16 the N2S spool records are framed with
+WEAK uint16_t crc16_ccitt(uint16_t crc, const uint8_t *data, size_t len) {
+  while (len--) {
+    crc ^= (uint16_t)(*data++) << 8;
+    for (int i=0; i<8; i++) {
+      crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+    }
+  }
+  return (crc);
+}
+
+// ssbits.cpp
+WEAK unsigned long SystemStatusBits = 0;
+
+// time.cpp
+WEAK RTCZero stc;
+WEAK bool STC_valid = false;
+
+// cf.cpp, wind burst
+WEAK int cf_wb_rate = 0;
+WEAK int cf_wb_interval = 60;
@@ -0,0 +1,28 @@
+/*
+ * ======================================================================================================================
+ *  test.h - Checks for the host tests
+ *
+ *  CHECK() counts and reports a failure without stopping, TEST_END() returns the exit code for ctest.
+ * ======================================================================================================================
+ */
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+
+static int test_checks = 0;
+static int test_failures = 0;
+
+#define CHECK(cond, ...) do {                                          \
+    test_checks++;                                                     \
+    if (!(cond)) {                                                     \
+      test_failures++;                                                 \
+      printf("FAIL %s:%d: %s: ", __FILE__, __LINE__, #cond);          \
+      printf(__VA_ARGS__);                                             \
+      printf("\n");                                                    \
+    }                                                                  \
+  } while (0)
+
+#define TEST_END() (printf("%d checks, %d failures\n", test_checks, test_failures), (test_failures) ? 1 : 0)
+
+#endif
@@ -0,0 +1,129 @@
+/*
+ * ======================================================================================================================
+ *  test_burst.cpp - High rate wind burst sampling from the main loop waits
+ *
+ *  A 10 Hz burst at a steady 13 m/s, 90 degree wind. The main loop is BackGroundWork() reduced to
+ *  WB_Service() and the wait out to the next second. Anemometer pulses arrive from yield(), which the host
+ *  delay() calls every step.
+ *    - Every slot is sampled and the first sample already has the right speed
+ *    - The burst file is under the year, /WB/YYYY/MMDDHHMM.WB
+ *    - delay() on its own takes no samples, only WB_Delay() does
+ * ======================================================================================================================
+ */
+#include <Arduino.h>
+#include <sys/stat.h>
+#include "include/qc.h"
+#include "include/i2c.h"
+#include "include/cf.h"
+#include "include/sdcard.h"
+#include "include/time.h"
+#include "include/wrda.h"
+#include "include/burst.h"
+#include "test.h"
+
+#define PULSE_US    50000                  // 10 revolutions a second
+#define WIND_SPEED  ((3.14156f * ws_radius) * 1000000.0f / PULSE_US * ws_calibration)
+#define START_EPOCH 1792411200UL           // 2026-10-19 12:00:00
+
+static uint64_t next_pulse_us = 0;
+
+/*
+ * ======================================================================================================================
+ * yield() - Host delay() calls this each step, fire the anemometer pulses that are due
+ * ======================================================================================================================
+ */
+void yield() {
+  while (host_time_us() >= next_pulse_us) {
+    anemometer_interrupt_handler();
+    next_pulse_us += PULSE_US;
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * I2C_Write(), I2C_Read() - AS5600 at AS5600_ADR reading a quarter turn
+ * ======================================================================================================================
+ */
+uint8_t I2C_Write(uint8_t addr, const uint8_t *buf, int len, bool stop) {
+  (void) buf; (void) len; (void) stop;
+  return (addr == AS5600_ADR) ? I2C_OK : 2;
+}
+
+int I2C_Read(uint8_t addr, uint8_t *buf, int len) {
+  if ((addr != AS5600_ADR) || (len != 2)) {
+    return (0);
+  }
+  buf[0] = 1024 >> 8;
+  buf[1] = 1024 & 0xff;
+  return (2);
+}
+
+static void main_loop_second() {
+  unsigned long OneSecondFromNow = millis() + 1000;
+
+  WB_Service();
+  delay(20);                               // The rest of BackGroundWork(), no sampling
+  unsigned long TimeRemaining = (OneSecondFromNow - millis());
+  if ((TimeRemaining > 0) && (TimeRemaining < 1000)) {
+    WB_Delay(TimeRemaining);
+  }
+}
+
+int main() {
+  struct stat st;
+  File fp;
+  WB_HEADER_STR h;
+  WB_SAMPLE_STR s;
+  int samples = 0, first_speed = -1;
+
+  snprintf(host_sd_root, sizeof(host_sd_root), "sd_burst");
+  if (system("rm -rf sd_burst && mkdir sd_burst") != 0) {
+    return (1);
+  }
+  SD_exists = true;
+  STC_valid = true;
+  cf_wb_rate = 10;
+  cf_wb_interval = 10;
+
+  // Wind blowing before the burst starts
+  host_advance_us(5000000);
+  next_pulse_us = host_time_us();
+  delay(3000);
+  stc.setEpoch(START_EPOCH);
+
+  // delay() alone is not a sampling point
+  main_loop_second();
+  CHECK(wb.active, "burst not started");
+  uint16_t head = wb.head;
+  delay(500);
+  CHECK(wb.head == head, "%u samples taken in delay()", wb.head - head);
+
+  while (wb.active) {
+    main_loop_second();
+  }
+
+  CHECK(stat("sd_burst/WB/2026/10191200.WB", &st) == 0, "no /WB/2026/10191200.WB");
+  CHECK(wb.lost == 0, "%u samples lost", wb.lost);
+  // Slots in the 500ms of plain delay() were skipped, every other slot is sampled
+  CHECK(wb.n >= wb.slots - 6, "%u of %u slots sampled", wb.n, wb.slots);
+
+  fp = SD.open("/WB/2026/10191200.WB", FILE_READ);
+  CHECK(fp.read(&h, sizeof(h)) == sizeof(h), "no header");
+  CHECK(!memcmp(h.magic, "WB01", 4) && (h.start == START_EPOCH) && (h.rate == 10), "bad header");
+  while (fp.read(&s, sizeof(s)) == sizeof(s)) {
+    if (first_speed == -1) {
+      first_speed = s.speed;
+    }
+    CHECK(abs((int) s.speed - (int) (WIND_SPEED * 100.0f + 0.5f)) <= 1, "slot %u speed %u cm/s", s.slot, s.speed);
+    CHECK(s.angle == 1024, "slot %u angle %u", s.slot, s.angle);
+    samples++;
+  }
+  fp.close();
+  CHECK(samples == wb.n, "%d samples in the file, %u taken", samples, wb.n);
+
+  CHECK(fabs(wb_result.ws - WIND_SPEED) < 0.01, "mean %.2f m/s", wb_result.ws);
+  CHECK(wb_result.wd == 90, "direction %d", wb_result.wd);
+  printf("burst %u samples, first %.2f m/s, mean %.2f m/s, expected %.2f m/s\n", wb.n, first_speed / 100.0,
+         wb_result.ws, WIND_SPEED);
+  return TEST_END();
+}
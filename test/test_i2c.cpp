@@ -0,0 +1,450 @@
+/*
+ * ======================================================================================================================
+ *  test_i2c.cpp - Station I2C code against the bus emulator (emu/)
+ *
+ *  The firmware modules and the vendored drivers run unchanged, the host Wire sends their transactions to
+ *  register level models of the parts, so detection, conversion waits, bus time and fault handling are what
+ *  they would be on the board.
+ *    - Detection of every part through the station's initialize functions
+ *    - Readings through the drivers and TH_Trigger()/TH_Collect() match the values set on the models
+ *    - Bus time of a transaction at 400 kHz
+ *    - Faults: data NACK, corrupted CRC, SDA held low freed by I2C_Service(), SDA stuck, a power glitch
+ *      that needs sensor_reinitialize(), a marginal part demoted to 100 kHz
+ *    - A part behind a PCA9548 channel, limited to 100 kHz while the channel is on
+ *    - DS2482-800 with external and parasite powered DS18B20s
+ *    - EEPROM page writes of only the changed bytes, FRAM
+ *    - OLED spinner sends one cell, not the whole display
+ * ======================================================================================================================
+ */
+#include <Arduino.h>
+#include "include/qc.h"
+#include "include/i2c.h"
+#include "include/i2cq.h"
+#include "include/sensors.h"
+#include "include/sensors_i2c_44_47.h"
+#include "include/baro.h"
+#include "include/th.h"
+#include "include/lux.h"
+#include "include/mux.h"
+#include "include/dsmux.h"
+#include "include/eeprom.h"
+#include "include/output.h"
+#include "include/wrda.h"
+#include "include/time.h"
+#include <Adafruit_SSD1306.h>
+#include "emu.h"
+#include "test.h"
+
+#define T_TOL   0.05                   // C
+#define RH_TOL  0.1                    // %
+#define P_TOL   0.05                   // hPa
+
+// Not in the module headers
+void dsmux_readTemperatures(float *t);
+bool EEPROM_Valid();
+extern Adafruit_SSD1306 display32;
+extern bool i2c_pending;
+
+// The station, 0x44-0x47 hold an SHT31, an HDC3022 and a BMP581
+static EmuBMP3 bmp390(0x77, true);
+static EmuBMx280 bme280(0x76, true);
+static EmuSHT3x sht31(0x44);
+static EmuHDC302x hdc(0x45);
+static EmuBMP5 bmp581(0x47);
+static EmuHTU21DF htu21;
+static EmuHIH8 hih8;
+static EmuMCP9808 mcp9808(0x18);
+static EmuLPS35HW lps(0x5D);
+static EmuVEML7700 veml7700;
+static EmuAS5600 as5600;
+static EmuDS2482 ds2482;
+static EmuDS18B20 probe0(0x0000041836A2ULL);
+static EmuDS18B20 probe4(0x0000043689641ULL);
+static EmuDS18B20 probe7(0x00000436D086ULL, true);
+static EmuEEPROM *eeprom24 = EmuEEPROM::EEPROM24LC32();
+static EmuSSD1306 oled(0x3C, 32);
+
+/*
+ * ======================================================================================================================
+ * station_attach() - Put the station's parts on the bus
+ * ======================================================================================================================
+ */
+static void station_attach() {
+  EmuDevice *devs[] = {&bmp390, &bme280, &sht31, &hdc, &bmp581, &htu21, &hih8, &mcp9808, &lps, &veml7700,
+                       &as5600, &ds2482, eeprom24, &oled};
+
+  EMU_Clear();
+  for (EmuDevice *d : devs) {
+    EMU_Attach(d);
+  }
+  for (auto &channel : ds2482.probes) {
+    channel.clear();
+  }
+  ds2482.attach(0, &probe0);
+  ds2482.attach(4, &probe4);
+  ds2482.attach(7, &probe7);
+}
+
+/*
+ * ======================================================================================================================
+ * test_detect() - The initialize functions find every part
+ * ======================================================================================================================
+ */
+static void test_detect() {
+  station_attach();
+  I2C_Begin();
+
+  OLED_initialize();
+  bmx_initialize();
+  htu21d_initialize();
+  mcp9808_initialize();
+  hih8_initialize();
+  lux_initialize();
+  lps_initialize();
+  sensor_initialize_i2c_44_47();
+  as5600_initialize();
+  dsmux_initialize();
+  EEPROM_initialize();
+
+  CHECK(oled_type == OLED32_I2C_ADDRESS, "oled %02X", oled_type);
+  CHECK(oled.on, "OLED not on");
+  CHECK(BMX_1_exists && (BMX_1_type == BMX_TYPE_BMP390), "BMX1 type %d", BMX_1_type);
+  CHECK(BMX_2_exists && (BMX_2_type == BMX_TYPE_BME280), "BMX2 type %d", BMX_2_type);
+  CHECK(HTU21DF_exists, "HTU21DF");
+  CHECK(MCP_1_exists && !MCP_2_exists, "MCP9808");
+  CHECK(HIH8_exists, "HIH8");
+  CHECK(VEML7700_exists, "VEML7700");
+  CHECK(LPS_1_exists && !LPS_2_exists, "LPS35HW");
+  CHECK(i2c_44_47_sensors[0].type == SENSOR_SHT31, "0x44 type %d", i2c_44_47_sensors[0].type);
+  CHECK(i2c_44_47_sensors[1].type == SENSOR_HDC302X, "0x45 type %d", i2c_44_47_sensors[1].type);
+  CHECK(i2c_44_47_sensors[2].type == SENSOR_UNKNOWN, "0x46 type %d", i2c_44_47_sensors[2].type);
+  CHECK(i2c_44_47_sensors[3].type == SENSOR_BMP581, "0x47 type %d", i2c_44_47_sensors[3].type);
+  CHECK(strcmp(i2c_44_47_sensors[0].sn, "A1B2C3D") == 0, "SHT31 serial %s", i2c_44_47_sensors[0].sn);
+  CHECK(AS5600_exists, "AS5600");
+  CHECK(DSMUX_exists, "DS2482");
+  CHECK(dsmux_sensor_exists[0] && dsmux_sensor_exists[4] && dsmux_sensor_exists[7], "DS18B20 0 4 7");
+  CHECK(!dsmux_sensor_exists[1] && !dsmux_sensor_exists[2], "DS18B20 on empty channels");
+  CHECK(!dsmux_sensor_parasite[0] && dsmux_sensor_parasite[7], "parasite %d %d", dsmux_sensor_parasite[0],
+    dsmux_sensor_parasite[7]);
+  CHECK(eeprom_exists, "EEPROM");
+
+  // The SHT45 answers neither the SHT3x nor the HDC302x probe
+  EmuSHT4x sht45(0x44);
+  EMU_Detach(&sht31);
+  EMU_Attach(&sht45);
+  delay(2);                          // Power up
+  sensor_i2c_44_47_begin(0x44);
+  CHECK(i2c_44_47_sensors[0].type == SENSOR_SHT45, "SHT45 type %d", i2c_44_47_sensors[0].type);
+  CHECK(strcmp(i2c_44_47_sensors[0].sn, "11223344") == 0, "SHT45 serial %s", i2c_44_47_sensors[0].sn);
+  EMU_Detach(&sht45);
+  EMU_Attach(&sht31);
+  sensor_i2c_44_47_begin(0x44);
+  CHECK(i2c_44_47_sensors[0].type == SENSOR_SHT31, "SHT31 back type %d", i2c_44_47_sensors[0].type);
+}
+
+/*
+ * ======================================================================================================================
+ * test_readings() - Values set on the models come back through the drivers
+ * ======================================================================================================================
+ */
+static void test_readings() {
+  float p, t, h;
+  BARO_STR bmp5 = {BARO_BMP5XX, &i2c_44_47_sensors[3].bmp5};
+
+  bmp390.t = 21.5;   bmp390.p = 1002.4;
+  bme280.t = 18.25;  bme280.p = 987.6;  bme280.rh = 63.0;
+  bmp581.t = 24.0;   bmp581.p = 1011.1;
+  lps.t = 19.75;     lps.p = 1020.3;
+  sht31.t = 22.3;    sht31.rh = 41.0;
+  hdc.t = -5.5;      hdc.rh = 88.0;
+  htu21.t = 30.1;    htu21.rh = 20.5;
+  hih8.t = 12.0;     hih8.rh = 70.0;
+  mcp9808.t = 25.3;
+  as5600.deg = 123.0;
+
+  // Continuous mode barometers, wait for a conversion with the new values at their rates
+  delay(2000);
+
+  bmx1_read(p, t, h);
+  CHECK(fabs(p - bmp390.p) < P_TOL && fabs(t - bmp390.t) < T_TOL, "BMP390 %.2f %.2f", p, t);
+  bmx2_read(p, t, h);
+  CHECK(fabs(p - bme280.p) < P_TOL && fabs(t - bme280.t) < T_TOL && fabs(h - bme280.rh) < RH_TOL,
+    "BME280 %.2f %.2f %.2f", p, t, h);
+  CHECK(BARO_Read(&bmp5, p, t, h) && fabs(p - bmp581.p) < P_TOL && fabs(t - bmp581.t) < T_TOL,
+    "BMP581 %.2f %.2f", p, t);
+  CHECK(BARO_Read(&lps1_baro, p, t, h) && fabs(p - lps.p) < P_TOL && fabs(t - lps.t) < T_TOL,
+    "LPS35HW %.2f %.2f", p, t);
+
+  t = mcp1.readTempC();
+  CHECK(fabs(t - 25.25) < 0.001, "MCP9808 %.4f", t);       // 0.0625 steps
+
+  TH_Trigger();
+  TH_Collect();
+  CHECK(th_result[0].ok && fabs(th_result[0].t - sht31.t) < T_TOL && fabs(th_result[0].h - sht31.rh) < RH_TOL,
+    "SHT31 %d %.2f %.2f", th_result[0].ok, th_result[0].t, th_result[0].h);
+  CHECK(th_result[1].ok && fabs(th_result[1].t - hdc.t) < T_TOL && fabs(th_result[1].h - hdc.rh) < RH_TOL,
+    "HDC302x %d %.2f %.2f", th_result[1].ok, th_result[1].t, th_result[1].h);
+  CHECK(!th_result[3].triggered, "BMP581 slot triggered");
+  CHECK(th_result[TH_HTU21DF].ok && fabs(th_result[TH_HTU21DF].t - htu21.t) < T_TOL &&
+    fabs(th_result[TH_HTU21DF].h - htu21.rh) < RH_TOL, "HTU21DF %d %.2f %.2f", th_result[TH_HTU21DF].ok,
+    th_result[TH_HTU21DF].t, th_result[TH_HTU21DF].h);
+  CHECK(th_result[TH_HIH8].ok && fabs(th_result[TH_HIH8].t - hih8.t) < 0.05 && fabs(th_result[TH_HIH8].h - hih8.rh) < 0.2,
+    "HIH8 %d %.2f %.2f", th_result[TH_HIH8].ok, th_result[TH_HIH8].t, th_result[TH_HIH8].h);
+
+  // Lux, the service steps the gain down from the start step at bright light
+  veml7700.lux = 20000;
+  for (int s = 0; s < 10; s++) {
+    delay(1000);
+    LUX_Service();
+  }
+  CHECK(lux_service.vlx_ok && (fabs(LUX_VEML() - veml7700.lux) / veml7700.lux < 0.01), "VEML7700 %.1f step %d",
+    LUX_VEML(), lux_service.step);
+
+  CHECK(Wind_ReadAngle() == (int) lround(123.0 / 360.0 * 4096), "AS5600 %d", Wind_ReadAngle());
+}
+
+/*
+ * ======================================================================================================================
+ * test_timing() - Queued pointer write and 2 byte read at 400 kHz: START, address, 1 byte, repeated START,
+ *                 address, 2 bytes, STOP. 48 clocks, 120 us
+ * ======================================================================================================================
+ */
+static void test_timing() {
+  uint32_t start;
+  EMU_STATS_STR s;
+
+  Wind_ReadAngle();                  // Clock already set for the address
+  EMU_StatsClear();
+  start = micros();
+  Wind_ReadAngle();
+  CHECK(micros() - start == 120, "AS5600 read %lu us", micros() - start);
+  s = EMU_Stats(AS5600_ADR);
+  CHECK((s.tx == 2) && (s.bytes == 3) && (s.us == 120), "AS5600 stats %lu %lu %llu", s.tx, s.bytes,
+    (unsigned long long) s.us);
+}
+
+/*
+ * ======================================================================================================================
+ * i2c_find() - The firmware's counters for an address
+ * ======================================================================================================================
+ */
+static I2C_STATS_STR *i2c_find(uint8_t addr) {
+  for (int i = 0; i < i2c_stats_count; i++) {
+    if (i2c_stats[i].addr == addr) {
+      return (&i2c_stats[i]);
+    }
+  }
+  return (NULL);
+}
+
+/*
+ * ======================================================================================================================
+ * test_faults() - Scripted faults and the firmware's handling of them
+ * ======================================================================================================================
+ */
+static void test_faults() {
+  I2C_STATS_STR *s = i2c_find(0x44);
+  unsigned long nack = s->nack;
+  unsigned int recoveries = i2c_recoveries;
+  unsigned long begins;
+  float p, t, h;
+
+  // The measurement command is not acknowledged, the SHT31 is not read
+  EMU_Fault(0x44, EMU_NACK_DATA, 1);
+  TH_Trigger();
+  TH_Collect();
+  CHECK(!th_result[0].triggered && !th_result[0].ok, "SHT31 read after a NACK");
+  CHECK(s->nack == nack + 1, "SHT31 nack %lu", s->nack);
+  CHECK(th_result[1].ok, "HDC302x after the SHT31 NACK");
+
+  // A bit error in the humidity word fails its CRC, the trigger goes through
+  EMU_Fault(0x44, EMU_CORRUPT, 4, 1, 1);
+  TH_Trigger();
+  TH_Collect();
+  CHECK(th_result[0].triggered && !th_result[0].ok, "SHT31 accepted a bad CRC");
+
+  // The SHT31 keeps failing with SDA high, I2C_Service() leaves Wire running and the bus alone
+  EMU_Fault(0x44, EMU_NACK_ADDR, 0, I2C_FAIL_LIMIT);
+  begins = host_wire_begins;
+  for (int i = 0; i < I2C_FAIL_LIMIT; i++) {
+    TH_Trigger();
+    TH_Collect();
+  }
+  CHECK(i2c_pending, "SHT31 failures not pending");
+  I2C_Service();
+  CHECK((host_wire_begins == begins) && (i2c_recoveries == recoveries) && !s->pending,
+    "SDA high, Wire restarted %lu recoveries %u", host_wire_begins - begins, i2c_recoveries - recoveries);
+
+  // SDA held low until 5 clocks: every address fails, I2C_Service() frees the bus and the BMP390 that glitched
+  // with it gets its normal mode back
+  EMU_Fault(0x77, EMU_RESET);
+  EMU_Fault(0x77, EMU_HOLD_SDA, 5);
+  for (int i = 0; i < I2C_FAIL_LIMIT; i++) {
+    bmx1_read(p, t, h);
+  }
+  CHECK(p == (float) QC_ERR_P, "BMP390 read with SDA held %.2f", p);
+  CHECK(I2C_SDALow(), "SDA not held");
+  I2C_Service();
+  CHECK(i2c_recoveries == recoveries + 1, "recoveries %u", i2c_recoveries);
+  CHECK(!I2C_SDALow(), "SDA still held");
+  bmp390.p = 995.0;
+  delay(2000);
+  bmx1_read(p, t, h);
+  CHECK(fabs(p - bmp390.p) < P_TOL, "BMP390 after reinitialize %.2f", p);
+
+  // Held for good, recovery reports it and gives up
+  EMU_Fault(0x76, EMU_HOLD_SDA, 0);
+  for (int i = 0; i < I2C_FAIL_LIMIT; i++) {
+    bmx2_read(p, t, h);
+  }
+  CHECK(!I2C_Recover(), "stuck SDA recovered");
+  station_attach();                  // Power cycle the bus
+  I2C_Recover();
+
+  // A part that cannot keep up at 400 kHz is dropped to 100 kHz after I2C_DEMOTE_LIMIT errors
+  s = i2c_find(0x18);
+  mcp9808.max_hz = I2C_CLOCK_STANDARD;
+  for (int i = 0; i < I2C_DEMOTE_LIMIT; i++) {
+    mcp1.readTempC();
+  }
+  CHECK(s->clock == I2C_CLOCK_STANDARD, "MCP9808 clock %lu", (unsigned long) s->clock);
+  t = mcp1.readTempC();
+  CHECK(fabs(t - 25.25) < 0.001, "MCP9808 at 100 kHz %.4f", t);
+  mcp9808.max_hz = 1000000;
+}
+
+/*
+ * ======================================================================================================================
+ * test_mux() - An MCP9808 on a long cable behind a PCA9548 channel
+ * ======================================================================================================================
+ */
+static void test_mux() {
+  EmuPCA9548 pca;
+  EmuMCP9808 remote(MCP_ADDRESS_3);
+  EMU_STATS_STR s;
+
+  remote.t = 4.5;
+  remote.max_hz = I2C_CLOCK_STANDARD;
+  pca.attach(3, &remote);
+  EMU_Attach(&pca);
+
+  mcp9808_begin(3);
+  CHECK(!MCP_3_exists, "MCP3 found with the channel off");
+
+  mux_channel_set(3);
+  mcp9808_begin(3);
+  CHECK(MCP_3_exists, "MCP3 not found on channel 3");
+  delay(300);
+  CHECK(fabs(mcp3.readTempC() - 4.5) < 0.001, "MCP3 %.4f", mcp3.readTempC());
+  s = EMU_Stats(MCP_ADDRESS_3);
+  CHECK(s.nack == 1 && s.err == 0, "MCP3 nack %lu err %lu", s.nack, s.err);
+  mux_deselect_all();
+  CHECK(pca.control == 0, "mux control %02X", pca.control);
+
+  EMU_Detach(&pca);
+}
+
+/*
+ * ======================================================================================================================
+ * test_dsmux() - DS18B20 conversions, a parasite probe reads 85C without the strong pullup
+ * ======================================================================================================================
+ */
+static void test_dsmux() {
+  float t[DS248X_CHANNELS];
+
+  probe0.t = 21.0625;
+  probe4.t = -3.5;
+  probe7.t = 30.25;
+  dsmux_readTemperatures(t);
+  CHECK(t[0] == probe0.t && t[4] == probe4.t && t[7] == probe7.t, "DS18B20 %.4f %.4f %.4f", t[0], t[4], t[7]);
+  CHECK(isnan(t[1]), "DS18B20 channel 1 %.4f", t[1]);
+
+  dsmux_sensor_parasite[7] = false;
+  dsmux_readTemperatures(t);
+  CHECK(t[7] == 85.0, "parasite probe without the strong pullup %.4f", t[7]);
+  dsmux_sensor_parasite[7] = true;
+
+  probe4.present = false;
+  dsmux_readTemperatures(t);
+  CHECK(isnan(t[4]) && (t[0] == probe0.t), "unplugged probe %.4f", t[4]);
+  probe4.present = true;
+}
+
+/*
+ * ======================================================================================================================
+ * test_eeprom() - A save writes the changed bytes a page per write cycle, FRAM takes the same code
+ * ======================================================================================================================
+ */
+static void test_eeprom() {
+  unsigned long cycles;
+  EMU_STATS_STR s;
+
+  STC_valid = true;
+  EEPROM_ClearRainTotals(1760832000);
+  CHECK(EEPROM_Read() && EEPROM_Valid() && (eeprom.rgts == 1760832000), "EEPROM after clear %lu",
+    (unsigned long) eeprom.rgts);
+
+  cycles = eeprom24->write_cycles;
+  eeprom.rgt1 = 2.5;
+  EEPROM_ChecksumUpdate();
+  EEPROM_Save();
+  I2CQ_Idle();                       // The page write is queued
+  CHECK(eeprom24->write_cycles == cycles + 2, "write cycles %lu", eeprom24->write_cycles - cycles);
+
+  memset(&eeprom, 0, sizeof(eeprom));
+  CHECK(EEPROM_Read() && (eeprom.rgt1 == 2.5) && EEPROM_Valid(), "EEPROM read back %.2f", eeprom.rgt1);
+
+  // Nothing changed, nothing written
+  EMU_StatsClear();
+  EEPROM_Save();
+  s = EMU_Stats(EEPROM_I2C_ADDR);
+  CHECK(s.tx == 0, "unchanged save tx %lu", s.tx);
+
+  EmuEEPROM *fram = EmuEEPROM::FRAM();
+  EMU_Detach(eeprom24);
+  EMU_Attach(fram);
+  EEPROM_Read();                     // What the new chip holds, as at boot
+  EEPROM_ClearRainTotals(1760835600);
+  memset(&eeprom, 0, sizeof(eeprom));
+  CHECK(EEPROM_Read() && EEPROM_Valid() && (eeprom.rgts == 1760835600), "FRAM %lu", (unsigned long) eeprom.rgts);
+  EMU_Detach(fram);
+  EMU_Attach(eeprom24);
+  delete fram;
+}
+
+/*
+ * ======================================================================================================================
+ * test_oled() - The display RAM follows the library buffer, the spinner is one 8 byte cell
+ * ======================================================================================================================
+ */
+static void test_oled() {
+  unsigned long bytes;
+
+  OLED_write("I2C TEST");
+  I2CQ_Idle();                       // The pages are queued
+  CHECK(memcmp(oled.ram, display32.getBuffer(), 4 * SCREEN_WIDTH) == 0, "OLED RAM differs from the buffer");
+
+  bytes = oled.data_bytes;
+  OLED_spin();
+  I2CQ_Idle();
+  CHECK(oled.data_bytes == bytes + 8, "spinner sent %lu bytes", oled.data_bytes - bytes);
+  CHECK(memcmp(oled.ram, display32.getBuffer(), 4 * SCREEN_WIDTH) == 0, "OLED RAM differs after the spinner");
+
+  OLED_sleepDisplay();
+  CHECK(!oled.on, "OLED on after sleep");
+  OLED_wakeDisplay();
+  CHECK(oled.on, "OLED off after wake");
+}
+
+int main() {
+  test_detect();
+  test_readings();
+  test_timing();
+  test_faults();
+  test_mux();
+  test_dsmux();
+  test_eeprom();
+  test_oled();
+  EMU_Report("test_i2c bus");
+  return TEST_END();
+}
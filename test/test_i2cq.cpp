@@ -0,0 +1,227 @@
+/*
+ * ======================================================================================================================
+ *  test_i2cq.cpp - Queued I2C master against the bus emulator
+ *
+ *  Off the SAMD a queued transaction runs on Wire when I2CQ_Poll() reaches it, so a caller that uses the result
+ *  without waiting sees it still pending, as it would on the board.
+ *    - Transactions stay pending until polled, run in order, call done() and are counted per address
+ *    - A missing device is an address NACK, bad lengths and a long write ahead of a read are refused, a full
+ *      queue waits for room
+ *    - A Wire transaction waits for the queue to empty first
+ *    - Adafruit_BusIO write_then_read() waits for the queue and keeps its repeated START on Wire
+ *    - The AS5600 read, EEPROM save and OLED update return with their transactions queued
+ * ======================================================================================================================
+ */
+#include <Arduino.h>
+#include "include/i2c.h"
+#include "include/i2cq.h"
+#include "include/eeprom.h"
+#include "include/output.h"
+#include "include/wrda.h"
+#include "include/time.h"
+#include <Adafruit_I2CDevice.h>
+#include "emu.h"
+#include "test.h"
+
+#define ABSENT_ADDR  0x29
+
+static EmuAS5600 as5600;
+static EmuEEPROM *eeprom24 = EmuEEPROM::EEPROM24LC32();
+static EmuSSD1306 oled(0x3C, 32);
+
+static int done_order[I2CQ_SIZE + 2];
+static int done_count = 0;
+
+/*
+ * ======================================================================================================================
+ * record_done() - done() for the tests, notes the order transactions finish in
+ * ======================================================================================================================
+ */
+static void record_done(I2CQ_XFER_STR *x) {
+  done_order[done_count++] = (int) (intptr_t) x->arg;
+}
+
+/*
+ * ======================================================================================================================
+ * angle_xfer() - AS5600 raw angle read, register pointer then 2 bytes
+ * ======================================================================================================================
+ */
+static const uint8_t angle_reg = 0x0C;
+
+static void angle_xfer(I2CQ_XFER_STR *x, uint8_t *buf, int arg) {
+  memset(x, 0, sizeof(*x));
+  x->addr = AS5600_ADR;
+  x->pre = &angle_reg;
+  x->pre_len = 1;
+  x->rx = buf;
+  x->rx_len = 2;
+  x->done = record_done;
+  x->arg = (void *) (intptr_t) arg;
+}
+
+/*
+ * ======================================================================================================================
+ * stats_tx() - Transactions counted by I2C_Count() for the address
+ * ======================================================================================================================
+ */
+static unsigned long stats_tx(uint8_t addr) {
+  for (int i = 0; i < i2c_stats_count; i++) {
+    if (i2c_stats[i].addr == addr) {
+      return i2c_stats[i].tx;
+    }
+  }
+  return 0;
+}
+
+/*
+ * ======================================================================================================================
+ * test_queue() - Pending until polled, in order, done() called, NACK status, counted
+ * ======================================================================================================================
+ */
+static void test_queue() {
+  I2CQ_XFER_STR x[3];
+  uint8_t buf[2][2];
+  uint8_t cmd = 0x00;
+  unsigned long tx = stats_tx(AS5600_ADR);
+  int raw = lround(as5600.deg / 360.0 * 4096);
+
+  done_count = 0;
+  angle_xfer(&x[0], buf[0], 0);
+  memset(&x[1], 0, sizeof(x[1]));
+  x[1].addr = ABSENT_ADDR;
+  x[1].tx = &cmd;
+  x[1].tx_len = 1;
+  x[1].done = record_done;
+  x[1].arg = (void *) 1;
+  angle_xfer(&x[2], buf[1], 2);
+  for (int i = 0; i < 3; i++) {
+    CHECK(I2CQ_Submit(&x[i]), "submit %d", i);
+  }
+  CHECK((x[0].status == I2CQ_PENDING) && (x[2].status == I2CQ_PENDING) && (done_count == 0), "ran before polled");
+
+  CHECK(I2CQ_Wait(&x[0]) == I2C_OK, "angle status %u", x[0].status);
+  CHECK((done_count == 1) && (x[1].status == I2CQ_PENDING), "wait ran past its transaction, %d done", done_count);
+  I2CQ_Idle();
+  CHECK((done_count == 3) && (done_order[0] == 0) && (done_order[1] == 1) && (done_order[2] == 2),
+    "done %d order %d %d %d", done_count, done_order[0], done_order[1], done_order[2]);
+  CHECK(x[1].status == I2C_NACK_ADDR, "absent status %u", x[1].status);
+  CHECK((x[2].status == I2C_OK) && (((buf[1][0] << 8) | buf[1][1]) == raw), "angle %d expected %d",
+    (buf[1][0] << 8) | buf[1][1], raw);
+  CHECK(stats_tx(AS5600_ADR) == tx + 2, "counted %lu", stats_tx(AS5600_ADR) - tx);
+}
+
+/*
+ * ======================================================================================================================
+ * test_limits() - Nothing to send, a phase too long or a write ahead of a read longer than I2CQ_PRE_MAX is
+ *                 refused, a full queue waits for room
+ * ======================================================================================================================
+ */
+static void test_limits() {
+  I2CQ_XFER_STR x[I2CQ_SIZE + 2];
+  uint8_t buf[I2CQ_SIZE + 2][2];
+  uint8_t big[I2CQ_MAX_LEN + 1];
+
+  memset(&x[0], 0, sizeof(x[0]));
+  x[0].addr = AS5600_ADR;
+  CHECK(!I2CQ_Submit(&x[0]), "empty transaction queued");
+  x[0].tx = big;
+  x[0].tx_len = sizeof(big);
+  CHECK(!I2CQ_Submit(&x[0]), "%u byte write queued", x[0].tx_len);
+  x[0].tx_len = I2CQ_PRE_MAX + 1;
+  x[0].rx = buf[0];
+  x[0].rx_len = 2;
+  CHECK(!I2CQ_Submit(&x[0]), "%u byte write ahead of a read queued", x[0].tx_len);
+
+  done_count = 0;
+  for (int i = 0; i < I2CQ_SIZE + 2; i++) {
+    angle_xfer(&x[i], buf[i], i);
+    I2CQ_Submit(&x[i]);
+  }
+  CHECK(done_count == 2, "%d done to make room", done_count);
+  I2CQ_Idle();
+  for (int i = 0; i < I2CQ_SIZE + 2; i++) {
+    CHECK((done_order[i] == i) && (x[i].status == I2C_OK), "transaction %d done as %d status %u", i, done_order[i],
+      x[i].status);
+  }
+}
+
+/*
+ * ======================================================================================================================
+ * test_wire() - A Wire transaction and an Adafruit driver read go after what is queued
+ * ======================================================================================================================
+ */
+static void test_wire() {
+  I2CQ_XFER_STR x;
+  uint8_t buf[2];
+  uint8_t reg = 0x0C;
+  unsigned long tx;
+
+  angle_xfer(&x, buf, 0);
+  I2CQ_Submit(&x);
+  I2C_Write(AS5600_ADR, &reg, 1);
+  CHECK(x.status == I2C_OK, "queued transaction not run before Wire, status %u", x.status);
+
+  Adafruit_I2CDevice dev(AS5600_ADR);
+  tx = stats_tx(AS5600_ADR);
+  EMU_StatsClear();
+  memset(buf, 0, sizeof(buf));
+  CHECK(dev.write_then_read(&reg, 1, buf, 2, false), "write_then_read");
+  CHECK(((buf[0] << 8) | buf[1]) == lround(as5600.deg / 360.0 * 4096), "driver angle %d", (buf[0] << 8) | buf[1]);
+  CHECK((stats_tx(AS5600_ADR) == tx + 2) && (EMU_Stats(AS5600_ADR).tx == 2), "driver read counted %lu, on bus %lu",
+    stats_tx(AS5600_ADR) - tx, EMU_Stats(AS5600_ADR).tx);
+}
+
+/*
+ * ======================================================================================================================
+ * test_hot_paths() - The 1s angle read, EEPROM save and OLED update return before their bytes are sent
+ * ======================================================================================================================
+ */
+static void test_hot_paths() {
+  unsigned long cycles, bytes;
+  int pages = (sizeof(eeprom) + EEPROM_PAGE_SIZE - 1) / EEPROM_PAGE_SIZE;   // 2 here, unsigned long is 8 bytes
+
+  as5600.deg = 200.0;
+  Wind_AngleRequest();
+  CHECK(EMU_Stats(AS5600_ADR).tx == 0, "angle read before it was collected");
+  CHECK(Wind_ReadAngle() == lround(200.0 / 360.0 * 4096), "queued angle %d", Wind_ReadAngle());
+
+  STC_valid = true;
+  EEPROM_ClearRainTotals(1760832000);
+  I2CQ_Idle();
+  cycles = eeprom24->write_cycles;
+  eeprom.rgt1 = 1.5;                 // First and last bytes change, every page is written
+  EEPROM_ChecksumUpdate();
+  EEPROM_Save();
+  CHECK(eeprom24->write_cycles == cycles + pages - 1, "save waited for the last page, %lu of %d written",
+    eeprom24->write_cycles - cycles, pages);
+  memset(&eeprom, 0, sizeof(eeprom));
+  CHECK(EEPROM_Read() && (eeprom.rgt1 == 1.5), "read after a queued save %.2f", eeprom.rgt1);
+
+  bytes = oled.data_bytes;
+  OLED_write("QUEUED");
+  CHECK(oled.data_bytes == bytes, "update waited for %lu bytes", oled.data_bytes - bytes);
+  I2CQ_Idle();
+  CHECK(oled.data_bytes == bytes + 4 * SCREEN_WIDTH, "frame sent %lu bytes", oled.data_bytes - bytes);
+}
+
+int main() {
+  EMU_Attach(&as5600);
+  EMU_Attach(eeprom24);
+  EMU_Attach(&oled);
+  as5600.deg = 45.0;
+
+  I2C_Begin();
+  OLED_initialize();
+  as5600_initialize();
+  EEPROM_initialize();
+  I2CQ_Idle();
+  CHECK((oled_type == OLED32_I2C_ADDRESS) && AS5600_exists && eeprom_exists, "station not found");
+
+  test_queue();
+  test_limits();
+  test_wire();
+  EMU_StatsClear();
+  test_hot_paths();
+
+  return TEST_END();
+}
@@ -0,0 +1,179 @@
+/*
+ * ======================================================================================================================
+ *  test_log.cpp - Daily observation log kept open on the file backed SdFat
+ *
+ *  The host preAllocate() leaves old log lines in the new space, as reused clusters on a card would.
+ *    - A new log is preallocated for the day, zeroed to the end of the sector after its data and no further
+ *    - After a power loss the log continues at its data, a line cut short, bytes that can not be in an
+ *      observation and the 0s after them are dropped
+ *    - Yesterday's log is cut to its data at the first open after boot, and at a rollover while running
+ * ======================================================================================================================
+ */
+#include <Arduino.h>
+#include <sys/stat.h>
+#include "include/sdcard.h"
+#include "include/time.h"
+#include "test.h"
+
+#define DAY0        20380              // 2025-10-19
+#define LOG_SIZE    (1440 * SD_LOG_LINE_SIZE)
+#define DAYS        3
+
+// sdcard.cpp
+extern File SD_logfp;
+extern uint32_t SD_log_day;
+
+static char expect[DAYS][4096];       // What each day's log should hold
+static int expect_len[DAYS];
+
+/*
+ * ======================================================================================================================
+ * log_path() - Path of the log for a day from DAY0
+ * ======================================================================================================================
+ */
+static void log_path(char *path, int day) {
+  time_t ts = (time_t) (DAY0 + day) * 86400;
+  struct tm *dt = gmtime(&ts);
+
+  sprintf(path, "%s/%4d%02d%02d.log", SD_obsdir, dt->tm_year+1900, dt->tm_mon+1, dt->tm_mday);
+}
+
+/*
+ * ======================================================================================================================
+ * read_log() - Contents of the log for a day, returns its size
+ * ======================================================================================================================
+ */
+static int read_log(int day, char *buf, int size) {
+  char path[32];
+  File fp;
+  int n;
+
+  log_path(path, day);
+  fp = SD.open(path, FILE_READ);
+  if (!fp) {
+    return (-1);
+  }
+  n = fp.read(buf, size);
+  fp.close();
+  return (n);
+}
+
+/*
+ * ======================================================================================================================
+ * log_obs() - Log an observation at a minute of a day from DAY0, and expect it
+ * ======================================================================================================================
+ */
+static void log_obs(int day, int minute) {
+  char obs[96];
+  int n = sprintf(obs, "{\"at\":\"%d %02d:%02d\",\"bp1\":1013.%d,\"ws\":%d.5}", day, minute / 60, minute % 60,
+    minute % 10, minute % 7);
+
+  stc.setEpoch((DAY0 + day) * 86400 + minute * 60);
+  SD_LogObservation(obs);
+  memcpy(&expect[day][expect_len[day]], obs, n);
+  memcpy(&expect[day][expect_len[day] + n], "\r\n", 2);
+  expect_len[day] += n + 2;
+}
+
+/*
+ * ======================================================================================================================
+ * power_loss() - The log is left as it is on the card and the station boots
+ * ======================================================================================================================
+ */
+static void power_loss() {
+  SD_logfp.close();
+  SD_log_day = 0;
+}
+
+/*
+ * ======================================================================================================================
+ * damage() - Bytes at the end of the data of day 0's log, as a sector written out before the power loss
+ * ======================================================================================================================
+ */
+static void damage(const char *bytes, int n) {
+  char path[32];
+  File fp;
+
+  log_path(path, 0);
+  fp = SD.open(path, O_RDWR);
+  fp.seek(expect_len[0]);
+  fp.write((const uint8_t *) bytes, n);
+  fp.close();
+}
+
+/*
+ * ======================================================================================================================
+ * check_log() - The log for a day holds the expected data, then 0s to the end of the sector after the one it
+ *               ends in, then the old lines preAllocate() left
+ * ======================================================================================================================
+ */
+static void check_log(const char *what, int day, int size) {
+  static char buf[LOG_SIZE + 1];
+  int n = read_log(day, buf, sizeof(buf));
+  int i = expect_len[day];
+  int zeroed = min(n, ((i / SD_LOG_SECTOR) + 2) * SD_LOG_SECTOR);
+
+  CHECK(n == size, "%s: day %d log %d bytes expected %d", what, day, n, size);
+  CHECK((n >= i) && (memcmp(buf, expect[day], i) == 0), "%s: day %d data \"%.*s\"", what, day,
+    (n > 0) ? min(n, i + 40) : 0, buf);
+  while ((i < zeroed) && (buf[i] == 0)) {
+    i++;
+  }
+  CHECK(i >= zeroed, "%s: day %d byte %d after the data is 0x%02X", what, day, i, (uint8_t) buf[i]);
+  CHECK((n <= zeroed) || memmem(&buf[zeroed], n - zeroed, "\"stale\":1", 9), "%s: day %d zeroed past byte %d",
+    what, day, zeroed);
+}
+
+int main() {
+  char path[32];
+
+  mkdir(host_sd_root, 0755);
+  SD.mkdir(SD_obsdir);
+  for (int day = 0; day < DAYS; day++) {
+    log_path(path, day);
+    SD.remove(path);
+  }
+  SD_exists = true;
+  STC_valid = true;
+
+  // Preallocated, zeroed a sector past the data
+  log_obs(0, 0);
+  log_obs(0, 1);
+  check_log("new", 0, LOG_SIZE);
+
+  // A line cut short, continued from the line before it
+  power_loss();
+  damage("{\"at\":\"0 00:0", 12);
+  log_obs(0, 2);
+  check_log("cut short", 0, LOG_SIZE);
+
+  // Bytes no observation holds, with an old line after them
+  power_loss();
+  damage("\xFF\xFF\xFF\xFF\r\n{\"at\":\"stale\"}\r\n", 20);
+  log_obs(0, 3);
+  check_log("erased", 0, LOG_SIZE);
+
+  // Yesterday's log cut to its data at the first open after boot
+  power_loss();
+  damage("{\"at\":\"0 00", 10);
+  log_obs(1, 0);
+  check_log("yesterday", 0, expect_len[0]);
+  check_log("today", 1, LOG_SIZE);
+
+  // Rollover while running
+  log_obs(1, 1439);
+  log_obs(2, 0);
+  check_log("rolled over", 1, expect_len[1]);
+  check_log("next day", 2, LOG_SIZE);
+
+  // Zeroed ahead as the data crosses sectors, continued after a power loss
+  for (int minute = 1; minute < 40; minute++) {
+    log_obs(2, minute);
+    check_log("growing", 2, LOG_SIZE);
+  }
+  power_loss();
+  log_obs(2, 40);
+  check_log("grown", 2, LOG_SIZE);
+
+  return TEST_END();
+}
@@ -0,0 +1,209 @@
+/*
+ * ======================================================================================================================
+ *  test_n2s.cpp - N2S spool on the file backed SdFat, writing, sending and recovering after a reboot
+ *
+ *  Each observation carries its number, Send_http() here records the numbers it is given and fails after
+ *  send_ok sends, as a lost network would.
+ *    - A full spool drops its oldest segment to take new observations
+ *    - A record with a bad CRC is skipped and the records after it are sent
+ *    - A segment is deleted only once all of it has been sent, a failed send leaves it and the cursor
+ *    - After a reboot sending resumes at the cursor, the record after the last one sent
+ *    - A N2SOBS.TXT from before the spool, CRLF ended with the last line cut short, is moved into it
+ * ======================================================================================================================
+ */
+#include <Arduino.h>
+#include <sys/stat.h>
+#include "include/sdcard.h"
+#include "include/eeprom.h"
+#include "include/network.h"
+#include "include/obs.h"
+#include "include/ssbits.h"
+#include "test.h"
+
+#define PER_SEGMENT 32                 // Records of REC_SIZE to a segment
+#define REC_SIZE    (SD_N2S_HEADER_SIZE + OBS_LEN + 1)
+#define OBS_LEN     990
+#define SEGMENTS    4
+#define RECORDS     ((SEGMENTS + 1) * PER_SEGMENT)
+#define BAD_CRC     (PER_SEGMENT + 8)  // Damaged after it is spooled
+
+static int send_ok = 0;               // Sends that go through before one fails
+static int sent[RECORDS];             // Observation numbers in the order sent
+static int sent_len[RECORDS];
+static int sent_count = 0;
+
+// sdcard.cpp
+extern uint32_t n2s_segments_max;
+extern char SD_n2s_file[];
+
+/*
+ * ======================================================================================================================
+ * Send_http() - Record the observation number, fail once send_ok sends have gone through
+ * ======================================================================================================================
+ */
+bool Send_http(char *msg, char *webserver, int webserver_port, char *webserver_path, int webserver_method,
+    char *webserver_xapikey) {
+  char *p = strstr(msg, "obs=");
+
+  if (send_ok <= 0) {
+    return false;
+  }
+  send_ok--;
+  if (sent_count < RECORDS) {
+    sent[sent_count] = (p) ? atoi(p + 4) : -1;
+    sent_len[sent_count++] = strlen(msg);
+  }
+  return true;
+}
+
+/*
+ * ======================================================================================================================
+ * seg_path() - Path of a spool segment, as SD_N2S_Name()
+ * ======================================================================================================================
+ */
+static void seg_path(char *path, uint32_t seq) {
+  sprintf(path, "%s/%08lX.TXT", SD_N2S_DIR, (unsigned long) seq);
+}
+
+/*
+ * ======================================================================================================================
+ * obs_text() - Observation i padded to OBS_LEN
+ * ======================================================================================================================
+ */
+static void obs_text(int i, char *buf) {
+  int n = sprintf(buf, "/measurements/url_create?key=test&obs=%d&at=2025-10-19T%02d:%02d:00", i, i / 60, i % 60);
+
+  memset(&buf[n], 'x', OBS_LEN - n);
+  buf[OBS_LEN] = 0;
+}
+
+/*
+ * ======================================================================================================================
+ * spool_clear() - Remove the segments and the legacy file of an earlier run
+ * ======================================================================================================================
+ */
+static void spool_clear() {
+  File dir, fp;
+  char name[16];
+  char path[32];
+
+  dir = SD.open(SD_N2S_DIR);
+  while (fp.openNext(&dir, O_RDONLY)) {
+    fp.getName(name, sizeof(name));
+    fp.close();
+    snprintf(path, sizeof(path), "%s/%s", SD_N2S_DIR, name);
+    SD.remove(path);
+  }
+  dir.close();
+  SD.remove(SD_n2s_file);
+}
+
+/*
+ * ======================================================================================================================
+ * reboot() - Find the spool again as at boot, eeprom keeps the cursor. The spool is held to SEGMENTS
+ * ======================================================================================================================
+ */
+static void reboot() {
+  SD_N2S_Initialize();
+  n2s_segments_max = SEGMENTS;
+}
+
+/*
+ * ======================================================================================================================
+ * publish() - Send with ok sends going through, check the observations sent are first to last, less BAD_CRC
+ * ======================================================================================================================
+ */
+static void publish(const char *what, int ok, int first, int last) {
+  int n = 0;
+
+  send_ok = ok;
+  sent_count = 0;
+  SD_N2S_Publish();
+
+  for (int i = first; i <= last; i++) {
+    if (i == BAD_CRC) {
+      continue;
+    }
+    CHECK((n < sent_count) && (sent[n] == i), "%s: send %d is %d expected %d", what, n,
+      (n < sent_count) ? sent[n] : -1, i);
+    n++;
+  }
+  CHECK(sent_count == n, "%s: %d sent expected %d", what, sent_count, n);
+}
+
+int main() {
+  char obs[MAX_OBS_SIZE];
+  char path[24];
+  File fp;
+
+  strcpy(host_sd_root, "sd_n2s");
+  mkdir(host_sd_root, 0755);
+  SD.mkdir(SD_N2S_DIR);
+  spool_clear();
+  SD_exists = true;
+  eeprom.n2sfp = 0;
+
+  reboot();
+  CHECK(n2s_head == 0, "new spool head %lu", (unsigned long) n2s_head);
+
+  // Full, the first segment is dropped for the last one
+  for (int i = 0; i < RECORDS; i++) {
+    obs_text(i, obs);
+    CHECK(SD_N2S_Write(obs), "write %d", i);
+  }
+  seg_path(path, 1);
+  CHECK((n2s_head == 2) && (n2s_tail == SEGMENTS + 1) && !SD.exists(path), "full spool %lu-%lu",
+    (unsigned long) n2s_head, (unsigned long) n2s_tail);
+  CHECK(n2s_bytes == (uint32_t) (SEGMENTS * PER_SEGMENT * REC_SIZE), "full spool %lu bytes",
+    (unsigned long) n2s_bytes);
+
+  // A payload byte for a CRC error
+  seg_path(path, 2);
+  fp = SD.open(path, O_RDWR);
+  fp.seek((BAD_CRC - PER_SEGMENT) * REC_SIZE + SD_N2S_HEADER_SIZE + 20);
+  fp.write((uint8_t) '#');
+  fp.close();
+
+  // Sending stops part way into the head segment, it stays
+  publish("part sent", 10, PER_SEGMENT, PER_SEGMENT + 10);
+  CHECK((n2s_head == 2) && SD.exists(path), "part sent head %lu", (unsigned long) n2s_head);
+  CHECK(eeprom.n2sfp == SD_N2S_CURSOR(2, 11 * REC_SIZE), "part sent cursor %08lX", (unsigned long) eeprom.n2sfp);
+
+  // After a reboot the rest of the head segment, it is deleted, then part of the next
+  reboot();
+  CHECK((n2s_head == 2) && (n2s_tail == SEGMENTS + 1), "reboot spool %lu-%lu", (unsigned long) n2s_head,
+    (unsigned long) n2s_tail);
+  publish("resumed", 40, PER_SEGMENT + 11, 2 * PER_SEGMENT + 18);
+  CHECK((n2s_head == 3) && !SD.exists(path), "resumed head %lu", (unsigned long) n2s_head);
+  CHECK(eeprom.n2sfp == SD_N2S_CURSOR(3, 19 * REC_SIZE), "resumed cursor %08lX", (unsigned long) eeprom.n2sfp);
+
+  // The rest, the spool is empty
+  publish("all sent", RECORDS, 2 * PER_SEGMENT + 19, RECORDS - 1);
+  CHECK((n2s_head == 0) && (n2s_bytes == 0) && !(SystemStatusBits & SSB_N2S), "all sent head %lu %lu bytes",
+    (unsigned long) n2s_head, (unsigned long) n2s_bytes);
+  for (uint32_t seq = 2; seq <= SEGMENTS + 1; seq++) {
+    seg_path(path, seq);
+    CHECK(!SD.exists(path), "all sent %s left", path);
+  }
+
+  // N2SOBS.TXT written with println(), a line too long, an empty line and the last line without its end
+  fp = SD.open(SD_n2s_file, FILE_WRITE);
+  fp.print("/measurements/url_create?obs=1000&legacy=1\r\n");
+  memset(obs, 'x', sizeof(obs));
+  fp.write((uint8_t *) obs, sizeof(obs));
+  fp.print("\r\n/measurements/url_create?obs=1001&legacy=1\r\n\r\n");
+  fp.print("/measurements/url_create?obs=1002&legacy=1");
+  fp.close();
+  reboot();
+  CHECK(!SD.exists(SD_n2s_file) && (n2s_head == 1), "legacy not moved, head %lu", (unsigned long) n2s_head);
+
+  send_ok = RECORDS;
+  sent_count = 0;
+  SD_N2S_Publish();
+  CHECK(sent_count == 3, "legacy %d sent", sent_count);
+  for (int i = 0; i < sent_count; i++) {
+    CHECK((sent[i] == 1000 + i) && (sent_len[i] == 42), "legacy send %d obs %d %d bytes", i, sent[i], sent_len[i]);
+  }
+
+  return TEST_END();
+}
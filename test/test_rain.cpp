@@ -0,0 +1,109 @@
+/*
+ * ======================================================================================================================
+ *  test_rain.cpp - Rain gauge tip ring and 1s bins
+ *
+ *    - A tip that sat in the ring past an observation counts without moving the bins backwards
+ *    - A tip queued just before an observation still counts in its own second
+ *    - millis() wrapping starts the bins over once, a tip from before the wrap does not move them back
+ * ======================================================================================================================
+ */
+#include <Arduino.h>
+#include "include/qc.h"
+#include "include/wrda.h"
+#include "test.h"
+
+static void set_ms(uint64_t ms) {
+  host_advance_us(ms * 1000 - host_time_us());
+}
+
+static void tip_at(uint64_t ms) {
+  set_ms(ms);
+  raingauge1_interrupt_handler();
+}
+
+/*
+ * ======================================================================================================================
+ * test_late_tip() - 5 tips, an observation, then a tip queued 80s before the observation is drained
+ * ======================================================================================================================
+ */
+static void test_late_tip() {
+  RAIN_PRODUCTS_STR p;
+
+  Rain_Clear(&raingauge1, RG_DEBOUNCE_MS);
+  for (int i = 0; i < 5; i++) {
+    tip_at(1000000 + i * 2000);
+  }
+  Rain_Drain();
+  CHECK(raingauge1.sum300 == 5, "sum300 %u", raingauge1.sum300);
+
+  tip_at(1020000);
+  set_ms(1100000);
+  Rain_Products(&raingauge1, &p, 1760000000);
+  uint32_t bin_sec = raingauge1.bin_sec;
+  Rain_Drain();
+
+  CHECK(raingauge1.bin_sec == bin_sec, "bins moved from %lu to %lu", (unsigned long) bin_sec,
+        (unsigned long) raingauge1.bin_sec);
+  CHECK(raingauge1.sum300 == 6, "earlier tips lost, sum300 %u", raingauge1.sum300);
+  CHECK(raingauge1.sum60 == 1, "late tip not in the newest second, sum60 %u", raingauge1.sum60);
+  CHECK(raingauge1.bin[bin_sec % RG_BINS] == 1, "newest bin %u", raingauge1.bin[bin_sec % RG_BINS]);
+  CHECK(raingauge1_interrupt_count == 6, "count %u", raingauge1_interrupt_count);
+}
+
+/*
+ * ======================================================================================================================
+ * test_recent_tip() - A tip 20s before the observation it is drained after
+ * ======================================================================================================================
+ */
+static void test_recent_tip() {
+  RAIN_PRODUCTS_STR p;
+
+  Rain_Clear(&raingauge1, RG_DEBOUNCE_MS);
+  tip_at(2000000);
+  Rain_Drain();
+  tip_at(2040000);
+  set_ms(2060000);
+  Rain_Products(&raingauge1, &p, 1760000000);
+  Rain_Drain();
+
+  CHECK(raingauge1.bin[2040 % RG_BINS] == 1, "tip not in its own second");
+  CHECK(raingauge1.bin_sec == 2060, "bin_sec %lu", (unsigned long) raingauge1.bin_sec);
+  CHECK(raingauge1.sum60 == 1, "sum60 %u", raingauge1.sum60);
+  CHECK(raingauge1.sum300 == 2, "sum300 %u", raingauge1.sum300);
+}
+
+/*
+ * ======================================================================================================================
+ * test_wrap() - Tips either side of millis() wrapping
+ * ======================================================================================================================
+ */
+static void test_wrap() {
+  const uint64_t wrap = 0x100000000ULL;
+
+  Rain_Clear(&raingauge1, RG_DEBOUNCE_MS);
+  tip_at(wrap - 10000);
+  Rain_Drain();
+  tip_at(wrap - 5000);                  // Queued before the wrap, drained after a tip past it
+  set_ms(wrap + 3000);
+  raingauge1_interrupt_handler();
+
+  // Drain the first queued tip only after a post wrap tip has moved the bins on
+  uint32_t first = raingauge1.tip[raingauge1.tail & RG_TIP_MASK];
+  uint32_t second = raingauge1.tip[(raingauge1.tail + 1) & RG_TIP_MASK];
+  raingauge1.tip[raingauge1.tail & RG_TIP_MASK] = second;
+  raingauge1.tip[(raingauge1.tail + 1) & RG_TIP_MASK] = first;
+  Rain_Drain();
+
+  CHECK(raingauge1.bin_sec == 3, "bin_sec %lu", (unsigned long) raingauge1.bin_sec);
+  CHECK(raingauge1.sum60 == 2, "sum60 %u", raingauge1.sum60);
+  CHECK(raingauge1_interrupt_count == 3, "count %u", raingauge1_interrupt_count);
+}
+
+int main() {
+  test_late_tip();
+  raingauge1_interrupt_count = 0;
+  test_recent_tip();
+  raingauge1_interrupt_count = 0;
+  test_wrap();
+  return TEST_END();
+}
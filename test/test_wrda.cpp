@@ -0,0 +1,181 @@
+/*
+ * ======================================================================================================================
+ *  test_wrda.cpp - Fixed point wind direction against a double precision reference
+ *
+ *  The Q15 sine table and the CORDIC vector angle replaced float sin/cos/atan2 in the 1s wind path. Every
+ *  direction they produce must be within 0.5 degrees of atan2() on the same samples.
+ *    - Single samples, all 4096 AS5600 raw angles
+ *    - Random vector sums over the full range of 60 sample minutes
+ *    - One minute of samples through Wind_TakeReading() and Wind_DirectionVector(), with the AS5600 answered
+ *      here in place of the I2C layer
+ * ======================================================================================================================
+ */
+#include <Arduino.h>
+#include "include/qc.h"
+#include "include/i2c.h"
+#include "include/wrda.h"
+#include "test.h"
+
+#define DIR_TOLERANCE  0.5     // Degrees
+
+static int as5600_angle = 0;   // Raw angle the emulated AS5600 returns
+
+extern WIND_STR wind;
+
+/*
+ * ======================================================================================================================
+ * I2C_Write(), I2C_Read() - AS5600 at AS5600_ADR, register pointer write then a 2 byte raw angle read
+ * ======================================================================================================================
+ */
+uint8_t I2C_Write(uint8_t addr, const uint8_t *buf, int len, bool stop) {
+  (void) buf; (void) len; (void) stop;
+  return (addr == AS5600_ADR) ? I2C_OK : 2;
+}
+
+int I2C_Read(uint8_t addr, uint8_t *buf, int len) {
+  if ((addr != AS5600_ADR) || (len != 2)) {
+    return (0);
+  }
+  buf[0] = (as5600_angle >> 8) & 0x0f;
+  buf[1] = as5600_angle & 0xff;
+  return (2);
+}
+
+/*
+ * ======================================================================================================================
+ * angle_diff() - Smallest difference between two directions in degrees
+ * ======================================================================================================================
+ */
+static double angle_diff(double a, double b) {
+  double d = fmod(fabs(a - b), 360.0);
+  return (d > 180.0) ? 360.0 - d : d;
+}
+
+static double bam_degrees(uint32_t angle) {
+  return angle * (360.0 / 4294967296.0);
+}
+
+static double reference_degrees(double ns, double ew) {
+  double d = atan2(ew, ns) * 180.0 / M_PI;
+  return (d < 0) ? d + 360.0 : d;
+}
+
+/*
+ * ======================================================================================================================
+ * test_sin_table() - Q15 sine and cosine against sin()/cos()
+ * ======================================================================================================================
+ */
+static void test_sin_table() {
+  int worst = 0;
+
+  for (int a = 0; a < WIND_ANGLE_STEPS; a++) {
+    double r = a * 2.0 * M_PI / WIND_ANGLE_STEPS;
+    int es = abs(Wind_Sin_Q15(a) - (int) lround(sin(r) * 32767.0));
+    int ec = abs(Wind_Cos_Q15(a) - (int) lround(cos(r) * 32767.0));
+    worst = max(worst, max(es, ec));
+  }
+  CHECK(worst <= 1, "sin/cos Q15 off by %d", worst);
+  printf("sin/cos Q15 worst error %d LSB\n", worst);
+}
+
+/*
+ * ======================================================================================================================
+ * test_single_angles() - One sample at every raw angle
+ * ======================================================================================================================
+ */
+static void test_single_angles() {
+  double worst = 0;
+
+  for (int a = 0; a < WIND_ANGLE_STEPS; a++) {
+    int32_t cms = 1 + (a % 5000);
+    int64_t ns = (int64_t) Wind_Cos_Q15(a) * cms;
+    int64_t ew = (int64_t) Wind_Sin_Q15(a) * cms;
+    double ref = a * 360.0 / WIND_ANGLE_STEPS;
+    double d = angle_diff(bam_degrees(Wind_VectorToAngle(ns, ew)), ref);
+
+    worst = max(worst, d);
+    CHECK(d <= DIR_TOLERANCE, "raw angle %d: %.4f from %.4f", a, bam_degrees(Wind_VectorToAngle(ns, ew)), ref);
+    CHECK(angle_diff(Wind_VectorToDegrees(ns, ew), ref) <= DIR_TOLERANCE + 0.5, "raw angle %d: %d degrees", a,
+          Wind_VectorToDegrees(ns, ew));
+  }
+  printf("single sample worst error %.4f degrees\n", worst);
+}
+
+/*
+ * ======================================================================================================================
+ * test_vector_sums() - Random sums from a few cm/s up to 60 samples at 100 m/s
+ * ======================================================================================================================
+ */
+static void test_vector_sums() {
+  const int64_t limit = 60LL * 32767 * 10000;
+  double worst = 0;
+
+  srand(27);
+  for (int i = 0; i < 200000; i++) {
+    int64_t scale = 1LL << (rand() % 36);
+    int64_t ns = ((int64_t) rand() * 2 - RAND_MAX) % (min(scale, limit) + 1);
+    int64_t ew = ((int64_t) rand() * 2 - RAND_MAX) % (min(scale, limit) + 1);
+    if ((ns == 0) && (ew == 0)) {
+      continue;
+    }
+    double d = angle_diff(bam_degrees(Wind_VectorToAngle(ns, ew)), reference_degrees(ns, ew));
+    worst = max(worst, d);
+    CHECK(d <= DIR_TOLERANCE, "ns %lld ew %lld: %.4f from %.4f", (long long) ns, (long long) ew,
+          bam_degrees(Wind_VectorToAngle(ns, ew)), reference_degrees(ns, ew));
+  }
+
+  // Axes and diagonals, where the quadrant handling has to be exact
+  CHECK(Wind_VectorToDegrees(1000, 0) == 0, "north");
+  CHECK(Wind_VectorToDegrees(0, 1000) == 90, "east");
+  CHECK(Wind_VectorToDegrees(-1000, 0) == 180, "south");
+  CHECK(Wind_VectorToDegrees(0, -1000) == 270, "west");
+  CHECK(Wind_VectorToDegrees(1000, 1000) == 45, "north east");
+  CHECK(Wind_VectorToDegrees(-1000, -1000) == 225, "south west");
+  CHECK(Wind_VectorToDegrees(limit, -1) == 0, "north, just west");
+  printf("vector sum worst error %.4f degrees\n", worst);
+}
+
+/*
+ * ======================================================================================================================
+ * test_minute() - 60 samples through the 1s path, a veering and gusting wind each minute
+ * ======================================================================================================================
+ */
+static void test_minute() {
+  double worst = 0;
+
+  srand(60);
+  for (int minute = 0; minute < 50; minute++) {
+    int centre = rand() % WIND_ANGLE_STEPS;
+    int spread = rand() % 1500;
+    double ns = 0, ew = 0, speed[WIND_READINGS];
+    int angle[WIND_READINGS];
+
+    for (int i = 0; i < WIND_READINGS; i++) {
+      angle[i] = (centre + (rand() % (2 * spread + 1)) - spread) & (WIND_ANGLE_STEPS - 1);
+      as5600_angle = angle[i];
+      anemometer_interrupt_count = 1 + rand() % 40;
+      delay(1000);
+      Wind_TakeReading();
+      speed[i] = wind.bucket[(wind.bucket_idx + WIND_READINGS - 1) % WIND_READINGS].speed;
+    }
+    for (int i = 0; i < WIND_READINGS; i++) {
+      double r = angle[i] * 2.0 * M_PI / WIND_ANGLE_STEPS;
+      ns += speed[i] * cos(r);
+      ew += speed[i] * sin(r);
+    }
+    double ref = reference_degrees(ns, ew);
+    int wd = Wind_DirectionVector();
+    double d = angle_diff(wd, ref);
+    worst = max(worst, d);
+    CHECK(d <= DIR_TOLERANCE + 0.5, "minute %d: %d degrees from %.4f", minute, wd, ref);
+  }
+  printf("one minute direction worst error %.4f degrees, integer output\n", worst);
+}
+
+int main() {
+  test_sin_table();
+  test_single_angles();
+  test_vector_sums();
+  test_minute();
+  return TEST_END();
+}
@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""
+cal_decode.py - Decode 3D-PAWS MKR calibration stream records to CSV
+
+Live from the station (needs pyserial), sends "CAL <hz>" and stops with "Q" on Ctrl-C:
+    python3 cal_decode.py --port /dev/ttyACM0 --rate 20 > run.csv
+From a saved raw capture:
+    python3 cal_decode.py --file capture.bin > run.csv
+
+Record: 0xA5 0x5A, type, length, payload, CRC-16/CCITT-FALSE (little endian) over type, length and payload.
+See include/cal.h for the payload layout.
+"""
+import argparse
+import struct
+import sys
+
+SYNC = b"\xa5\x5a"
+TYPE_RAW = 1
+RAW = struct.Struct("<HIIIIHHHIIfff")
+FIELDS = ["seq", "ms", "us", "pulses", "pulse_us", "angle", "op1", "op2",
+          "rg1", "rg2", "bp", "bt", "bh"]
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if (crc & 0x8000) else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+class Decoder:
+    """Feed bytes, get (type, payload) for each record with a good CRC. Text before the stream is skipped."""
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.bad = 0
+
+    def feed(self, data):
+        self.buf += data
+        while True:
+            i = self.buf.find(SYNC)
+            if i < 0:
+                del self.buf[:-1]
+                return
+            del self.buf[:i]
+            if len(self.buf) < 4:
+                return
+            n = self.buf[3]
+            if len(self.buf) < 4 + n + 2:
+                return
+            body = bytes(self.buf[2:4 + n])
+            crc, = struct.unpack_from("<H", self.buf, 4 + n)
+            if crc16_ccitt(body) != crc:
+                self.bad += 1
+                del self.buf[:1]  # False sync, look again one byte on
+                continue
+            del self.buf[:4 + n + 2]
+            yield body[0], body[2:]
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--port", help="serial port of the station")
+    ap.add_argument("--rate", type=int, default=20, help="records per second, 10-50")
+    ap.add_argument("--file", help="decode a raw capture instead of a port")
+    args = ap.parse_args()
+
+    if args.file:
+        src = open(args.file, "rb")
+        read = lambda: src.read(4096)
+    elif args.port:
+        import serial
+        src = serial.Serial(args.port, 115200, timeout=0.5)
+        src.write(b"CAL %d\r\n" % args.rate)
+        read = lambda: src.read(4096)
+    else:
+        ap.error("--port or --file is needed")
+
+    dec = Decoder()
+    last_seq = None
+    lost = 0
+    print(",".join(FIELDS))
+    try:
+        while True:
+            data = read()
+            if not data:
+                if args.file:
+                    break
+                continue
+            for rtype, payload in dec.feed(data):
+                if rtype != TYPE_RAW or len(payload) != RAW.size:
+                    continue
+                rec = RAW.unpack(payload)
+                if last_seq is not None:
+                    lost += (rec[0] - last_seq - 1) & 0xFFFF
+                last_seq = rec[0]
+                print(",".join("%.2f" % v if isinstance(v, float) else str(v) for v in rec))
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if args.port:
+            src.write(b"Q")
+        print("records lost %d, bad crc %d" % (lost, dec.bad), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()